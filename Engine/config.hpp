@@ -9,4 +9,28 @@
 // === RENDERER BACKENDS ===
 #define RENDERER_OPENGL
 
+// === MATH ===
+
+// Routes VectorBase::magnitude() and normalize() through Math::fast::rsqrt (see math/fast_math.hpp).
+// #define MATH_FAST_SQRT
+
+// Routes the Mat4 rotation builders through Math::fast::sin and cos.
+// #define MATH_FAST_TRIG
+
+// === STRING NAMES ===
+
+// Keeps the StringNameTable in release builds too, so names still print as text instead of hashes.
+// It is always kept in debug builds.
+// #define STRING_NAME_TABLE_IN_RELEASE
+
+// === LOGGING ===
+
+// The least important severity that is compiled in at all (Error, Warning or Info).
+// Log calls below it compile to nothing. Defaults to Info, which keeps everything.
+// #define LOG_MIN_SEVERITY Warning
+
+// The channels that are compiled in at all, as Logger::Channel values or'ed together.
+// Log calls on other channels compile to nothing. Defaults to Channel::All.
+// #define LOG_COMPILED_CHANNELS (Channel::General | Channel::Resources)
+
 #endif // CONFIG_H
@@ -67,13 +67,13 @@ Use this line before header, if you don't want flags(T x) function to be impleme
 
 #define ENUM_FLAGS_EX_NO_FLAGS_FUNC(T,INT_T) \
 enum class T;	\
-inline T	operator	&	(T x, T y)		{	return static_cast<T>	(static_cast<INT_T>(x) & static_cast<INT_T>(y));	}; \
-inline T	operator	|	(T x, T y)		{	return static_cast<T>	(static_cast<INT_T>(x) | static_cast<INT_T>(y));	}; \
-inline T	operator	^	(T x, T y)		{	return static_cast<T>	(static_cast<INT_T>(x) ^ static_cast<INT_T>(y));	}; \
-inline T	operator	~	(T x)			{	return static_cast<T>	(~static_cast<INT_T>(x));							}; \
-inline T&	operator	&=	(T& x, T y)		{	x = x & y;	return x;	}; \
-inline T&	operator	|=	(T& x, T y)		{	x = x | y;	return x;	}; \
-inline T&	operator	^=	(T& x, T y)		{	x = x ^ y;	return x;	};
+constexpr T	operator	&	(T x, T y)		{	return static_cast<T>	(static_cast<INT_T>(x) & static_cast<INT_T>(y));	}; \
+constexpr T	operator	|	(T x, T y)		{	return static_cast<T>	(static_cast<INT_T>(x) | static_cast<INT_T>(y));	}; \
+constexpr T	operator	^	(T x, T y)		{	return static_cast<T>	(static_cast<INT_T>(x) ^ static_cast<INT_T>(y));	}; \
+constexpr T	operator	~	(T x)			{	return static_cast<T>	(~static_cast<INT_T>(x));							}; \
+constexpr T&	operator	&=	(T& x, T y)		{	x = x & y;	return x;	}; \
+constexpr T&	operator	|=	(T& x, T y)		{	x = x | y;	return x;	}; \
+constexpr T&	operator	^=	(T& x, T y)		{	x = x ^ y;	return x;	};
 
 #if(USE_ENUM_FLAGS_FUNCTION)
 
@@ -1,37 +1,60 @@
-#include <stack>
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <csignal>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 #include "logger.hpp"
+#include "string_name_table.hpp"
 
 using namespace Logger;
+using namespace Logger::Detail;
 
 Severity Logger::g_severityMask {Severity::All};
 Channel Logger::g_channelMask {Channel::All};
 
-bool Logger::shouldShow(Channel channel)
-{
-    return (g_channelMask & channel) != Channel::None;
-}
-
-bool Logger::shouldShow(Severity severity)
-{
-    return (g_severityMask & severity) != Severity::None;
-}
-
 // Default Channel Stack
-static std::stack<Channel> s_channelStack{};
+// Each thread has its own, so janitors on different threads can't pop each other's channels.
+static thread_local Channel t_channelStack[MAX_CHANNEL_DEPTH] {};
+static thread_local s32 t_channelDepth {};
 
 void Logger::pushDefaultChannel(Channel channel)
 {
-    s_channelStack.push(channel);
+    assert(t_channelDepth < MAX_CHANNEL_DEPTH && "Too many default channels pushed.");
+
+    if (t_channelDepth < MAX_CHANNEL_DEPTH)
+        t_channelStack[t_channelDepth] = channel;
+
+    t_channelDepth++;
 }
 
 void Logger::popDefaultChannel()
 {
-    s_channelStack.pop();
+    assert(t_channelDepth > 0 && "Popped more default channels than were pushed.");
+
+    if (t_channelDepth > 0)
+        t_channelDepth--;
 }
 
 Channel Logger::getDefaultChannel()
 {
-    return s_channelStack.empty() ? Channel::General : s_channelStack.top();
+    return t_channelDepth == 0 ? Channel::General : t_channelStack[std::min(t_channelDepth, MAX_CHANNEL_DEPTH) - 1];
 }
 
 DefaultLogChannelJanitor::DefaultLogChannelJanitor(Channel channel)
@@ -43,3 +66,980 @@ DefaultLogChannelJanitor::~DefaultLogChannelJanitor()
 {
     popDefaultChannel();
 }
+
+const char* Logger::getName(Severity severity)
+{
+    switch (severity)
+    {
+        case Severity::Error: return "Error";
+        case Severity::Warning: return "Warning";
+        case Severity::Info: return "Info";
+        default: return "";
+    }
+}
+
+const char* Logger::getName(Channel channel)
+{
+    switch (channel)
+    {
+        case Channel::General: return "General";
+        case Channel::Rendering: return "Rendering";
+        case Channel::Resources: return "Resources";
+        default: return "";
+    }
+}
+
+// === Sinks ===
+
+void ConsoleSink::write(std::string_view lines)
+{
+    std::cout.write(lines.data(), static_cast<std::streamsize>(lines.size()));
+}
+
+void ConsoleSink::flush()
+{
+    std::cout.flush();
+}
+
+FileSink::FileSink(const char* path) : m_file{path, std::ios::out | std::ios::trunc}
+{
+    if (!m_file.is_open())
+        std::cerr << "Failed to open log file " << path << "!" << std::endl;
+}
+
+void FileSink::write(std::string_view lines)
+{
+    m_file.write(lines.data(), static_cast<std::streamsize>(lines.size()));
+}
+
+void FileSink::flush()
+{
+    m_file.flush();
+}
+
+// Guards the sink list, and keeps lines from different threads from interleaving.
+static std::mutex s_sinkMutex {};
+static std::vector<std::unique_ptr<Sink>> s_sinks {};
+static ConsoleSink s_defaultSink {};
+
+void Logger::addSink(std::unique_ptr<Sink> sink)
+{
+    std::scoped_lock lock {s_sinkMutex};
+    s_sinks.push_back(std::move(sink));
+}
+
+void Logger::clearSinks()
+{
+    std::scoped_lock lock {s_sinkMutex};
+    s_sinks.clear();
+}
+
+static void writeToSinks(std::string_view lines, bool flush)
+{
+    std::scoped_lock lock {s_sinkMutex};
+
+    if (s_sinks.empty())
+    {
+        s_defaultSink.write(lines);
+
+        if (flush)
+            s_defaultSink.flush();
+    }
+
+    for (std::unique_ptr<Sink>& sink : s_sinks)
+    {
+        sink->write(lines);
+
+        if (flush)
+            sink->flush();
+    }
+}
+
+static void appendPrefix(std::string& output, Channel channel, Severity severity)
+{
+    std::format_to(std::back_inserter(output), "[{}:{}] ", getName(severity), getName(channel));
+}
+
+void Logger::writeMessage(Channel channel, Severity severity, std::string_view message)
+{
+    std::string line {};
+    appendPrefix(line, channel, severity);
+    line.append(message);
+    line.push_back('\n');
+    writeToSinks(line, true);
+}
+
+// === Asynchronous Logging ===
+
+std::atomic<bool> Detail::g_async {false};
+std::atomic<bool> Detail::g_binary {false};
+
+namespace
+{
+    // A single-producer, single-consumer ring of records. Each logging thread owns one,
+    // and only the sink thread reads from it.
+    struct Queue
+    {
+        explicit Queue(u32 capacity) : records{new Record[capacity]}, mask{capacity - 1}
+        {
+        }
+
+        std::unique_ptr<Record[]> records;
+        const u32 mask;
+        // The queue that was added before this one. Never changes once the queue is in s_queueList.
+        Queue* next {};
+
+        // Only written by the sink thread.
+        alignas(64) std::atomic<u32> head {};
+        // Only written by the owning thread.
+        alignas(64) std::atomic<u32> tail {};
+        // Cleared when the owning thread exits, so another thread can take the queue over.
+        std::atomic<bool> owned {};
+
+        // Only used by the crash handler, which can't allocate anywhere else to keep track.
+        u32 crashCursor {};
+        u32 crashEnd {};
+    };
+
+    AsyncSettings s_settings {};
+    std::atomic<u32> s_generation {};
+    std::atomic<u64> s_sequence {};
+    std::atomic<u64> s_droppedCount {};
+    // The drops that have not been reported in the log yet.
+    std::atomic<u64> s_unreportedDrops {};
+
+    // Every queue made since startAsync(), newest first. Queues are only freed by stopAsync(), once nothing
+    // can be writing to them, so the sink thread and the crash handler can walk this without a lock.
+    std::atomic<Queue*> s_queueList {};
+
+    // How many threads are between beginRecord() and commitRecord(), or handing a queue back.
+    // stopAsync() waits for this to reach zero before its final drain, and before freeing the queues.
+    std::atomic<u32> s_activeWriters {};
+
+    std::thread s_sinkThread {};
+    std::mutex s_wakeMutex {};
+    std::condition_variable s_wake {};
+    std::atomic<bool> s_stopRequested {};
+
+    // Set by the crash handler, so stopAsync() leaves the queues it may be reading alone.
+    std::atomic<bool> s_crashing {};
+
+    // Held while draining, so flush() and the sink thread never drain at the same time.
+    std::mutex s_drainMutex {};
+
+    // === Binary Log Writing ===
+
+    struct FormatInfo
+    {
+        std::string_view format;
+        std::vector<ArgumentType> types;
+    };
+
+    // Every compile-time format registered so far. Format ids are indices into this, plus one.
+    std::mutex s_formatMutex {};
+    std::deque<FormatInfo> s_formats {};
+
+    // Only touched while draining.
+    std::ofstream s_binaryFile {};
+    std::vector<bool> s_writtenFormats {};
+    std::unordered_set<StringName::Hash> s_writtenNames {};
+
+    template <typename T>
+    void append(std::string& output, const T& value)
+    {
+        output.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void appendString(std::string& output, std::string_view string)
+    {
+        append(output, static_cast<u32>(string.size()));
+        output.append(string);
+    }
+
+    // Writes the format (and any names its arguments refer to) the first time a record uses them,
+    // followed by the record itself.
+    void appendBinaryRecord(std::string& output, const Record& record)
+    {
+        const FormatInfo* info {};
+        {
+            std::scoped_lock lock {s_formatMutex};
+            info = &s_formats[record.formatId - 1];
+        }
+
+        if (s_writtenFormats.size() <= record.formatId)
+            s_writtenFormats.resize(record.formatId + 1);
+
+        if (!s_writtenFormats[record.formatId])
+        {
+            s_writtenFormats[record.formatId] = true;
+            append(output, BinaryEntry::Format);
+            append(output, record.formatId);
+            appendString(output, info->format);
+            append(output, static_cast<u8>(info->types.size()));
+            output.append(reinterpret_cast<const char*>(info->types.data()), info->types.size());
+        }
+
+        const u8* cursor {record.arguments};
+
+        for (ArgumentType type : info->types)
+        {
+            if (type == ArgumentType::Name)
+            {
+                StringName::Hash hash {};
+                std::memcpy(&hash, cursor, sizeof(hash));
+
+                if (const char* name = StringNameTable::find(hash); name != nullptr && s_writtenNames.insert(hash).second)
+                {
+                    append(output, BinaryEntry::Name);
+                    append(output, hash);
+                    appendString(output, name);
+                }
+            }
+
+            if (type == ArgumentType::String)
+            {
+                u32 size {};
+                std::memcpy(&size, cursor, sizeof(size));
+                cursor += size;
+            }
+
+            cursor += Detail::getFixedSize(type);
+        }
+
+        append(output, BinaryEntry::Message);
+        append(output, record.formatId);
+        append(output, static_cast<u32>(record.channel));
+        append(output, static_cast<u32>(record.severity));
+        append(output, record.size);
+        output.append(reinterpret_cast<const char*>(record.arguments), record.size);
+    }
+
+    bool openBinaryLog(const char* path)
+    {
+        s_binaryFile.open(path, std::ios::binary | std::ios::out | std::ios::trunc);
+
+        if (!s_binaryFile.is_open())
+            return false;
+
+        s_writtenFormats.clear();
+        s_writtenNames.clear();
+        s_binaryFile.write(reinterpret_cast<const char*>(&BINARY_LOG_MAGIC), sizeof(BINARY_LOG_MAGIC));
+        s_binaryFile.write(reinterpret_cast<const char*>(&BINARY_LOG_VERSION), sizeof(BINARY_LOG_VERSION));
+        return true;
+    }
+
+    u32 roundUpToPowerOfTwo(u32 value)
+    {
+        u32 result {1};
+
+        while (result < value)
+            result <<= 1;
+
+        return result;
+    }
+
+    // Takes over the queue of a thread that has exited, or adds a new one. Anything the last owner
+    // left in a queue is still written first, since it was logged first.
+    Queue* takeQueue()
+    {
+        for (Queue* queue = s_queueList.load(std::memory_order_acquire); queue != nullptr; queue = queue->next)
+        {
+            if (!queue->owned.load(std::memory_order_relaxed) && !queue->owned.exchange(true, std::memory_order_acquire))
+                return queue;
+        }
+
+        Queue* queue {new Queue{roundUpToPowerOfTwo(std::max(s_settings.queueCapacity, 2u))}};
+        queue->owned.store(true, std::memory_order_relaxed);
+        queue->next = s_queueList.load(std::memory_order_relaxed);
+
+        while (!s_queueList.compare_exchange_weak(queue->next, queue, std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+
+        return queue;
+    }
+
+    // Takes a queue the first time this thread logs, and hands it back when the thread exits.
+    struct QueueOwner
+    {
+        Queue* queue {};
+        // Which startAsync() call the queue was taken after. Queues from earlier ones have been freed.
+        u32 generation {};
+
+        // Only called by writers, so the queues can't be freed in the meantime.
+        Queue& get()
+        {
+            u32 current {s_generation.load(std::memory_order_acquire)};
+
+            if (queue == nullptr || generation != current)
+            {
+                queue = takeQueue();
+                generation = current;
+            }
+
+            return *queue;
+        }
+
+        ~QueueOwner()
+        {
+            // Counts as a writer, so stopAsync() can't free the queue while it is being handed back.
+            s_activeWriters.fetch_add(1);
+
+            if (queue != nullptr && g_async.load() && generation == s_generation.load(std::memory_order_acquire))
+                queue->owned.store(false, std::memory_order_release);
+
+            s_activeWriters.fetch_sub(1, std::memory_order_release);
+        }
+    };
+
+    thread_local QueueOwner t_queue {};
+
+    void wakeSinkThread()
+    {
+        s_wake.notify_one();
+    }
+
+    // Formats and writes everything currently queued, in the order it was logged.
+    // Must be called with s_drainMutex held.
+    void drain()
+    {
+        // Snapshot every queue first, then merge them by sequence number.
+        struct Pending
+        {
+            Record* record;
+            Queue* queue;
+        };
+
+        std::vector<Pending> pending {};
+
+        for (Queue* queue = s_queueList.load(std::memory_order_acquire); queue != nullptr; queue = queue->next)
+        {
+            u32 head {queue->head.load(std::memory_order_relaxed)};
+            u32 tail {queue->tail.load(std::memory_order_acquire)};
+
+            for (u32 i = head; i != tail; i++)
+                pending.push_back({&queue->records[i & queue->mask], queue});
+        }
+
+        std::sort(pending.begin(), pending.end(), [](const Pending& a, const Pending& b)
+        {
+            return a.record->sequence < b.record->sequence;
+        });
+
+        std::string lines {};
+        std::string binary {};
+
+        if (u64 drops = s_unreportedDrops.exchange(0, std::memory_order_relaxed))
+        {
+            appendPrefix(lines, Channel::General, Severity::Warning);
+            std::format_to(std::back_inserter(lines), "{} log messages were dropped, the log queue was full.\n", drops);
+        }
+
+        for (Pending& entry : pending)
+        {
+            if (entry.record->formatId != 0)
+                appendBinaryRecord(binary, *entry.record);
+            else
+            {
+                appendPrefix(lines, entry.record->channel, entry.record->severity);
+                entry.record->consume(*entry.record, lines);
+                lines.push_back('\n');
+            }
+
+            // Free the slot right away, so a blocked thread can continue.
+            entry.queue->head.fetch_add(1, std::memory_order_release);
+        }
+
+        if (!lines.empty())
+            writeToSinks(lines, true);
+
+        if (!binary.empty())
+        {
+            s_binaryFile.write(binary.data(), static_cast<std::streamsize>(binary.size()));
+            s_binaryFile.flush();
+        }
+    }
+
+    // Must be called with s_drainMutex held, once nothing can write to the queues.
+    void freeQueues()
+    {
+        Queue* queue {s_queueList.exchange(nullptr)};
+
+        // The crash handler may still be reading them.
+        if (s_crashing.load())
+            return;
+
+        while (queue != nullptr)
+            delete std::exchange(queue, queue->next);
+    }
+
+    void runSinkThread()
+    {
+        std::unique_lock wakeLock {s_wakeMutex};
+
+        while (!s_stopRequested)
+        {
+            s_wake.wait_for(wakeLock, s_settings.flushInterval);
+            wakeLock.unlock();
+            {
+                std::scoped_lock drainLock {s_drainMutex};
+                drain();
+            }
+            wakeLock.lock();
+        }
+    }
+
+    // === Crash Handling ===
+
+    // Best effort: drains whatever is queued from the crashing thread, without waiting on a
+    // sink thread that may be the one that crashed.
+    void flushForCrash()
+    {
+        if (!g_async.load())
+            return;
+
+        std::unique_lock lock {s_drainMutex, std::defer_lock};
+
+        for (s32 attempt = 0; attempt < 100 && !lock.try_lock(); attempt++)
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+
+        if (lock.owns_lock())
+            drain();
+    }
+
+    // The only storage the signal handler writes lines into.
+    char s_crashLine[512] {};
+    size_t s_crashLineSize {};
+
+    void appendCrashLine(std::string_view text)
+    {
+        size_t size {std::min(text.size(), sizeof(s_crashLine) - 1 - s_crashLineSize)};
+        std::memcpy(s_crashLine + s_crashLineSize, text.data(), size);
+        s_crashLineSize += size;
+    }
+
+    void writeCrashLine()
+    {
+        s_crashLine[s_crashLineSize++] = '\n';
+#ifdef _WIN32
+        _write(2, s_crashLine, static_cast<unsigned>(s_crashLineSize));
+#else
+        [[maybe_unused]] ssize_t written {write(STDERR_FILENO, s_crashLine, s_crashLineSize)};
+#endif
+        s_crashLineSize = 0;
+    }
+
+    void appendCrashPrefix(Channel channel, Severity severity)
+    {
+        appendCrashLine("[");
+        appendCrashLine(getName(severity));
+        appendCrashLine(":");
+        appendCrashLine(getName(channel));
+        appendCrashLine("] ");
+    }
+
+    /**
+     * \brief Writes what is still queued straight to stderr, with nothing but async-signal-safe calls.
+     * \details Formatting allocates, and the crash may have happened inside malloc, or while a lock was held,
+     * so nothing is formatted or locked here. Each message is written as its format string, which is a literal.
+     * Its arguments are not: the sink thread may be destroying them at this very moment.
+     */
+    void writeQueuedForCrash(int signal)
+    {
+        // Sequentially consistent with freeQueues(), so either it sees the crash, or this sees no queues.
+        s_crashing.store(true);
+        u32 count {};
+
+        for (Queue* queue = s_queueList.load(); queue != nullptr; queue = queue->next)
+        {
+            queue->crashCursor = queue->head.load(std::memory_order_acquire);
+            queue->crashEnd = queue->tail.load(std::memory_order_acquire);
+            count += queue->crashEnd - queue->crashCursor;
+        }
+
+        char number[16] {};
+        appendCrashPrefix(Channel::General, Severity::Error);
+        appendCrashLine("Crashed with signal ");
+        appendCrashLine({number, std::to_chars(number, number + sizeof(number), signal).ptr});
+        appendCrashLine(", ");
+        appendCrashLine({number, std::to_chars(number, number + sizeof(number), count).ptr});
+        appendCrashLine(" queued log messages follow, without their arguments.");
+        writeCrashLine();
+
+        // Merges the queues by sequence number, like drain() does.
+        while (true)
+        {
+            Queue* next {};
+
+            for (Queue* queue = s_queueList.load(std::memory_order_acquire); queue != nullptr; queue = queue->next)
+            {
+                if (queue->crashCursor != queue->crashEnd
+                    && (next == nullptr || queue->records[queue->crashCursor & queue->mask].sequence < next->records[next->crashCursor & next->mask].sequence))
+                    next = queue;
+            }
+
+            if (next == nullptr)
+                break;
+
+            const Record& record {next->records[next->crashCursor++ & next->mask]};
+            appendCrashPrefix(record.channel, record.severity);
+            appendCrashLine(record.format);
+            writeCrashLine();
+        }
+    }
+
+    void onSignal(int signal)
+    {
+        if (g_async.load())
+            writeQueuedForCrash(signal);
+
+        std::signal(signal, SIG_DFL);
+        std::raise(signal);
+    }
+
+    std::terminate_handler s_previousTerminate {};
+
+    // Unlike a signal, std::terminate() is called from ordinary code, so this can format and lock as usual.
+    void onTerminate()
+    {
+        flushForCrash();
+
+        if (s_previousTerminate != nullptr)
+            s_previousTerminate();
+
+        std::abort();
+    }
+
+    void installCrashHandlers()
+    {
+        static bool s_installed {false};
+
+        if (s_installed)
+            return;
+
+        s_installed = true;
+
+        for (int signal : {SIGSEGV, SIGABRT, SIGFPE, SIGILL})
+            std::signal(signal, onSignal);
+
+        s_previousTerminate = std::set_terminate(onTerminate);
+        std::atexit(stopAsync);
+    }
+}
+
+bool Detail::beginRecord(Channel channel, Severity severity, Record*& record)
+{
+    // Counted before checking, so stopAsync() either sees this writer, or this writer sees it stopped.
+    s_activeWriters.fetch_add(1);
+
+    if (!g_async.load())
+    {
+        s_activeWriters.fetch_sub(1, std::memory_order_release);
+        return false;
+    }
+
+    // startAsync() wrote the settings before setting g_async, and can't write them again until stopAsync() returns.
+    Queue& queue {t_queue.get()};
+    u32 tail {queue.tail.load(std::memory_order_relaxed)};
+    bool mustWait {s_settings.overflowPolicy == OverflowPolicy::Block
+                || (s_settings.overflowPolicy == OverflowPolicy::DropUnlessError && severity == Severity::Error)};
+
+    while (tail - queue.head.load(std::memory_order_acquire) > queue.mask)
+    {
+        if (!mustWait)
+        {
+            s_droppedCount.fetch_add(1, std::memory_order_relaxed);
+            s_unreportedDrops.fetch_add(1, std::memory_order_relaxed);
+            s_activeWriters.fetch_sub(1, std::memory_order_release);
+            record = nullptr;
+            return true;
+        }
+
+        // The sink thread is gone (or going), so nothing will make room.
+        if (s_stopRequested.load(std::memory_order_acquire))
+        {
+            s_activeWriters.fetch_sub(1, std::memory_order_release);
+            return false;
+        }
+
+        // Back-pressure: the queue is full, so let the sink thread catch up.
+        wakeSinkThread();
+        std::this_thread::yield();
+    }
+
+    record = &queue.records[tail & queue.mask];
+    record->sequence = s_sequence.fetch_add(1, std::memory_order_relaxed);
+    record->channel = channel;
+    record->severity = severity;
+    record->formatId = 0;
+    return true;
+}
+
+void Detail::commitRecord(Severity severity)
+{
+    Queue& queue {*t_queue.queue};
+    queue.tail.store(queue.tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+    if (severity == Severity::Error)
+        wakeSinkThread();
+
+    s_activeWriters.fetch_sub(1, std::memory_order_release);
+}
+
+void Logger::startAsync(const AsyncSettings& settings)
+{
+    if (g_async.load())
+        return;
+
+    s_settings = settings;
+    s_generation.fetch_add(1, std::memory_order_release);
+    s_stopRequested = false;
+    installCrashHandlers();
+    s_sinkThread = std::thread{runSinkThread};
+    g_async.store(true);
+
+    if (settings.binaryLogPath != nullptr)
+    {
+        if (openBinaryLog(settings.binaryLogPath))
+            g_binary.store(true);
+        else
+            log_error(Channel::General, "Failed to open binary log {}, logging as text instead.", settings.binaryLogPath);
+    }
+}
+
+void Logger::stopAsync()
+{
+    if (!g_async.exchange(false))
+        return;
+
+    g_binary.store(false);
+
+    {
+        std::scoped_lock lock {s_wakeMutex};
+        s_stopRequested = true;
+    }
+
+    wakeSinkThread();
+    s_sinkThread.join();
+
+    // Threads that got past the g_async check before it was cleared either finish their record,
+    // or (when their queue is full) write it themselves, now that nothing will make room.
+    while (s_activeWriters.load(std::memory_order_acquire) != 0)
+        std::this_thread::yield();
+
+    // Anything queued while the sink thread was stopping.
+    std::scoped_lock drainLock {s_drainMutex};
+    drain();
+    freeQueues();
+
+    if (s_binaryFile.is_open())
+        s_binaryFile.close();
+}
+
+bool Logger::isAsync()
+{
+    return g_async.load();
+}
+
+void Logger::flush()
+{
+    if (!g_async.load())
+    {
+        writeToSinks({}, true);
+        return;
+    }
+
+    // Drain on this thread rather than waiting for the sink thread to wake up.
+    std::scoped_lock lock {s_drainMutex};
+    drain();
+}
+
+u64 Logger::getDroppedCount()
+{
+    return s_droppedCount.load(std::memory_order_relaxed);
+}
+
+// === Binary Logging ===
+
+u32 Detail::registerFormat(std::string_view format, std::span<const ArgumentType> types)
+{
+    std::scoped_lock lock {s_formatMutex};
+    s_formats.push_back({format, {types.begin(), types.end()}});
+    return static_cast<u32>(s_formats.size());
+}
+
+namespace
+{
+    // Reads values out of a binary log, failing (rather than reading past the end) on truncated data.
+    struct BinaryReader
+    {
+        std::span<const u8> data;
+        size_t position {};
+
+        template <typename T>
+        bool read(T& value)
+        {
+            if (data.size() - position < sizeof(T))
+                return false;
+
+            std::memcpy(&value, data.data() + position, sizeof(T));
+            position += sizeof(T);
+            return true;
+        }
+
+        bool readString(std::string_view& string)
+        {
+            u32 size {};
+
+            if (!read(size) || data.size() - position < size)
+                return false;
+
+            string = {reinterpret_cast<const char*>(data.data() + position), size};
+            position += size;
+            return true;
+        }
+    };
+
+    struct DecodedFormat
+    {
+        std::string_view format;
+        std::vector<ArgumentType> types;
+    };
+
+    using DecodedArgument = std::variant<bool, char, s64, u64, f32, f64, std::string_view, const void*>;
+
+    bool decodeArguments(BinaryReader& reader, const DecodedFormat& format,
+                         const std::unordered_map<StringName::Hash, std::string>& names,
+                         std::vector<std::string>& nameStrings, std::vector<DecodedArgument>& arguments)
+    {
+        arguments.clear();
+        nameStrings.clear();
+        nameStrings.reserve(format.types.size());
+
+        for (ArgumentType type : format.types)
+        {
+            bool ok {true};
+
+            switch (type)
+            {
+                case ArgumentType::Bool:
+                {
+                    u8 value {};
+                    ok = reader.read(value);
+                    arguments.emplace_back(value != 0);
+                    break;
+                }
+                case ArgumentType::Char:
+                {
+                    char value {};
+                    ok = reader.read(value);
+                    arguments.emplace_back(value);
+                    break;
+                }
+                case ArgumentType::Signed:
+                {
+                    s64 value {};
+                    ok = reader.read(value);
+                    arguments.emplace_back(value);
+                    break;
+                }
+                case ArgumentType::Unsigned:
+                {
+                    u64 value {};
+                    ok = reader.read(value);
+                    arguments.emplace_back(value);
+                    break;
+                }
+                case ArgumentType::Float:
+                {
+                    f32 value {};
+                    ok = reader.read(value);
+                    arguments.emplace_back(value);
+                    break;
+                }
+                case ArgumentType::Double:
+                {
+                    f64 value {};
+                    ok = reader.read(value);
+                    arguments.emplace_back(value);
+                    break;
+                }
+                case ArgumentType::String:
+                {
+                    std::string_view value {};
+                    ok = reader.readString(value);
+                    arguments.emplace_back(value);
+                    break;
+                }
+                case ArgumentType::Name:
+                {
+                    // Shown the same way as the StringName formatter does.
+                    StringName::Hash hash {};
+                    ok = reader.read(hash);
+                    auto found {names.find(hash)};
+                    nameStrings.push_back(found != names.end() ? found->second : std::format("#{:016x}", hash));
+                    arguments.emplace_back(std::string_view{nameStrings.back()});
+                    break;
+                }
+                case ArgumentType::Pointer:
+                {
+                    u64 value {};
+                    ok = reader.read(value);
+                    arguments.emplace_back(reinterpret_cast<const void*>(static_cast<uintptr_t>(value)));
+                    break;
+                }
+                default:
+                    return false;
+            }
+
+            if (!ok)
+                return false;
+        }
+
+        return true;
+    }
+
+    // Formats one message, one replacement field at a time, since the argument types are only known at runtime.
+    void formatMessage(std::string& output, std::string_view format, const std::vector<DecodedArgument>& arguments)
+    {
+        size_t nextArgument {};
+
+        for (size_t i = 0; i < format.size(); i++)
+        {
+            char c {format[i]};
+
+            if ((c == '{' || c == '}') && i + 1 < format.size() && format[i + 1] == c)
+            {
+                output.push_back(c);
+                i++;
+                continue;
+            }
+
+            size_t end {format.find('}', i)};
+
+            if (c != '{' || end == std::string_view::npos)
+            {
+                output.push_back(c);
+                continue;
+            }
+
+            // A field is {[index][:spec]}.
+            std::string_view field {format.substr(i + 1, end - i - 1)};
+            std::string_view index {field.substr(0, field.find(':'))};
+            std::string_view spec {field.substr(index.size())};
+            size_t argument {nextArgument++};
+
+            if (!index.empty())
+                std::from_chars(index.data(), index.data() + index.size(), argument);
+
+            i = end;
+
+            if (argument >= arguments.size())
+            {
+                output.append("{?}");
+                continue;
+            }
+
+            std::string replacement {"{"};
+            replacement.append(spec);
+            replacement.push_back('}');
+
+            try
+            {
+                std::visit([&](auto value)
+                {
+                    std::vformat_to(std::back_inserter(output), replacement, std::make_format_args(value));
+                }, arguments[argument]);
+            }
+            catch (const std::format_error&)
+            {
+                output.append("{?}");
+            }
+        }
+    }
+}
+
+bool Logger::decodeBinaryLog(std::span<const u8> data, std::string& output)
+{
+    BinaryReader reader {data};
+    u32 magic {};
+    u32 version {};
+
+    if (!reader.read(magic) || !reader.read(version) || magic != BINARY_LOG_MAGIC || version != BINARY_LOG_VERSION)
+        return false;
+
+    std::unordered_map<u32, DecodedFormat> formats {};
+    std::unordered_map<StringName::Hash, std::string> names {};
+    std::vector<std::string> nameStrings {};
+    std::vector<DecodedArgument> arguments {};
+
+    while (reader.position < data.size())
+    {
+        BinaryEntry entry {};
+
+        if (!reader.read(entry))
+            return false;
+
+        switch (entry)
+        {
+            case BinaryEntry::Format:
+            {
+                u32 id {};
+                DecodedFormat format {};
+                u8 count {};
+
+                if (!reader.read(id) || !reader.readString(format.format) || !reader.read(count))
+                    return false;
+
+                format.types.resize(count);
+
+                for (ArgumentType& type : format.types)
+                {
+                    if (!reader.read(type))
+                        return false;
+                }
+
+                formats[id] = std::move(format);
+                break;
+            }
+            case BinaryEntry::Name:
+            {
+                StringName::Hash hash {};
+                std::string_view name {};
+
+                if (!reader.read(hash) || !reader.readString(name))
+                    return false;
+
+                names[hash] = name;
+                break;
+            }
+            case BinaryEntry::Message:
+            {
+                u32 id {};
+                u32 channel {};
+                u32 severity {};
+                u32 size {};
+
+                if (!reader.read(id) || !reader.read(channel) || !reader.read(severity) || !reader.read(size)
+                    || data.size() - reader.position < size)
+                    return false;
+
+                auto format {formats.find(id)};
+                BinaryReader payload {data.subspan(reader.position, size)};
+                reader.position += size;
+
+                if (format == formats.end() || !decodeArguments(payload, format->second, names, nameStrings, arguments))
+                    return false;
+
+                appendPrefix(output, static_cast<Channel>(channel), static_cast<Severity>(severity));
+                formatMessage(output, format->second.format, arguments);
+                output.push_back('\n');
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+
+    return true;
+}
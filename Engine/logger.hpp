@@ -4,11 +4,23 @@
 // Global logging utilities.
 // TODO: serialize logging info, like the masks, and write logs to a file? Also, provide dear ImGui integration for managing the masks, and viewing logs in-game
 // todo: i dont like having to leak all these headers in something as global as logging...
-#include <string_view>
-#include <unordered_map>
-#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstring>
 #include <format>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include "config.hpp"
 #include "enum_flags.hpp"
+#include "string_name.hpp"
+#include "types.hpp"
 
 namespace Logger
 {
@@ -39,6 +51,32 @@ namespace Logger
     // A printf style format string.
     typedef std::string_view FormatString;
 
+#ifndef LOG_MIN_SEVERITY
+#define LOG_MIN_SEVERITY Info
+#endif
+
+#ifndef LOG_COMPILED_CHANNELS
+#define LOG_COMPILED_CHANNELS Channel::All
+#endif
+
+    // The least important severity that is compiled in (see config.hpp).
+    constexpr Severity COMPILED_MIN_SEVERITY {Severity::LOG_MIN_SEVERITY};
+
+    // A bitmask of all channels that are compiled in (see config.hpp).
+    constexpr Channel COMPILED_CHANNELS {LOG_COMPILED_CHANNELS};
+
+    // Is a message with the given severity compiled in? More important severities use lower bits.
+    constexpr bool isCompiledIn(Severity severity)
+    {
+        return static_cast<intptr_t>(severity) <= static_cast<intptr_t>(COMPILED_MIN_SEVERITY);
+    }
+
+    // Is a message with the given channel compiled in?
+    constexpr bool isCompiledIn(Channel channel)
+    {
+        return (COMPILED_CHANNELS & channel) != Channel::None;
+    }
+
     // A bitmask of all severities that are allowed to be logged.
     extern Severity g_severityMask;
 
@@ -46,10 +84,16 @@ namespace Logger
     extern Channel g_channelMask;
 
     // Should a message with the given severity be shown?
-    bool shouldShow(Severity severity);
+    inline bool shouldShow(Severity severity)
+    {
+        return isCompiledIn(severity) && (g_severityMask & severity) != Severity::None;
+    }
 
     // Should a message with the given channel be shown?
-    bool shouldShow(Channel channel);
+    inline bool shouldShow(Channel channel)
+    {
+        return isCompiledIn(channel) && (g_channelMask & channel) != Channel::None;
+    }
 
     // Uses RAII to automatically push-and-pop a default channel within its scope.
     struct DefaultLogChannelJanitor
@@ -58,60 +102,392 @@ namespace Logger
         ~DefaultLogChannelJanitor();
     };
 
-    // Pushes a new default logging channel for all following logs.
+    // How many default channels each thread can push. Deeper pushes are ignored (but still need popping).
+    constexpr s32 MAX_CHANNEL_DEPTH {16};
+
+    // Pushes a new default logging channel for all following logs on this thread.
     void pushDefaultChannel(Channel channel);
 
     // Removes the current default logging channel. If no channels are pushed, the true default is "General".
     void popDefaultChannel();
 
-    // Gets the current default logging channel. Logs without a specified channel will use this one.
+    // Gets this thread's current default logging channel. Logs without a specified channel will use this one.
     Channel getDefaultChannel();
 
-    // Core logging logic (everything else calls into this).
-    template <typename... Args>
-    void log(Channel channel, Severity severity, FormatString format, Args&&... args)
+    // === Sinks ===
+
+    // A destination for formatted log lines.
+    class Sink
+    {
+    public:
+        virtual ~Sink() = default;
+
+        // Writes one or more complete lines, each ending in a newline.
+        virtual void write(std::string_view lines) = 0;
+        virtual void flush() = 0;
+    };
+
+    class ConsoleSink final : public Sink
+    {
+    public:
+        void write(std::string_view lines) override;
+        void flush() override;
+    };
+
+    class FileSink final : public Sink
+    {
+    public:
+        explicit FileSink(const char* path);
+        void write(std::string_view lines) override;
+        void flush() override;
+
+    private:
+        std::ofstream m_file;
+    };
+
+    // Adds a destination for all following logs. If no sinks are added, logs go to a ConsoleSink.
+    void addSink(std::unique_ptr<Sink> sink);
+
+    // Removes (and destroys) every added sink.
+    void clearSinks();
+
+    // === Asynchronous Logging ===
+
+    // What a thread does when its log queue is full.
+    enum class OverflowPolicy
+    {
+        // Wait for the sink thread to make room. Nothing is lost, but logging can stall.
+        Block,
+        // Throw the message away. Logging never stalls, and the drops are reported later.
+        Drop,
+        // Throw away info and warning messages, but wait to make room for errors.
+        DropUnlessError,
+    };
+
+    struct AsyncSettings
     {
-        static std::unordered_map<Severity, const char*> severityNameLookup{
+        // How many messages each thread can queue before the overflow policy applies. Rounded up to a power of two.
+        u32 queueCapacity {1024};
+        OverflowPolicy overflowPolicy {OverflowPolicy::DropUnlessError};
+        // How long the sink thread sleeps when there is nothing to write. Errors always wake it immediately.
+        std::chrono::milliseconds flushInterval {5};
+        // If set, messages logged with a compile-time format (log<"...">) are written to this file in
+        // binary instead of being formatted. See decodeBinaryLog().
+        const char* binaryLogPath {nullptr};
+    };
+
+    /**
+     * \brief Moves formatting and writing off the logging threads.
+     * \details Each thread pushes its messages into its own lock-free queue, with copies of the
+     * arguments. A background thread formats them in order and writes them to the sinks in batches.
+     * Everything queued is written out when stopAsync() is called, at exit, and when std::terminate() is called.
+     * A crash signal can't format safely, so it only writes the format strings of what is queued to stderr.
+     * \note Format strings must outlive the call (in practice, they should be literals).
+     */
+    void startAsync(const AsyncSettings& settings = {});
+
+    // Writes out everything that is queued, and goes back to logging on the calling thread.
+    void stopAsync();
+
+    bool isAsync();
+
+    // Blocks until everything queued so far has been written to the sinks, and the sinks are flushed.
+    void flush();
+
+    // How many messages have been thrown away by the overflow policy.
+    u64 getDroppedCount();
+
+    // === Binary Logging ===
+
+    // How each argument is stored in a binary log, so the decoder knows how to read it back.
+    enum class ArgumentType : u8
+    {
+        Bool,
+        Char,
+        // Any signed integer, stored as an s64.
+        Signed,
+        // Any unsigned integer, stored as a u64.
+        Unsigned,
+        Float,
+        Double,
+        // A u32 length, followed by the characters (without a terminator).
+        String,
+        // The hash of a StringName. The decoder shows its string, if the log recorded it.
+        Name,
+        Pointer,
+        // Not a real type. Marks arguments that cannot be logged in binary.
+        Unsupported,
+    };
+
+    /**
+     * \brief Turns a binary log back into text, one line per message, exactly as the text sinks would have.
+     * \details A binary log is a header (BINARY_LOG_MAGIC, BINARY_LOG_VERSION), followed by entries that
+     * each start with a BinaryEntry. The format strings and names are written the first time they are used,
+     * so a log that was cut short (by a crash) is still readable up to that point.
+     * \return False if the data is not a binary log, or is damaged. Everything before the damage is still decoded.
+     */
+    bool decodeBinaryLog(std::span<const u8> data, std::string& output);
+
+    constexpr u32 BINARY_LOG_MAGIC {0x474F4C42}; // "BLOG"
+    constexpr u32 BINARY_LOG_VERSION {1};
+
+    enum class BinaryEntry : u8
+    {
+        // u32 id, u32 length, the format string, u8 argument count, then an ArgumentType per argument.
+        Format = 1,
+        // u64 hash, u32 length, then the string.
+        Name = 2,
+        // u32 format id, u32 channel, u32 severity, u32 size, then the encoded arguments.
+        Message = 3,
+    };
+
+    // === Internals ===
+
+    // A readable name for each severity and channel, used as the message prefix.
+    const char* getName(Severity severity);
+    const char* getName(Channel channel);
+
+    // Writes a finished message to the sinks, on the calling thread.
+    void writeMessage(Channel channel, Severity severity, std::string_view message);
+
+    namespace Detail
+    {
+        // Anything string-like is copied, since the original may be gone by the time it is formatted.
+        template <typename T>
+        using Captured = std::conditional_t<std::is_convertible_v<const std::decay_t<T>&, std::string_view>, std::string, std::decay_t<T>>;
+
+        constexpr size_t ARGUMENT_BYTES {192};
+
+        // A queued message. The arguments are constructed in place, so queueing never allocates
+        // unless an argument does (like a copied string).
+        struct Record
+        {
+            u64 sequence;
+            Channel channel;
+            Severity severity;
+            // Set for binary records, which hold encoded arguments instead of an Arguments<...>.
+            u32 formatId;
+            u32 size;
+            FormatString format;
+            // Formats the stored arguments into the output, then destroys them.
+            void (*consume)(Record& record, std::string& output);
+            alignas(std::max_align_t) u8 arguments[ARGUMENT_BYTES];
+        };
+
+        template <typename... Args>
+        struct Arguments
+        {
+            std::tuple<Captured<Args>...> values;
+
+            static void consume(Record& record, std::string& output)
             {
-                {Severity::Error, "Error"},
-                {Severity::Warning, "Warning"},
-                {Severity::Info, "Info"},
+                auto* self {std::launder(reinterpret_cast<Arguments*>(record.arguments))};
+
+                std::apply([&](auto&... values)
+                {
+                    std::vformat_to(std::back_inserter(output), record.format, std::make_format_args(values...));
+                }, self->values);
+
+                self->~Arguments();
             }
         };
 
-        static std::unordered_map<Channel, const char*> channelNameLookup{
+        /**
+         * \brief Reserves the next record in this thread's queue.
+         * \return False if logging is no longer asynchronous, so the message has to be written on this thread.
+         * Otherwise, the record is set to nullptr if the message was dropped, and must be committed if not.
+         */
+        bool beginRecord(Channel channel, Severity severity, Record*& record);
+
+        // Hands the record reserved by beginRecord() over to the sink thread.
+        void commitRecord(Severity severity);
+
+        extern std::atomic<bool> g_async;
+        extern std::atomic<bool> g_binary;
+
+        // Returns false if the message could not be queued, and has to be written on this thread instead.
+        template <typename... Args>
+        bool queue(Channel channel, Severity severity, FormatString format, Args&&... args)
+        {
+            Record* record {};
+
+            if (!beginRecord(channel, severity, record))
+                return false;
+
+            if (record == nullptr)
+                return true;
+
+            if constexpr (sizeof(Arguments<Args...>) <= ARGUMENT_BYTES && alignof(Arguments<Args...>) <= alignof(std::max_align_t))
             {
-                {Channel::General, "General"},
-                {Channel::Rendering, "Rendering"},
-                {Channel::Resources, "Resources"}
+                record->format = format;
+                record->consume = &Arguments<Args...>::consume;
+                new (record->arguments) Arguments<Args...>{std::tuple<Captured<Args>...>(std::forward<Args>(args)...)};
             }
-        };
+            else
+            {
+                // Too big to queue as-is, so format it here and queue the result instead.
+                record->format = "{}";
+                record->consume = &Arguments<std::string>::consume;
+                new (record->arguments) Arguments<std::string>{{std::vformat(format, std::make_format_args(args...))}};
+            }
+
+            commitRecord(severity);
+            return true;
+        }
+
+        template <typename T>
+        constexpr ArgumentType getArgumentType()
+        {
+            using Type = std::decay_t<T>;
+
+            if constexpr (std::is_same_v<Type, bool>)
+                return ArgumentType::Bool;
+            else if constexpr (std::is_same_v<Type, char>)
+                return ArgumentType::Char;
+            else if constexpr (std::is_integral_v<Type> && std::is_signed_v<Type>)
+                return ArgumentType::Signed;
+            else if constexpr (std::is_integral_v<Type>)
+                return ArgumentType::Unsigned;
+            else if constexpr (std::is_same_v<Type, f32>)
+                return ArgumentType::Float;
+            else if constexpr (std::is_same_v<Type, f64>)
+                return ArgumentType::Double;
+            else if constexpr (std::is_convertible_v<const Type&, std::string_view>)
+                return ArgumentType::String;
+            else if constexpr (std::is_same_v<Type, StringName>)
+                return ArgumentType::Name;
+            else if constexpr (std::is_same_v<Type, void*> || std::is_same_v<Type, const void*>)
+                return ArgumentType::Pointer;
+            else
+                return ArgumentType::Unsupported;
+        }
+
+        // The encoded size of an argument, not counting the characters of a string.
+        constexpr size_t getFixedSize(ArgumentType type)
+        {
+            switch (type)
+            {
+                case ArgumentType::Bool:
+                case ArgumentType::Char: return 1;
+                case ArgumentType::Float:
+                case ArgumentType::String: return 4;
+                default: return 8;
+            }
+        }
+
+        template <typename... Args>
+        constexpr bool canLogBinary()
+        {
+            return ((getArgumentType<Args>() != ArgumentType::Unsupported) && ...)
+                && (getFixedSize(getArgumentType<Args>()) + ... + 0) <= ARGUMENT_BYTES;
+        }
+
+        // Registers a compile-time format string, and returns the id binary records refer to it by.
+        u32 registerFormat(std::string_view format, std::span<const ArgumentType> types);
+
+        template <FixedString Format, typename... Args>
+        u32 getFormatId()
+        {
+            static constexpr ArgumentType TYPES[] {getArgumentType<Args>()..., ArgumentType::Unsupported};
+            static const u32 id {registerFormat(Format.data, {TYPES, sizeof...(Args)})};
+            return id;
+        }
 
-        if (shouldShow(channel) && shouldShow(severity))
+        template <typename T>
+        void encode(u8*& cursor, const T& value)
         {
-            const char* severityName{severityNameLookup[severity]};
-            const char* channelName{channelNameLookup[channel]};
-            std::cout << std::format("[{}:{}] ", severityName, channelName) << std::vformat(
-                format, std::make_format_args(args...)) << std::endl;
+            std::memcpy(cursor, &value, sizeof(T));
+            cursor += sizeof(T);
+        }
+
+        template <typename T>
+        void encodeArgument(u8*& cursor, size_t& stringBudget, const T& value)
+        {
+            constexpr ArgumentType TYPE {getArgumentType<T>()};
+
+            if constexpr (TYPE == ArgumentType::Bool)
+                encode(cursor, static_cast<u8>(value));
+            else if constexpr (TYPE == ArgumentType::Char)
+                encode(cursor, value);
+            else if constexpr (TYPE == ArgumentType::Signed)
+                encode(cursor, static_cast<s64>(value));
+            else if constexpr (TYPE == ArgumentType::Unsigned)
+                encode(cursor, static_cast<u64>(value));
+            else if constexpr (TYPE == ArgumentType::Float || TYPE == ArgumentType::Double)
+                encode(cursor, value);
+            else if constexpr (TYPE == ArgumentType::String)
+            {
+                // Strings share whatever room the other arguments leave, and are cut short to fit.
+                std::string_view string {value};
+                u32 size {static_cast<u32>(std::min(string.size(), stringBudget))};
+                stringBudget -= size;
+                encode(cursor, size);
+                std::memcpy(cursor, string.data(), size);
+                cursor += size;
+            }
+            else if constexpr (TYPE == ArgumentType::Name)
+                encode(cursor, value.hash);
+            else if constexpr (TYPE == ArgumentType::Pointer)
+                encode(cursor, static_cast<u64>(reinterpret_cast<uintptr_t>(value)));
+        }
+
+        // Queues the raw argument bytes, to be written to the binary log as they are.
+        // Returns false if the message could not be queued, and has to be written as text instead.
+        template <FixedString Format, typename... Args>
+        bool queueBinary(Channel channel, Severity severity, const Args&... args)
+        {
+            u32 formatId {getFormatId<Format, Args...>()};
+            Record* record {};
+
+            if (!beginRecord(channel, severity, record))
+                return false;
+
+            if (record == nullptr)
+                return true;
+
+            u8* cursor {record->arguments};
+            [[maybe_unused]] size_t stringBudget {ARGUMENT_BYTES - (getFixedSize(getArgumentType<Args>()) + ... + 0)};
+            (encodeArgument(cursor, stringBudget, args), ...);
+
+            record->formatId = formatId;
+            record->format = Format.data;
+            record->size = static_cast<u32>(cursor - record->arguments);
+            commitRecord(severity);
+            return true;
         }
     }
 
+    // Core logging logic (everything else calls into this).
+    template <typename... Args>
+    void log(Channel channel, Severity severity, FormatString format, Args&&... args)
+    {
+        if (!shouldShow(channel) || !shouldShow(severity))
+            return;
+
+        // Nothing is forwarded unless the message is queued, so the arguments are still there if it isn't.
+        if (!Detail::g_async.load(std::memory_order_relaxed) || !Detail::queue(channel, severity, format, std::forward<Args>(args)...))
+            writeMessage(channel, severity, std::vformat(format, std::make_format_args(args...)));
+    }
+
     template <typename... Args>
     void log_info(Channel channel, FormatString format, Args&&... args)
     {
-        log(channel, Severity::Info, format, args...);
+        if constexpr (isCompiledIn(Severity::Info))
+            log(channel, Severity::Info, format, args...);
     }
 
     template <typename... Args>
     void log_warning(Channel channel, FormatString format, Args&&... args)
     {
-        log(channel, Severity::Warning, format, args...);
+        if constexpr (isCompiledIn(Severity::Warning))
+            log(channel, Severity::Warning, format, args...);
     }
 
     template <typename... Args>
     void log_error(Channel channel, FormatString format, Args&&... args)
     {
-        log(channel, Severity::Error, format, args...);
+        if constexpr (isCompiledIn(Severity::Error))
+            log(channel, Severity::Error, format, args...);
     }
 
     template <typename... Args>
@@ -123,26 +499,130 @@ namespace Logger
     template <typename... Args>
     void log_info(FormatString format, Args&&... args)
     {
-        log(getDefaultChannel(), Severity::Info, format, args...);
+        if constexpr (isCompiledIn(Severity::Info))
+            log(getDefaultChannel(), Severity::Info, format, args...);
     }
 
     template <typename... Args>
     void log_warning(FormatString format, Args&&... args)
     {
-        log(getDefaultChannel(), Severity::Warning, format, args...);
+        if constexpr (isCompiledIn(Severity::Warning))
+            log(getDefaultChannel(), Severity::Warning, format, args...);
     }
 
     template <typename... Args>
     void log_error(FormatString format, Args&&... args)
     {
-        log(getDefaultChannel(), Severity::Error, format, args...);
+        if constexpr (isCompiledIn(Severity::Error))
+            log(getDefaultChannel(), Severity::Error, format, args...);
     }
 
     template <typename... Args>
     void log(FormatString format, Args&&... args)
     {
-        log(getDefaultChannel(), Severity::Info, format, args...);
+        if constexpr (isCompiledIn(Severity::Info))
+            log(getDefaultChannel(), Severity::Info, format, args...);
+    }
+
+    // === Compile-Time Formats ===
+
+    /**
+     * \brief Logs a message whose format string is known at compile time, like log<"Loaded {}">(name).
+     * \details When a binary log is open, the format is registered once, and each call only copies the raw
+     * arguments into the queue: nothing is formatted, in this process or any other, until the log is decoded.
+     * Otherwise (or if an argument type has no binary encoding), this is the same as the text version.
+     */
+    template <FixedString Format, typename... Args>
+    void log(Channel channel, Severity severity, Args&&... args)
+    {
+        if constexpr (Detail::canLogBinary<Args...>())
+        {
+            if (Detail::g_binary.load(std::memory_order_relaxed))
+            {
+                if (!shouldShow(channel) || !shouldShow(severity) || Detail::queueBinary<Format>(channel, severity, args...))
+                    return;
+            }
+        }
+
+        log(channel, severity, Format.data, std::forward<Args>(args)...);
+    }
+
+    template <FixedString Format, typename... Args>
+    void log_info(Channel channel, Args&&... args)
+    {
+        if constexpr (isCompiledIn(Severity::Info))
+            log<Format>(channel, Severity::Info, args...);
+    }
+
+    template <FixedString Format, typename... Args>
+    void log_warning(Channel channel, Args&&... args)
+    {
+        if constexpr (isCompiledIn(Severity::Warning))
+            log<Format>(channel, Severity::Warning, args...);
+    }
+
+    template <FixedString Format, typename... Args>
+    void log_error(Channel channel, Args&&... args)
+    {
+        if constexpr (isCompiledIn(Severity::Error))
+            log<Format>(channel, Severity::Error, args...);
+    }
+
+    template <FixedString Format, typename... Args>
+    void log(Severity severity, Args&&... args)
+    {
+        log<Format>(getDefaultChannel(), severity, args...);
+    }
+
+    template <FixedString Format, typename... Args>
+    void log_info(Args&&... args)
+    {
+        if constexpr (isCompiledIn(Severity::Info))
+            log<Format>(getDefaultChannel(), Severity::Info, args...);
+    }
+
+    template <FixedString Format, typename... Args>
+    void log_warning(Args&&... args)
+    {
+        if constexpr (isCompiledIn(Severity::Warning))
+            log<Format>(getDefaultChannel(), Severity::Warning, args...);
+    }
+
+    template <FixedString Format, typename... Args>
+    void log_error(Args&&... args)
+    {
+        if constexpr (isCompiledIn(Severity::Error))
+            log<Format>(getDefaultChannel(), Severity::Error, args...);
+    }
+
+    template <FixedString Format, typename... Args>
+    void log(Args&&... args)
+    {
+        if constexpr (isCompiledIn(Severity::Info))
+            log<Format>(getDefaultChannel(), Severity::Info, args...);
     }
 } // namespace Logger
 
+/**
+ * \brief Logs a message, without evaluating its arguments unless it is both compiled in and shown.
+ * \details The channel and severity must be constants, and the format a string literal, like
+ * LOG_INFO(Logger::Channel::Rendering, "Drew {}", count()). When either is filtered out by config.hpp, the whole
+ * statement compiles to nothing. The format is a compile-time one (see log<Format>(...)), so these also log in binary.
+ * The functions check the same masks, but only after their arguments have been evaluated, so the engine uses these.
+ */
+#define LOGGER_LOG(channel, severity, format, ...) \
+    do \
+    { \
+        if constexpr (Logger::isCompiledIn(channel) && Logger::isCompiledIn(severity)) \
+        { \
+            if (Logger::shouldShow(channel) && Logger::shouldShow(severity)) \
+                Logger::log<format>(channel, severity, ##__VA_ARGS__); \
+        } \
+    } while (false)
+
+// "##" drops the comma when there are no arguments, on MSVC as well as GCC and Clang.
+#define LOG_INFO(channel, format, ...) LOGGER_LOG(channel, Logger::Severity::Info, format, ##__VA_ARGS__)
+#define LOG_WARNING(channel, format, ...) LOGGER_LOG(channel, Logger::Severity::Warning, format, ##__VA_ARGS__)
+#define LOG_ERROR(channel, format, ...) LOGGER_LOG(channel, Logger::Severity::Error, format, ##__VA_ARGS__)
+
 #endif // LOGGER_HPP
@@ -0,0 +1,61 @@
+﻿#include "aabb.hpp"
+#include <cmath>
+#include "mat4.hpp"
+
+// === Lifetime ===
+Aabb Aabb::fromCenterExtents(Vec3 center, Vec3 extents)
+{
+    return Aabb{center - extents, center + extents};
+}
+
+// === Queries ===
+Vec3 Aabb::center() const
+{
+    return (min + max) * 0.5f;
+}
+
+Vec3 Aabb::extents() const
+{
+    return (max - min) * 0.5f;
+}
+
+bool Aabb::contains(Vec3 point) const
+{
+    return point.x >= min.x && point.x <= max.x
+        && point.y >= min.y && point.y <= max.y
+        && point.z >= min.z && point.z <= max.z;
+}
+
+bool Aabb::intersects(const Aabb& other) const
+{
+    return min.x <= other.max.x && max.x >= other.min.x
+        && min.y <= other.max.y && max.y >= other.min.y
+        && min.z <= other.max.z && max.z >= other.min.z;
+}
+
+// === Operations ===
+void Aabb::encapsulate(Vec3 point)
+{
+    for (u8f i = 0; i < 3; i++)
+    {
+        min[i] = point[i] < min[i] ? point[i] : min[i];
+        max[i] = point[i] > max[i] ? point[i] : max[i];
+    }
+}
+
+// Transforms the center, and projects the extents onto each new axis (Arvo, "Transforming Axis-Aligned
+// Bounding Boxes", Graphics Gems 1990). Much cheaper than transforming all eight corners.
+Aabb Aabb::transformed(const Mat4& transform) const
+{
+    Vec3 oldExtents = extents();
+    Vec3 newCenter = transform.transformPoint(center());
+    Vec3 newExtents{};
+
+    for (u8f column = 0; column < 3; column++)
+    {
+        for (u8f row = 0; row < 3; row++)
+            newExtents[column] += std::abs(transform[row][column]) * oldExtents[row];
+    }
+
+    return fromCenterExtents(newCenter, newExtents);
+}
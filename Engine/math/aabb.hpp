@@ -0,0 +1,41 @@
+﻿#ifndef AABB_H
+#define AABB_H
+
+#include "../types.hpp"
+#include "vec3.hpp"
+
+struct Mat4;
+
+/**
+ * \brief An axis-aligned bounding box, stored as its minimum and maximum corners.
+ */
+struct Aabb
+{
+    Vec3 min;
+    Vec3 max;
+
+    // === Lifetime ===
+    static Aabb fromCenterExtents(Vec3 center, Vec3 extents);
+
+    // === Queries ===
+    Vec3 center() const;
+    Vec3 extents() const;
+    bool contains(Vec3 point) const;
+    bool intersects(const Aabb& other) const;
+
+    // === Operations ===
+
+    /**
+     * \brief Grows this box so that it contains the given point.
+     */
+    void encapsulate(Vec3 point);
+
+    /**
+     * \brief Computes the box that tightly contains this one after a transformation.
+     * \param transform The (affine) transformation to apply.
+     * \return A new axis-aligned box, which may be larger than the transformed original.
+     */
+    Aabb transformed(const Mat4& transform) const;
+};
+
+#endif // AABB_H
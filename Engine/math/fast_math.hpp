@@ -0,0 +1,344 @@
+﻿#ifndef FAST_MATH_H
+#define FAST_MATH_H
+
+#include <bit>
+#include "../types.hpp"
+#include "math_util.hpp"
+#include "simd.hpp"
+
+/**
+ * \brief Approximations of common math functions that trade accuracy for speed.
+ * \details Every function comes in a scalar and a 4-wide SIMD flavour, and takes an Accuracy
+ * to pick between a cheaper and a more precise polynomial. The documented errors are the
+ * worst cases measured against libm over the stated input range (see tests_fast_math.cpp),
+ * and hold for both flavours.
+ *
+ * The polynomial coefficients are minimax fits (Remez exchange), not Taylor series, so the
+ * error is spread evenly over the reduced range instead of piling up at its edges.
+ */
+namespace Math::fast
+{
+    enum class Accuracy
+    {
+        // Roughly 4 significant digits, the cheapest polynomials.
+        Low,
+        // Within a few ULP of single precision.
+        High,
+    };
+
+    // PI and PI/2 split into a part with trailing zero bits (exact when multiplied by small integers) and a correction.
+    constexpr f32 PI_HIGH {3.140625f};
+    constexpr f32 PI_LOW {9.67653589793e-4f};
+    constexpr f32 HALF_PI_HIGH {1.5703125f};
+    constexpr f32 HALF_PI_LOW {4.83826794897e-4f};
+
+    // === Coefficients (lowest order first) ===
+
+    // sin(x) / x as a polynomial of x^2, over [0, PI/2].
+    constexpr f32 SIN_LOW[] {0.99991304f, -0.16602490f, 0.0076286447f};
+    constexpr f32 SIN_HIGH[] {1.0f, -0.16666658f, 0.0083330511f, -0.00019809075f, 2.6052249e-06f};
+
+    // atan(x) / x as a polynomial of x^2, over [0, 1].
+    constexpr f32 ATAN_LOW[] {0.99921381f, -0.32117497f, 0.14626446f, -0.038986514f};
+    constexpr f32 ATAN_HIGH[] {
+        0.99999611f, -0.33317368f, 0.19807816f, -0.13233342f, 0.079623671f, -0.033604219f, 0.0068117928f
+    };
+
+    // 2^x over [0, 1).
+    constexpr f32 EXP2_LOW[] {0.99992522f, 0.69583354f, 0.22606716f, 0.078024523f};
+    constexpr f32 EXP2_HIGH[] {0.99999993f, 0.69315307f, 0.24015362f, 0.055826318f, 0.0089893401f, 0.0018775767f};
+
+    // log2(1 + x) / x over [0, 1).
+    constexpr f32 LOG2_LOW[] {1.4390147f, -0.67994416f, 0.32559587f, -0.084768744f};
+    constexpr f32 LOG2_HIGH[] {
+        1.4426678f, -0.72058547f, 0.47355341f, -0.32590197f, 0.19429432f, -0.079557731f, 0.015529917f
+    };
+
+    // Evaluates a polynomial with Horner's method.
+    template <size_t Count>
+    f32 polynomial(f32 x, const f32 (&coefficients)[Count])
+    {
+        f32 result {coefficients[Count - 1]};
+
+        for (size_t i = Count - 1; i > 0; i--)
+            result = result * x + coefficients[i - 1];
+
+        return result;
+    }
+
+    template <size_t Count>
+    simd::f32x4 polynomial(simd::f32x4 x, const f32 (&coefficients)[Count])
+    {
+        simd::f32x4 result {simd::set(coefficients[Count - 1])};
+
+        for (size_t i = Count - 1; i > 0; i--)
+            result = simd::madd(result, x, simd::set(coefficients[i - 1]));
+
+        return result;
+    }
+
+    // === Reciprocal Square Root ===
+
+    /**
+     * \brief Approximates 1 / sqrt(x), for positive, normal x.
+     * \details Starts from the SSE2 hardware estimate and refines it with a Newton step for High.
+     * Max relative error: Low 3.7e-4, High 3.0e-7. Without SSE2, a bit-trick estimate is used
+     * with one extra Newton step, for Low 1.8e-3, High 4.8e-6.
+     */
+    template <Accuracy A = Accuracy::High>
+    f32 rsqrt(f32 x)
+    {
+#if MATH_SIMD_SSE2
+        f32 y {_mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)))};
+        constexpr s32 STEPS {A == Accuracy::High ? 1 : 0};
+#else
+        f32 y {std::bit_cast<f32>(0x5F375A86u - (std::bit_cast<u32>(x) >> 1))};
+        constexpr s32 STEPS {A == Accuracy::High ? 2 : 1};
+#endif
+        f32 halfX {0.5f * x};
+
+        for (s32 i = 0; i < STEPS; i++)
+            y = y * (1.5f - halfX * y * y);
+
+        return y;
+    }
+
+    template <Accuracy A = Accuracy::High>
+    simd::f32x4 rsqrt(simd::f32x4 x)
+    {
+#if MATH_SIMD_SSE2
+        simd::f32x4 y {_mm_rsqrt_ps(x)};
+        constexpr s32 STEPS {A == Accuracy::High ? 1 : 0};
+#else
+        simd::f32x4 y {simd::asFloat(simd::subInt(simd::setInt(0x5F375A86u), simd::shiftRight<1>(simd::asInt(x))))};
+        constexpr s32 STEPS {A == Accuracy::High ? 2 : 1};
+#endif
+        simd::f32x4 halfX {simd::mul(simd::set(0.5f), x)};
+
+        for (s32 i = 0; i < STEPS; i++)
+            y = simd::mul(y, simd::sub(simd::set(1.5f), simd::mul(halfX, simd::mul(y, y))));
+
+        return y;
+    }
+
+    /**
+     * \brief Approximates sqrt(x) as x * rsqrt(x), for non-negative x. Zero maps to zero.
+     * \details Max relative error matches rsqrt().
+     */
+    template <Accuracy A = Accuracy::High>
+    f32 sqrt(f32 x)
+    {
+        return x > 0 ? x * rsqrt<A>(x) : 0;
+    }
+
+    template <Accuracy A = Accuracy::High>
+    simd::f32x4 sqrt(simd::f32x4 x)
+    {
+        simd::f32x4 positive {simd::greaterThan(x, simd::set(0.0f))};
+        return simd::bitAnd(positive, simd::mul(x, rsqrt<A>(x)));
+    }
+
+    // === Trigonometry ===
+
+    /**
+     * \brief Approximates sin(x + offset), for |x| <= 8192 and a small offset.
+     * \details Reduces to [-PI/2, PI/2] with PI split in two parts, so k * PI_HIGH is exact and
+     * the reduction loses almost nothing. The offset is given in the same two parts, which lets
+     * cos() shift by PI/2 without rounding x first.
+     */
+    template <Accuracy A>
+    f32 sinOffset(f32 x, f32 offsetHigh, f32 offsetLow)
+    {
+        f32 turns {(x + offsetHigh) * (1 / PI)};
+        f32 k {static_cast<f32>(static_cast<s32>(turns + (turns >= 0 ? 0.5f : -0.5f)))};
+        f32 r {((x - k * PI_HIGH) + offsetHigh) - k * PI_LOW + offsetLow};
+        f32 result;
+
+        if constexpr (A == Accuracy::High)
+            result = r * polynomial(r * r, SIN_HIGH);
+        else
+            result = r * polynomial(r * r, SIN_LOW);
+
+        // sin(r + k * PI) flips sign for every odd k.
+        return (static_cast<s32>(k) & 1) ? -result : result;
+    }
+
+    template <Accuracy A>
+    simd::f32x4 sinOffset(simd::f32x4 x, f32 offsetHigh, f32 offsetLow)
+    {
+        simd::f32x4 turns {simd::mul(simd::add(x, simd::set(offsetHigh)), simd::set(1 / PI))};
+        simd::f32x4 roundBias {simd::bitOr(simd::bitAnd(turns, simd::set(-0.0f)), simd::set(0.5f))};
+        simd::u32x4 k {simd::toInt(simd::add(turns, roundBias))};
+        simd::f32x4 kf {simd::toFloat(k)};
+        simd::f32x4 r {simd::sub(x, simd::mul(kf, simd::set(PI_HIGH)))};
+        r = simd::add(simd::sub(simd::add(r, simd::set(offsetHigh)), simd::mul(kf, simd::set(PI_LOW))), simd::set(offsetLow));
+        simd::f32x4 result;
+
+        if constexpr (A == Accuracy::High)
+            result = simd::mul(r, polynomial(simd::mul(r, r), SIN_HIGH));
+        else
+            result = simd::mul(r, polynomial(simd::mul(r, r), SIN_LOW));
+
+        // Move the low bit of k into the sign bit, to flip the result for odd k.
+        return simd::bitXor(result, simd::asFloat(simd::shiftLeft<31>(k)));
+    }
+
+    /**
+     * \brief Approximates sin(x), for |x| <= 8192.
+     * \details Max absolute error: Low 1.5e-4, High 2.5e-7.
+     */
+    template <Accuracy A = Accuracy::High>
+    f32 sin(f32 x)
+    {
+        return sinOffset<A>(x, 0, 0);
+    }
+
+    template <Accuracy A = Accuracy::High>
+    simd::f32x4 sin(simd::f32x4 x)
+    {
+        return sinOffset<A>(x, 0, 0);
+    }
+
+    /**
+     * \brief Approximates cos(x) as sin(x + PI/2), for |x| <= 8192.
+     * \details Max absolute error: Low 1.5e-4, High 2.5e-7.
+     */
+    template <Accuracy A = Accuracy::High>
+    f32 cos(f32 x)
+    {
+        return sinOffset<A>(x, HALF_PI_HIGH, HALF_PI_LOW);
+    }
+
+    template <Accuracy A = Accuracy::High>
+    simd::f32x4 cos(simd::f32x4 x)
+    {
+        return sinOffset<A>(x, HALF_PI_HIGH, HALF_PI_LOW);
+    }
+
+    /**
+     * \brief Approximates atan2(y, x), returning an angle in [-PI, PI]. atan2(0, 0) is 0.
+     * \details Evaluates atan on [0, 1] with the smaller-over-larger ratio, then unfolds the octant.
+     * Max absolute error: Low 8.5e-5, High 6.0e-7.
+     */
+    template <Accuracy A = Accuracy::High>
+    f32 atan2(f32 y, f32 x)
+    {
+        f32 absX {x < 0 ? -x : x};
+        f32 absY {y < 0 ? -y : y};
+        f32 larger {absX > absY ? absX : absY};
+        f32 smaller {absX > absY ? absY : absX};
+        f32 ratio {larger > 0 ? smaller / larger : 0};
+        f32 result;
+
+        if constexpr (A == Accuracy::High)
+            result = ratio * polynomial(ratio * ratio, ATAN_HIGH);
+        else
+            result = ratio * polynomial(ratio * ratio, ATAN_LOW);
+
+        if (absY > absX)
+            result = PI / 2 - result;
+
+        if (x < 0)
+            result = PI - result;
+
+        return y < 0 ? -result : result;
+    }
+
+    template <Accuracy A = Accuracy::High>
+    simd::f32x4 atan2(simd::f32x4 y, simd::f32x4 x)
+    {
+        simd::f32x4 absX {simd::abs(x)};
+        simd::f32x4 absY {simd::abs(y)};
+        simd::f32x4 larger {simd::max(absX, absY)};
+        simd::f32x4 smaller {simd::min(absX, absY)};
+        simd::f32x4 nonZero {simd::greaterThan(larger, simd::set(0.0f))};
+        simd::f32x4 ratio {simd::bitAnd(nonZero, simd::div(smaller, larger))};
+        simd::f32x4 ratioSqr {simd::mul(ratio, ratio)};
+        simd::f32x4 result;
+
+        if constexpr (A == Accuracy::High)
+            result = simd::mul(ratio, polynomial(ratioSqr, ATAN_HIGH));
+        else
+            result = simd::mul(ratio, polynomial(ratioSqr, ATAN_LOW));
+
+        result = simd::select(simd::greaterThan(absY, absX), simd::sub(simd::set(PI / 2), result), result);
+        result = simd::select(simd::lessThan(x, simd::set(0.0f)), simd::sub(simd::set(PI), result), result);
+
+        // Copy the sign of y onto the result.
+        return simd::bitOr(result, simd::bitAnd(y, simd::set(-0.0f)));
+    }
+
+    // === Exponentials ===
+
+    /**
+     * \brief Approximates 2^x, with x clamped to [-126, 127] so the result stays a normal float.
+     * \details Splits x into an integer part (written straight into the exponent bits) and a
+     * fraction in [0, 1) evaluated by polynomial. Max relative error: Low 7.5e-5, High 3.0e-7.
+     */
+    template <Accuracy A = Accuracy::High>
+    f32 exp2(f32 x)
+    {
+        x = x < -126.0f ? -126.0f : (x > 127.0f ? 127.0f : x);
+
+        s32 whole {static_cast<s32>(x)};
+        whole -= x < static_cast<f32>(whole) ? 1 : 0;
+        f32 fraction {x - static_cast<f32>(whole)};
+        f32 scale {std::bit_cast<f32>(static_cast<u32>(whole + 127) << 23)};
+
+        if constexpr (A == Accuracy::High)
+            return polynomial(fraction, EXP2_HIGH) * scale;
+        else
+            return polynomial(fraction, EXP2_LOW) * scale;
+    }
+
+    template <Accuracy A = Accuracy::High>
+    simd::f32x4 exp2(simd::f32x4 x)
+    {
+        x = simd::min(simd::max(x, simd::set(-126.0f)), simd::set(127.0f));
+
+        simd::f32x4 whole {simd::floor(x)};
+        simd::f32x4 fraction {simd::sub(x, whole)};
+        simd::u32x4 exponent {simd::addInt(simd::toInt(whole), simd::setInt(127))};
+        simd::f32x4 scale {simd::asFloat(simd::shiftLeft<23>(exponent))};
+
+        if constexpr (A == Accuracy::High)
+            return simd::mul(polynomial(fraction, EXP2_HIGH), scale);
+        else
+            return simd::mul(polynomial(fraction, EXP2_LOW), scale);
+    }
+
+    /**
+     * \brief Approximates log2(x), for positive, normal x.
+     * \details Reads the exponent straight from the float bits, and evaluates the mantissa
+     * (in [1, 2)) by polynomial. Max absolute error: Low 1.1e-4, High 6.0e-7.
+     */
+    template <Accuracy A = Accuracy::High>
+    f32 log2(f32 x)
+    {
+        u32 bits {std::bit_cast<u32>(x)};
+        f32 exponent {static_cast<f32>(static_cast<s32>(bits >> 23) - 127)};
+        f32 mantissa {std::bit_cast<f32>((bits & 0x007FFFFFu) | 0x3F800000u) - 1.0f};
+
+        if constexpr (A == Accuracy::High)
+            return exponent + mantissa * polynomial(mantissa, LOG2_HIGH);
+        else
+            return exponent + mantissa * polynomial(mantissa, LOG2_LOW);
+    }
+
+    template <Accuracy A = Accuracy::High>
+    simd::f32x4 log2(simd::f32x4 x)
+    {
+        simd::u32x4 bits {simd::asInt(x)};
+        simd::f32x4 exponent {simd::toFloat(simd::subInt(simd::shiftRight<23>(bits), simd::setInt(127)))};
+        simd::u32x4 mantissaBits {simd::bitOr(simd::bitAnd(bits, simd::setInt(0x007FFFFFu)), simd::setInt(0x3F800000u))};
+        simd::f32x4 mantissa {simd::sub(simd::asFloat(mantissaBits), simd::set(1.0f))};
+
+        if constexpr (A == Accuracy::High)
+            return simd::madd(mantissa, polynomial(mantissa, LOG2_HIGH), exponent);
+        else
+            return simd::madd(mantissa, polynomial(mantissa, LOG2_LOW), exponent);
+    }
+
+} // namespace Math::fast
+
+#endif // FAST_MATH_H
@@ -0,0 +1,183 @@
+﻿#include <cmath>
+#include "frustum.hpp"
+#include "mat4.hpp"
+#include "aabb.hpp"
+#include "sphere.hpp"
+#include "simd.hpp"
+
+using namespace Math;
+
+f32 Plane::distanceTo(Vec3 point) const
+{
+    return Vec3::dot(normal, point) + distance;
+}
+
+// === Lifetime ===
+
+// Gribb and Hartmann, "Fast Extraction of Viewing Frustum Planes from the World-View-Projection Matrix".
+// Points are row vectors here (clip = point * matrix), so each clip coordinate comes from a column,
+// and a point is inside when -w <= x, y, z <= w.
+Frustum Frustum::fromMatrix(const Mat4& worldToClip)
+{
+    auto extractPlane = [&](s32 index, f32 sign)
+    {
+        Plane plane {};
+        plane.normal.x = worldToClip[0][3] + sign * worldToClip[0][index];
+        plane.normal.y = worldToClip[1][3] + sign * worldToClip[1][index];
+        plane.normal.z = worldToClip[2][3] + sign * worldToClip[2][index];
+        plane.distance = worldToClip[3][3] + sign * worldToClip[3][index];
+
+        f32 length {plane.normal.magnitude()};
+        plane.normal *= 1 / length;
+        plane.distance /= length;
+        return plane;
+    };
+
+    Frustum result {};
+    result.planes[Left] = extractPlane(0, 1);
+    result.planes[Right] = extractPlane(0, -1);
+    result.planes[Bottom] = extractPlane(1, 1);
+    result.planes[Top] = extractPlane(1, -1);
+    result.planes[Near] = extractPlane(2, 1);
+    result.planes[Far] = extractPlane(2, -1);
+    return result;
+}
+
+// === Queries ===
+bool Frustum::contains(Vec3 point) const
+{
+    for (const Plane& plane : planes)
+    {
+        if (plane.distanceTo(point) < 0)
+            return false;
+    }
+
+    return true;
+}
+
+bool Frustum::intersects(const Aabb& box) const
+{
+    Vec3 center {box.center()};
+    Vec3 extents {box.extents()};
+
+    for (const Plane& plane : planes)
+    {
+        // The furthest the box reaches towards the inside of the plane.
+        f32 radius = std::abs(plane.normal.x) * extents.x
+                   + std::abs(plane.normal.y) * extents.y
+                   + std::abs(plane.normal.z) * extents.z;
+
+        if (plane.distanceTo(center) + radius < 0)
+            return false;
+    }
+
+    return true;
+}
+
+bool Frustum::intersects(const Sphere& sphere) const
+{
+    for (const Plane& plane : planes)
+    {
+        if (plane.distanceTo(sphere.center) + sphere.radius < 0)
+            return false;
+    }
+
+    return true;
+}
+
+// === Batch Culling ===
+
+// Both batch functions test four bounds against each plane at once, then append the survivors
+// without branching: every lane writes its index, but the count only advances for visible lanes.
+
+namespace
+{
+    s32 appendVisible(u32* visible, s32 count, u32 first, s32 mask)
+    {
+        for (s32 lane = 0; lane < simd::WIDTH; lane++)
+        {
+            visible[count] = first + lane;
+            count += (mask >> lane) & 1;
+        }
+
+        return count;
+    }
+}
+
+s32 Frustum::cull(const AabbBatch& boxes, u32* visible) const
+{
+    s32 count {};
+    s32 i {};
+
+    for (; i + simd::WIDTH <= boxes.count; i += simd::WIDTH)
+    {
+        simd::f32x4 centerX {simd::load(boxes.centerX + i)};
+        simd::f32x4 centerY {simd::load(boxes.centerY + i)};
+        simd::f32x4 centerZ {simd::load(boxes.centerZ + i)};
+        simd::f32x4 extentX {simd::load(boxes.extentX + i)};
+        simd::f32x4 extentY {simd::load(boxes.extentY + i)};
+        simd::f32x4 extentZ {simd::load(boxes.extentZ + i)};
+        simd::f32x4 inside {simd::asFloat(simd::setInt(~0u))};
+
+        for (const Plane& plane : planes)
+        {
+            simd::f32x4 distance {simd::set(plane.distance)};
+            distance = simd::madd(centerX, simd::set(plane.normal.x), distance);
+            distance = simd::madd(centerY, simd::set(plane.normal.y), distance);
+            distance = simd::madd(centerZ, simd::set(plane.normal.z), distance);
+            distance = simd::madd(extentX, simd::set(std::abs(plane.normal.x)), distance);
+            distance = simd::madd(extentY, simd::set(std::abs(plane.normal.y)), distance);
+            distance = simd::madd(extentZ, simd::set(std::abs(plane.normal.z)), distance);
+            inside = simd::bitAnd(inside, simd::greaterEqual(distance, simd::set(0.0f)));
+        }
+
+        count = appendVisible(visible, count, i, simd::moveMask(inside));
+    }
+
+    for (; i < boxes.count; i++)
+    {
+        Vec3 center {boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i]};
+        Vec3 extents {boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i]};
+
+        if (intersects(Aabb::fromCenterExtents(center, extents)))
+            visible[count++] = i;
+    }
+
+    return count;
+}
+
+s32 Frustum::cull(const SphereBatch& spheres, u32* visible) const
+{
+    s32 count {};
+    s32 i {};
+
+    for (; i + simd::WIDTH <= spheres.count; i += simd::WIDTH)
+    {
+        simd::f32x4 centerX {simd::load(spheres.centerX + i)};
+        simd::f32x4 centerY {simd::load(spheres.centerY + i)};
+        simd::f32x4 centerZ {simd::load(spheres.centerZ + i)};
+        simd::f32x4 radius {simd::load(spheres.radius + i)};
+        simd::f32x4 inside {simd::asFloat(simd::setInt(~0u))};
+
+        for (const Plane& plane : planes)
+        {
+            simd::f32x4 distance {simd::add(radius, simd::set(plane.distance))};
+            distance = simd::madd(centerX, simd::set(plane.normal.x), distance);
+            distance = simd::madd(centerY, simd::set(plane.normal.y), distance);
+            distance = simd::madd(centerZ, simd::set(plane.normal.z), distance);
+            inside = simd::bitAnd(inside, simd::greaterEqual(distance, simd::set(0.0f)));
+        }
+
+        count = appendVisible(visible, count, i, simd::moveMask(inside));
+    }
+
+    for (; i < spheres.count; i++)
+    {
+        Sphere sphere {{spheres.centerX[i], spheres.centerY[i], spheres.centerZ[i]}, spheres.radius[i]};
+
+        if (intersects(sphere))
+            visible[count++] = i;
+    }
+
+    return count;
+}
@@ -0,0 +1,101 @@
+﻿#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include "../types.hpp"
+#include "vec3.hpp"
+
+struct Mat4;
+struct Aabb;
+struct Sphere;
+
+/**
+ * \brief A plane, stored as a unit normal and the signed distance of the origin from it.
+ * Points on the side the normal faces have a positive distance.
+ */
+struct Plane
+{
+    Vec3 normal;
+    f32 distance;
+
+    f32 distanceTo(Vec3 point) const;
+};
+
+/**
+ * \brief Many axis-aligned boxes, stored as separate arrays (structure of arrays), so that
+ * the batch culling functions can test several at once.
+ */
+struct AabbBatch
+{
+    const f32* centerX;
+    const f32* centerY;
+    const f32* centerZ;
+    const f32* extentX;
+    const f32* extentY;
+    const f32* extentZ;
+    s32 count;
+};
+
+/**
+ * \brief Many spheres, stored as separate arrays (structure of arrays), so that the batch
+ * culling functions can test several at once.
+ */
+struct SphereBatch
+{
+    const f32* centerX;
+    const f32* centerY;
+    const f32* centerZ;
+    const f32* radius;
+    s32 count;
+};
+
+/**
+ * \brief The six planes bounding the volume a camera can see, all facing inwards.
+ */
+struct Frustum
+{
+    enum PlaneIndex { Left, Right, Bottom, Top, Near, Far, PlaneCount };
+
+    Plane planes[PlaneCount];
+
+    // === Lifetime ===
+
+    /**
+     * \brief Extracts the frustum planes from a combined projection matrix.
+     * \param worldToClip The world to clip space transformation, i.e. (world_to_view * view_to_clip).
+     * \return The frustum, in the same space that the matrix transforms from.
+     */
+    static Frustum fromMatrix(const Mat4& worldToClip);
+
+    // === Queries ===
+    bool contains(Vec3 point) const;
+
+    /**
+     * \brief Conservatively checks if a box overlaps the frustum.
+     * \details Boxes near the frustum corners may be reported as visible when they are not,
+     * but visible boxes are never rejected.
+     */
+    bool intersects(const Aabb& box) const;
+    bool intersects(const Sphere& sphere) const;
+
+    // === Batch Culling ===
+
+    /**
+     * \brief Finds every box in a batch that overlaps the frustum.
+     * \param boxes The boxes to test.
+     * \param visible Receives the index of each visible box in ascending order.
+     * Must have room for boxes.count indices.
+     * \return The number of indices written to visible.
+     */
+    s32 cull(const AabbBatch& boxes, u32* visible) const;
+
+    /**
+     * \brief Finds every sphere in a batch that overlaps the frustum.
+     * \param spheres The spheres to test.
+     * \param visible Receives the index of each visible sphere in ascending order.
+     * Must have room for spheres.count indices.
+     * \return The number of indices written to visible.
+     */
+    s32 cull(const SphereBatch& spheres, u32* visible) const;
+};
+
+#endif // FRUSTUM_H
@@ -5,9 +5,33 @@
 
 #include "math_util.hpp"
 #include "vector_base.h"
+#include "../config.hpp"
+
+#ifdef MATH_FAST_TRIG
+#include "fast_math.hpp"
+#endif
 
 using namespace Math;
 
+// The rotation builders go through these, so MATH_FAST_TRIG can swap in the polynomial approximations.
+static f32 rotationSin(f32 amount)
+{
+#ifdef MATH_FAST_TRIG
+    return fast::sin(amount);
+#else
+    return std::sin(amount);
+#endif
+}
+
+static f32 rotationCos(f32 amount)
+{
+#ifdef MATH_FAST_TRIG
+    return fast::cos(amount);
+#else
+    return std::cos(amount);
+#endif
+}
+
 std::ostream& operator<<(std::ostream& os, const Mat4& value)
 {
     return os << stringFormat(
@@ -224,12 +248,15 @@ Mat4 Mat4::scale(f32 x, f32 y, f32 z)
 
 Mat4 Mat4::rotateX(f32 amount)
 {
+    f32 s = rotationSin(amount);
+    f32 c = rotationCos(amount);
+
     return Mat4
     {
         {
             {1, 0, 0, 0},
-            {0, cos(amount), sin(amount), 0},
-            {0, -sin(amount), cos(amount), 0},
+            {0, c, s, 0},
+            {0, -s, c, 0},
             {0, 0, 0, 1},
         }
     };
@@ -238,12 +265,15 @@ Mat4 Mat4::rotateX(f32 amount)
 Mat4 Mat4::rotateY(f32 amount)
 {
     // amount *= -1;
+    f32 s = rotationSin(amount);
+    f32 c = rotationCos(amount);
+
     return Mat4
     {
         {
-            {cos(amount), 0, -sin(amount), 0},
+            {c, 0, -s, 0},
             {0, 1, 0, 0},
-            {sin(amount), 0, cos(amount), 0},
+            {s, 0, c, 0},
             {0, 0, 0, 1},
         }
     };
@@ -252,11 +282,14 @@ Mat4 Mat4::rotateY(f32 amount)
 Mat4 Mat4::rotateZ(f32 amount)
 {
     // amount *= -1;
+    f32 s = rotationSin(amount);
+    f32 c = rotationCos(amount);
+
     return Mat4
     {
         {
-            {cos(amount), sin(amount), 0, 0},
-            {-sin(amount), cos(amount), 0, 0},
+            {c, s, 0, 0},
+            {-s, c, 0, 0},
             {0, 0, 1, 0},
             {0, 0, 0, 1},
         }
@@ -0,0 +1,278 @@
+﻿#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+#include "noise.hpp"
+
+using namespace Math;
+
+// The scalar and SIMD paths below are written to perform the exact same operations, so that
+// both give the same results, and can be mixed freely.
+
+// Skews the input grid onto a grid of triangles, and back.
+constexpr f32 SKEW {0.36602540378f};   // (sqrt(3) - 1) / 2
+constexpr f32 UNSKEW {0.21132486540f}; // (3 - sqrt(3)) / 6
+
+// Brings the summed corner contributions into [-1, 1].
+constexpr f32 SIMPLEX_SCALE {45.23f};
+
+// Spreads out octave and warp seeds, so they do not produce correlated fields.
+constexpr u32 SEED_STEP {0x9E3779B9};
+
+// Offsets the second warp field, so it is not a copy of the first.
+constexpr f32 WARP_OFFSET {5.2f};
+
+// How many rows make up one unit of work for the heightfield threads.
+constexpr s32 TILE_ROWS {16};
+
+// === Scalar ===
+
+// Mixes a lattice point and seed into well distributed bits.
+static u32 hash(u32 x, u32 y, u32 seed)
+{
+    u32 result = seed ^ (x * 0x27D4EB2D) ^ (y * 0x165667B1);
+    result ^= result >> 15;
+    result *= 0x2C1B3C6D;
+    result ^= result >> 12;
+    result *= 0x297A2D39;
+    result ^= result >> 15;
+    return result;
+}
+
+// Dots the offset with one of eight gradients, picked by the low bits of the hash.
+static f32 gradient(u32 hash, f32 x, f32 y)
+{
+    f32 u = (hash & 4) ? y : x;
+    f32 v = (hash & 4) ? x : y;
+    return ((hash & 1) ? -u : u) + ((hash & 2) ? -2 * v : 2 * v);
+}
+
+static f32 corner(u32 hash, f32 x, f32 y)
+{
+    f32 falloff = std::max(0.5f - x * x - y * y, 0.0f);
+    falloff *= falloff;
+    return falloff * falloff * gradient(hash, x, y);
+}
+
+f32 noise::simplex(f32 x, f32 y, u32 seed)
+{
+    // Find the triangle containing the point, and the offsets to its three corners.
+    f32 skew = (x + y) * SKEW;
+    f32 cellX = std::floor(x + skew);
+    f32 cellY = std::floor(y + skew);
+    f32 unskew = (cellX + cellY) * UNSKEW;
+    f32 x0 = x - (cellX - unskew);
+    f32 y0 = y - (cellY - unskew);
+
+    u32 stepX = x0 > y0 ? 1 : 0;
+    u32 stepY = 1 - stepX;
+    f32 x1 = x0 - static_cast<f32>(stepX) + UNSKEW;
+    f32 y1 = y0 - static_cast<f32>(stepY) + UNSKEW;
+    f32 x2 = x0 - 1 + 2 * UNSKEW;
+    f32 y2 = y0 - 1 + 2 * UNSKEW;
+
+    u32 i = static_cast<u32>(static_cast<s32>(cellX));
+    u32 j = static_cast<u32>(static_cast<s32>(cellY));
+
+    f32 total = corner(hash(i, j, seed), x0, y0)
+              + corner(hash(i + stepX, j + stepY, seed), x1, y1)
+              + corner(hash(i + 1, j + 1, seed), x2, y2);
+
+    return total * SIMPLEX_SCALE;
+}
+
+f32 noise::fbm(f32 x, f32 y, u32 seed, const FractalSettings& settings)
+{
+    f32 total {};
+    f32 amplitude {1};
+    f32 amplitudeSum {};
+    f32 frequency {settings.frequency};
+
+    for (s32 octave = 0; octave < settings.octaves; octave++)
+    {
+        total += simplex(x * frequency, y * frequency, seed + octave * SEED_STEP) * amplitude;
+        amplitudeSum += amplitude;
+        amplitude *= settings.gain;
+        frequency *= settings.lacunarity;
+    }
+
+    return amplitudeSum > 0 ? total / amplitudeSum : 0;
+}
+
+void noise::warp(f32& x, f32& y, u32 seed, const FractalSettings& settings, f32 strength)
+{
+    f32 offsetX = fbm(x, y, seed + SEED_STEP / 2, settings);
+    f32 offsetY = fbm(x + WARP_OFFSET, y + WARP_OFFSET, seed - SEED_STEP / 2, settings);
+    x += offsetX * strength;
+    y += offsetY * strength;
+}
+
+// === SIMD ===
+
+static simd::u32x4 hash(simd::u32x4 x, simd::u32x4 y, u32 seed)
+{
+    simd::u32x4 result = simd::bitXor(simd::setInt(seed), simd::bitXor(
+        simd::mulInt(x, simd::setInt(0x27D4EB2D)),
+        simd::mulInt(y, simd::setInt(0x165667B1))));
+
+    result = simd::bitXor(result, simd::shiftRight<15>(result));
+    result = simd::mulInt(result, simd::setInt(0x2C1B3C6D));
+    result = simd::bitXor(result, simd::shiftRight<12>(result));
+    result = simd::mulInt(result, simd::setInt(0x297A2D39));
+    result = simd::bitXor(result, simd::shiftRight<15>(result));
+    return result;
+}
+
+// Negating 0 or 1 gives an all-clear or all-set lane mask, no comparisons needed.
+template <s32 Bit>
+simd::f32x4 bitMask(simd::u32x4 value)
+{
+    return simd::asFloat(simd::subInt(simd::setInt(0), simd::bitAnd(simd::shiftRight<Bit>(value), simd::setInt(1))));
+}
+
+// Moves a bit into the sign position, ready to be xor'ed onto a float.
+template <s32 Bit>
+simd::f32x4 signBit(simd::u32x4 value)
+{
+    return simd::asFloat(simd::bitAnd(simd::shiftLeft<31 - Bit>(value), simd::setInt(0x80000000)));
+}
+
+static simd::f32x4 gradient(simd::u32x4 hash, simd::f32x4 x, simd::f32x4 y)
+{
+    simd::f32x4 swap = bitMask<2>(hash);
+    simd::f32x4 u = simd::select(swap, y, x);
+    simd::f32x4 v = simd::select(swap, x, y);
+    return simd::add(simd::bitXor(u, signBit<0>(hash)), simd::bitXor(simd::add(v, v), signBit<1>(hash)));
+}
+
+static simd::f32x4 corner(simd::u32x4 hash, simd::f32x4 x, simd::f32x4 y)
+{
+    simd::f32x4 falloff = simd::sub(simd::sub(simd::set(0.5f), simd::mul(x, x)), simd::mul(y, y));
+    falloff = simd::max(falloff, simd::set(0.0f));
+    falloff = simd::mul(falloff, falloff);
+    return simd::mul(simd::mul(falloff, falloff), gradient(hash, x, y));
+}
+
+simd::f32x4 noise::simplex(simd::f32x4 x, simd::f32x4 y, u32 seed)
+{
+    simd::f32x4 skew = simd::mul(simd::add(x, y), simd::set(SKEW));
+    simd::f32x4 cellX = simd::floor(simd::add(x, skew));
+    simd::f32x4 cellY = simd::floor(simd::add(y, skew));
+    simd::f32x4 unskew = simd::mul(simd::add(cellX, cellY), simd::set(UNSKEW));
+    simd::f32x4 x0 = simd::sub(x, simd::sub(cellX, unskew));
+    simd::f32x4 y0 = simd::sub(y, simd::sub(cellY, unskew));
+
+    simd::f32x4 stepMask = simd::greaterThan(x0, y0);
+    simd::f32x4 one = simd::set(1.0f);
+    simd::f32x4 x1 = simd::add(simd::sub(x0, simd::bitAnd(stepMask, one)), simd::set(UNSKEW));
+    simd::f32x4 y1 = simd::add(simd::sub(y0, simd::bitAndNot(stepMask, one)), simd::set(UNSKEW));
+    simd::f32x4 x2 = simd::add(simd::sub(x0, one), simd::set(2 * UNSKEW));
+    simd::f32x4 y2 = simd::add(simd::sub(y0, one), simd::set(2 * UNSKEW));
+
+    simd::u32x4 i = simd::toInt(cellX);
+    simd::u32x4 j = simd::toInt(cellY);
+    simd::u32x4 stepX = simd::bitAnd(simd::asInt(stepMask), simd::setInt(1));
+    simd::u32x4 stepY = simd::subInt(simd::setInt(1), stepX);
+    simd::u32x4 intOne = simd::setInt(1);
+
+    simd::f32x4 total = corner(hash(i, j, seed), x0, y0);
+    total = simd::add(total, corner(hash(simd::addInt(i, stepX), simd::addInt(j, stepY), seed), x1, y1));
+    total = simd::add(total, corner(hash(simd::addInt(i, intOne), simd::addInt(j, intOne), seed), x2, y2));
+
+    return simd::mul(total, simd::set(SIMPLEX_SCALE));
+}
+
+simd::f32x4 noise::fbm(simd::f32x4 x, simd::f32x4 y, u32 seed, const FractalSettings& settings)
+{
+    simd::f32x4 total = simd::set(0.0f);
+    f32 amplitude {1};
+    f32 amplitudeSum {};
+    f32 frequency {settings.frequency};
+
+    for (s32 octave = 0; octave < settings.octaves; octave++)
+    {
+        simd::f32x4 scaledFrequency = simd::set(frequency);
+        simd::f32x4 octaveNoise = simplex(simd::mul(x, scaledFrequency), simd::mul(y, scaledFrequency), seed + octave * SEED_STEP);
+        total = simd::add(total, simd::mul(octaveNoise, simd::set(amplitude)));
+        amplitudeSum += amplitude;
+        amplitude *= settings.gain;
+        frequency *= settings.lacunarity;
+    }
+
+    return amplitudeSum > 0 ? simd::div(total, simd::set(amplitudeSum)) : simd::set(0.0f);
+}
+
+void noise::warp(simd::f32x4& x, simd::f32x4& y, u32 seed, const FractalSettings& settings, f32 strength)
+{
+    simd::f32x4 offset = simd::set(WARP_OFFSET);
+    simd::f32x4 offsetX = fbm(x, y, seed + SEED_STEP / 2, settings);
+    simd::f32x4 offsetY = fbm(simd::add(x, offset), simd::add(y, offset), seed - SEED_STEP / 2, settings);
+    x = simd::add(x, simd::mul(offsetX, simd::set(strength)));
+    y = simd::add(y, simd::mul(offsetY, simd::set(strength)));
+}
+
+// === Heightfields ===
+
+static void generateRow(f32* row, s32 width, f32 y, const noise::HeightfieldSettings& settings)
+{
+    simd::f32x4 laneOffsets = simd::set(0.0f, 1.0f, 2.0f, 3.0f);
+
+    for (s32 x = 0; x < width; x += simd::WIDTH)
+    {
+        simd::f32x4 sampleX = simd::add(simd::set(static_cast<f32>(x)), laneOffsets);
+        sampleX = simd::add(simd::set(settings.originX), simd::mul(sampleX, simd::set(settings.spacing)));
+        simd::f32x4 sampleY = simd::set(y);
+
+        if (settings.warpStrength != 0)
+            noise::warp(sampleX, sampleY, settings.seed, settings.fractal, settings.warpStrength);
+
+        simd::f32x4 value = noise::fbm(sampleX, sampleY, settings.seed, settings.fractal);
+        value = simd::madd(value, simd::set(0.5f), simd::set(0.5f));
+        value = simd::min(simd::max(value, simd::set(0.0f)), simd::set(1.0f));
+
+        // The last few samples of a row may not fill a whole register.
+        if (x + simd::WIDTH <= width)
+        {
+            simd::store(row + x, value);
+        }
+        else
+        {
+            f32 lanes[simd::WIDTH];
+            simd::store(lanes, value);
+            std::copy(lanes, lanes + (width - x), row + x);
+        }
+    }
+}
+
+void noise::generateHeightfield(f32* heights, s32 width, s32 height, const HeightfieldSettings& settings, s32 threadCount)
+{
+    if (threadCount <= 0)
+        threadCount = static_cast<s32>(std::max(std::thread::hardware_concurrency(), 1u));
+
+    s32 tileCount = (height + TILE_ROWS - 1) / TILE_ROWS;
+    threadCount = std::min(threadCount, tileCount);
+    std::atomic<s32> nextTile {0};
+
+    // Tiles are handed out dynamically, since warped tiles can take longer than others.
+    auto work = [&]
+    {
+        for (s32 tile = nextTile++; tile < tileCount; tile = nextTile++)
+        {
+            s32 end = std::min((tile + 1) * TILE_ROWS, height);
+
+            for (s32 y = tile * TILE_ROWS; y < end; y++)
+                generateRow(heights + static_cast<size_t>(y) * width, width, settings.originY + static_cast<f32>(y) * settings.spacing, settings);
+        }
+    };
+
+    std::vector<std::thread> workers {};
+
+    for (s32 i = 1; i < threadCount; i++)
+        workers.emplace_back(work);
+
+    work();
+
+    for (std::thread& worker : workers)
+        worker.join();
+}
@@ -0,0 +1,80 @@
+﻿#ifndef NOISE_H
+#define NOISE_H
+
+#include "../types.hpp"
+#include "simd.hpp"
+
+/**
+ * \brief Coherent noise for procedural content, like terrain heightfields.
+ * \details Everything is a pure function of its position and seed: the same inputs give the
+ * same result on every platform and thread, so generated content never needs to be stored.
+ * Gradients come from hashing the lattice coordinates instead of a permutation table, which
+ * keeps the SIMD versions free of gathers and allows any number of seeds.
+ */
+namespace Math::noise
+{
+    struct FractalSettings
+    {
+        // How many layers of noise are summed, each one finer than the last.
+        s32 octaves {6};
+        // The frequency of the first (coarsest) octave.
+        f32 frequency {1};
+        // How much the frequency grows with each octave.
+        f32 lacunarity {2};
+        // How much the amplitude shrinks with each octave.
+        f32 gain {0.5f};
+    };
+
+    struct HeightfieldSettings
+    {
+        u32 seed {};
+        FractalSettings fractal {};
+        // How far sample positions are displaced by domain warping, 0 turns warping off.
+        f32 warpStrength {};
+        // The position of the first sample.
+        f32 originX {};
+        f32 originY {};
+        // The distance between neighbouring samples.
+        f32 spacing {1};
+    };
+
+    // === Simplex Noise ===
+
+    /**
+     * \brief 2D simplex noise (Perlin 2001, after Gustavson's "Simplex noise demystified").
+     * \return A smoothly varying value in [-1, 1], with features roughly one unit apart.
+     */
+    f32 simplex(f32 x, f32 y, u32 seed);
+    simd::f32x4 simplex(simd::f32x4 x, simd::f32x4 y, u32 seed);
+
+    // === Fractal Noise ===
+
+    /**
+     * \brief Fractal Brownian motion: several octaves of simplex noise summed together.
+     * \return A value in [-1, 1], normalized by the total amplitude of all octaves.
+     */
+    f32 fbm(f32 x, f32 y, u32 seed, const FractalSettings& settings);
+    simd::f32x4 fbm(simd::f32x4 x, simd::f32x4 y, u32 seed, const FractalSettings& settings);
+
+    /**
+     * \brief Displaces a position by two fbm fields (domain warping), which bends straight
+     * noise features into more natural, eroded looking shapes.
+     * \param strength The largest distance a position can move.
+     */
+    void warp(f32& x, f32& y, u32 seed, const FractalSettings& settings, f32 strength);
+    void warp(simd::f32x4& x, simd::f32x4& y, u32 seed, const FractalSettings& settings, f32 strength);
+
+    // === Heightfields ===
+
+    /**
+     * \brief Fills a heightfield with (optionally warped) fbm noise, remapped to [0, 1].
+     * \details The rows are split into tiles which are generated in parallel, and each
+     * row is generated four samples at a time. The result does not depend on the thread count.
+     * \param heights Receives width * height samples, row by row.
+     * \param threadCount How many threads to use, 0 uses one per hardware thread.
+     */
+    void generateHeightfield(f32* heights, s32 width, s32 height, const HeightfieldSettings& settings, s32 threadCount = 0);
+
+} // namespace Math::noise
+
+#endif // NOISE_H
@@ -0,0 +1,131 @@
+﻿#include "random.hpp"
+
+// Blackman and Vigna, "Scrambled Linear Pseudorandom Number Generators" (2018).
+// See https://prng.di.unimi.it/xoshiro128starstar.c for the reference implementation.
+
+using namespace Math;
+
+// Expands a single seed into well-mixed state words, as recommended by the xoshiro authors.
+static u64 splitMix64(u64& state)
+{
+    u64 result = (state += 0x9E3779B97F4A7C15);
+    result = (result ^ (result >> 30)) * 0xBF58476D1CE4E5B9;
+    result = (result ^ (result >> 27)) * 0x94D049BB133111EB;
+    return result ^ (result >> 31);
+}
+
+static u32 rotateLeft(u32 value, s32 bits)
+{
+    return (value << bits) | (value >> (32 - bits));
+}
+
+// Turns the top 24 bits into a float in [0, 1), every result is exactly representable.
+static f32 toUnitFloat(u32 value)
+{
+    return static_cast<f32>(value >> 8) * 0x1.0p-24f;
+}
+
+// === Random ===
+
+Random::Random(u64 seed)
+{
+    u64 first = splitMix64(seed);
+    u64 second = splitMix64(seed);
+    m_state[0] = static_cast<u32>(first);
+    m_state[1] = static_cast<u32>(first >> 32);
+    m_state[2] = static_cast<u32>(second);
+    m_state[3] = static_cast<u32>(second >> 32);
+}
+
+u32 Random::next()
+{
+    u32 result = rotateLeft(m_state[1] * 5, 7) * 9;
+    u32 shifted = m_state[1] << 9;
+
+    m_state[2] ^= m_state[0];
+    m_state[3] ^= m_state[1];
+    m_state[1] ^= m_state[2];
+    m_state[0] ^= m_state[3];
+    m_state[2] ^= shifted;
+    m_state[3] = rotateLeft(m_state[3], 11);
+
+    return result;
+}
+
+f32 Random::nextFloat()
+{
+    return toUnitFloat(next());
+}
+
+f32 Random::range(f32 min, f32 max)
+{
+    return min + (max - min) * nextFloat();
+}
+
+s32 Random::range(s32 min, s32 max)
+{
+    u64 span = static_cast<u64>(static_cast<s64>(max) - min) + 1;
+    return static_cast<s32>(min + static_cast<s64>((next() * span) >> 32));
+}
+
+void Random::jump()
+{
+    constexpr u32 JUMP[] {0x8764000B, 0xF542D2D3, 0x6FA035C3, 0x77F2DB5B};
+    u32 state[4] {};
+
+    for (u32 word : JUMP)
+    {
+        for (s32 bit = 0; bit < 32; bit++)
+        {
+            if (word & (1u << bit))
+            {
+                for (s32 i = 0; i < 4; i++)
+                    state[i] ^= m_state[i];
+            }
+
+            next();
+        }
+    }
+
+    for (s32 i = 0; i < 4; i++)
+        m_state[i] = state[i];
+}
+
+// === RandomX4 ===
+
+RandomX4::RandomX4(Random source)
+{
+    u32 lanes[4][simd::WIDTH];
+
+    for (s32 lane = 0; lane < simd::WIDTH; lane++)
+    {
+        source.jump();
+
+        for (s32 i = 0; i < 4; i++)
+            lanes[i][lane] = source.m_state[i];
+    }
+
+    for (s32 i = 0; i < 4; i++)
+        m_state[i] = simd::loadInt(lanes[i]);
+}
+
+simd::u32x4 RandomX4::next()
+{
+    simd::u32x4 result = simd::mulInt(simd::rotateLeft<7>(simd::mulInt(m_state[1], simd::setInt(5))), simd::setInt(9));
+    simd::u32x4 shifted = simd::shiftLeft<9>(m_state[1]);
+
+    m_state[2] = simd::bitXor(m_state[2], m_state[0]);
+    m_state[3] = simd::bitXor(m_state[3], m_state[1]);
+    m_state[1] = simd::bitXor(m_state[1], m_state[2]);
+    m_state[0] = simd::bitXor(m_state[0], m_state[3]);
+    m_state[2] = simd::bitXor(m_state[2], shifted);
+    m_state[3] = simd::rotateLeft<11>(m_state[3]);
+
+    return result;
+}
+
+simd::f32x4 RandomX4::nextFloat()
+{
+    // The top 24 bits always fit in a positive signed integer, so the signed conversion is safe.
+    return simd::mul(simd::toFloat(simd::shiftRight<8>(next())), simd::set(0x1.0p-24f));
+}
@@ -0,0 +1,69 @@
+﻿#ifndef RANDOM_H
+#define RANDOM_H
+
+#include "../types.hpp"
+#include "simd.hpp"
+
+namespace Math
+{
+    /**
+     * \brief A fast, non-cryptographic pseudo random number generator (xoshiro128**).
+     * \details 16 bytes of state and a period of 2^128 - 1. Sequences are deterministic for
+     * a given seed on every platform, so anything generated from them (like terrain) can be
+     * rebuilt instead of stored.
+     */
+    class Random
+    {
+    public:
+        // === Lifetime ===
+        explicit Random(u64 seed = 0);
+
+        // === Generation ===
+        u32 next();
+
+        // A uniformly distributed value in [0, 1).
+        f32 nextFloat();
+
+        // A uniformly distributed value in [min, max).
+        f32 range(f32 min, f32 max);
+
+        // A uniformly distributed value in [min, max]. Slightly biased for very large ranges.
+        s32 range(s32 min, s32 max);
+
+        /**
+         * \brief Advances the generator by 2^64 steps.
+         * \details Calling this between handing out copies gives each copy its own
+         * non-overlapping sequence, which is how parallel workers should be seeded.
+         */
+        void jump();
+
+    private:
+        u32 m_state[4];
+
+        friend class RandomX4;
+    };
+
+    /**
+     * \brief Four independent xoshiro128** generators, stepped together in SIMD registers.
+     */
+    class RandomX4
+    {
+    public:
+        // === Lifetime ===
+
+        // Each lane continues from its own jump() of the given generator.
+        explicit RandomX4(Random source);
+
+        // === Generation ===
+        simd::u32x4 next();
+
+        // Uniformly distributed values in [0, 1).
+        simd::f32x4 nextFloat();
+
+    private:
+        simd::u32x4 m_state[4];
+    };
+
+} // namespace Math
+
+#endif // RANDOM_H
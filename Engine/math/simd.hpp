@@ -0,0 +1,452 @@
+﻿#ifndef SIMD_H
+#define SIMD_H
+
+#include "../types.hpp"
+
+// SSE2 is guaranteed on every x64 target, but MSVC never defines __SSE2__, so check its architecture macros too.
+// Define MATH_SIMD_SSE2 as 0 in the project settings to force the scalar fallback.
+#ifndef MATH_SIMD_SSE2
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MATH_SIMD_SSE2 1
+#else
+#define MATH_SIMD_SSE2 0
+#endif
+#endif
+
+#if MATH_SIMD_SSE2
+#include <emmintrin.h>
+#else
+#include <bit>
+#include <cmath>
+#endif
+
+/**
+ * \brief A thin wrapper over 4-wide SIMD registers, so batch math can be written once
+ * and still compile (as plain scalar loops) on targets without SSE2.
+ * \details Comparisons return lane masks (all bits set = true), which are consumed by
+ * select() and moveMask(). Integer lanes are unsigned, except for toInt() and toFloat()
+ * which convert to and from signed integers.
+ */
+namespace Math::simd
+{
+    // The number of lanes in every SIMD register.
+    constexpr s32 WIDTH {4};
+
+#if MATH_SIMD_SSE2
+    typedef __m128 f32x4;
+    typedef __m128i u32x4;
+#else
+    struct f32x4 { f32 lane[WIDTH]; };
+    struct u32x4 { u32 lane[WIDTH]; };
+#endif
+
+// Applies a per-lane expression for the scalar fallback path.
+#define SIMD_FALLBACK(Type, expression) \
+    Type result; \
+    for (s32 i = 0; i < WIDTH; i++) \
+        result.lane[i] = expression; \
+    return result;
+
+    // === Loading / Storing ===
+
+    // Loads four floats, the source does not need to be aligned.
+    inline f32x4 load(const f32* source)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_loadu_ps(source);
+#else
+        SIMD_FALLBACK(f32x4, source[i])
+#endif
+    }
+
+    // Stores four floats, the destination does not need to be aligned.
+    inline void store(f32* destination, f32x4 value)
+    {
+#if MATH_SIMD_SSE2
+        _mm_storeu_ps(destination, value);
+#else
+        for (s32 i = 0; i < WIDTH; i++)
+            destination[i] = value.lane[i];
+#endif
+    }
+
+    inline u32x4 loadInt(const u32* source)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+#else
+        SIMD_FALLBACK(u32x4, source[i])
+#endif
+    }
+
+    inline void storeInt(u32* destination, u32x4 value)
+    {
+#if MATH_SIMD_SSE2
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination), value);
+#else
+        for (s32 i = 0; i < WIDTH; i++)
+            destination[i] = value.lane[i];
+#endif
+    }
+
+    // Broadcasts a single value into every lane.
+    inline f32x4 set(f32 value)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_set1_ps(value);
+#else
+        SIMD_FALLBACK(f32x4, value)
+#endif
+    }
+
+    // Builds a register from four values, "a" ends up in the first lane.
+    inline f32x4 set(f32 a, f32 b, f32 c, f32 d)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_setr_ps(a, b, c, d);
+#else
+        return f32x4{{a, b, c, d}};
+#endif
+    }
+
+    inline u32x4 setInt(u32 value)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_set1_epi32(static_cast<s32>(value));
+#else
+        SIMD_FALLBACK(u32x4, value)
+#endif
+    }
+
+    inline u32x4 setInt(u32 a, u32 b, u32 c, u32 d)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_setr_epi32(static_cast<s32>(a), static_cast<s32>(b), static_cast<s32>(c), static_cast<s32>(d));
+#else
+        return u32x4{{a, b, c, d}};
+#endif
+    }
+
+    // Reads a single lane back out. Slow, intended for tests and debugging.
+    inline f32 lane(f32x4 value, s32 index)
+    {
+        f32 lanes[WIDTH];
+        store(lanes, value);
+        return lanes[index];
+    }
+
+    // === Arithmetic ===
+
+    inline f32x4 add(f32x4 a, f32x4 b)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_add_ps(a, b);
+#else
+        SIMD_FALLBACK(f32x4, a.lane[i] + b.lane[i])
+#endif
+    }
+
+    inline f32x4 sub(f32x4 a, f32x4 b)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_sub_ps(a, b);
+#else
+        SIMD_FALLBACK(f32x4, a.lane[i] - b.lane[i])
+#endif
+    }
+
+    inline f32x4 mul(f32x4 a, f32x4 b)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_mul_ps(a, b);
+#else
+        SIMD_FALLBACK(f32x4, a.lane[i] * b.lane[i])
+#endif
+    }
+
+    inline f32x4 div(f32x4 a, f32x4 b)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_div_ps(a, b);
+#else
+        SIMD_FALLBACK(f32x4, a.lane[i] / b.lane[i])
+#endif
+    }
+
+    // Computes a * b + c.
+    inline f32x4 madd(f32x4 a, f32x4 b, f32x4 c)
+    {
+        return add(mul(a, b), c);
+    }
+
+    inline f32x4 min(f32x4 a, f32x4 b)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_min_ps(a, b);
+#else
+        SIMD_FALLBACK(f32x4, a.lane[i] < b.lane[i] ? a.lane[i] : b.lane[i])
+#endif
+    }
+
+    inline f32x4 max(f32x4 a, f32x4 b)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_max_ps(a, b);
+#else
+        SIMD_FALLBACK(f32x4, a.lane[i] > b.lane[i] ? a.lane[i] : b.lane[i])
+#endif
+    }
+
+    inline f32x4 sqrt(f32x4 value)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_sqrt_ps(value);
+#else
+        SIMD_FALLBACK(f32x4, std::sqrt(value.lane[i]))
+#endif
+    }
+
+    // === Integer Arithmetic ===
+
+    inline u32x4 addInt(u32x4 a, u32x4 b)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_add_epi32(a, b);
+#else
+        SIMD_FALLBACK(u32x4, a.lane[i] + b.lane[i])
+#endif
+    }
+
+    inline u32x4 subInt(u32x4 a, u32x4 b)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_sub_epi32(a, b);
+#else
+        SIMD_FALLBACK(u32x4, a.lane[i] - b.lane[i])
+#endif
+    }
+
+    // Multiplies and keeps the low 32 bits of each lane.
+    inline u32x4 mulInt(u32x4 a, u32x4 b)
+    {
+#if MATH_SIMD_SSE2
+        // SSE2 has no 32-bit multiply, so multiply the even and odd lanes as 64-bit values and interleave.
+        __m128i even = _mm_mul_epu32(a, b);
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+        return _mm_unpacklo_epi32(
+            _mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+            _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#else
+        SIMD_FALLBACK(u32x4, a.lane[i] * b.lane[i])
+#endif
+    }
+
+    template <s32 Bits>
+    u32x4 shiftLeft(u32x4 value)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_slli_epi32(value, Bits);
+#else
+        SIMD_FALLBACK(u32x4, value.lane[i] << Bits)
+#endif
+    }
+
+    // Logical (zero-filling) shift.
+    template <s32 Bits>
+    u32x4 shiftRight(u32x4 value)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_srli_epi32(value, Bits);
+#else
+        SIMD_FALLBACK(u32x4, value.lane[i] >> Bits)
+#endif
+    }
+
+    // === Comparison ===
+
+    inline f32x4 lessThan(f32x4 a, f32x4 b)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_cmplt_ps(a, b);
+#else
+        SIMD_FALLBACK(f32x4, std::bit_cast<f32>(a.lane[i] < b.lane[i] ? 0xFFFFFFFFu : 0u))
+#endif
+    }
+
+    inline f32x4 lessEqual(f32x4 a, f32x4 b)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_cmple_ps(a, b);
+#else
+        SIMD_FALLBACK(f32x4, std::bit_cast<f32>(a.lane[i] <= b.lane[i] ? 0xFFFFFFFFu : 0u))
+#endif
+    }
+
+    inline f32x4 greaterThan(f32x4 a, f32x4 b)
+    {
+        return lessThan(b, a);
+    }
+
+    inline f32x4 greaterEqual(f32x4 a, f32x4 b)
+    {
+        return lessEqual(b, a);
+    }
+
+    // Packs the top bit of each lane into the low 4 bits of an integer, lane 0 = bit 0.
+    inline s32 moveMask(f32x4 mask)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_movemask_ps(mask);
+#else
+        s32 result {};
+
+        for (s32 i = 0; i < WIDTH; i++)
+            result |= static_cast<s32>(std::bit_cast<u32>(mask.lane[i]) >> 31) << i;
+
+        return result;
+#endif
+    }
+
+    // === Bitwise ===
+
+    inline f32x4 bitAnd(f32x4 a, f32x4 b)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_and_ps(a, b);
+#else
+        SIMD_FALLBACK(f32x4, std::bit_cast<f32>(std::bit_cast<u32>(a.lane[i]) & std::bit_cast<u32>(b.lane[i])))
+#endif
+    }
+
+    inline f32x4 bitOr(f32x4 a, f32x4 b)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_or_ps(a, b);
+#else
+        SIMD_FALLBACK(f32x4, std::bit_cast<f32>(std::bit_cast<u32>(a.lane[i]) | std::bit_cast<u32>(b.lane[i])))
+#endif
+    }
+
+    inline f32x4 bitXor(f32x4 a, f32x4 b)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_xor_ps(a, b);
+#else
+        SIMD_FALLBACK(f32x4, std::bit_cast<f32>(std::bit_cast<u32>(a.lane[i]) ^ std::bit_cast<u32>(b.lane[i])))
+#endif
+    }
+
+    // Computes (~a & b), matching the SSE instruction.
+    inline f32x4 bitAndNot(f32x4 a, f32x4 b)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_andnot_ps(a, b);
+#else
+        SIMD_FALLBACK(f32x4, std::bit_cast<f32>(~std::bit_cast<u32>(a.lane[i]) & std::bit_cast<u32>(b.lane[i])))
+#endif
+    }
+
+    inline u32x4 bitAnd(u32x4 a, u32x4 b)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_and_si128(a, b);
+#else
+        SIMD_FALLBACK(u32x4, a.lane[i] & b.lane[i])
+#endif
+    }
+
+    inline u32x4 bitOr(u32x4 a, u32x4 b)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_or_si128(a, b);
+#else
+        SIMD_FALLBACK(u32x4, a.lane[i] | b.lane[i])
+#endif
+    }
+
+    inline u32x4 bitXor(u32x4 a, u32x4 b)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_xor_si128(a, b);
+#else
+        SIMD_FALLBACK(u32x4, a.lane[i] ^ b.lane[i])
+#endif
+    }
+
+    template <s32 Bits>
+    u32x4 rotateLeft(u32x4 value)
+    {
+        return bitOr(shiftLeft<Bits>(value), shiftRight<32 - Bits>(value));
+    }
+
+    // Picks lanes from "whenTrue" where the mask is set, and from "whenFalse" otherwise.
+    inline f32x4 select(f32x4 mask, f32x4 whenTrue, f32x4 whenFalse)
+    {
+        return bitOr(bitAnd(mask, whenTrue), bitAndNot(mask, whenFalse));
+    }
+
+    inline f32x4 abs(f32x4 value)
+    {
+        return bitAndNot(set(-0.0f), value);
+    }
+
+    inline f32x4 negate(f32x4 value)
+    {
+        return bitXor(set(-0.0f), value);
+    }
+
+    // === Conversion ===
+
+    // Reinterprets the bits of each lane, no conversion happens.
+    inline u32x4 asInt(f32x4 value)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_castps_si128(value);
+#else
+        SIMD_FALLBACK(u32x4, std::bit_cast<u32>(value.lane[i]))
+#endif
+    }
+
+    // Reinterprets the bits of each lane, no conversion happens.
+    inline f32x4 asFloat(u32x4 value)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_castsi128_ps(value);
+#else
+        SIMD_FALLBACK(f32x4, std::bit_cast<f32>(value.lane[i]))
+#endif
+    }
+
+    // Converts each lane to a signed integer, rounding towards zero.
+    inline u32x4 toInt(f32x4 value)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_cvttps_epi32(value);
+#else
+        SIMD_FALLBACK(u32x4, static_cast<u32>(static_cast<s32>(value.lane[i])))
+#endif
+    }
+
+    // Converts each lane from a signed integer.
+    inline f32x4 toFloat(u32x4 value)
+    {
+#if MATH_SIMD_SSE2
+        return _mm_cvtepi32_ps(value);
+#else
+        SIMD_FALLBACK(f32x4, static_cast<f32>(static_cast<s32>(value.lane[i])))
+#endif
+    }
+
+    // Rounds each lane towards negative infinity. Only valid for magnitudes below 2^31.
+    inline f32x4 floor(f32x4 value)
+    {
+        f32x4 truncated = toFloat(toInt(value));
+        f32x4 correction = bitAnd(greaterThan(truncated, value), set(1.0f));
+        return sub(truncated, correction);
+    }
+
+#undef SIMD_FALLBACK
+
+} // namespace Math::simd
+
+#endif // SIMD_H
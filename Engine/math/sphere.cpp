@@ -0,0 +1,20 @@
+﻿#include "sphere.hpp"
+#include "aabb.hpp"
+
+// === Lifetime ===
+Sphere Sphere::fromAabb(const Aabb& box)
+{
+    return Sphere{box.center(), box.extents().magnitude()};
+}
+
+// === Queries ===
+bool Sphere::contains(Vec3 point) const
+{
+    return (point - center).magnitudeSqr() <= radius * radius;
+}
+
+bool Sphere::intersects(const Sphere& other) const
+{
+    f32 radii = radius + other.radius;
+    return (other.center - center).magnitudeSqr() <= radii * radii;
+}
@@ -0,0 +1,25 @@
+﻿#ifndef SPHERE_H
+#define SPHERE_H
+
+#include "../types.hpp"
+#include "vec3.hpp"
+
+struct Aabb;
+
+/**
+ * \brief A bounding sphere. Cheaper to test than an Aabb, but usually a looser fit.
+ */
+struct Sphere
+{
+    Vec3 center;
+    f32 radius;
+
+    // === Lifetime ===
+    static Sphere fromAabb(const Aabb& box);
+
+    // === Queries ===
+    bool contains(Vec3 point) const;
+    bool intersects(const Sphere& other) const;
+};
+
+#endif // SPHERE_H
@@ -1,9 +1,14 @@
 ﻿#ifndef VECTOR_H
 #define VECTOR_H
 
+#include "../config.hpp"
 #include "../types.hpp"
 #include "math_util.hpp"
 
+#ifdef MATH_FAST_SQRT
+#include "fast_math.hpp"
+#endif
+
 /**
  * \brief A templated base for vectors, allowing types and sizes to be swapped
  * without duplicate code.
@@ -21,7 +26,11 @@ struct VectorBase
      */
     f32 magnitude() const
     {
+#ifdef MATH_FAST_SQRT
+        return Math::fast::sqrt(magnitudeSqr());
+#else
         return sqrt(magnitudeSqr());
+#endif
     }
 
     /**
@@ -43,6 +52,18 @@ struct VectorBase
      */
     void normalize()
     {
+#ifdef MATH_FAST_SQRT
+        // Same cutoff as below (magnitude nearly 0), compared before taking the root.
+        f32 sqr = magnitudeSqr();
+
+        if (sqr > 0.00001f * 0.00001f)
+        {
+            f32 inverse = Math::fast::rsqrt(sqr);
+
+            for (u8f i = 0; i < Length; i++)
+                (*this)[i] *= inverse;
+        }
+#else
         f32 m = magnitude();
 
         if (!Math::nearlyEqual(m, 0))
@@ -50,6 +71,7 @@ struct VectorBase
             for (u8f i = 0; i < Length; i++)
                 (*this)[i] /= m;
         }
+#endif
     }
 
     /**
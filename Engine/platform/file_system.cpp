@@ -0,0 +1,37 @@
+﻿#include "platform/file_system.hpp"
+#include "platform/pooled_read_queue.hpp"
+
+using namespace FileSystem;
+
+void File::queueRead(void* destination, size_t count, u64 offset, u64 userData)
+{
+    getReadQueue().queue(destination, count, offset, userData);
+}
+
+void File::submitReads()
+{
+    getReadQueue().submit();
+}
+
+u32 File::completeReads(std::span<ReadCompletion> completions, bool wait)
+{
+    return getReadQueue().complete(completions, wait);
+}
+
+bool File::registerBuffers(std::span<const std::span<u8>> buffers)
+{
+    return getReadQueue().registerBuffers(buffers);
+}
+
+std::unique_ptr<ReadQueue> File::createReadQueue()
+{
+    return std::make_unique<PooledReadQueue>(this);
+}
+
+ReadQueue& File::getReadQueue()
+{
+    if (m_readQueue == nullptr)
+        m_readQueue = createReadQueue();
+
+    return *m_readQueue;
+}
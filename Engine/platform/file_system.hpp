@@ -2,7 +2,11 @@
 #define FILE_SYSTEM_HPP
 
 #include <climits>
+#include <cstddef>
+#include <memory>
+#include <span>
 #include "enum_flags.hpp"
+#include "types.hpp"
 
 namespace FileSystem
 {
@@ -15,6 +19,45 @@ namespace FileSystem
         Write = 1 << 1,
     };
 
+    // How a file is about to be read, so the OS can tune its read-ahead. Only ever a hint.
+    enum class AccessHint
+    {
+        Normal,
+        // Front to back, so read further ahead.
+        Sequential,
+        // All over the place, so don't read ahead at all.
+        Random,
+        // This range will be read soon, so start reading it in the background now.
+        WillNeed,
+    };
+
+    // An asynchronous read (see File::queueRead(...)) that has finished.
+    struct ReadCompletion
+    {
+        // Whatever was passed to queueRead(...).
+        u64 userData;
+        bool succeeded;
+    };
+
+    /**
+     * \brief What runs a file's asynchronous reads. Each platform picks the best one it has, see File::createReadQueue().
+     * \details Used from one thread at a time.
+     */
+    class ReadQueue
+    {
+    public:
+        virtual ~ReadQueue() = default;
+
+        virtual void queue(void* destination, size_t count, u64 offset, u64 userData) = 0;
+        virtual void submit() = 0;
+        virtual u32 complete(std::span<ReadCompletion> completions, bool wait) = 0;
+
+        virtual bool registerBuffers([[maybe_unused]] std::span<const std::span<u8>> buffers)
+        {
+            return false;
+        }
+    };
+
     class File
     {
     public:
@@ -22,11 +65,103 @@ namespace FileSystem
 
         virtual void read(void* destination, size_t count) = 0;
         virtual void seek(size_t offset) = 0;
+
+        /**
+         * \brief Reads from an offset, without using or moving the cursor of read() and seek().
+         * \details Safe to call from several threads at once.
+         * \return False (and logs why) unless all of it was read.
+         */
+        virtual bool readAt(void* destination, size_t count, u64 offset) = 0;
+
+        /**
+         * \brief Like readAt(), but the data is spread over several buffers in order.
+         * \details Lets one large read land straight in the buffers that keep the data, instead of being copied
+         * out of a staging buffer.
+         */
+        virtual bool readAtScattered(std::span<const std::span<u8>> destinations, u64 offset) = 0;
+
+        /**
+         * \brief Tells the OS how part of the file is about to be read.
+         * \param length Zero means up to the end of the file.
+         */
+        virtual void adviseAccess(AccessHint hint, u64 offset = 0, u64 length = 0) = 0;
+
+        virtual u64 size() const = 0;
+
+        // Reads that are still in flight must be completed first.
         virtual void close() = 0;
+
+        // === Asynchronous reads ===
+        // Unlike readAt(), these are used from one thread at a time, which collects every completion.
+
+        /**
+         * \brief Queues a read, which must not be touched until it completes.
+         * \details Nothing starts until submitReads(), so many reads can be started at once (with one system call,
+         * where the platform allows it).
+         * \param userData Handed back with the completion, to tell reads apart.
+         */
+        void queueRead(void* destination, size_t count, u64 offset, u64 userData);
+
+        // Starts every queued read.
+        void submitReads();
+
+        /**
+         * \brief Collects reads that have finished, without blocking unless asked to.
+         * \param wait Blocks until at least one read finishes, unless none are in flight.
+         * \return How many completions were written.
+         */
+        u32 completeReads(std::span<ReadCompletion> completions, bool wait = false);
+
+        /**
+         * \brief Registers buffers that reads will be made into, so they don't have to be mapped for every read.
+         * \details Optional. Replaces the buffers registered before, and must not be called with reads in flight.
+         * \return False if the platform has no use for them. Reads work either way.
+         */
+        bool registerBuffers(std::span<const std::span<u8>> buffers);
+
+    protected:
+        // Called the first time a read is queued. Defaults to a PooledReadQueue.
+        virtual std::unique_ptr<ReadQueue> createReadQueue();
+
+    private:
+        ReadQueue& getReadQueue();
+
+        std::unique_ptr<ReadQueue> m_readQueue {};
     };
 
+    /**
+     * \brief Opens a file. With FileAccess::Write it is created, or emptied if it exists.
+     * \return The file, or nullptr (and logs why) if it can't be opened.
+     */
     File* openFile(const char* fileName, FileAccess access = FileAccess::Read | FileAccess::Write);
 
+    /**
+     * \brief A read-only view of a whole file in memory.
+     * \details Nothing is read up front: the OS pages the file in as it is touched, and can drop
+     * those pages again under memory pressure, so resident memory only tracks what is used.
+     */
+    class MappedFile
+    {
+    public:
+        virtual ~MappedFile() = default;
+
+        virtual const u8* data() const = 0;
+        virtual size_t size() const = 0;
+
+        /**
+         * \brief Tells the OS how part of the mapping is about to be touched, like File::adviseAccess(...).
+         * \details With AccessHint::WillNeed, the pages start being read in the background, so touching them
+         * later doesn't fault on the disk.
+         * \param length Zero means up to the end of the file.
+         */
+        virtual void adviseAccess(AccessHint hint, u64 offset = 0, u64 length = 0) const = 0;
+
+        virtual void close() = 0;
+    };
+
+    // Maps a whole file for reading. Returns nullptr (and logs why) if it can't be mapped.
+    MappedFile* mapFile(const char* fileName);
+
 } // namespace FileSystem
 
 #endif // FILE_SYSTEM_HPP
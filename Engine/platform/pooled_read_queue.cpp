@@ -0,0 +1,59 @@
+﻿#include <algorithm>
+#include "platform/pooled_read_queue.hpp"
+#include "thread_pool.hpp"
+
+using namespace FileSystem;
+
+PooledReadQueue::PooledReadQueue(File* file) : m_file{file}
+{
+}
+
+PooledReadQueue::~PooledReadQueue()
+{
+    std::unique_lock lock {m_mutex};
+    m_readFinished.wait(lock, [this] { return m_inFlight == 0; });
+}
+
+void PooledReadQueue::queue(void* destination, size_t count, u64 offset, u64 userData)
+{
+    m_queued.push_back({destination, count, offset, userData});
+}
+
+void PooledReadQueue::submit()
+{
+    static ThreadPool s_pool {THREAD_COUNT};
+
+    {
+        std::scoped_lock lock {m_mutex};
+        m_inFlight += static_cast<u32>(m_queued.size());
+    }
+
+    for (const Read& read : m_queued)
+    {
+        s_pool.submit([this, read]
+        {
+            bool succeeded {m_file->readAt(read.destination, read.count, read.offset)};
+
+            // Notified under the lock, since the destructor may run as soon as it is released.
+            std::scoped_lock lock {m_mutex};
+            m_completed.push_back({read.userData, succeeded});
+            m_inFlight--;
+            m_readFinished.notify_all();
+        });
+    }
+
+    m_queued.clear();
+}
+
+u32 PooledReadQueue::complete(std::span<ReadCompletion> completions, bool wait)
+{
+    std::unique_lock lock {m_mutex};
+
+    if (wait)
+        m_readFinished.wait(lock, [this] { return !m_completed.empty() || m_inFlight == 0; });
+
+    u32 count {static_cast<u32>(std::min(completions.size(), m_completed.size()))};
+    std::copy_n(m_completed.begin(), count, completions.begin());
+    m_completed.erase(m_completed.begin(), m_completed.begin() + count);
+    return count;
+}
@@ -0,0 +1,51 @@
+﻿#ifndef POOLED_READ_QUEUE_HPP
+#define POOLED_READ_QUEUE_HPP
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include "platform/file_system.hpp"
+
+namespace FileSystem
+{
+    /**
+     * \brief Runs asynchronous reads as blocking File::readAt() calls on a shared thread pool.
+     * \details Works everywhere, but ties up a thread per read in flight. Platforms fall back to it
+     * when they have no real asynchronous I/O.
+     */
+    class PooledReadQueue final : public ReadQueue
+    {
+    public:
+        explicit PooledReadQueue(File* file);
+
+        // Waits for every read in flight, since they point back here.
+        ~PooledReadQueue() override;
+
+        void queue(void* destination, size_t count, u64 offset, u64 userData) override;
+        void submit() override;
+        u32 complete(std::span<ReadCompletion> completions, bool wait) override;
+
+    private:
+        struct Read
+        {
+            void* destination;
+            size_t count;
+            u64 offset;
+            u64 userData;
+        };
+
+        // How many reads can block at once, across every file.
+        static constexpr u32 THREAD_COUNT {4};
+
+        File* m_file;
+        std::vector<Read> m_queued {};
+
+        // Guards everything below, which the pool's threads touch.
+        std::mutex m_mutex {};
+        std::condition_variable m_readFinished {};
+        std::vector<ReadCompletion> m_completed {};
+        u32 m_inFlight {};
+    };
+} // namespace FileSystem
+
+#endif // POOLED_READ_QUEUE_HPP
@@ -0,0 +1,314 @@
+﻿#ifdef __linux__
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "logger.hpp"
+#include "platform/posix/io_uring_read_queue.hpp"
+
+using namespace FileSystem;
+
+namespace
+{
+    int ioUringSetup(u32 entries, io_uring_params* params)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int ioUringEnter(int ring, u32 toSubmit, u32 minimumComplete, u32 flags)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_enter, ring, toSubmit, minimumComplete, flags, nullptr, 0));
+    }
+
+    int ioUringRegister(int ring, u32 opcode, const void* arguments, u32 count)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_register, ring, opcode, arguments, count));
+    }
+
+    // The rings are shared with the kernel, so their heads and tails are read and written atomically.
+    u32 loadAcquire(u32* value)
+    {
+        return std::atomic_ref<u32>{*value}.load(std::memory_order_acquire);
+    }
+
+    void storeRelease(u32* value, u32 newValue)
+    {
+        std::atomic_ref<u32>{*value}.store(newValue, std::memory_order_release);
+    }
+}
+
+std::unique_ptr<IoUringReadQueue> IoUringReadQueue::create(int fileDescriptor, const char* fileName)
+{
+    io_uring_params params {};
+    int ring {ioUringSetup(RING_SIZE, &params)};
+
+    if (ring < 0)
+    {
+        LOG_INFO(Logger::Channel::General, "POSIX: io_uring is not available ({}), so reads from {} fall back to a thread pool.",
+            strerror(errno), fileName);
+        return nullptr;
+    }
+
+    // Older kernels map the two rings separately, which isn't worth supporting.
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) == 0)
+    {
+        LOG_INFO(Logger::Channel::General, "POSIX: io_uring is too old, so reads from {} fall back to a thread pool.", fileName);
+        ::close(ring);
+        return nullptr;
+    }
+
+    std::unique_ptr<IoUringReadQueue> queue {new IoUringReadQueue{ring, fileDescriptor, fileName, params}};
+
+    if (queue->m_ringMemory == nullptr || queue->m_submissions == nullptr)
+    {
+        LOG_INFO(Logger::Channel::General, "POSIX: Failed to map the io_uring rings ({}), so reads from {} fall back to a thread pool.",
+            strerror(errno), fileName);
+        return nullptr;
+    }
+
+    return queue;
+}
+
+IoUringReadQueue::IoUringReadQueue(int ring, int fileDescriptor, const char* fileName, const io_uring_params& params)
+    : m_ring{ring}, m_fileDescriptor{fileDescriptor}, m_fileName{fileName}
+{
+    m_ringMemorySize = std::max(params.sq_off.array + params.sq_entries * sizeof(u32), params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    void* ringMemory {mmap(nullptr, m_ringMemorySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING)};
+    m_submissionsSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* submissions {mmap(nullptr, m_submissionsSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQES)};
+
+    if (ringMemory != MAP_FAILED)
+        m_ringMemory = ringMemory;
+
+    if (submissions != MAP_FAILED)
+        m_submissions = static_cast<io_uring_sqe*>(submissions);
+
+    if (m_ringMemory == nullptr || m_submissions == nullptr)
+        return;
+
+    u8* memory {static_cast<u8*>(m_ringMemory)};
+    m_submissionHead = reinterpret_cast<u32*>(memory + params.sq_off.head);
+    m_submissionTail = reinterpret_cast<u32*>(memory + params.sq_off.tail);
+    m_submissionMask = *reinterpret_cast<u32*>(memory + params.sq_off.ring_mask);
+    m_submissionArray = reinterpret_cast<u32*>(memory + params.sq_off.array);
+    m_completionHead = reinterpret_cast<u32*>(memory + params.cq_off.head);
+    m_completionTail = reinterpret_cast<u32*>(memory + params.cq_off.tail);
+    m_completionMask = *reinterpret_cast<u32*>(memory + params.cq_off.ring_mask);
+    m_completions = reinterpret_cast<io_uring_cqe*>(memory + params.cq_off.cqes);
+}
+
+IoUringReadQueue::~IoUringReadQueue()
+{
+    ReadCompletion completions[RING_SIZE] {};
+
+    // Reads that were only queued never reach the kernel.
+    m_waiting.clear();
+
+    while (m_ringMemory != nullptr && m_submissions != nullptr && (m_inFlight > 0 || m_unsubmitted > 0))
+        complete(completions, true);
+
+    if (m_submissions != nullptr)
+        munmap(m_submissions, m_submissionsSize);
+
+    if (m_ringMemory != nullptr)
+        munmap(m_ringMemory, m_ringMemorySize);
+
+    ::close(m_ring);
+}
+
+void IoUringReadQueue::queue(void* destination, size_t count, u64 offset, u64 userData)
+{
+    u32 slot {static_cast<u32>(m_reads.size())};
+
+    if (m_freeSlots.empty())
+        m_reads.push_back({static_cast<u8*>(destination), count, offset, userData});
+    else
+    {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        m_reads[slot] = {static_cast<u8*>(destination), count, offset, userData};
+    }
+
+    m_waiting.push_back(slot);
+}
+
+void IoUringReadQueue::fillRing()
+{
+    u32 tail {*m_submissionTail};
+
+    // Never more in flight than there is room for completions.
+    while (!m_waiting.empty() && m_unsubmitted + m_inFlight < RING_SIZE)
+    {
+        u32 slot {m_waiting.front()};
+        m_waiting.pop_front();
+        const Read& read {m_reads[slot]};
+        u32 length {static_cast<u32>(std::min<size_t>(read.remaining, MAX_READ))};
+        s32 bufferIndex {findRegisteredBuffer(read.destination, length)};
+
+        u32 index {tail & m_submissionMask};
+        io_uring_sqe& submission {m_submissions[index]};
+        submission = {};
+        submission.opcode = bufferIndex >= 0 ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        submission.fd = m_fileDescriptor;
+        submission.off = read.offset;
+        submission.addr = reinterpret_cast<u64>(read.destination);
+        submission.len = length;
+        submission.buf_index = static_cast<u16>(std::max(bufferIndex, 0));
+        submission.user_data = slot;
+
+        m_submissionArray[index] = index;
+        tail++;
+        m_unsubmitted++;
+    }
+
+    storeRelease(m_submissionTail, tail);
+}
+
+void IoUringReadQueue::submit()
+{
+    fillRing();
+
+    if (m_unsubmitted == 0)
+        return;
+
+    int submitted {ioUringEnter(m_ring, m_unsubmitted, 0, 0)};
+
+    // Busy or interrupted: the entries stay in the ring, and go with the next submit.
+    if (submitted < 0)
+    {
+        if (errno != EAGAIN && errno != EBUSY && errno != EINTR)
+            LOG_ERROR(Logger::Channel::General, "POSIX: Failed to submit reads from {}. Reason: {}", m_fileName, strerror(errno));
+
+        return;
+    }
+
+    m_unsubmitted -= static_cast<u32>(submitted);
+    m_inFlight += static_cast<u32>(submitted);
+}
+
+u32 IoUringReadQueue::complete(std::span<ReadCompletion> completions, bool wait)
+{
+    u32 count {};
+
+    while (count < completions.size())
+    {
+        u32 head {*m_completionHead};
+        u32 tail {loadAcquire(m_completionTail)};
+
+        if (head == tail)
+        {
+            bool pending {m_inFlight > 0 || m_unsubmitted > 0 || !m_waiting.empty()};
+
+            if (!wait || count > 0 || !pending)
+                break;
+
+            // Submits whatever is left, and sleeps until something completes.
+            fillRing();
+            int submitted {ioUringEnter(m_ring, m_unsubmitted, 1, IORING_ENTER_GETEVENTS)};
+
+            if (submitted < 0 && errno != EAGAIN && errno != EBUSY && errno != EINTR)
+            {
+                LOG_ERROR(Logger::Channel::General, "POSIX: Failed to wait for reads from {}. Reason: {}", m_fileName, strerror(errno));
+                break;
+            }
+
+            if (submitted > 0)
+            {
+                m_unsubmitted -= static_cast<u32>(submitted);
+                m_inFlight += static_cast<u32>(submitted);
+            }
+
+            continue;
+        }
+
+        for (; head != tail && count < completions.size(); head++)
+        {
+            const io_uring_cqe& completion {m_completions[head & m_completionMask]};
+            u32 slot {static_cast<u32>(completion.user_data)};
+            Read& read {m_reads[slot]};
+            m_inFlight--;
+
+            if (completion.res == -EAGAIN || completion.res == -EINTR)
+            {
+                m_waiting.push_front(slot);
+                continue;
+            }
+
+            if (completion.res > 0 && static_cast<size_t>(completion.res) < read.remaining)
+            {
+                // A short read, so go again for the rest.
+                read.destination += completion.res;
+                read.offset += static_cast<u64>(completion.res);
+                read.remaining -= static_cast<size_t>(completion.res);
+                m_waiting.push_front(slot);
+                continue;
+            }
+
+            bool succeeded {completion.res >= 0 && static_cast<size_t>(completion.res) == read.remaining};
+
+            if (!succeeded)
+            {
+                LOG_ERROR(Logger::Channel::General, "POSIX: Failed to read {} bytes at {} from {}. Reason: {}",
+                    read.remaining, read.offset, m_fileName, completion.res < 0 ? strerror(-completion.res) : "end of file");
+            }
+
+            completions[count++] = {read.userData, succeeded};
+            m_freeSlots.push_back(slot);
+        }
+
+        storeRelease(m_completionHead, head);
+    }
+
+    // Room was made for reads that are still waiting.
+    if (!m_waiting.empty())
+        submit();
+
+    return count;
+}
+
+bool IoUringReadQueue::registerBuffers(std::span<const std::span<u8>> buffers)
+{
+    if (!m_registeredBuffers.empty())
+    {
+        ioUringRegister(m_ring, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+        m_registeredBuffers.clear();
+    }
+
+    if (buffers.empty())
+        return true;
+
+    std::vector<iovec> vectors {};
+
+    for (std::span<u8> buffer : buffers)
+        vectors.push_back({buffer.data(), buffer.size()});
+
+    if (ioUringRegister(m_ring, IORING_REGISTER_BUFFERS, vectors.data(), static_cast<u32>(vectors.size())) < 0)
+    {
+        LOG_WARNING(Logger::Channel::General, "POSIX: Failed to register {} buffers for reads from {}. Reason: {}",
+            buffers.size(), m_fileName, strerror(errno));
+        return false;
+    }
+
+    m_registeredBuffers.assign(buffers.begin(), buffers.end());
+    return true;
+}
+
+s32 IoUringReadQueue::findRegisteredBuffer(const u8* destination, size_t count) const
+{
+    for (size_t i = 0; i < m_registeredBuffers.size(); i++)
+    {
+        const u8* start {m_registeredBuffers[i].data()};
+
+        if (destination >= start && destination + count <= start + m_registeredBuffers[i].size())
+            return static_cast<s32>(i);
+    }
+
+    return -1;
+}
+
+#endif // __linux__
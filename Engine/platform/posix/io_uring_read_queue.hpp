@@ -0,0 +1,91 @@
+﻿#ifndef IO_URING_READ_QUEUE_HPP
+#define IO_URING_READ_QUEUE_HPP
+
+#ifdef __linux__
+
+#include <deque>
+#include <memory>
+#include <vector>
+#include <linux/io_uring.h>
+#include "platform/file_system.hpp"
+
+namespace FileSystem
+{
+    /**
+     * \brief Runs asynchronous reads with io_uring, so no thread blocks on them.
+     * \details Talks to the kernel directly (no liburing). Queued reads are written into the submission ring, and
+     * submit() starts all of them with a single io_uring_enter. Completions are polled from the completion ring,
+     * which costs no system call at all unless there is nothing there yet and wait is set.
+     * Reads into registered buffers use IORING_OP_READ_FIXED, which skips mapping the pages for every read.
+     */
+    class IoUringReadQueue final : public ReadQueue
+    {
+    public:
+        // Returns nullptr (and logs why) when io_uring isn't available, like on old kernels or in some containers.
+        static std::unique_ptr<IoUringReadQueue> create(int fileDescriptor, const char* fileName);
+
+        // Waits for every read in flight, since the kernel still writes into their buffers.
+        ~IoUringReadQueue() override;
+
+        void queue(void* destination, size_t count, u64 offset, u64 userData) override;
+        void submit() override;
+        u32 complete(std::span<ReadCompletion> completions, bool wait) override;
+        bool registerBuffers(std::span<const std::span<u8>> buffers) override;
+
+    private:
+        // A read, which may take several trips through the ring when the kernel reads less than was asked.
+        struct Read
+        {
+            u8* destination;
+            size_t remaining;
+            u64 offset;
+            u64 userData;
+        };
+
+        // Submission ring entries. Twice as many completions fit, so the completion ring can't overflow.
+        static constexpr u32 RING_SIZE {256};
+        // The most a single read asks the kernel for, since lengths are 32 bit.
+        static constexpr u32 MAX_READ {1u << 30};
+
+        IoUringReadQueue(int ring, int fileDescriptor, const char* fileName, const io_uring_params& params);
+
+        // Moves as many waiting reads as fit into the submission ring.
+        void fillRing();
+        // Finds the registered buffer a read lies in, or -1.
+        s32 findRegisteredBuffer(const u8* destination, size_t count) const;
+
+        int m_ring;
+        int m_fileDescriptor;
+        const char* m_fileName;
+
+        void* m_ringMemory {};
+        size_t m_ringMemorySize {};
+        io_uring_sqe* m_submissions {};
+        size_t m_submissionsSize {};
+
+        u32* m_submissionHead {};
+        u32* m_submissionTail {};
+        u32 m_submissionMask {};
+        u32* m_submissionArray {};
+        u32* m_completionHead {};
+        u32* m_completionTail {};
+        u32 m_completionMask {};
+        io_uring_cqe* m_completions {};
+
+        // Reads by slot, which is what travels through the ring as user data.
+        std::vector<Read> m_reads {};
+        std::vector<u32> m_freeSlots {};
+        // Slots of reads that are queued, but not in the submission ring yet.
+        std::deque<u32> m_waiting {};
+        // Entries written into the submission ring, but not yet taken by the kernel.
+        u32 m_unsubmitted {};
+        // Entries the kernel has taken, but not completed.
+        u32 m_inFlight {};
+
+        std::vector<std::span<u8>> m_registeredBuffers {};
+    };
+} // namespace FileSystem
+
+#endif // __linux__
+
+#endif // IO_URING_READ_QUEUE_HPP
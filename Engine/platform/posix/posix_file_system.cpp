@@ -0,0 +1,307 @@
+﻿#if defined(__unix__) || defined(__APPLE__)
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "logger.hpp"
+#include "platform/file_system.hpp"
+#include "platform/posix/io_uring_read_queue.hpp"
+
+using namespace FileSystem;
+
+class PosixFile final : public File
+{
+public:
+    PosixFile(const char* fileName, int descriptor) : m_descriptor{descriptor}, m_fileName{fileName}
+    {
+    }
+
+    void read(void* destination, size_t count) override
+    {
+        u8* output {static_cast<u8*>(destination)};
+
+        while (count > 0)
+        {
+            ssize_t result {::read(m_descriptor, output, count)};
+
+            if (result < 0 && errno == EINTR)
+                continue;
+
+            if (result <= 0)
+            {
+                LOG_ERROR(Logger::Channel::General, "POSIX: Failed to read {} bytes from {}. Reason: {}",
+                    count, m_fileName, result == 0 ? "end of file" : strerror(errno));
+                return;
+            }
+
+            output += result;
+            count -= static_cast<size_t>(result);
+        }
+    }
+
+    void seek(size_t offset) override
+    {
+        if (lseek(m_descriptor, static_cast<off_t>(offset), SEEK_SET) < 0)
+            LOG_ERROR(Logger::Channel::General, "POSIX: Failed to seek offset {}. Reason: {}", offset, strerror(errno));
+    }
+
+    bool readAt(void* destination, size_t count, u64 offset) override
+    {
+        u8* output {static_cast<u8*>(destination)};
+
+        // pread can return less than was asked for, so keep going until it is all there.
+        while (count > 0)
+        {
+            ssize_t result {pread(m_descriptor, output, count, static_cast<off_t>(offset))};
+
+            if (result < 0 && errno == EINTR)
+                continue;
+
+            if (result <= 0)
+            {
+                LOG_ERROR(Logger::Channel::General, "POSIX: Failed to read {} bytes at {} from {}. Reason: {}",
+                    count, offset, m_fileName, result == 0 ? "end of file" : strerror(errno));
+                return false;
+            }
+
+            output += result;
+            offset += static_cast<u64>(result);
+            count -= static_cast<size_t>(result);
+        }
+
+        return true;
+    }
+
+    bool readAtScattered(std::span<const std::span<u8>> destinations, u64 offset) override
+    {
+        std::vector<iovec> vectors {};
+
+        for (std::span<u8> destination : destinations)
+        {
+            if (!destination.empty())
+                vectors.push_back({destination.data(), destination.size()});
+        }
+
+        size_t first {};
+
+        while (first < vectors.size())
+        {
+            int count {static_cast<int>(std::min<size_t>(vectors.size() - first, IOV_MAX))};
+            ssize_t result {preadv(m_descriptor, &vectors[first], count, static_cast<off_t>(offset))};
+
+            if (result < 0 && errno == EINTR)
+                continue;
+
+            if (result <= 0)
+            {
+                LOG_ERROR(Logger::Channel::General, "POSIX: Failed to read {} buffers at {} from {}. Reason: {}",
+                    vectors.size() - first, offset, m_fileName, result == 0 ? "end of file" : strerror(errno));
+                return false;
+            }
+
+            offset += static_cast<u64>(result);
+
+            // Skip what was read, which may end partway through a buffer.
+            size_t remaining {static_cast<size_t>(result)};
+
+            for (; first < vectors.size() && remaining >= vectors[first].iov_len; first++)
+                remaining -= vectors[first].iov_len;
+
+            if (remaining > 0)
+            {
+                vectors[first].iov_base = static_cast<u8*>(vectors[first].iov_base) + remaining;
+                vectors[first].iov_len -= remaining;
+            }
+        }
+
+        return true;
+    }
+
+    void adviseAccess(AccessHint hint, u64 offset, u64 length) override
+    {
+#ifdef __APPLE__
+        // No posix_fadvise here, but read-ahead can be turned on and off, and ranges can be prefetched.
+        if (hint == AccessHint::WillNeed)
+        {
+            radvisory advisory {};
+            advisory.ra_offset = static_cast<off_t>(offset);
+            advisory.ra_count = static_cast<int>(std::min<u64>(length == 0 ? size() - offset : length, INT_MAX));
+            fcntl(m_descriptor, F_RDADVISE, &advisory);
+        }
+        else
+            fcntl(m_descriptor, F_RDAHEAD, hint == AccessHint::Random ? 0 : 1);
+#else
+        int advice {POSIX_FADV_NORMAL};
+
+        if (hint == AccessHint::Sequential)
+            advice = POSIX_FADV_SEQUENTIAL;
+        else if (hint == AccessHint::Random)
+            advice = POSIX_FADV_RANDOM;
+        else if (hint == AccessHint::WillNeed)
+        {
+#ifdef __linux__
+            // Starts reading right away, where WILLNEED may be put off or ignored.
+            if (readahead(m_descriptor, static_cast<off64_t>(offset), length == 0 ? size() - offset : length) == 0)
+                return;
+#endif // __linux__
+            advice = POSIX_FADV_WILLNEED;
+        }
+
+        // Only a hint, so failing is not worth logging.
+        posix_fadvise(m_descriptor, static_cast<off_t>(offset), static_cast<off_t>(length), advice);
+#endif // __APPLE__
+    }
+
+    u64 size() const override
+    {
+        struct stat status {};
+
+        if (fstat(m_descriptor, &status) != 0)
+        {
+            LOG_ERROR(Logger::Channel::General, "POSIX: Failed to get the size of {}. Reason: {}", m_fileName, strerror(errno));
+            return 0;
+        }
+
+        return static_cast<u64>(status.st_size);
+    }
+
+    void close() override
+    {
+        if (::close(m_descriptor) != 0)
+            LOG_ERROR(Logger::Channel::General, "POSIX: Failed to close file {}. Reason: {}", m_fileName, strerror(errno));
+    }
+
+protected:
+    std::unique_ptr<ReadQueue> createReadQueue() override
+    {
+#ifdef __linux__
+        if (std::unique_ptr<ReadQueue> queue = IoUringReadQueue::create(m_descriptor, m_fileName))
+            return queue;
+#endif // __linux__
+
+        return File::createReadQueue();
+    }
+
+private:
+    int m_descriptor {};
+    const char* m_fileName {};
+};
+
+File* FileSystem::openFile(const char* fileName, FileAccess access)
+{
+    bool reading {(access & FileAccess::Read) != FileAccess::None};
+    bool writing {(access & FileAccess::Write) != FileAccess::None};
+    int flags {O_CLOEXEC};
+
+    if (reading && writing)
+        flags |= O_RDWR;
+    else
+        flags |= writing ? O_WRONLY : O_RDONLY;
+
+    if (writing)
+        flags |= O_CREAT | O_TRUNC;
+
+    int descriptor {open(fileName, flags, 0644)};
+
+    if (descriptor < 0)
+    {
+        LOG_ERROR(Logger::Channel::General, "POSIX: Failed to open {}. Reason: {}", fileName, strerror(errno));
+        return nullptr;
+    }
+
+    return new PosixFile{fileName, descriptor};
+}
+
+class PosixMappedFile final : public MappedFile
+{
+public:
+    PosixMappedFile(const char* fileName, const u8* data, size_t size) : m_data{data}, m_size{size}, m_fileName{fileName}
+    {
+    }
+
+    const u8* data() const override
+    {
+        return m_data;
+    }
+
+    size_t size() const override
+    {
+        return m_size;
+    }
+
+    void adviseAccess(AccessHint hint, u64 offset, u64 length) const override
+    {
+        if (offset >= m_size)
+            return;
+
+        u64 end {length == 0 ? m_size : std::min<u64>(offset + length, m_size)};
+        // madvise() only takes whole pages.
+        u64 pageSize {static_cast<u64>(sysconf(_SC_PAGESIZE))};
+        u64 start {offset / pageSize * pageSize};
+        int advice {MADV_NORMAL};
+
+        if (hint == AccessHint::Sequential)
+            advice = MADV_SEQUENTIAL;
+        else if (hint == AccessHint::Random)
+            advice = MADV_RANDOM;
+        else if (hint == AccessHint::WillNeed)
+            advice = MADV_WILLNEED;
+
+        // Only a hint, so failing is not worth logging.
+        madvise(const_cast<u8*>(m_data) + start, end - start, advice);
+    }
+
+    void close() override
+    {
+        if (munmap(const_cast<u8*>(m_data), m_size) != 0)
+            LOG_ERROR(Logger::Channel::General, "POSIX: Failed to unmap file {}. Reason: {}", m_fileName, strerror(errno));
+    }
+
+private:
+    const u8* m_data {};
+    size_t m_size {};
+    const char* m_fileName {};
+};
+
+MappedFile* FileSystem::mapFile(const char* fileName)
+{
+    int descriptor {open(fileName, O_RDONLY | O_CLOEXEC)};
+
+    if (descriptor < 0)
+    {
+        LOG_ERROR(Logger::Channel::General, "POSIX: Failed to open {}. Reason: {}", fileName, strerror(errno));
+        return nullptr;
+    }
+
+    struct stat status {};
+
+    if (fstat(descriptor, &status) != 0 || status.st_size == 0)
+    {
+        LOG_ERROR(Logger::Channel::General, "POSIX: Failed to map {}, it is empty or its size is unknown.", fileName);
+        ::close(descriptor);
+        return nullptr;
+    }
+
+    size_t size {static_cast<size_t>(status.st_size)};
+    void* data {mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0)};
+
+    // The mapping keeps its own reference to the file.
+    ::close(descriptor);
+
+    if (data == MAP_FAILED)
+    {
+        LOG_ERROR(Logger::Channel::General, "POSIX: Failed to map {}. Reason: {}", fileName, strerror(errno));
+        return nullptr;
+    }
+
+    return new PosixMappedFile{fileName, static_cast<const u8*>(data), size};
+}
+
+#endif // defined(__unix__) || defined(__APPLE__)
@@ -15,53 +15,246 @@ public:
 
     void read(void* destination, size_t count) override
     {
-        if (ReadFile(m_fileHandle, destination, static_cast<int>(count), nullptr, nullptr) != TRUE)
-            Logger::log_error("WIN32: Failed to read {} bytes from {}. Reason: {}", count, m_fileName, getLastErrorAsString());
+        m_cursor += readOverlapped(destination, count, m_cursor);
     }
 
     void seek(size_t offset) override
     {
-        DWORD result = SetFilePointer(m_fileHandle, static_cast<int>(offset), nullptr, FILE_BEGIN);
+        // The handle is overlapped (see openFile()), so it has no cursor of its own to move.
+        m_cursor = offset;
+    }
 
-        if (result == INVALID_SET_FILE_POINTER && GetLastError() != NO_ERROR)
-            Logger::log_error("WIN32: Failed to seek offset {}. Reason: {}", offset, getLastErrorAsString());
+    bool readAt(void* destination, size_t count, u64 offset) override
+    {
+        return readOverlapped(destination, count, offset) == count;
+    }
+
+    bool readAtScattered(std::span<const std::span<u8>> destinations, u64 offset) override
+    {
+        // ReadFileScatter only works on unbuffered files, with whole pages.
+        for (std::span<u8> destination : destinations)
+        {
+            if (!readAt(destination.data(), destination.size(), offset))
+                return false;
+
+            offset += destination.size();
+        }
+
+        return true;
+    }
+
+    void adviseAccess(AccessHint, u64, u64) override
+    {
+        // Windows only takes access hints when a file is opened (FILE_FLAG_SEQUENTIAL_SCAN and FILE_FLAG_RANDOM_ACCESS),
+        // and its cache manager already detects sequential reads on its own.
+    }
+
+    u64 size() const override
+    {
+        LARGE_INTEGER size {};
+
+        if (GetFileSizeEx(m_fileHandle, &size) != TRUE)
+            LOG_ERROR(Logger::Channel::General, "WIN32: Failed to get the size of {}. Reason: {}", m_fileName, getLastErrorAsString());
+
+        return static_cast<u64>(size.QuadPart);
     }
 
     void close() override
     {
         if (CloseHandle(m_fileHandle) != TRUE)
-            Logger::log_error("WIN32: Failed to close file {}. Reason: {}", m_fileName, getLastErrorAsString());
+            LOG_ERROR(Logger::Channel::General, "WIN32: Failed to close file {}. Reason: {}", m_fileName, getLastErrorAsString());
     }
 
 private:
+    // Reads from an offset, and returns how much was read. Less than count (and logs why) if it failed.
+    size_t readOverlapped(void* destination, size_t count, u64 offset)
+    {
+        // Each read waits on an event of its own, so several threads can read at once.
+        HANDLE event {CreateEventA(nullptr, TRUE, FALSE, nullptr)};
+
+        if (event == nullptr)
+        {
+            LOG_ERROR(Logger::Channel::General, "WIN32: Failed to read {} bytes at {} from {}. Reason: {}",
+                count, offset, m_fileName, getLastErrorAsString());
+            return 0;
+        }
+
+        u8* output {static_cast<u8*>(destination)};
+        size_t total {};
+
+        // ReadFile takes at most a DWORD at a time.
+        while (total < count)
+        {
+            u64 position {offset + total};
+            OVERLAPPED overlapped {};
+            overlapped.Offset = static_cast<DWORD>(position);
+            overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+            overlapped.hEvent = event;
+            DWORD chunk {count - total > MAXDWORD ? MAXDWORD : static_cast<DWORD>(count - total)};
+            DWORD bytesRead {};
+
+            bool started {ReadFile(m_fileHandle, output + total, chunk, nullptr, &overlapped) == TRUE || GetLastError() == ERROR_IO_PENDING};
+
+            if (!started || GetOverlappedResult(m_fileHandle, &overlapped, &bytesRead, TRUE) != TRUE)
+            {
+                if (GetLastError() == ERROR_HANDLE_EOF)
+                    LOG_ERROR(Logger::Channel::General, "WIN32: Failed to read {} bytes at {} from {}. Reason: the file ends first.",
+                        count, offset, m_fileName);
+                else
+                    LOG_ERROR(Logger::Channel::General, "WIN32: Failed to read {} bytes at {} from {}. Reason: {}",
+                        count, offset, m_fileName, getLastErrorAsString());
+
+                break;
+            }
+
+            if (bytesRead == 0)
+            {
+                LOG_ERROR(Logger::Channel::General, "WIN32: Failed to read {} bytes at {} from {}. Reason: the file ends first.",
+                    count, offset, m_fileName);
+                break;
+            }
+
+            total += bytesRead;
+        }
+
+        CloseHandle(event);
+        return total;
+    }
+
     HANDLE m_fileHandle {};
     const char* m_fileName {};
+    // Where read() continues from. Only moved by read() and seek().
+    u64 m_cursor {};
 };
 
 File* FileSystem::openFile(const char* fileName, FileAccess access)
 {
     DWORD desiredAccess = 0;
+    bool writing {(access & FileAccess::Write) != FileAccess::None};
 
     if ((access & FileAccess::Read) != FileAccess::None)
         desiredAccess |= GENERIC_READ;
 
-    if ((access & FileAccess::Write) != FileAccess::None)
+    if (writing)
         desiredAccess |= GENERIC_WRITE;
 
+    // Overlapped, so every read says where it starts: readAt() never moves the cursor that read() and seek() use, and
+    // reads from several threads can't move each other's.
     HANDLE fileHandle = CreateFileA(
         fileName,
         desiredAccess,
-        0,
+        writing ? 0 : FILE_SHARE_READ,
         nullptr,
-        CREATE_ALWAYS,
-        FILE_ATTRIBUTE_NORMAL,
+        writing ? CREATE_ALWAYS : OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED,
         nullptr
     );
 
     if (fileHandle == INVALID_HANDLE_VALUE)
-        Logger::log_error("WIN32: Failed to open {}. Reason: {}", fileName, getLastErrorAsString());
+    {
+        LOG_ERROR(Logger::Channel::General, "WIN32: Failed to open {}. Reason: {}", fileName, getLastErrorAsString());
+        return nullptr;
+    }
 
     return new WindowsFile{fileName, fileHandle};
 }
 
+class WindowsMappedFile final : public MappedFile
+{
+public:
+    WindowsMappedFile(const char* fileName, HANDLE fileHandle, HANDLE mappingHandle, const u8* data, size_t size)
+        : m_fileHandle{fileHandle}, m_mappingHandle{mappingHandle}, m_data{data}, m_size{size}, m_fileName{fileName}
+    {
+    }
+
+    const u8* data() const override
+    {
+        return m_data;
+    }
+
+    size_t size() const override
+    {
+        return m_size;
+    }
+
+    void adviseAccess(AccessHint hint, u64 offset, u64 length) const override
+    {
+        // Like files, mappings only take the hint to read a range ahead.
+        if (hint != AccessHint::WillNeed || offset >= m_size)
+            return;
+
+        WIN32_MEMORY_RANGE_ENTRY range {};
+        range.VirtualAddress = const_cast<u8*>(m_data) + offset;
+        range.NumberOfBytes = static_cast<SIZE_T>(length == 0 || length > m_size - offset ? m_size - offset : length);
+
+        // Only a hint, so failing is not worth logging.
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+
+    void close() override
+    {
+        if (UnmapViewOfFile(m_data) != TRUE)
+            LOG_ERROR(Logger::Channel::General, "WIN32: Failed to unmap file {}. Reason: {}", m_fileName, getLastErrorAsString());
+
+        CloseHandle(m_mappingHandle);
+        CloseHandle(m_fileHandle);
+    }
+
+private:
+    HANDLE m_fileHandle {};
+    HANDLE m_mappingHandle {};
+    const u8* m_data {};
+    size_t m_size {};
+    const char* m_fileName {};
+};
+
+MappedFile* FileSystem::mapFile(const char* fileName)
+{
+    HANDLE fileHandle = CreateFileA(
+        fileName,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        LOG_ERROR(Logger::Channel::General, "WIN32: Failed to open {}. Reason: {}", fileName, getLastErrorAsString());
+        return nullptr;
+    }
+
+    LARGE_INTEGER size {};
+
+    if (GetFileSizeEx(fileHandle, &size) != TRUE || size.QuadPart == 0)
+    {
+        LOG_ERROR(Logger::Channel::General, "WIN32: Failed to map {}, it is empty or its size is unknown.", fileName);
+        CloseHandle(fileHandle);
+        return nullptr;
+    }
+
+    HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (mappingHandle == nullptr)
+    {
+        LOG_ERROR(Logger::Channel::General, "WIN32: Failed to map {}. Reason: {}", fileName, getLastErrorAsString());
+        CloseHandle(fileHandle);
+        return nullptr;
+    }
+
+    const void* data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+
+    if (data == nullptr)
+    {
+        LOG_ERROR(Logger::Channel::General, "WIN32: Failed to map a view of {}. Reason: {}", fileName, getLastErrorAsString());
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        return nullptr;
+    }
+
+    return new WindowsMappedFile{fileName, fileHandle, mappingHandle, static_cast<const u8*>(data), static_cast<size_t>(size.QuadPart)};
+}
+
 #endif // _WIN32
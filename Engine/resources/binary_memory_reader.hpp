@@ -0,0 +1,106 @@
+﻿#ifndef BINARY_MEMORY_READER_HPP
+#define BINARY_MEMORY_READER_HPP
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include "types.hpp"
+
+/**
+ * \brief Reads common data types out of a block of memory (like a mapped package), with the same
+ * interface as the reading half of BinaryStreamBuilder.
+ * \details Reads past the end are flagged (see failed()) and read zeroes, rather than reading out of bounds.
+ */
+class BinaryMemoryReader
+{
+public:
+    BinaryMemoryReader(const u8* data, size_t size) : m_data{data}, m_size{size}
+    {
+    }
+
+    // Reads an arbitrary amount of binary data from memory.
+    template <typename T>
+    BinaryMemoryReader& read(T* result, size_t size)
+    {
+        const u8* source {view(size)};
+
+        if (source != nullptr)
+            std::memcpy(result, source, size);
+        else if (size != 0)
+            std::memset(result, 0, size);
+
+        return *this;
+    }
+
+    template <typename T>
+    BinaryMemoryReader& readFixed(T* result)
+    {
+        read(result, sizeof(T));
+        return *this;
+    }
+
+    template <typename T>
+    BinaryMemoryReader& readVector(std::vector<T>* result)
+    {
+        size_t size{};
+        readFixed(&size);
+        result->resize(size);
+        read(result->data(), size * sizeof(T));
+        return *this;
+    }
+
+    BinaryMemoryReader& readString(std::string* result)
+    {
+        size_t size{};
+        readFixed(&size);
+        result->resize(size);
+        read(result->data(), size);
+        return *this;
+    }
+
+    /**
+     * \brief Skips over some data, and returns where it is instead of copying it.
+     * \return A pointer that stays valid as long as the memory does, or nullptr if the data runs past the end.
+     */
+    const u8* view(size_t size)
+    {
+        if (size > m_size - m_position)
+        {
+            m_failed = true;
+            m_position = m_size;
+            return nullptr;
+        }
+
+        const u8* result {m_data + m_position};
+        m_position += size;
+        return result;
+    }
+
+    // Moves to a position, measured in bytes from the start.
+    BinaryMemoryReader& seek(size_t position)
+    {
+        m_failed |= position > m_size;
+        m_position = position > m_size ? m_size : position;
+        return *this;
+    }
+
+    // The current position, measured in bytes from the start.
+    size_t tell() const
+    {
+        return m_position;
+    }
+
+    // Has anything tried to read past the end?
+    bool failed() const
+    {
+        return m_failed;
+    }
+
+private:
+    const u8* m_data;
+    size_t m_size;
+    size_t m_position {};
+    bool m_failed {};
+};
+
+#endif // BINARY_MEMORY_READER_HPP
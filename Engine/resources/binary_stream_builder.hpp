@@ -7,30 +7,31 @@
 #include <vector>
 
 /**
- * \brief A wrapper around a file stream that manages reading and writing of common data types.
+ * \brief A wrapper around a file (or any other) stream that manages reading and writing of common data types.
  */
 class BinaryStreamBuilder
 {
 public:
-    explicit BinaryStreamBuilder(std::fstream* stream) : m_stream{stream}, m_managedStream{false}
+    explicit BinaryStreamBuilder(std::iostream* stream) : m_stream{stream}, m_managedStream{false}
     {
     }
 
-    explicit BinaryStreamBuilder(std::string_view fileName) : m_stream{new std::fstream{}}, m_managedStream{true}
+    explicit BinaryStreamBuilder(std::string_view fileName) : m_stream{}, m_managedStream{true}
     {
-        m_stream->open(fileName.data(), std::ios::binary | std::ios::in | std::ios::out);
+        std::fstream* file {new std::fstream{}};
+        file->open(fileName.data(), std::ios::binary | std::ios::in | std::ios::out);
 
-        if (!m_stream->is_open())
+        if (!file->is_open())
             std::cerr << "Failed to open file " << fileName << "!" << std::endl;
+
+        m_stream = file;
     }
 
     ~BinaryStreamBuilder()
     {
+        // Closes the file too.
         if (m_managedStream)
-        {
-            m_stream->close();
             delete m_stream;
-        }
     }
 
     // Writes an arbitrary amount of binary data into the stream.
@@ -49,6 +50,25 @@ public:
         return *this;
     }
 
+    // Moves the stream to a position, measured in bytes from the start.
+    BinaryStreamBuilder& seek(size_t position)
+    {
+        m_stream->seekg(static_cast<std::streamoff>(position));
+        return *this;
+    }
+
+    // The current position of the stream, measured in bytes from the start.
+    size_t tell() const
+    {
+        return static_cast<size_t>(m_stream->tellg());
+    }
+
+    // Whether a read or write has failed, for example by running past the end of the file.
+    bool failed() const
+    {
+        return m_stream->fail();
+    }
+
     template <typename T>
     BinaryStreamBuilder& writeFixed(const T& data)
     {
@@ -100,6 +120,6 @@ public:
     }
 
 private:
-    std::fstream* m_stream;
+    std::iostream* m_stream;
     bool m_managedStream;
 };
@@ -0,0 +1,202 @@
+﻿#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "block_cache.hpp"
+
+BlockCache::BlockCache(FileSystem::File* file, u64 budget) : m_file{file}, m_fileSize{file->size()}, m_budget{budget}
+{
+}
+
+BlockCache::~BlockCache()
+{
+    m_prefetchPool.wait();
+}
+
+bool BlockCache::read(void* destination, size_t count, u64 offset)
+{
+    if (count == 0)
+        return true;
+
+    if (offset + count > m_fileSize)
+        return m_file->readAt(destination, count, offset);
+
+    u8* output {static_cast<u8*>(destination)};
+    u64 firstBlock {offset / BLOCK_SIZE};
+    u64 lastBlock {(offset + count - 1) / BLOCK_SIZE};
+
+    for (u64 index = firstBlock; index <= lastBlock; index++)
+    {
+        std::shared_ptr<Block> block {};
+        bool fill {};
+
+        {
+            std::unique_lock lock {m_mutex};
+            block = findBlock(index, fill);
+
+            if (!fill)
+                m_blockFilled.wait(lock, [&block] { return !block->filling; });
+
+            // Prefetched once the read is known to be sequential, while this read copies.
+            if (index == lastBlock)
+            {
+                if (firstBlock == m_lastBlock || firstBlock == m_lastBlock + 1)
+                    prefetch(lastBlock + 1);
+
+                m_lastBlock = lastBlock;
+            }
+        }
+
+        if (fill)
+            fillBlock(index, block);
+
+        if (block->failed)
+            return false;
+
+        u64 start {std::max(offset, index * BLOCK_SIZE)};
+        u64 end {std::min(offset + count, index * BLOCK_SIZE + block->size)};
+        std::memcpy(output + (start - offset), block->data.get() + (start - index * BLOCK_SIZE), end - start);
+    }
+
+    return true;
+}
+
+bool BlockCache::readCached(void* destination, size_t count, u64 offset)
+{
+    if (count == 0)
+        return true;
+
+    if (offset + count > m_fileSize)
+        return false;
+
+    u64 firstBlock {offset / BLOCK_SIZE};
+    u64 lastBlock {(offset + count - 1) / BLOCK_SIZE};
+    std::vector<std::shared_ptr<Block>> blocks {};
+
+    {
+        std::scoped_lock lock {m_mutex};
+
+        for (u64 index = firstBlock; index <= lastBlock; index++)
+        {
+            auto found {m_blocks.find(index)};
+
+            if (found == m_blocks.end() || found->second->filling)
+                return false;
+
+            blocks.push_back(found->second);
+        }
+
+        for (u64 index = firstBlock; index <= lastBlock; index++)
+        {
+            Block& block {*blocks[index - firstBlock]};
+            m_leastRecentlyUsed.splice(m_leastRecentlyUsed.begin(), m_leastRecentlyUsed, block.lruEntry);
+            m_hits++;
+        }
+    }
+
+    u8* output {static_cast<u8*>(destination)};
+
+    for (u64 index = firstBlock; index <= lastBlock; index++)
+    {
+        u64 start {std::max(offset, index * BLOCK_SIZE)};
+        u64 end {std::min(offset + count, (index + 1) * BLOCK_SIZE)};
+        std::memcpy(output + (start - offset), blocks[index - firstBlock]->data.get() + (start - index * BLOCK_SIZE), end - start);
+    }
+
+    return true;
+}
+
+void BlockCache::setBudget(u64 bytes)
+{
+    std::scoped_lock lock {m_mutex};
+    m_budget = bytes;
+    evictBlocks();
+}
+
+BlockCacheStats BlockCache::getStats()
+{
+    std::scoped_lock lock {m_mutex};
+    return {m_hits, m_misses, m_prefetches, m_evictions, m_cachedBytes, m_budget};
+}
+
+std::shared_ptr<BlockCache::Block> BlockCache::findBlock(u64 index, bool& fill)
+{
+    if (auto found = m_blocks.find(index); found != m_blocks.end())
+    {
+        if (!found->second->filling)
+            m_leastRecentlyUsed.splice(m_leastRecentlyUsed.begin(), m_leastRecentlyUsed, found->second->lruEntry);
+
+        m_hits++;
+        fill = false;
+        return found->second;
+    }
+
+    m_misses++;
+    fill = true;
+    return m_blocks.emplace(index, std::make_shared<Block>(Block{.filling = true})).first->second;
+}
+
+void BlockCache::fillBlock(u64 index, const std::shared_ptr<Block>& block)
+{
+    // Blocks are only filled while they are in the map and marked filling, so nobody else touches them here.
+    u64 size {std::min(BLOCK_SIZE, m_fileSize - index * BLOCK_SIZE)};
+    std::unique_ptr<u8[]> data {new u8[size]};
+    bool succeeded {m_file->readAt(data.get(), size, index * BLOCK_SIZE)};
+
+    {
+        std::scoped_lock lock {m_mutex};
+        block->filling = false;
+
+        if (succeeded)
+        {
+            block->data = std::move(data);
+            block->size = size;
+            m_leastRecentlyUsed.push_front(index);
+            block->lruEntry = m_leastRecentlyUsed.begin();
+            m_cachedBytes += size;
+            evictBlocks();
+        }
+        else
+        {
+            // Not cached, so the next read tries again.
+            block->failed = true;
+            m_blocks.erase(index);
+        }
+    }
+
+    m_blockFilled.notify_all();
+}
+
+void BlockCache::readAhead(u64 offset, size_t count)
+{
+    if (count == 0)
+        return;
+
+    std::scoped_lock lock {m_mutex};
+
+    for (u64 index = offset / BLOCK_SIZE; index <= (offset + count - 1) / BLOCK_SIZE; index++)
+        prefetch(index);
+}
+
+void BlockCache::prefetch(u64 index)
+{
+    if (index * BLOCK_SIZE >= m_fileSize || m_blocks.contains(index))
+        return;
+
+    std::shared_ptr<Block> block {m_blocks.emplace(index, std::make_shared<Block>(Block{.filling = true})).first->second};
+    m_prefetches++;
+    m_prefetchPool.submit([this, index, block] { fillBlock(index, block); });
+}
+
+void BlockCache::evictBlocks()
+{
+    while (m_cachedBytes > m_budget && !m_leastRecentlyUsed.empty())
+    {
+        u64 evicted {m_leastRecentlyUsed.back()};
+        m_leastRecentlyUsed.pop_back();
+
+        auto found {m_blocks.find(evicted)};
+        m_cachedBytes -= found->second->size;
+        m_blocks.erase(found);
+        m_evictions++;
+    }
+}
@@ -0,0 +1,107 @@
+﻿#ifndef BLOCK_CACHE_HPP
+#define BLOCK_CACHE_HPP
+
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "platform/file_system.hpp"
+#include "thread_pool.hpp"
+#include "types.hpp"
+
+struct BlockCacheStats
+{
+    // Blocks a read found cached, or already being read by someone else.
+    u64 hits;
+    // Blocks a read had to read from the file itself.
+    u64 misses;
+    // Blocks read ahead of a sequential reader, or for readAhead(...).
+    u64 prefetches;
+    // Blocks freed to stay within the budget.
+    u64 evictions;
+    u64 cachedBytes;
+    u64 budget;
+};
+
+/**
+ * \brief Caches a file in fixed size blocks, so small reads close to each other cost a copy instead of a system call.
+ * \details Blocks are kept in an LRU under a byte budget. Concurrent readers of a block that isn't cached yet
+ * share a single read of it. When reads move through the file in order, the block after them is read ahead
+ * on a background thread. Safe to use from any thread.
+ */
+class BlockCache
+{
+public:
+    static constexpr u64 BLOCK_SIZE {64 * 1024};
+    static constexpr u64 DEFAULT_BUDGET {16 * 1024 * 1024};
+
+    // The file must outlive the cache, and is only read with readAt().
+    explicit BlockCache(FileSystem::File* file, u64 budget = DEFAULT_BUDGET);
+
+    // Waits for the blocks that are being read ahead.
+    ~BlockCache();
+
+    BlockCache(const BlockCache&) = delete;
+    BlockCache& operator=(const BlockCache&) = delete;
+
+    // Like File::readAt(), but through the cache.
+    bool read(void* destination, size_t count, u64 offset);
+
+    // Only reads if every block is already cached, and never touches the file. Misses aren't counted.
+    bool readCached(void* destination, size_t count, u64 offset);
+
+    // Starts reading the blocks of a range that aren't cached yet on a background thread, without waiting for them.
+    void readAhead(u64 offset, size_t count);
+
+    void setBudget(u64 bytes);
+
+    BlockCacheStats getStats();
+
+private:
+    struct Block
+    {
+        std::unique_ptr<u8[]> data {};
+        u64 size {};
+        // Being read from the file. Everyone else waits for it, rather than reading it again.
+        bool filling {};
+        bool failed {};
+        // Where the block is in m_leastRecentlyUsed, once it is filled.
+        std::list<u64>::iterator lruEntry {};
+    };
+
+    // Finds a block, or starts filling it on this thread, in which case fill is set. Needs m_mutex.
+    std::shared_ptr<Block> findBlock(u64 index, bool& fill);
+    // Reads a block that findBlock(...) said to fill, and hands it to everyone waiting for it.
+    void fillBlock(u64 index, const std::shared_ptr<Block>& block);
+    // Reads a block ahead of time on m_prefetchPool, unless it is already there. Needs m_mutex.
+    void prefetch(u64 index);
+    // Frees the least recently used blocks, until they fit in the budget. Needs m_mutex.
+    void evictBlocks();
+
+    FileSystem::File* m_file;
+    u64 m_fileSize;
+
+    // Guards everything below.
+    std::mutex m_mutex {};
+    std::condition_variable m_blockFilled {};
+
+    // Blocks stay alive while a reader copies out of them, even if they are evicted meanwhile.
+    std::unordered_map<u64, std::shared_ptr<Block>> m_blocks {};
+    // Every filled block, the most recently used first.
+    std::list<u64> m_leastRecentlyUsed {};
+    // The last block of the last read, to tell when reads move through the file in order.
+    u64 m_lastBlock {~0ull};
+
+    u64 m_budget;
+    u64 m_cachedBytes {};
+    u64 m_hits {};
+    u64 m_misses {};
+    u64 m_prefetches {};
+    u64 m_evictions {};
+
+    // Destroyed first, so it finishes its reads while everything above is still alive.
+    ThreadPool m_prefetchPool {1};
+};
+
+#endif // BLOCK_CACHE_HPP
@@ -0,0 +1,191 @@
+﻿#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "compression.hpp"
+
+namespace
+{
+    constexpr u32 HASH_BITS {14};
+
+    u32 read32(const u8* data)
+    {
+        u32 result {};
+        std::memcpy(&result, data, sizeof(result));
+        return result;
+    }
+
+    u32 hash(u32 sequence)
+    {
+        return sequence * 2654435761u >> (32 - HASH_BITS);
+    }
+
+    // Writes the part of a length that didn't fit in its nibble.
+    bool writeLength(u8*& output, const u8* end, size_t length)
+    {
+        for (; length >= 255; length -= 255)
+        {
+            if (output == end)
+                return false;
+
+            *output++ = 255;
+        }
+
+        if (output == end)
+            return false;
+
+        *output++ = static_cast<u8>(length);
+        return true;
+    }
+
+    bool readLength(const u8*& input, const u8* end, size_t& length)
+    {
+        u8 byte {};
+
+        do
+        {
+            if (input == end)
+                return false;
+
+            byte = *input++;
+            length += byte;
+        }
+        while (byte == 255);
+
+        return true;
+    }
+
+    bool writeSequence(u8*& output, const u8* end, const u8* literals, size_t literalCount, u32 offset, size_t matchLength)
+    {
+        if (output == end)
+            return false;
+
+        u8* token {output++};
+        *token = static_cast<u8>(std::min<size_t>(literalCount, 15) << 4);
+
+        if (literalCount >= 15 && !writeLength(output, end, literalCount - 15))
+            return false;
+
+        if (static_cast<size_t>(end - output) < literalCount)
+            return false;
+
+        std::memcpy(output, literals, literalCount);
+        output += literalCount;
+
+        // Only the last sequence has no match.
+        if (matchLength == 0)
+            return true;
+
+        if (end - output < 2)
+            return false;
+
+        *output++ = static_cast<u8>(offset);
+        *output++ = static_cast<u8>(offset >> 8);
+
+        size_t length {matchLength - Compression::MIN_MATCH};
+        *token |= static_cast<u8>(std::min<size_t>(length, 15));
+        return length < 15 || writeLength(output, end, length - 15);
+    }
+}
+
+size_t Compression::compress(std::span<const u8> source, std::span<u8> destination)
+{
+    const u8* input {source.data()};
+    size_t size {source.size()};
+    u8* output {destination.data()};
+    const u8* outputEnd {output + destination.size()};
+
+    // Where each hashed sequence was last seen, plus one so zero means never.
+    std::vector<u32> table(1 << HASH_BITS);
+    size_t position {};
+    size_t anchor {};
+
+    while (size >= MIN_MATCH && position <= size - MIN_MATCH)
+    {
+        u32 sequence {read32(input + position)};
+        u32& slot {table[hash(sequence)]};
+        size_t candidate {slot};
+        slot = static_cast<u32>(position + 1);
+
+        if (candidate == 0 || position - (candidate - 1) > MAX_OFFSET || read32(input + candidate - 1) != sequence)
+        {
+            position++;
+            continue;
+        }
+
+        candidate--;
+        size_t length {MIN_MATCH};
+
+        while (position + length < size && input[candidate + length] == input[position + length])
+            length++;
+
+        if (!writeSequence(output, outputEnd, input + anchor, position - anchor, static_cast<u32>(position - candidate), length))
+            return 0;
+
+        position += length;
+        anchor = position;
+    }
+
+    if (!writeSequence(output, outputEnd, input + anchor, size - anchor, 0, 0))
+        return 0;
+
+    return static_cast<size_t>(output - destination.data());
+}
+
+bool Compression::decompress(std::span<const u8> source, std::span<u8> destination)
+{
+    const u8* input {source.data()};
+    const u8* inputEnd {input + source.size()};
+    u8* output {destination.data()};
+    u8* outputEnd {output + destination.size()};
+
+    while (input != inputEnd)
+    {
+        u8 token {*input++};
+        size_t literalCount {static_cast<size_t>(token >> 4)};
+
+        if (literalCount == 15 && !readLength(input, inputEnd, literalCount))
+            return false;
+
+        if (static_cast<size_t>(inputEnd - input) < literalCount || static_cast<size_t>(outputEnd - output) < literalCount)
+            return false;
+
+        std::memcpy(output, input, literalCount);
+        input += literalCount;
+        output += literalCount;
+
+        if (input == inputEnd)
+            break;
+
+        if (inputEnd - input < 2)
+            return false;
+
+        size_t offset {static_cast<size_t>(input[0] | input[1] << 8)};
+        input += 2;
+        size_t length {static_cast<size_t>(token & 15)};
+
+        if (length == 15 && !readLength(input, inputEnd, length))
+            return false;
+
+        length += MIN_MATCH;
+
+        if (offset == 0 || offset > static_cast<size_t>(output - destination.data())
+            || static_cast<size_t>(outputEnd - output) < length)
+            return false;
+
+        const u8* match {output - offset};
+
+        if (offset >= length)
+        {
+            std::memcpy(output, match, length);
+            output += length;
+        }
+        else
+        {
+            // Overlapping matches repeat the bytes they just wrote, so they must be copied one at a time.
+            for (size_t i = 0; i < length; i++)
+                *output++ = match[i];
+        }
+    }
+
+    return output == outputEnd;
+}
@@ -0,0 +1,42 @@
+﻿#ifndef COMPRESSION_HPP
+#define COMPRESSION_HPP
+
+#include <span>
+#include "types.hpp"
+
+/**
+ * \brief A small LZ77 codec (in the spirit of LZ4), that favours decompression speed over ratio.
+ * \details Compressed data is a run of sequences. Each one starts with a token byte, whose high nibble is the
+ * literal count and low nibble the match length minus MIN_MATCH (15 means more bytes of 255 follow, ending
+ * with one below 255). Then come the literals, a little-endian u16 offset back into the output, and the
+ * rest of the match length. The last sequence is only literals, and ends the data.
+ * There is no framing: the caller must know the decompressed size.
+ */
+namespace Compression
+{
+    // The shortest match worth encoding.
+    constexpr u32 MIN_MATCH {4};
+    // The furthest back a match can start.
+    constexpr u32 MAX_OFFSET {65535};
+
+    // The most that compress() can ever write for some input, when nothing in it matches.
+    constexpr size_t maxCompressedSize(size_t size)
+    {
+        return size + size / 255 + 16;
+    }
+
+    /**
+     * \brief Compresses data with a greedy, hash based match finder.
+     * \return The number of bytes written, or 0 if the destination was too small.
+     */
+    size_t compress(std::span<const u8> source, std::span<u8> destination);
+
+    /**
+     * \brief Decompresses data written by compress().
+     * \details Every read and write is bounds checked, so damaged data fails instead of overrunning.
+     * \return False unless the source decompressed into exactly the whole destination.
+     */
+    bool decompress(std::span<const u8> source, std::span<u8> destination);
+}
+
+#endif // COMPRESSION_HPP
@@ -0,0 +1,104 @@
+﻿#include <algorithm>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <string>
+#include "load_telemetry.hpp"
+#include "logger.hpp"
+
+u64 LoadTelemetry::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void LoadTelemetry::recordHit(StringName name, u64 frame)
+{
+    std::scoped_lock lock {m_mutex};
+    auto [found, inserted] = m_stats.try_emplace(name.hash, AssetLoadStats{.name = name.hash, .firstFrame = frame});
+    found->second.hits++;
+    found->second.lastFrame = std::max(found->second.lastFrame, frame);
+}
+
+void LoadTelemetry::recordMiss(StringName name, u64 frame, const LoadTimings& timings, u64 size, bool succeeded)
+{
+    std::scoped_lock lock {m_mutex};
+    auto [found, inserted] = m_stats.try_emplace(name.hash, AssetLoadStats{.name = name.hash, .firstFrame = frame});
+    AssetLoadStats& stats {found->second};
+    u64 nanoseconds {timings.ioNanoseconds + timings.decompressNanoseconds + timings.decodeNanoseconds};
+
+    stats.misses++;
+    stats.failures += succeeded ? 0 : 1;
+    stats.size = succeeded ? size : stats.size;
+    stats.total.readBytes += timings.readBytes;
+    stats.total.ioNanoseconds += timings.ioNanoseconds;
+    stats.total.decompressNanoseconds += timings.decompressNanoseconds;
+    stats.total.decodeNanoseconds += timings.decodeNanoseconds;
+    stats.slowestNanoseconds = std::max(stats.slowestNanoseconds, nanoseconds);
+    stats.lastFrame = std::max(stats.lastFrame, frame);
+}
+
+std::vector<AssetLoadStats> LoadTelemetry::getStats()
+{
+    std::vector<AssetLoadStats> result {};
+    {
+        std::scoped_lock lock {m_mutex};
+        result.reserve(m_stats.size());
+
+        for (const auto& [name, stats] : m_stats)
+            result.push_back(stats);
+    }
+
+    auto totalTime = [](const AssetLoadStats& stats)
+    {
+        return stats.total.ioNanoseconds + stats.total.decompressNanoseconds + stats.total.decodeNanoseconds;
+    };
+
+    std::sort(result.begin(), result.end(), [&](const AssetLoadStats& a, const AssetLoadStats& b)
+    {
+        return totalTime(a) != totalTime(b) ? totalTime(a) > totalTime(b) : a.name < b.name;
+    });
+
+    return result;
+}
+
+void LoadTelemetry::clear()
+{
+    std::scoped_lock lock {m_mutex};
+    m_stats.clear();
+}
+
+bool LoadTelemetry::writeCsv(const char* path)
+{
+    std::ofstream file {path, std::ios::out | std::ios::trunc};
+
+    if (!file.is_open())
+    {
+        LOG_ERROR(Logger::Channel::Resources, "Failed to open {} to write load telemetry to!", path);
+        return false;
+    }
+
+    auto milliseconds = [](u64 nanoseconds) { return static_cast<f64>(nanoseconds) / 1e6; };
+
+    file << "name,hits,misses,failures,size,read_bytes,io_ms,decompress_ms,decode_ms,slowest_ms,first_frame,last_frame\n";
+
+    for (const AssetLoadStats& stats : getStats())
+    {
+        // Quoted, since names are paths that may have commas in them.
+        std::string name {std::format("{}", StringName{stats.name})};
+        std::erase(name, '"');
+
+        file << std::format("\"{}\",{},{},{},{},{},{:.3f},{:.3f},{:.3f},{:.3f},{},{}\n", name, stats.hits, stats.misses, stats.failures,
+            stats.size, stats.total.readBytes, milliseconds(stats.total.ioNanoseconds), milliseconds(stats.total.decompressNanoseconds),
+            milliseconds(stats.total.decodeNanoseconds), milliseconds(stats.slowestNanoseconds), stats.firstFrame, stats.lastFrame);
+    }
+
+    file.flush();
+
+    if (!file)
+    {
+        LOG_ERROR(Logger::Channel::Resources, "Failed to write load telemetry to {}!", path);
+        return false;
+    }
+
+    return true;
+}
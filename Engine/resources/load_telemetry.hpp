@@ -0,0 +1,71 @@
+﻿#ifndef LOAD_TELEMETRY_HPP
+#define LOAD_TELEMETRY_HPP
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "string_name.hpp"
+#include "types.hpp"
+
+// Where one load spent its time, and how much of the package it read.
+struct LoadTimings
+{
+    // The asset as it is stored in the package, compressed or not.
+    u64 readBytes {};
+    // Reading the package. Mapped packages are paged in while decoding instead, so this stays zero for them.
+    u64 ioNanoseconds {};
+    u64 decompressNanoseconds {};
+    // Reading the resource out of its asset, in readResourceInPlace() or from a relocatable image.
+    u64 decodeNanoseconds {};
+};
+
+// Everything recorded about one asset, see LoadTelemetry.
+struct AssetLoadStats
+{
+    StringName::Hash name {};
+    // Requests served without reading the package: the resource was loaded, cached, or already being loaded.
+    u32 hits {};
+    // Requests that read the package, and how many of those failed.
+    u32 misses {};
+    u32 failures {};
+    // The size of the resource in the package once decompressed.
+    u64 size {};
+    // Summed over every miss.
+    LoadTimings total {};
+    // The slowest miss, over every phase.
+    u64 slowestNanoseconds {};
+    // The first and last frames (see ResourceManager::getFrame()) the asset was requested in.
+    u64 firstFrame {};
+    u64 lastFrame {};
+};
+
+/**
+ * \brief Records every request a ResourceManager serves, per asset, to find the heaviest assets and the slowest phases.
+ * \details Safe to record into from any thread. See ResourceManager::setTelemetryEnabled().
+ */
+class LoadTelemetry
+{
+public:
+    // A steady clock to time load phases with.
+    static u64 now();
+
+    void recordHit(StringName name, u64 frame);
+    void recordMiss(StringName name, u64 frame, const LoadTimings& timings, u64 size, bool succeeded);
+
+    // Every asset recorded so far, the one that took longest to load in total first.
+    std::vector<AssetLoadStats> getStats();
+
+    void clear();
+
+    /**
+     * \brief Writes every asset's stats as CSV, one row per asset in the order of getStats(). Times are in milliseconds.
+     * \return False (and logs why) if the file can't be written.
+     */
+    bool writeCsv(const char* path);
+
+private:
+    std::mutex m_mutex {};
+    std::unordered_map<StringName::Hash, AssetLoadStats> m_stats {};
+};
+
+#endif // LOAD_TELEMETRY_HPP
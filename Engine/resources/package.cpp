@@ -0,0 +1,198 @@
+﻿#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include "package.hpp"
+#include "compression.hpp"
+#include "logger.hpp"
+#include "string_name_table.hpp"
+
+const PackageIndexEntry* findPackageEntry(std::span<const PackageIndexEntry> index, StringName::Hash hash)
+{
+    auto entry = std::lower_bound(index.begin(), index.end(), hash, [](const PackageIndexEntry& entry, StringName::Hash hash)
+    {
+        return entry.hash < hash;
+    });
+
+    return entry != index.end() && entry->hash == hash ? &*entry : nullptr;
+}
+
+bool decompressPackageAsset(const PackageIndexEntry& entry, std::span<const u8> stored, u8* destination, ThreadPool& pool)
+{
+    u64 chunkCount {(entry.size + PACKAGE_CHUNK_SIZE - 1) / PACKAGE_CHUNK_SIZE};
+
+    if (chunkCount > stored.size() / sizeof(u32))
+        return false;
+
+    // Where each chunk starts in stored, plus where the last one ends.
+    std::vector<u64> chunkOffsets(chunkCount + 1);
+    chunkOffsets[0] = chunkCount * sizeof(u32);
+
+    for (u64 i = 0; i < chunkCount; i++)
+    {
+        u32 chunkSize {};
+        std::memcpy(&chunkSize, stored.data() + i * sizeof(u32), sizeof(u32));
+        chunkOffsets[i + 1] = chunkOffsets[i] + chunkSize;
+    }
+
+    if (chunkOffsets.back() != stored.size())
+        return false;
+
+    std::atomic<bool> failed {};
+
+    pool.parallelFor(static_cast<u32>(chunkCount), [&](u32 chunk)
+    {
+        u64 start {static_cast<u64>(chunk) * PACKAGE_CHUNK_SIZE};
+        std::span<const u8> source {stored.subspan(chunkOffsets[chunk], chunkOffsets[chunk + 1] - chunkOffsets[chunk])};
+        std::span<u8> output {destination + start, std::min<u64>(PACKAGE_CHUNK_SIZE, entry.size - start)};
+
+        if (source.size() == output.size())
+            std::memcpy(output.data(), source.data(), source.size());
+        else if (!Compression::decompress(source, output))
+            failed = true;
+    });
+
+    return !failed;
+}
+
+// Compresses each chunk of an asset, into the layout described in package.hpp.
+static std::vector<u8> compressChunks(std::span<const u8> asset)
+{
+    u64 chunkCount {(asset.size() + PACKAGE_CHUNK_SIZE - 1) / PACKAGE_CHUNK_SIZE};
+    std::vector<u8> result(chunkCount * sizeof(u32));
+    std::vector<u8> compressed(Compression::maxCompressedSize(PACKAGE_CHUNK_SIZE));
+
+    for (u64 i = 0; i < chunkCount; i++)
+    {
+        std::span<const u8> chunk {asset.subspan(i * PACKAGE_CHUNK_SIZE, std::min<u64>(PACKAGE_CHUNK_SIZE, asset.size() - i * PACKAGE_CHUNK_SIZE))};
+        size_t size {Compression::compress(chunk, compressed)};
+
+        // Chunks that would grow are stored as is.
+        if (size == 0 || size >= chunk.size())
+        {
+            size = chunk.size();
+            result.insert(result.end(), chunk.begin(), chunk.end());
+        }
+        else
+            result.insert(result.end(), compressed.begin(), compressed.begin() + static_cast<std::ptrdiff_t>(size));
+
+        u32 storedSize {static_cast<u32>(size)};
+        std::memcpy(result.data() + i * sizeof(u32), &storedSize, sizeof(u32));
+    }
+
+    return result;
+}
+
+PackageWriter::PackageWriter(std::fstream* file, bool compress, u64 blockSize)
+    : m_file{file}, m_builder{file}, m_compress{compress}, m_blockSize{blockSize}
+{
+    // Filled in by finish().
+    PackageHeader header {};
+    m_builder.writeFixed(header);
+}
+
+BinaryStreamBuilder& PackageWriter::beginAsset(StringName name, bool startsBlock)
+{
+    writeAsset();
+    // The rest is filled in by writeAsset(), once the asset's data is known.
+    m_index.push_back({.hash = name.hash, .offset = 0, .size = 0, .compressedSize = 0});
+    m_hasAsset = true;
+    m_startsBlock = startsBlock;
+    return m_assetBuilder;
+}
+
+u64 PackageWriter::getPaddingBytes() const
+{
+    return m_paddingBytes;
+}
+
+void PackageWriter::writeAsset()
+{
+    if (!m_hasAsset)
+        return;
+
+    std::string_view data {m_asset.view()};
+    std::span<const u8> asset {reinterpret_cast<const u8*>(data.data()), data.size()};
+    PackageIndexEntry& entry {m_index.back()};
+
+    std::vector<u8> compressed {m_compress ? compressChunks(asset) : std::vector<u8>{}};
+    // Compressed assets are always smaller than their size, which is how they are told apart.
+    bool isCompressed {m_compress && compressed.size() < asset.size()};
+
+    entry.size = asset.size();
+    entry.compressedSize = isCompressed ? compressed.size() : asset.size();
+
+    u64 start {m_builder.tell()};
+    u64 offset {(start + PACKAGE_ASSET_ALIGNMENT - 1) / PACKAGE_ASSET_ALIGNMENT * PACKAGE_ASSET_ALIGNMENT};
+
+    if (m_blockSize != 0)
+    {
+        u64 blockOffset {offset % m_blockSize};
+
+        if (blockOffset != 0 && (m_startsBlock || blockOffset + entry.compressedSize > m_blockSize))
+            offset += m_blockSize - blockOffset;
+    }
+
+    if (offset > start)
+    {
+        std::vector<u8> padding(offset - start);
+        m_builder.write(padding[0], padding.size());
+        m_paddingBytes += padding.size();
+    }
+
+    entry.offset = offset;
+
+    if (isCompressed)
+        m_builder.write(compressed[0], compressed.size());
+    else if (!asset.empty())
+        m_builder.write(asset[0], asset.size());
+
+    m_asset.str({});
+    m_asset.clear();
+    m_hasAsset = false;
+}
+
+bool PackageWriter::finish()
+{
+    writeAsset();
+
+    // The index offset is filled in once the name table has been written.
+    PackageHeader header {
+        .magic = PACKAGE_MAGIC,
+        .version = PACKAGE_VERSION,
+        .assetCount = m_index.size(),
+        .indexOffset = 0,
+        .nameTableOffset = m_builder.tell(),
+    };
+
+    StringNameTable::writeTo(m_builder);
+
+    // Pad, so the index can be read in place.
+    while (m_builder.tell() % alignof(PackageIndexEntry) != 0)
+        m_builder.writeFixed(u8{0});
+
+    std::sort(m_index.begin(), m_index.end(), [](const PackageIndexEntry& a, const PackageIndexEntry& b)
+    {
+        return a.hash < b.hash;
+    });
+
+    auto duplicate = std::adjacent_find(m_index.begin(), m_index.end(), [](const PackageIndexEntry& a, const PackageIndexEntry& b)
+    {
+        return a.hash == b.hash;
+    });
+
+    if (duplicate != m_index.end())
+    {
+        LOG_ERROR(Logger::Channel::Resources, "Two assets in the package are named {}!", StringName{duplicate->hash});
+        return false;
+    }
+
+    header.indexOffset = m_builder.tell();
+
+    if (!m_index.empty())
+        m_builder.write(m_index[0], m_index.size() * sizeof(PackageIndexEntry));
+
+    m_builder.seek(0);
+    m_builder.writeFixed(header);
+    m_file->flush();
+    return !m_file->fail();
+}
@@ -0,0 +1,125 @@
+﻿#ifndef PACKAGE_HPP
+#define PACKAGE_HPP
+
+#include <fstream>
+#include <span>
+#include <sstream>
+#include <vector>
+#include "binary_stream_builder.hpp"
+#include "string_name.hpp"
+#include "thread_pool.hpp"
+#include "types.hpp"
+
+/*
+ * Package file binary layout:
+ * 1) a PackageHeader
+ * 2) the asset data, each found through the index and aligned to PACKAGE_ASSET_ALIGNMENT (or more, see PackageWriter)
+ * 3) the name table, see StringNameTable::writeTo(...)
+ * 4) the index: a PackageIndexEntry per asset, sorted by name hash
+ *
+ * The index is written last (so the asset count doesn't have to be known up front) and aligned,
+ * so a mapped package can be searched in place, without building anything at startup.
+ *
+ * Assets that compress are split into chunks of PACKAGE_CHUNK_SIZE, each compressed on its own
+ * (see Compression::compress(...)), so they can be decompressed in parallel. They are stored as:
+ * 1) a u32 per chunk, the number of bytes it was compressed to (equal to its size when it is stored as is)
+ * 2) the chunks, back to back
+ * Assets that don't compress are stored as is, so they can still be read in place.
+ */
+
+constexpr u32 PACKAGE_MAGIC {0x4B415047}; // "GPAK"
+constexpr u32 PACKAGE_VERSION {4};
+constexpr u32 PACKAGE_CHUNK_SIZE {64 * 1024};
+// So relocatable resources (see relocatable.hpp) are aligned when they are read in place from a mapped package.
+constexpr u64 PACKAGE_ASSET_ALIGNMENT {16};
+
+struct PackageHeader
+{
+    u32 magic;
+    u32 version;
+    u64 assetCount;
+    // Where the index starts, measured in bytes from the start of the package.
+    u64 indexOffset;
+    // Where the name table starts, or 0 if there is none.
+    u64 nameTableOffset;
+};
+
+struct PackageIndexEntry
+{
+    StringName::Hash hash;
+    // Where the asset starts, measured in bytes from the start of the package.
+    u64 offset;
+    // The size of the asset once it is decompressed.
+    u64 size;
+    // The size of the asset in the package. Equal to size when it is stored uncompressed.
+    u64 compressedSize;
+};
+
+/**
+ * \brief Finds an asset in a sorted index with a binary search.
+ * \return The entry, or nullptr if the asset is not in the index.
+ */
+const PackageIndexEntry* findPackageEntry(std::span<const PackageIndexEntry> index, StringName::Hash hash);
+
+/**
+ * \brief Decompresses a compressed asset, spreading its chunks over a thread pool.
+ * \param stored The asset as it is stored in the package (entry.compressedSize bytes).
+ * \param destination Where the chunks are decompressed straight into. Must hold entry.size bytes.
+ * \return False if the asset is damaged.
+ */
+bool decompressPackageAsset(const PackageIndexEntry& entry, std::span<const u8> stored, u8* destination, ThreadPool& pool);
+
+/**
+ * \brief Writes assets into a package, and builds its index.
+ */
+class PackageWriter
+{
+public:
+    /**
+     * \param file Must be open for binary reading and writing, and empty.
+     * \param compress Should assets be compressed (when that makes them smaller)?
+     * \param blockSize When not zero, assets are laid out to touch as few blocks (pages or disk sectors) of this
+     * size as they can: assets that fit in a block never straddle two, and bigger ones start on one. Must be a
+     * multiple of PACKAGE_ASSET_ALIGNMENT.
+     */
+    explicit PackageWriter(std::fstream* file, bool compress = true, u64 blockSize = 0);
+
+    /**
+     * \brief Starts the next asset, and writes the one before it into the package.
+     * \details Assets are written in the order they are started, so assets that are used together should be
+     * started one after the other.
+     * \param startsBlock Starts the asset on a new block (see the constructor), so a group of assets that are
+     * used together doesn't share its first block with whatever came before.
+     * \return The stream to write the asset's data into, before the next call.
+     */
+    BinaryStreamBuilder& beginAsset(StringName name, bool startsBlock = false);
+
+    /**
+     * \brief Writes the name table (of every interned string), the index and the header.
+     * \return False if two assets share a name, or the stream failed.
+     */
+    bool finish();
+
+    // How many bytes were written between assets to align them, which is what a layout costs.
+    u64 getPaddingBytes() const;
+
+private:
+    // Writes the asset that was last started, compressing it if that helps.
+    void writeAsset();
+
+    std::fstream* m_file;
+    BinaryStreamBuilder m_builder;
+    bool m_compress;
+    u64 m_blockSize;
+    u64 m_paddingBytes {};
+
+    // The asset that is being written, kept whole so it can be compressed.
+    std::stringstream m_asset {std::ios::binary | std::ios::in | std::ios::out};
+    BinaryStreamBuilder m_assetBuilder {&m_asset};
+    bool m_hasAsset {};
+    bool m_startsBlock {};
+
+    std::vector<PackageIndexEntry> m_index {};
+};
+
+#endif // PACKAGE_HPP
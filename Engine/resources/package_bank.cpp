@@ -0,0 +1,188 @@
+﻿#include "logger.hpp"
+#include "package_bank.hpp"
+#include "binary_memory_reader.hpp"
+#include "string_name_table.hpp"
+
+using namespace FileSystem;
+
+std::shared_ptr<PackageBank> PackageBank::open(const char* packageFile, PackageAccess access, PackageId id, s32 priority)
+{
+    std::shared_ptr<PackageBank> bank {new PackageBank{packageFile, id, priority}};
+
+    if (access == PackageAccess::Mapped)
+    {
+        if (bank->openMapped())
+            return bank;
+
+        if (bank->m_mappedFile != nullptr)
+            return nullptr;
+
+        LOG_WARNING(Logger::Channel::Resources, "Failed to map {}, so it will be streamed instead.", packageFile);
+    }
+
+    return bank->openStreamed() ? bank : nullptr;
+}
+
+PackageBank::PackageBank(const char* packageFile, PackageId id, s32 priority) : m_id{id}, m_priority{priority}, m_file{packageFile}
+{
+}
+
+PackageBank::~PackageBank()
+{
+    if (m_blockCache != nullptr)
+    {
+        BlockCacheStats stats {m_blockCache->getStats()};
+        u64 reads {stats.hits + stats.misses};
+
+        if (reads > 0)
+        {
+            LOG_INFO(Logger::Channel::Resources, "Block cache of {}: {} hits, {} misses ({:.1f}% hit rate), {} blocks prefetched.",
+                m_file, stats.hits, stats.misses, 100.0 * static_cast<f64>(stats.hits) / static_cast<f64>(reads), stats.prefetches);
+        }
+
+        // Reads ahead from the package, which is closed below.
+        m_blockCache.reset();
+    }
+
+    if (m_mappedFile != nullptr)
+    {
+        m_mappedFile->close();
+        delete m_mappedFile;
+    }
+
+    if (m_streamedFile != nullptr)
+    {
+        m_streamedFile->close();
+        delete m_streamedFile;
+    }
+}
+
+bool PackageBank::openMapped()
+{
+    m_mappedFile = mapFile(m_file.c_str());
+
+    if (m_mappedFile == nullptr)
+        return false;
+
+    PackageHeader header {};
+    BinaryMemoryReader reader {m_mappedFile->data(), m_mappedFile->size()};
+    reader.readFixed(&header);
+
+    if (!checkHeader(header, m_mappedFile->size()))
+        return false;
+
+    // The index is searched straight from the mapping, so opening a package doesn't depend on its size.
+    m_index = {reinterpret_cast<const PackageIndexEntry*>(m_mappedFile->data() + header.indexOffset), header.assetCount};
+
+#ifdef STRING_NAME_TABLE_ENABLED
+    // Lets every asset name be printed, without ever hashing or copying strings at runtime.
+    if (header.nameTableOffset != 0 && header.nameTableOffset < header.indexOffset)
+        StringNameTable::readFrom(reader.seek(header.nameTableOffset), header.indexOffset - header.nameTableOffset);
+#endif // STRING_NAME_TABLE_ENABLED
+
+    return true;
+}
+
+bool PackageBank::openStreamed()
+{
+    m_streamedFile = openFile(m_file.c_str(), FileAccess::Read);
+
+    if (m_streamedFile == nullptr)
+        return false;
+
+    // Single loads jump all over the package, so reading ahead would mostly be wasted.
+    m_streamedFile->adviseAccess(AccessHint::Random);
+
+    PackageHeader header {};
+
+    if (!m_streamedFile->readAt(&header, sizeof(header), 0) || !checkHeader(header, m_streamedFile->size()))
+        return false;
+
+    // Still a single read, and no per-asset work.
+    m_streamedIndex.resize(header.assetCount);
+
+    if (!m_streamedFile->readAt(m_streamedIndex.data(), m_streamedIndex.size() * sizeof(PackageIndexEntry), header.indexOffset))
+        return false;
+
+    m_index = m_streamedIndex;
+    m_blockCache = std::make_unique<BlockCache>(m_streamedFile);
+
+#ifdef STRING_NAME_TABLE_ENABLED
+    // The name table is written right before the index.
+    if (header.nameTableOffset != 0 && header.nameTableOffset < header.indexOffset)
+    {
+        std::vector<u8> nameTable(header.indexOffset - header.nameTableOffset);
+
+        if (m_streamedFile->readAt(nameTable.data(), nameTable.size(), header.nameTableOffset))
+        {
+            BinaryMemoryReader reader {nameTable.data(), nameTable.size()};
+            StringNameTable::readFrom(reader, nameTable.size());
+        }
+    }
+#endif // STRING_NAME_TABLE_ENABLED
+
+    return true;
+}
+
+bool PackageBank::checkHeader(const PackageHeader& header, u64 packageSize)
+{
+    if (header.magic != PACKAGE_MAGIC || header.version != PACKAGE_VERSION)
+    {
+        LOG_ERROR(Logger::Channel::Resources, "{} is not a package, or was built by an older ResourceCompiler!", m_file);
+        return false;
+    }
+
+    if (header.indexOffset % alignof(PackageIndexEntry) != 0 || header.indexOffset > packageSize
+        || header.assetCount > (packageSize - header.indexOffset) / sizeof(PackageIndexEntry))
+    {
+        LOG_ERROR(Logger::Channel::Resources, "The index of {} is damaged!", m_file);
+        return false;
+    }
+
+    return true;
+}
+
+bool PackageBank::overrides(const PackageBank& other) const
+{
+    return m_priority != other.m_priority ? m_priority > other.m_priority : m_id > other.m_id;
+}
+
+PackageId PackageBank::getId() const
+{
+    return m_id;
+}
+
+s32 PackageBank::getPriority() const
+{
+    return m_priority;
+}
+
+const std::string& PackageBank::getFile() const
+{
+    return m_file;
+}
+
+PackageAccess PackageBank::getAccess() const
+{
+    return m_mappedFile != nullptr ? PackageAccess::Mapped : PackageAccess::Streamed;
+}
+
+std::span<const PackageIndexEntry> PackageBank::getIndex() const
+{
+    return m_index;
+}
+
+const MappedFile* PackageBank::getMappedFile() const
+{
+    return m_mappedFile;
+}
+
+File* PackageBank::getStreamedFile() const
+{
+    return m_streamedFile;
+}
+
+BlockCache* PackageBank::getBlockCache() const
+{
+    return m_blockCache.get();
+}
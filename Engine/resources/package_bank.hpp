@@ -0,0 +1,89 @@
+﻿#ifndef PACKAGE_BANK_HPP
+#define PACKAGE_BANK_HPP
+
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include "block_cache.hpp"
+#include "package.hpp"
+#include "platform/file_system.hpp"
+#include "types.hpp"
+
+// How a ResourceManager reads its packages.
+enum class PackageAccess
+{
+    // Keeps the package open, and reads each resource into a buffer of its own the first time it is loaded.
+    Streamed,
+    // Maps the whole package into memory once. Resources are read in place, so nothing is opened or copied
+    // per load, and the OS only pages in the parts that are touched.
+    Mapped,
+};
+
+// Identifies a package mounted with ResourceManager::mount().
+using PackageId = u32;
+
+constexpr PackageId INVALID_PACKAGE {0};
+
+/**
+ * \brief A package mounted in a ResourceManager, as a bank of assets that is loaded and unloaded as a whole.
+ * \details Owns the open (or mapped) file, its index and, when it is streamed, its block cache. Shared by
+ * everything that still reads from it (and by resources that point into it), so unmounting it never pulls
+ * it out from under a load.
+ */
+class PackageBank : public std::enable_shared_from_this<PackageBank>
+{
+public:
+    /**
+     * \brief Opens a package, and reads its index.
+     * \details Falls back to PackageAccess::Streamed if the package can't be mapped.
+     * \return Null if the package can't be opened, or isn't one. Logs why.
+     */
+    static std::shared_ptr<PackageBank> open(const char* packageFile, PackageAccess access, PackageId id, s32 priority);
+
+    // Logs how well the block cache did, and closes the package.
+    ~PackageBank();
+
+    PackageBank(const PackageBank&) = delete;
+    PackageBank& operator=(const PackageBank&) = delete;
+
+    // Does this bank win over another, for assets they both have? Higher priorities do, then the later mount.
+    bool overrides(const PackageBank& other) const;
+
+    PackageId getId() const;
+    s32 getPriority() const;
+    const std::string& getFile() const;
+    PackageAccess getAccess() const;
+
+    // Every asset in the package, sorted by hash.
+    std::span<const PackageIndexEntry> getIndex() const;
+
+    // Null unless the package is mapped.
+    const FileSystem::MappedFile* getMappedFile() const;
+    // Null unless the package is streamed. Only read with readAt(), so it is shared by every thread.
+    FileSystem::File* getStreamedFile() const;
+    // Null unless the package is streamed.
+    BlockCache* getBlockCache() const;
+
+private:
+    PackageBank(const char* packageFile, PackageId id, s32 priority);
+
+    bool openMapped();
+    bool openStreamed();
+    // Logs why, if the header doesn't belong to a package this can read.
+    bool checkHeader(const PackageHeader& header, u64 packageSize);
+
+    PackageId m_id;
+    s32 m_priority;
+    std::string m_file;
+
+    FileSystem::MappedFile* m_mappedFile {};
+    FileSystem::File* m_streamedFile {};
+    std::unique_ptr<BlockCache> m_blockCache {};
+
+    // Points into the mapped package, or into m_streamedIndex.
+    std::span<const PackageIndexEntry> m_index {};
+    std::vector<PackageIndexEntry> m_streamedIndex {};
+};
+
+#endif // PACKAGE_BANK_HPP
@@ -0,0 +1,79 @@
+﻿#include <charconv>
+#include <format>
+#include <fstream>
+#include <string>
+#include "prefetch_manifest.hpp"
+#include "logger.hpp"
+
+const char* PrefetchManifest::TYPE_NAME = "PrefetchManifest";
+
+template <>
+void writeRelocatableBlobs<PrefetchManifest>(const PrefetchManifest& resource, RelocatableWriter& writer)
+{
+    writer.writeBlob(resource.assets, resource.assets, resource.assetCount * sizeof(StringName::Hash));
+}
+
+bool writeAccessTrace(const char* fileName, std::span<const StringName> assets)
+{
+    std::ofstream file {fileName, std::ios::out | std::ios::trunc};
+
+    if (!file.is_open())
+    {
+        LOG_ERROR(Logger::Channel::Resources, "Failed to open {} to write an access trace to!", fileName);
+        return false;
+    }
+
+    for (StringName asset : assets)
+        file << std::format("{}\n", asset);
+
+    file.flush();
+
+    if (!file)
+    {
+        LOG_ERROR(Logger::Channel::Resources, "Failed to write an access trace to {}!", fileName);
+        return false;
+    }
+
+    return true;
+}
+
+bool readAccessTrace(const char* fileName, std::vector<StringName::Hash>& assets)
+{
+    std::ifstream file {fileName};
+
+    if (!file.is_open())
+    {
+        LOG_ERROR(Logger::Channel::Resources, "Failed to open access trace {}!", fileName);
+        return false;
+    }
+
+    std::string line {};
+
+    while (std::getline(file, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+
+        if (line.empty())
+            continue;
+
+        // A name the writer didn't know, as # and its hash.
+        StringName::Hash hash {};
+
+        if (line.size() == 17 && line[0] == '#'
+            && std::from_chars(line.data() + 1, line.data() + line.size(), hash, 16).ptr == line.data() + line.size())
+        {
+            assets.push_back(hash);
+        }
+        else
+            assets.push_back(StringName::createHash(line.data(), line.size()));
+    }
+
+    if (file.bad())
+    {
+        LOG_ERROR(Logger::Channel::Resources, "Failed to read access trace {}!", fileName);
+        return false;
+    }
+
+    return true;
+}
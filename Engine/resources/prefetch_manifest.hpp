@@ -0,0 +1,40 @@
+﻿#ifndef PREFETCH_MANIFEST_HPP
+#define PREFETCH_MANIFEST_HPP
+
+#include <span>
+#include <vector>
+#include "relocatable.hpp"
+#include "string_name.hpp"
+#include "types.hpp"
+
+/**
+ * \brief The assets a session asked for, in the order it first asked for them.
+ * \details The ResourceCompiler builds one out of each access trace (see ResourceManager::startAccessTrace()),
+ * and ResourceManager::startPrefetch(...) follows it to read assets ahead of the game.
+ * Relocatable, so it is used straight from the package (see RelocatableResource).
+ */
+struct PrefetchManifest
+{
+    static const char* TYPE_NAME;
+    static constexpr u16 LAYOUT_VERSION {1};
+
+    u32 assetCount {};
+    const StringName::Hash* assets {};
+};
+
+// The assets are written after the manifest, and point straight into the package once it is loaded.
+template <>
+void writeRelocatableBlobs<PrefetchManifest>(const PrefetchManifest& resource, RelocatableWriter& writer);
+
+/**
+ * \brief Writes an access trace, one asset per line, as it is formatted (see std::formatter<StringName>).
+ * \details Names that aren't in the StringNameTable are written as # and their hash, which readAccessTrace(...)
+ * reads back as is.
+ * \return False (and logs why) if the file can't be written.
+ */
+bool writeAccessTrace(const char* fileName, std::span<const StringName> assets);
+
+// Reads the assets of a trace written by writeAccessTrace(...), in order. False (and logs why) if it can't be read.
+bool readAccessTrace(const char* fileName, std::vector<StringName::Hash>& assets);
+
+#endif // PREFETCH_MANIFEST_HPP
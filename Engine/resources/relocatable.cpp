@@ -0,0 +1,100 @@
+﻿#include "logger.hpp"
+#include "relocatable.hpp"
+
+u64 RelocatableWriter::append(const void* data, size_t size)
+{
+    u64 target {(m_image.size() + RELOCATABLE_ALIGNMENT - 1) / RELOCATABLE_ALIGNMENT * RELOCATABLE_ALIGNMENT};
+    m_image.resize(target + size);
+
+    if (size != 0)
+        std::memcpy(m_image.data() + target, data, size);
+
+    return target;
+}
+
+void RelocatableWriter::addFixup(u64 location, u64 target)
+{
+    std::memset(m_image.data() + location, 0, sizeof(void*));
+    m_fixups.push_back({location, target});
+}
+
+void RelocatableWriter::writeTo(BinaryStreamBuilder& packageFile)
+{
+    // Aligned, so the table can be read in place too.
+    m_image.resize((m_image.size() + alignof(RelocatableFixup) - 1) / alignof(RelocatableFixup) * alignof(RelocatableFixup));
+
+    RelocatableHeader header {
+        .magic = RELOCATABLE_MAGIC,
+        .formatVersion = RELOCATABLE_FORMAT_VERSION,
+        .layoutVersion = m_layoutVersion,
+        .rootSize = m_rootSize,
+        .fixupCount = static_cast<u32>(m_fixups.size()),
+        .fixupOffset = m_image.size(),
+    };
+
+    std::memcpy(m_image.data(), &header, sizeof(header));
+    packageFile.write(m_image[0], m_image.size());
+
+    if (!m_fixups.empty())
+        packageFile.write(m_fixups[0], m_fixups.size() * sizeof(RelocatableFixup));
+}
+
+bool readRelocatableImage(BinaryMemoryReader& package, u16 layoutVersion, u32 rootSize, RelocatableImage& image)
+{
+    size_t start {package.tell()};
+    RelocatableHeader header {};
+    const u8* headerData {package.view(sizeof(header))};
+
+    if (headerData == nullptr)
+        return false;
+
+    std::memcpy(&header, headerData, sizeof(header));
+
+    if (header.magic != RELOCATABLE_MAGIC || header.formatVersion != RELOCATABLE_FORMAT_VERSION)
+    {
+        LOG_ERROR(Logger::Channel::Resources, "A resource is not relocatable, or was built by an older ResourceCompiler!");
+        return false;
+    }
+
+    if (header.layoutVersion != layoutVersion || header.rootSize != rootSize)
+    {
+        LOG_ERROR(Logger::Channel::Resources, "A resource was written with layout version {} ({} bytes), but version {} ({} bytes) is expected!",
+            header.layoutVersion, header.rootSize, layoutVersion, rootSize);
+        return false;
+    }
+
+    const u8* root {package.view(rootSize)};
+    const u8* fixups {package.seek(start + header.fixupOffset).view(header.fixupCount * sizeof(RelocatableFixup))};
+
+    if (root == nullptr || fixups == nullptr)
+        return false;
+
+    for (u32 i = 0; i < header.fixupCount; i++)
+    {
+        RelocatableFixup fixup {};
+        std::memcpy(&fixup, fixups + i * sizeof(RelocatableFixup), sizeof(fixup));
+
+        // Pointers must be in the resource, and point somewhere before the fixup table.
+        if (fixup.location < sizeof(RelocatableHeader) || fixup.location + sizeof(void*) > sizeof(RelocatableHeader) + rootSize
+            || fixup.target > header.fixupOffset || header.fixupOffset < sizeof(RelocatableHeader) + rootSize)
+        {
+            LOG_ERROR(Logger::Channel::Resources, "A resource's fixup table is damaged!");
+            return false;
+        }
+    }
+
+    image = {headerData, root, fixups, header.fixupCount};
+    return true;
+}
+
+void applyFixups(const RelocatableImage& image, u8* root)
+{
+    for (u32 i = 0; i < image.fixupCount; i++)
+    {
+        RelocatableFixup fixup {};
+        std::memcpy(&fixup, image.fixups + i * sizeof(RelocatableFixup), sizeof(fixup));
+
+        const u8* target {image.start + fixup.target};
+        std::memcpy(root + (fixup.location - sizeof(RelocatableHeader)), &target, sizeof(target));
+    }
+}
@@ -0,0 +1,139 @@
+﻿#ifndef RELOCATABLE_HPP
+#define RELOCATABLE_HPP
+
+#include <concepts>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+#include "binary_memory_reader.hpp"
+#include "binary_stream_builder.hpp"
+#include "types.hpp"
+
+/*
+ * Relocatable resource layout, for resources that are used straight from the memory they were read into:
+ * 1) a RelocatableHeader
+ * 2) the resource itself, exactly as it is in memory, with every pointer zeroed
+ * 3) whatever those pointers point at (pixels and the like), each aligned to RELOCATABLE_ALIGNMENT
+ * 4) the fixup table: a RelocatableFixup per pointer in the resource, saying where it is and where it should point
+ *
+ * Offsets are measured in bytes from the start of the header. Loading is a single read of the asset, and
+ * then a patch per fixup, rather than a read per field. Since the targets are kept in the table (instead of
+ * in the pointers themselves), patching the same bytes twice gives the same result.
+ */
+
+constexpr u32 RELOCATABLE_MAGIC {0x434F4C52}; // "RLOC"
+constexpr u16 RELOCATABLE_FORMAT_VERSION {1};
+constexpr u64 RELOCATABLE_ALIGNMENT {16};
+
+struct alignas(RELOCATABLE_ALIGNMENT) RelocatableHeader
+{
+    u32 magic;
+    u16 formatVersion;
+    // The resource type's LAYOUT_VERSION, so resources written with an older layout are rejected.
+    u16 layoutVersion;
+    // sizeof the resource, which checks the layout too.
+    u32 rootSize;
+    u32 fixupCount;
+    u64 fixupOffset;
+};
+
+struct RelocatableFixup
+{
+    // Where the pointer is.
+    u64 location;
+    // Where it points.
+    u64 target;
+};
+
+/**
+ * \brief Resource types that can be written into a package as is, and used in place once they are read.
+ * \details They can't own anything (no strings, vectors or virtual functions), and point at everything else
+ * with plain pointers, which writeRelocatableBlobs(...) writes out. Only the resource's own pointers are patched,
+ * since what they point at may be read-only (like a mapped package). LAYOUT_VERSION should be bumped whenever
+ * the type changes.
+ */
+template <typename T>
+concept RelocatableResource = std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>
+    && alignof(T) <= RELOCATABLE_ALIGNMENT && requires { { T::LAYOUT_VERSION } -> std::convertible_to<u16>; };
+
+/**
+ * \brief Builds the relocatable image of a resource, see RelocatableResource.
+ */
+class RelocatableWriter
+{
+public:
+    template <RelocatableResource T>
+    explicit RelocatableWriter(const T& root)
+        : m_root{reinterpret_cast<const u8*>(&root)}, m_rootSize{sizeof(T)}, m_layoutVersion{T::LAYOUT_VERSION}
+    {
+        m_image.resize(sizeof(RelocatableHeader) + sizeof(T));
+        std::memcpy(m_image.data() + sizeof(RelocatableHeader), &root, sizeof(T));
+    }
+
+    /**
+     * \brief Copies some data into the image, and points a pointer in the resource at it.
+     * \param pointer A member of the resource this writer was made for.
+     * \return Where the data is in the image, for fixups of pointers inside it.
+     */
+    template <typename P>
+    u64 writeBlob(P* const& pointer, const void* data, size_t size)
+    {
+        u64 target {append(data, size)};
+        addFixup(locationOf(pointer), target);
+        return target;
+    }
+
+    // Where a member of the resource is in the image.
+    template <typename M>
+    u64 locationOf(const M& member) const
+    {
+        return sizeof(RelocatableHeader) + static_cast<u64>(reinterpret_cast<const u8*>(&member) - m_root);
+    }
+
+    // Appends some data to the image, aligned to RELOCATABLE_ALIGNMENT, and returns where it is.
+    u64 append(const void* data, size_t size);
+
+    // Points the pointer at location (in the resource) to target in the image. Zeroes it, since it is only patched when loaded.
+    void addFixup(u64 location, u64 target);
+
+    // Writes the header, the image and the fixup table.
+    void writeTo(BinaryStreamBuilder& packageFile);
+
+private:
+    const u8* m_root;
+    u32 m_rootSize;
+    u16 m_layoutVersion;
+
+    std::vector<u8> m_image {};
+    std::vector<RelocatableFixup> m_fixups {};
+};
+
+// A relocatable image found in memory by readRelocatableImage(...), whose fixups have been checked.
+struct RelocatableImage
+{
+    // The header, which offsets are measured from.
+    const u8* start;
+    // The resource, as it was written.
+    const u8* root;
+    // The fixup table, which may not be aligned.
+    const u8* fixups;
+    u32 fixupCount;
+};
+
+/**
+ * \brief Finds the parts of a relocatable image at the reader's position, and moves the reader past it.
+ * \return False if the reader ran past the end (see BinaryMemoryReader::failed()), or the image was written
+ * with another layout or is damaged, which is logged.
+ */
+bool readRelocatableImage(BinaryMemoryReader& package, u16 layoutVersion, u32 rootSize, RelocatableImage& image);
+
+// Points every pointer in a copy of the image's resource (or the resource itself, if it is writable) into the image.
+void applyFixups(const RelocatableImage& image, u8* root);
+
+// A template that can be specialized by relocatable resource types that point at more memory, to write what they point at.
+template <typename T>
+void writeRelocatableBlobs([[maybe_unused]] const T& resource, [[maybe_unused]] RelocatableWriter& writer)
+{
+}
+
+#endif // RELOCATABLE_HPP
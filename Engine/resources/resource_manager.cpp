@@ -1,57 +1,1065 @@
-﻿#include "resource_manager.hpp"
+﻿#include <bit>
+#include <utility>
+#include "resource_manager.hpp"
+#include "prefetch_manifest.hpp"
 #include "platform/file_system.hpp"
+#include "string_name_table.hpp"
 
 using namespace FileSystem;
 
-ResourceManager::ResourceManager(const char* packageFile): m_packageFile{packageFile}
+ResourceManager::ResourceManager(PackageAccess access) : m_access{access}
 {
-    /*
-     * Package file binary layout:
-     * 1) the number for total assets in the package
-     * 2) key-value pairs for each asset: key = name hash, value = offset from start
-     * 3) the asset data, looked up by offsets in header
-     */
+}
+
+ResourceManager::ResourceManager(const char* packageFile, PackageAccess access) : m_access{access}
+{
+    mount(packageFile);
+}
+
+ResourceManager::~ResourceManager()
+{
+    // Nothing may still be reading from the packages below.
+    while (pumpAsyncReads(true))
+    {
+    }
+
+    m_loadPool.wait();
+
+    for (ResourceShard& shard : m_shards)
+    {
+        for (std::unique_ptr<LoadedResource>& resource : shard.resources)
+        {
+            if ((resource->state.load() & LOADED) != 0)
+                resource->free(resource->data, resource->readInPlace);
+        }
+    }
+
+    // Resources may point into the packages, so they are closed last.
+    for (ResourceShard& shard : m_shards)
+        shard.resources.clear();
+
+    m_mergedIndex.clear();
+    m_banks.clear();
+}
+
+PackageId ResourceManager::mount(const char* packageFile, s32 priority)
+{
+    PackageId id {};
+    {
+        std::scoped_lock lock {m_bankMutex};
+        id = m_nextPackage++;
+    }
+
+    // Opened before anything is locked, so loads from the other packages carry on meanwhile.
+    std::shared_ptr<PackageBank> bank {PackageBank::open(packageFile, m_access, id, priority)};
+
+    if (bank == nullptr)
+        return INVALID_PACKAGE;
+
+    std::scoped_lock lock {m_bankMutex};
+
+    if (BlockCache* blockCache = bank->getBlockCache())
+        blockCache->setBudget(m_blockCacheBudget);
+
+    m_banks.push_back(bank);
+    std::vector<StringName::Hash> overridden {};
+
+    if (m_banks.size() > 1)
+    {
+        reserveMergedIndex(m_mergedCount + bank->getIndex().size() + (m_banks.size() == 2 ? m_banks.front()->getIndex().size() : 0));
+
+        // Until now, the first package was searched on its own.
+        if (m_banks.size() == 2)
+            mergeBank(*m_banks.front(), overridden);
+
+        mergeBank(*bank, overridden);
+    }
+
+    if (!overridden.empty())
+    {
+        std::scoped_lock cacheLock {m_cacheMutex};
+
+        for (StringName::Hash hash : overridden)
+            dropOverriddenResource(StringName{hash});
+    }
+
+    LOG_INFO(Logger::Channel::Resources, "Mounted {} with priority {}, overriding {} assets.", packageFile, priority, overridden.size());
+    return id;
+}
+
+bool ResourceManager::unmount(PackageId package)
+{
+    std::scoped_lock lock {m_bankMutex};
+    auto found = std::find_if(m_banks.begin(), m_banks.end(), [package](const std::shared_ptr<PackageBank>& bank)
+    {
+        return bank->getId() == package;
+    });
+
+    if (found == m_banks.end())
+    {
+        LOG_ERROR(Logger::Channel::Resources, "Cannot unmount package {}, it is not mounted!", package);
+        return false;
+    }
+
+    // Kept open by loads still reading from it, and by resources that are still referenced.
+    std::shared_ptr<PackageBank> bank {std::move(*found)};
+    m_banks.erase(found);
+
+    std::vector<StringName::Hash> dropped {};
+
+    for (const PackageIndexEntry& entry : bank->getIndex())
+    {
+        // It was the only package, so it won for everything.
+        if (m_mergedIndex.empty())
+        {
+            dropped.push_back(entry.hash);
+            continue;
+        }
+
+        u64 slot {findMergedSlot(entry.hash)};
+
+        if (m_mergedIndex[slot].bank != bank.get())
+            continue;
+
+        dropped.push_back(entry.hash);
+
+        // Falls back to whichever package wins among the ones that are left.
+        MergedIndexEntry next {.hash = entry.hash};
+
+        for (const std::shared_ptr<PackageBank>& other : m_banks)
+        {
+            const PackageIndexEntry* otherEntry {findPackageEntry(other->getIndex(), entry.hash)};
+
+            if (otherEntry != nullptr && (next.bank == nullptr || other->overrides(*next.bank)))
+                next = {entry.hash, other.get(), otherEntry};
+        }
+
+        if (next.bank != nullptr)
+            m_mergedIndex[slot] = next;
+        else
+            eraseMergedSlot(slot);
+    }
+
+    // The package that is left is searched on its own again.
+    if (m_banks.size() == 1)
+    {
+        m_mergedIndex = {};
+        m_mergedCount = 0;
+    }
+
+    if (!dropped.empty())
+    {
+        std::scoped_lock cacheLock {m_cacheMutex};
+
+        for (StringName::Hash hash : dropped)
+            dropOverriddenResource(StringName{hash});
+    }
+
+    LOG_INFO(Logger::Channel::Resources, "Unmounted {}.", bank->getFile());
+    return true;
+}
+
+ResourceManager::AssetLocation ResourceManager::findAsset(StringName resourceName)
+{
+    std::shared_lock lock {m_bankMutex};
+
+    if (m_banks.size() == 1)
+    {
+        const PackageIndexEntry* entry {findPackageEntry(m_banks.front()->getIndex(), resourceName.hash)};
+        return entry != nullptr ? AssetLocation{m_banks.front(), entry} : AssetLocation{};
+    }
+
+    if (m_mergedIndex.empty())
+        return {};
+
+    const MergedIndexEntry& merged {m_mergedIndex[findMergedSlot(resourceName.hash)]};
+
+    if (merged.bank == nullptr)
+        return {};
+
+    return {merged.bank->shared_from_this(), merged.entry};
+}
+
+u64 ResourceManager::findMergedSlot(StringName::Hash hash) const
+{
+    u64 mask {m_mergedIndex.size() - 1};
+    u64 slot {hash & mask};
+
+    while (m_mergedIndex[slot].bank != nullptr && m_mergedIndex[slot].hash != hash)
+        slot = (slot + 1) & mask;
+
+    return slot;
+}
+
+void ResourceManager::reserveMergedIndex(u64 count)
+{
+    if (count * 2 <= m_mergedIndex.size())
+        return;
+
+    std::vector<MergedIndexEntry> previous {std::exchange(m_mergedIndex, std::vector<MergedIndexEntry>(std::bit_ceil(std::max<u64>(count * 2, 16))))};
+
+    for (const MergedIndexEntry& entry : previous)
+    {
+        if (entry.bank != nullptr)
+            m_mergedIndex[findMergedSlot(entry.hash)] = entry;
+    }
+}
+
+void ResourceManager::mergeBank(PackageBank& bank, std::vector<StringName::Hash>& overridden)
+{
+    for (const PackageIndexEntry& entry : bank.getIndex())
+    {
+        MergedIndexEntry& merged {m_mergedIndex[findMergedSlot(entry.hash)]};
+
+        if (merged.bank == nullptr)
+        {
+            merged = {entry.hash, &bank, &entry};
+            m_mergedCount++;
+        }
+        else if (bank.overrides(*merged.bank))
+        {
+            merged = {entry.hash, &bank, &entry};
+            overridden.push_back(entry.hash);
+        }
+    }
+}
+
+void ResourceManager::eraseMergedSlot(u64 slot)
+{
+    u64 mask {m_mergedIndex.size() - 1};
+
+    for (u64 next = (slot + 1) & mask; m_mergedIndex[next].bank != nullptr; next = (next + 1) & mask)
+    {
+        // An entry can fill the gap unless the gap comes before the slot it hashes to.
+        u64 home {m_mergedIndex[next].hash & mask};
+
+        if (((next - home) & mask) >= ((next - slot) & mask))
+        {
+            m_mergedIndex[slot] = m_mergedIndex[next];
+            slot = next;
+        }
+    }
+
+    m_mergedIndex[slot] = {};
+    m_mergedCount--;
+}
+
+ResourceManager::ResourceShard& ResourceManager::shardOf(StringName resourceName)
+{
+    return m_shards[resourceName.hash % SHARD_COUNT];
+}
+
+ResourceManager::LoadedResource* ResourceManager::findResource(StringName resourceName)
+{
+    ResourceShard::Slots* slots {shardOf(resourceName).slots.load(std::memory_order_acquire)};
+
+    if (slots == nullptr)
+        return nullptr;
+
+    // The low bits picked the shard, so the ones above them pick the slot.
+    for (u64 i = (resourceName.hash / SHARD_COUNT) & slots->mask;; i = (i + 1) & slots->mask)
+    {
+        LoadedResource* resource {slots->slots[i].load(std::memory_order_acquire)};
+
+        if (resource == nullptr || resource->name.hash == resourceName.hash)
+            return resource;
+    }
+}
+
+ResourceManager::LoadedResource& ResourceManager::findOrInsertResource(ResourceShard& shard, StringName resourceName)
+{
+    if (LoadedResource* resource = findResource(resourceName))
+        return *resource;
+
+    auto insert = [](ResourceShard::Slots& slots, LoadedResource* resource)
+    {
+        u64 i {(resource->name.hash / SHARD_COUNT) & slots.mask};
+
+        while (slots.slots[i].load(std::memory_order_relaxed) != nullptr)
+            i = (i + 1) & slots.mask;
+
+        slots.slots[i].store(resource, std::memory_order_release);
+    };
+
+    ResourceShard::Slots* slots {shard.slots.load(std::memory_order_relaxed)};
+
+    // Kept at most three quarters full, so searches stay short.
+    if (slots == nullptr || (shard.count + 1) * 4 > (slots->mask + 1) * 3)
+    {
+        u64 capacity {slots != nullptr ? (slots->mask + 1) * 2 : 64};
+        std::unique_ptr<ResourceShard::Slots> grown {new ResourceShard::Slots{capacity - 1,
+            std::make_unique<std::atomic<LoadedResource*>[]>(capacity)}};
+
+        for (const std::unique_ptr<LoadedResource>& resource : shard.resources)
+            insert(*grown, resource.get());
+
+        slots = grown.get();
+        shard.slots.store(slots, std::memory_order_release);
+        shard.tables.push_back(std::move(grown));
+    }
+
+    shard.resources.emplace_back(new LoadedResource{.name = resourceName});
+    insert(*slots, shard.resources.back().get());
+    shard.count++;
+    return *shard.resources.back();
+}
 
-    size_t assetCount {};
-    BinaryStreamBuilder builder {packageFile};
-    builder.readFixed(&assetCount);
+bool ResourceManager::acquire(LoadedResource& resource)
+{
+    u32 state {resource.state.load(std::memory_order_relaxed)};
 
-    for (size_t i {0}; i < assetCount; i++)
+    do
     {
-        StringName::Hash hash {};
-        size_t offset {};
+        if ((state & LOADED) == 0)
+            return false;
+    }
+    while (!resource.state.compare_exchange_weak(state, state + 1));
+
+    if (state == LOADED)
+    {
+        // Back in use, so it no longer counts against the cache. It stays in the list until it reaches the end.
+        m_cachedBytes -= static_cast<s64>(resource.size);
+        m_cacheHits++;
+    }
+
+    return true;
+}
+
+bool ResourceManager::freeUnreferenced(LoadedResource& resource)
+{
+    u32 unreferenced {LOADED};
 
-        builder.readFixed(&hash);
-        builder.readFixed(&offset);
+    if (!resource.state.compare_exchange_strong(unreferenced, 0))
+        return false;
 
-        m_resourceOffsetLookup.emplace(hash, offset);
+    if (resource.isCached)
+    {
+        m_cachedResources.erase(resource.cacheEntry);
+        resource.isCached = false;
     }
+
+    m_cachedBytes -= static_cast<s64>(resource.size);
+
+    // todo: change the deallocation scheme when we change the alloc scheme in readResourceFrom(...)
+    resource.free(resource.data, resource.readInPlace);
+    resource.data = nullptr;
+    resource.buffer.reset();
+    resource.bank.reset();
+    return true;
+}
+
+void ResourceManager::dropOverriddenResource(StringName resourceName)
+{
+    LoadedResource* resource {findResource(resourceName)};
+
+    if (resource == nullptr)
+        return;
+
+    // Set first, so an unload() that lets go of it right after this frees it, instead of caching it.
+    resource->overridden.store(true);
+
+    // Whoever still holds it keeps what they have, and the next load after them reads it again.
+    std::scoped_lock lock {shardOf(resourceName).mutex};
+    freeUnreferenced(*resource);
 }
 
 void ResourceManager::unload(StringName resourceName)
 {
     Logger::DefaultLogChannelJanitor janitor {Logger::Channel::Resources};
+    LoadedResource* resource {findResource(resourceName)};
+    u32 state {resource != nullptr ? resource->state.load(std::memory_order_relaxed) : 0};
+    u64 size {};
+
+    do
+    {
+        if ((state & LOADED) == 0 || state == LOADED)
+        {
+            LOG_ERROR(Logger::Channel::Resources, "Cannot unload a resource before it is loaded!");
+            return;
+        }
+
+        // Read while we still hold a reference, since nothing stops it being freed after.
+        size = resource->size;
+    }
+    while (!resource->state.compare_exchange_weak(state, state - 1));
+
+    if (state - 1 != LOADED)
+    {
+        LOG_INFO(Logger::Channel::Resources, "Decreased ref count on {} to {}", resourceName, (state - 1) & ~LOADED);
+        return;
+    }
+
+    m_cachedBytes += static_cast<s64>(size);
+    std::scoped_lock lock {m_cacheMutex};
+
+    if (resource->overridden.load())
+    {
+        // Another package has won for it since it was loaded, so it is read again next time.
+        std::scoped_lock shardLock {shardOf(resourceName).mutex};
+
+        if (freeUnreferenced(*resource))
+            LOG_INFO(Logger::Channel::Resources, "Ref count for {} reached 0, and it was overridden, so it was freed", resourceName);
+
+        return;
+    }
+
+    // Nobody else is using this resource, but keep it around in case it is loaded again soon.
+    if (resource->isCached)
+        m_cachedResources.erase(resource->cacheEntry);
+
+    m_cachedResources.push_front(resource);
+    resource->cacheEntry = m_cachedResources.begin();
+    resource->isCached = true;
+    LOG_INFO(Logger::Channel::Resources, "Ref count for {} reached 0, so it was cached", resourceName);
+    evictCachedResources();
+}
+
+void ResourceManager::setCacheBudget(u64 bytes)
+{
+    std::scoped_lock lock {m_cacheMutex};
+    m_cacheBudget = bytes;
+    evictCachedResources();
+}
+
+ResourceCacheStats ResourceManager::getCacheStats()
+{
+    return {m_cacheHits.load(), m_cacheMisses.load(), m_cacheEvictions.load(), static_cast<u64>(std::max<s64>(m_cachedBytes.load(), 0)),
+        m_cacheBudget.load()};
+}
+
+void ResourceManager::setBlockCacheBudget(u64 bytes)
+{
+    std::scoped_lock lock {m_bankMutex};
+    m_blockCacheBudget = bytes;
+
+    for (const std::shared_ptr<PackageBank>& bank : m_banks)
+    {
+        if (BlockCache* blockCache = bank->getBlockCache())
+            blockCache->setBudget(bytes);
+    }
+}
+
+BlockCacheStats ResourceManager::getBlockCacheStats()
+{
+    std::shared_lock lock {m_bankMutex};
+    BlockCacheStats result {};
+
+    for (const std::shared_ptr<PackageBank>& bank : m_banks)
+    {
+        if (BlockCache* blockCache = bank->getBlockCache())
+        {
+            BlockCacheStats stats {blockCache->getStats()};
+            result.hits += stats.hits;
+            result.misses += stats.misses;
+            result.prefetches += stats.prefetches;
+            result.evictions += stats.evictions;
+            result.cachedBytes += stats.cachedBytes;
+            result.budget += stats.budget;
+        }
+    }
+
+    return result;
+}
 
-    if (m_loadedResourceTable.contains(resourceName))
+void ResourceManager::evictCachedResources()
+{
+    while (m_cachedBytes.load() > static_cast<s64>(m_cacheBudget.load()) && !m_cachedResources.empty())
     {
-        LoadedResource& resource = m_loadedResourceTable[resourceName];
-        resource.referenceCount--;
+        LoadedResource& resource {*m_cachedResources.back()};
+        std::scoped_lock lock {shardOf(resource.name).mutex};
 
-        if (resource.referenceCount == 0)
+        if (freeUnreferenced(resource))
         {
-            // Nobody else is using this resource, so fully unload it.
-            // todo: change the deallocation scheme when we change the alloc scheme in readResourceFrom(...)
-            free(const_cast<void*>(resource.data));
-            m_loadedResourceTable.erase(resourceName);
-            Logger::log_info("Ref count for {} reached 0, so it was unloaded", resourceName.hash);
+            m_cacheEvictions++;
+            LOG_INFO(Logger::Channel::Resources, "{} was evicted from the cache", resource.name);
         }
         else
         {
-            Logger::log_info("Decreased ref count on {} to {}", resourceName.hash, resource.referenceCount);
+            // Referenced again since it was cached, so it only leaves the list.
+            m_cachedResources.pop_back();
+            resource.isCached = false;
+        }
+    }
+}
+
+std::unique_ptr<u8[]> ResourceManager::readAsset(StringName resourceName, const AssetLocation& location, LoadTimings& timings)
+{
+    const PackageIndexEntry& entry {*location.entry};
+    const MappedFile* mappedPackage {location.bank->getMappedFile()};
+    std::span<const u8> stored {};
+    std::vector<u8> streamed {};
+
+    if (mappedPackage != nullptr)
+    {
+        BinaryMemoryReader reader {mappedPackage->data(), mappedPackage->size()};
+        const u8* data {reader.seek(entry.offset).view(entry.compressedSize)};
+
+        if (data == nullptr)
+        {
+            LOG_ERROR(Logger::Channel::Resources, "Cannot load {}, it runs past the end of the package!", resourceName);
+            return nullptr;
+        }
+
+        stored = {data, entry.compressedSize};
+    }
+    else if (entry.compressedSize == entry.size)
+    {
+        // Nothing to decompress, so read straight into the buffer the resource keeps.
+        std::unique_ptr<u8[]> buffer {new u8[entry.size]};
+        u64 ioStart {timestamp()};
+        bool succeeded {readStoredAsset(buffer.get(), location)};
+        timings.ioNanoseconds = elapsedSince(ioStart);
+        return succeeded ? std::move(buffer) : nullptr;
+    }
+    else
+    {
+        streamed.resize(entry.compressedSize);
+        u64 ioStart {timestamp()};
+        bool succeeded {readStoredAsset(streamed.data(), location)};
+        timings.ioNanoseconds = elapsedSince(ioStart);
+
+        if (!succeeded)
+            return nullptr;
+
+        stored = streamed;
+    }
+
+    return unpackResource(resourceName, entry, stored, timings);
+}
+
+bool ResourceManager::readStoredAsset(void* destination, const AssetLocation& location)
+{
+    const PackageIndexEntry& entry {*location.entry};
+
+    // Bigger assets are worth a read of their own, and would push many small ones out of the cache.
+    if (entry.compressedSize <= BlockCache::BLOCK_SIZE)
+        return location.bank->getBlockCache()->read(destination, entry.compressedSize, entry.offset);
+
+    return location.bank->getStreamedFile()->readAt(destination, entry.compressedSize, entry.offset);
+}
+
+std::unique_ptr<u8[]> ResourceManager::unpackResource(StringName resourceName, const PackageIndexEntry& entry, std::span<const u8> stored,
+    LoadTimings& timings)
+{
+    std::unique_ptr<u8[]> buffer {new u8[entry.size]};
+
+    if (entry.compressedSize == entry.size)
+    {
+        if (!stored.empty())
+            std::memcpy(buffer.get(), stored.data(), stored.size());
+
+        return buffer;
+    }
+
+    // Chunks are decompressed straight into the final buffer, in parallel.
+    u64 decompressStart {timestamp()};
+    bool succeeded {decompressPackageAsset(entry, stored, buffer.get(), m_decompressPool)};
+    timings.decompressNanoseconds += elapsedSince(decompressStart);
+
+    if (!succeeded)
+    {
+        LOG_ERROR(Logger::Channel::Resources, "Cannot load {}, it is damaged!", resourceName);
+        return nullptr;
+    }
+
+    return buffer;
+}
+
+void ResourceManager::readMerged(PackageBank& bank, std::span<const PackageIndexEntry* const> entries,
+    const std::function<void(size_t index, std::unique_ptr<u8[]> stored, u64 ioNanoseconds)>& onRead)
+{
+    // A range of the package read in one go, holding entries [first, last).
+    struct MergedRead
+    {
+        size_t first;
+        size_t last;
+        u64 start;
+        u64 end;
+    };
+
+    File* package {bank.getStreamedFile()};
+    std::vector<MergedRead> reads {};
+
+    for (size_t first = 0; first < entries.size();)
+    {
+        MergedRead read {first, first + 1, entries[first]->offset, entries[first]->offset + entries[first]->compressedSize};
+
+        // Grow the read over every asset that starts soon after it.
+        for (; read.last < entries.size(); read.last++)
+        {
+            const PackageIndexEntry& entry {*entries[read.last]};
+
+            if (entry.offset < read.end || entry.offset > read.end + BATCH_MAX_GAP
+                || entry.offset + entry.compressedSize - read.start > BATCH_MAX_READ)
+                break;
+
+            read.end = entry.offset + entry.compressedSize;
+        }
+
+        reads.push_back(read);
+        first = read.last;
+    }
+
+    // Lets the OS fetch the later ranges while the earlier ones are being read and decoded.
+    for (size_t i = 1; i < reads.size(); i++)
+        package->adviseAccess(AccessHint::WillNeed, reads[i].start, reads[i].end - reads[i].start);
+
+    // Every gap is read into the same place, since it is thrown away.
+    std::vector<u8> gap(BATCH_MAX_GAP);
+    std::vector<std::unique_ptr<u8[]>> stored {};
+    std::vector<std::span<u8>> destinations {};
+
+    for (const MergedRead& read : reads)
+    {
+        stored.clear();
+        destinations.clear();
+        u64 position {read.start};
+
+        for (size_t i = read.first; i < read.last; i++)
+        {
+            if (entries[i]->offset > position)
+                destinations.emplace_back(gap.data(), entries[i]->offset - position);
+
+            stored.emplace_back(new u8[entries[i]->compressedSize]);
+            destinations.emplace_back(stored.back().get(), entries[i]->compressedSize);
+            position = entries[i]->offset + entries[i]->compressedSize;
+        }
+
+        u64 ioStart {timestamp()};
+        bool succeeded {package->readAtScattered(destinations, read.start)};
+        f64 nanosecondsPerByte {static_cast<f64>(elapsedSince(ioStart)) / static_cast<f64>(read.end - read.start)};
+
+        for (size_t i = read.first; i < read.last; i++)
+        {
+            u64 ioNanoseconds {static_cast<u64>(nanosecondsPerByte * static_cast<f64>(entries[i]->compressedSize))};
+            onRead(i, succeeded ? std::move(stored[i - read.first]) : nullptr, ioNanoseconds);
+        }
+    }
+}
+
+PackageAccess ResourceManager::getAccess(PackageId package)
+{
+    std::shared_lock lock {m_bankMutex};
+
+    for (const std::shared_ptr<PackageBank>& bank : m_banks)
+    {
+        if (package == INVALID_PACKAGE || bank->getId() == package)
+            return bank->getAccess();
+    }
+
+    return m_access;
+}
+
+void ResourceManager::setTelemetryEnabled(bool enabled)
+{
+    m_telemetryEnabled = enabled;
+}
+
+LoadTelemetry& ResourceManager::getTelemetry()
+{
+    return m_telemetry;
+}
+
+u64 ResourceManager::timestamp() const
+{
+    return m_telemetryEnabled.load(std::memory_order_relaxed) ? LoadTelemetry::now() : 0;
+}
+
+u64 ResourceManager::elapsedSince(u64 start) const
+{
+    return start != 0 ? LoadTelemetry::now() - start : 0;
+}
+
+u64 ResourceManager::getFrame() const
+{
+    return m_frame.load(std::memory_order_relaxed);
+}
+
+void ResourceManager::startAccessTrace()
+{
+    std::scoped_lock lock {m_traceMutex};
+    m_trace.clear();
+    m_tracedAssets.clear();
+    m_tracing = true;
+}
+
+std::vector<StringName> ResourceManager::stopAccessTrace()
+{
+    std::scoped_lock lock {m_traceMutex};
+    m_tracing = false;
+    m_tracedAssets.clear();
+
+    std::vector<StringName> trace {};
+    trace.swap(m_trace);
+    return trace;
+}
+
+void ResourceManager::traceAccess(StringName resourceName)
+{
+    std::scoped_lock lock {m_traceMutex};
+
+    // Checked again under the lock, so nothing is added after the trace was stopped.
+    if (m_tracing.load(std::memory_order_relaxed) && m_tracedAssets.insert(resourceName.hash).second)
+        m_trace.push_back(resourceName);
+}
+
+bool ResourceManager::startPrefetch(StringName manifestName, u32 distance)
+{
+    stopPrefetch();
+
+    ResourceHandle<PrefetchManifest> manifest {load<PrefetchManifest>(manifestName)};
+
+    if (manifest.data == nullptr)
+    {
+        LOG_ERROR(Logger::Channel::Resources, "Failed to load prefetch manifest {}!", manifestName);
+        return false;
+    }
+
+    const PrefetchManifest* previous {};
+    StringName::Hash previousName {};
+
+    {
+        std::scoped_lock lock {m_prefetchMutex};
+        // Someone else may have started prefetching meanwhile.
+        previous = std::exchange(m_prefetchManifest, manifest.data);
+        previousName = std::exchange(m_prefetchManifestName, manifestName.hash);
+
+        m_prefetchPositions.clear();
+        m_prefetchPositions.reserve(manifest.data->assetCount);
+
+        for (u32 i = 0; i < manifest.data->assetCount; i++)
+            m_prefetchPositions.emplace(manifest.data->assets[i], i);
+
+        m_prefetchNext = 0;
+        m_prefetchDistance = distance;
+        m_prefetchStats = {};
+
+        // Nothing has been asked for yet, so the start of the session is read ahead right away.
+        readAheadUntil(distance);
+        m_prefetching = true;
+    }
+
+    if (previous != nullptr)
+        unload(StringName{previousName});
+
+    return true;
+}
+
+void ResourceManager::stopPrefetch()
+{
+    const PrefetchManifest* manifest {};
+    StringName::Hash manifestName {};
+
+    {
+        std::scoped_lock lock {m_prefetchMutex};
+        m_prefetching = false;
+        manifest = std::exchange(m_prefetchManifest, nullptr);
+        manifestName = m_prefetchManifestName;
+        m_prefetchPositions.clear();
+    }
+
+    if (manifest != nullptr)
+        unload(StringName{manifestName});
+}
+
+PrefetchStats ResourceManager::getPrefetchStats()
+{
+    std::scoped_lock lock {m_prefetchMutex};
+    return m_prefetchStats;
+}
+
+void ResourceManager::advancePrefetch(StringName resourceName)
+{
+    std::scoped_lock lock {m_prefetchMutex};
+
+    if (m_prefetchManifest == nullptr)
+        return;
+
+    auto position = m_prefetchPositions.find(resourceName.hash);
+
+    if (position == m_prefetchPositions.end())
+    {
+        m_prefetchStats.strayed++;
+        return;
+    }
+
+    m_prefetchStats.followed++;
+
+    // When the session jumps ahead, the assets it skipped aren't worth reading anymore.
+    u32 next {position->second + 1};
+    m_prefetchNext = std::max(m_prefetchNext, next);
+    readAheadUntil(next + m_prefetchDistance);
+}
+
+void ResourceManager::readAheadUntil(u32 end)
+{
+    end = std::min(end, m_prefetchManifest->assetCount);
+
+    for (; m_prefetchNext < end; m_prefetchNext++)
+        readAhead(StringName{m_prefetchManifest->assets[m_prefetchNext]});
+}
+
+void ResourceManager::readAhead(StringName resourceName)
+{
+    // Loaded (or cached) resources won't read their asset again.
+    LoadedResource* resource {findResource(resourceName)};
+
+    if (resource != nullptr && (resource->state.load(std::memory_order_relaxed) & LOADED) != 0)
+        return;
+
+    AssetLocation location {findAsset(resourceName)};
+
+    if (location.bank == nullptr)
+        return;
+
+    const PackageIndexEntry& entry {*location.entry};
+
+    // Each of these only starts the reads, and returns right away.
+    if (location.bank->getAccess() == PackageAccess::Mapped)
+        location.bank->getMappedFile()->adviseAccess(AccessHint::WillNeed, entry.offset, entry.compressedSize);
+    else if (entry.compressedSize <= BlockCache::BLOCK_SIZE)
+        location.bank->getBlockCache()->readAhead(entry.offset, entry.compressedSize);
+    else
+        location.bank->getStreamedFile()->adviseAccess(AccessHint::WillNeed, entry.offset, entry.compressedSize);
+
+    m_prefetchStats.readAhead++;
+}
+
+void ResourceManager::update()
+{
+    m_frame.fetch_add(1, std::memory_order_relaxed);
+    pumpAsyncReads(false);
+
+    std::vector<std::function<void()>> callbacks {};
+    {
+        std::scoped_lock lock {m_callbackMutex};
+        callbacks.swap(m_finishedCallbacks);
+    }
+
+    // Run without the lock held, so callbacks can load more resources.
+    for (std::function<void()>& callback : callbacks)
+        callback();
+}
+
+ResourceManager::LoadRequest ResourceManager::beginLoad(StringName resourceName, bool isAsync, std::function<void(const void* data)> onLoaded)
+{
+    if (m_tracing.load(std::memory_order_relaxed))
+        traceAccess(resourceName);
+
+    if (m_prefetching.load(std::memory_order_relaxed))
+        advancePrefetch(resourceName);
+
+    LoadedResource* resource {findResource(resourceName)};
+
+    // Already loaded is the common case, and takes no lock at all.
+    if (resource == nullptr || !acquire(*resource))
+    {
+        ResourceShard& shard {shardOf(resourceName)};
+        std::scoped_lock lock {shard.mutex};
+        resource = &findOrInsertResource(shard, resourceName);
+
+        // Loads only finish under the lock, so this is the last chance one finished first.
+        if (!acquire(*resource))
+        {
+            if (resource->pending != nullptr)
+            {
+                resource->pending->requestCount++;
+
+                if (onLoaded)
+                    resource->pending->callbacks.push_back(std::move(onLoaded));
+
+                if (m_telemetryEnabled.load(std::memory_order_relaxed))
+                    m_telemetry.recordHit(resourceName, getFrame());
+
+                return {nullptr, resource->pending, false};
+            }
+
+            auto load {std::make_shared<PendingResourceLoad>()};
+            load->frame = getFrame();
+
+            if (onLoaded)
+                load->callbacks.push_back(std::move(onLoaded));
+
+            // Read from whichever package wins now. Only a mount or unmount after this can override it.
+            resource->overridden.store(false);
+            resource->pending = load;
+            m_cacheMisses++;
+            return {nullptr, load, true};
         }
     }
+
+    if (m_telemetryEnabled.load(std::memory_order_relaxed))
+        m_telemetry.recordHit(resourceName, getFrame());
+
+    const void* data {resource->data};
+
+    if (!isAsync)
+        return {data, nullptr, false};
+
+    // Already done, but asynchronous callers still expect a handle, and their callback on the next update().
+    auto load {std::make_shared<PendingResourceLoad>()};
+    load->data = data;
+    load->state.store(LoadState::Loaded, std::memory_order_release);
+
+    if (onLoaded)
+    {
+        std::scoped_lock callbackLock {m_callbackMutex};
+        m_finishedCallbacks.emplace_back([onLoaded = std::move(onLoaded), data] { onLoaded(data); });
+    }
+
+    return {data, load, false};
+}
+
+void ResourceManager::queueAsyncRead(const AssetLocation& location, std::function<void(std::unique_ptr<u8[]> stored, u64 ioNanoseconds)> finish)
+{
+    const PackageIndexEntry& entry {*location.entry};
+    std::unique_ptr<u8[]> stored {new u8[entry.compressedSize]};
+    u64 queuedAt {timestamp()};
+
+    // Small assets that are already cached don't need a read at all.
+    if (entry.compressedSize <= BlockCache::BLOCK_SIZE
+        && location.bank->getBlockCache()->readCached(stored.get(), entry.compressedSize, entry.offset))
+    {
+        auto read {std::make_shared<AsyncRead>(AsyncRead{location.bank, std::move(stored), std::move(finish), queuedAt})};
+        u64 ioNanoseconds {elapsedSince(queuedAt)};
+        m_loadPool.submit([read, ioNanoseconds] { read->finish(std::move(read->stored), ioNanoseconds); });
+        return;
+    }
+
+    std::scoped_lock lock {m_asyncReadMutex};
+    u64 id {m_nextAsyncRead++};
+    AsyncRead& read {m_asyncReads.emplace(id, AsyncRead{location.bank, std::move(stored), std::move(finish), queuedAt}).first->second};
+
+    auto bank = std::find_if(m_asyncReadBanks.begin(), m_asyncReadBanks.end(), [&](const auto& reads)
+    {
+        return reads.first == location.bank;
+    });
+
+    if (bank != m_asyncReadBanks.end())
+        bank->second++;
     else
+        m_asyncReadBanks.emplace_back(location.bank, 1);
+
+    // Started with the rest of this frame's reads, by the next update() (or whoever waits first).
+    location.bank->getStreamedFile()->queueRead(read.stored.get(), entry.compressedSize, entry.offset, id);
+}
+
+bool ResourceManager::pumpAsyncReads(bool wait)
+{
+    std::unique_lock lock {m_asyncReadMutex, std::defer_lock};
+
+    // Someone is already blocked in here waiting for their load, and collects for everyone.
+    if (wait)
+        lock.lock();
+    else if (!lock.try_lock())
+        return true;
+
+    if (m_asyncReads.empty())
+        return false;
+
+    for (auto& [bank, reads] : m_asyncReadBanks)
+        bank->getStreamedFile()->submitReads();
+
+    u32 completed {};
+
+    for (auto& [bank, reads] : m_asyncReadBanks)
+    {
+        u32 count {completeAsyncReads(*bank, false)};
+        reads -= count;
+        completed += count;
+    }
+
+    // Nothing was done yet, so block on one package. Whoever still waits pumps again for the others.
+    if (wait && completed == 0)
+        m_asyncReadBanks.front().second -= completeAsyncReads(*m_asyncReadBanks.front().first, true);
+
+    std::erase_if(m_asyncReadBanks, [](const auto& reads) { return reads.second == 0; });
+    return !m_asyncReads.empty();
+}
+
+u32 ResourceManager::completeAsyncReads(PackageBank& bank, bool wait)
+{
+    ReadCompletion completions[64] {};
+    u32 count {bank.getStreamedFile()->completeReads(completions, wait)};
+
+    for (u32 i = 0; i < count; i++)
+    {
+        auto read {std::make_shared<AsyncRead>(std::move(m_asyncReads.extract(completions[i].userData).mapped()))};
+
+        u64 ioNanoseconds {elapsedSince(read->queuedAt)};
+
+        if (!completions[i].succeeded)
+            read->stored.reset();
+
+        // Decoded off this thread, since it may be the main thread in update().
+        m_loadPool.submit([read, ioNanoseconds] { read->finish(std::move(read->stored), ioNanoseconds); });
+    }
+
+    return count;
+}
+
+void ResourceManager::finishLoad(StringName resourceName, PendingResourceLoad& load, ReadResource resource, void (*free)(const void*, bool))
+{
+    const void* data {resource.data};
+
+    // A package may have been mounted or unmounted while this was read. Checked before the shard's mutex, which
+    // they take inside m_bankMutex. One that changes the winner after this marks the resource overridden itself.
+    bool overridden {data != nullptr && findAsset(resourceName).bank != resource.bank};
+
     {
-        Logger::log_error("Cannot unload a resource before it is loaded!");
+        std::scoped_lock lock {shardOf(resourceName).mutex};
+        LoadedResource& loaded {*findResource(resourceName)};
+        loaded.pending.reset();
+
+        if (data != nullptr)
+        {
+            loaded.data = data;
+            loaded.readInPlace = resource.readInPlace;
+            loaded.free = resource.inBuffer ? &freeNothing : free;
+            loaded.buffer = std::move(resource.buffer);
+            loaded.size = resource.size;
+            loaded.bank = std::move(resource.bank);
+
+            if (overridden)
+                loaded.overridden.store(true);
+
+            // Every request that joined this load gets its own reference.
+            loaded.state.store(LOADED | load.requestCount, std::memory_order_release);
+        }
+
+        // Queued before anyone can see the load finish, so an update() right after wait() runs them.
+        if (!load.callbacks.empty())
+        {
+            std::scoped_lock callbackLock {m_callbackMutex};
+
+            for (std::function<void(const void* data)>& callback : load.callbacks)
+                m_finishedCallbacks.emplace_back([callback = std::move(callback), data] { callback(data); });
+
+            load.callbacks.clear();
+        }
+
+        load.data = data;
+        load.state.store(data != nullptr ? LoadState::Loaded : LoadState::Failed, std::memory_order_release);
     }
+
+    // Taken once, so a waiter can't miss the notification between checking the state and sleeping.
+    {
+        std::scoped_lock lock {m_loadFinishedMutex};
+    }
+
+    m_loadFinished.notify_all();
+
+    if (m_telemetryEnabled.load(std::memory_order_relaxed))
+        m_telemetry.recordMiss(resourceName, load.frame, resource.timings, resource.size, data != nullptr);
+}
+
+void ResourceManager::waitFor(const PendingResourceLoad& load)
+{
+    // The load may be an asynchronous read nobody has started yet, so start and collect reads until it is done.
+    while (load.state.load(std::memory_order_acquire) == LoadState::Loading && pumpAsyncReads(true))
+    {
+    }
+
+    std::unique_lock lock {m_loadFinishedMutex};
+    m_loadFinished.wait(lock, [&load] { return load.state.load(std::memory_order_acquire) != LoadState::Loading; });
 }
@@ -1,16 +1,35 @@
 ﻿#ifndef RESOURCE_MANAGER_HPP
 #define RESOURCE_MANAGER_HPP
 
-// todo: support for async loading
 // todo: singleton might make multithreading bad? we do really only want one instance of stuff loaded though. just go async if you want to avoid blocking
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "binary_memory_reader.hpp"
 #include "binary_stream_builder.hpp"
+#include "block_cache.hpp"
+#include "load_telemetry.hpp"
 #include "logger.hpp"
+#include "package.hpp"
+#include "package_bank.hpp"
+#include "relocatable.hpp"
+#include "platform/file_system.hpp"
+#include "thread_pool.hpp"
 #include "types.hpp"
 #include "string_name.hpp"
 
 class ResourceManager;
+struct PrefetchManifest;
 
 /**
  * \brief A handle to some resource managed by a ResourceManager.
@@ -23,84 +42,892 @@ struct ResourceHandle
     const T* data;
 };
 
-// A template that should be specialized by each new resource type, so we know how to write it into a package.
+/**
+ * \brief Writes a resource into a package.
+ * \details Relocatable resources (see RelocatableResource) are written as a relocatable image. Every other
+ * resource type should specialize this, so we know how to write it.
+ */
 template <typename T>
 void writeResourceTo(T* resource, BinaryStreamBuilder& packageFile)
 {
-    log_error(Logger::Channel::Resources, "Failed to find specialization for writing resource {}!", typeid(T).name());
+    if constexpr (RelocatableResource<T>)
+    {
+        RelocatableWriter writer {*resource};
+        writeRelocatableBlobs(*resource, writer);
+        writer.writeTo(packageFile);
+    }
+    else
+    {
+        LOG_ERROR(Logger::Channel::Resources, "Failed to find specialization for writing resource {}!", typeid(T).name());
+    }
 };
 
-// A template that should be specialized by each new resource type, so we know how to read it from a package.
+/**
+ * \brief Reads a resource out of a package.
+ * \details Resources are always read from memory: a mapped package, or a buffer holding just their asset.
+ * Relocatable resources are copied out of their image (which may be read-only), with their pointers patched
+ * to point straight into it. Every other resource type should specialize this, so we know how to read it.
+ * Large blobs (like pixels) should point straight into the package with BinaryMemoryReader::view(),
+ * instead of being copied. That memory is read-only, and lives as long as the resource.
+ */
 template <typename T>
-T* readResourceFrom(BinaryStreamBuilder& packageFile)
+T* readResourceInPlace(BinaryMemoryReader& package)
 {
-    log_error(Logger::Channel::Resources, "Failed to find specialization for reading resource {}!", typeid(T).name());
-    return nullptr;
+    if constexpr (RelocatableResource<T>)
+    {
+        RelocatableImage image {};
+
+        if (!readRelocatableImage(package, T::LAYOUT_VERSION, sizeof(T), image))
+            return nullptr;
+
+        T* resource {new T};
+        std::memcpy(static_cast<void*>(resource), image.root, sizeof(T));
+        applyFixups(image, reinterpret_cast<u8*>(resource));
+        return resource;
+    }
+    else
+    {
+        LOG_ERROR(Logger::Channel::Resources, "Failed to find specialization for reading resource {} in place!", typeid(T).name());
+        return nullptr;
+    }
 }
 
+// A template that can be specialized by resource types that own more memory, so we know how to free them.
+// Resources that were read in place must not free anything that points into the package.
+template <typename T>
+void freeResource(T* resource, [[maybe_unused]] bool readInPlace)
+{
+    delete resource;
+}
+
+// How far along an asynchronous load is.
+enum class LoadState
+{
+    Loading,
+    Loaded,
+    // The resource is not in the package, or could not be read.
+    Failed,
+};
+
+// The shared state of one load. Every request for the same resource waits on the same one.
+struct PendingResourceLoad
+{
+    std::atomic<LoadState> state {LoadState::Loading};
+    // Only valid once the state is no longer Loading.
+    const void* data {};
+    // How many requests are waiting on this load. Each one holds a reference once it finishes.
+    u32 requestCount {1};
+    // Queued to run in ResourceManager::update() once the load finishes.
+    std::vector<std::function<void(const void* data)>> callbacks {};
+    // The frame the load was requested in, for LoadTelemetry.
+    u64 frame {};
+};
+
+// How well the cache of unreferenced resources is doing, see ResourceManager::setCacheBudget(...).
+struct ResourceCacheStats
+{
+    // Loads of an unreferenced resource that was still cached.
+    u64 hits;
+    // Loads that had to read the package.
+    u64 misses;
+    // Unreferenced resources that were freed to stay within the budget.
+    u64 evictions;
+    // The size of every cached resource, as it is in the package once decompressed.
+    u64 cachedBytes;
+    u64 budget;
+};
+
+// How closely requests follow a prefetch manifest, see ResourceManager::startPrefetch(...).
+struct PrefetchStats
+{
+    // Requests for an asset in the manifest, and for one it doesn't have.
+    u64 followed;
+    u64 strayed;
+    // Assets whose reads were started ahead of the game.
+    u64 readAhead;
+};
+
+/**
+ * \brief A resource that may still be loading in the background, returned by ResourceManager::loadAsync().
+ * \details Once the load finishes, this holds one reference to the resource, just like load() does.
+ */
+template <typename T>
+class AsyncResourceHandle
+{
+public:
+    AsyncResourceHandle(ResourceManager* manager, StringName name, std::shared_ptr<PendingResourceLoad> load);
+
+    StringName getName() const;
+
+    // Has the load finished (or failed)? Never blocks.
+    bool isReady() const;
+
+    // Blocks until the load has finished. The data is null if it failed.
+    ResourceHandle<T> wait() const;
+
+private:
+    ResourceManager* m_manager;
+    StringName m_name;
+    std::shared_ptr<PendingResourceLoad> m_load;
+};
+
 /**
  * \brief A system that keeps track of loaded resources and
  * serves them by hashed string ID's.
+ * \details Safe to use from any number of threads. Loading a resource that is already loaded (or cached)
+ * doesn't take a lock at all, and neither does unloading one that is still referenced elsewhere.
  */
 class ResourceManager
 {
 public:
-    explicit ResourceManager(const char* packageFile);
+    // Starts with no packages mounted. Every package mounted later is read with the given access.
+    explicit ResourceManager(PackageAccess access = PackageAccess::Mapped);
+
+    // Mounts a package right away, see mount().
+    explicit ResourceManager(const char* packageFile, PackageAccess access = PackageAccess::Mapped);
+    ~ResourceManager();
+
+    ResourceManager(const ResourceManager&) = delete;
+    ResourceManager& operator=(const ResourceManager&) = delete;
 
+    // Loads a resource on the calling thread. If it is already loading in the background, waits for that instead.
     template <typename T>
     ResourceHandle<T> load(StringName resourceName);
 
+    /**
+     * \brief Starts loading a resource on a worker thread, without blocking.
+     * \details Requests for a resource that is already loading share that load, rather than reading it again.
+     * Each request still holds its own reference once the load finishes.
+     * \param onLoaded Called on the main thread, from update(), once the load has finished. The data is null if it failed.
+     */
+    template <typename T>
+    AsyncResourceHandle<T> loadAsync(StringName resourceName, std::function<void(ResourceHandle<T>)> onLoaded = {});
+
+    /**
+     * \brief Loads many resources on the calling thread at once, like calling load() for each of them.
+     * \details Reads are sorted by where they are in the package, and reads that are close together are
+     * merged into one, so loading a level streams through the package instead of seeking around it.
+     * \return A handle for each name, in the same order.
+     */
+    template <typename T>
+    std::vector<ResourceHandle<T>> loadBatch(std::span<const StringName> resourceNames);
+
+    /**
+     * \brief Mounts a package, so the assets in it can be loaded.
+     * \details Where several mounted packages have the same asset, the one with the highest priority wins, and then
+     * the one mounted last. Cached resources it overrides are freed, but resources that are still referenced keep
+     * what they were loaded from until nobody references them, as do loads that already started reading. Takes time
+     * in the size of this package's index only, however many are mounted.
+     * Falls back to PackageAccess::Streamed if the package can't be mapped.
+     * \return INVALID_PACKAGE if the package can't be read.
+     */
+    PackageId mount(const char* packageFile, s32 priority = 0);
+
+    /**
+     * \brief Unmounts a package, so its assets fall back to whichever mounted package has them next.
+     * \details Cached resources from it are freed. Resources that are still referenced keep it open until they are.
+     * Only the assets it wins for are looked up again, in the packages that are left.
+     * \return False if the package isn't mounted.
+     */
+    bool unmount(PackageId package);
+
+    /**
+     * \brief Drops a reference to a resource.
+     * \details Once nobody uses it anymore it is cached rather than freed, so loading it again soon doesn't
+     * go back to the package. The least recently used cached resources are freed once the budget is exceeded.
+     */
     void unload(StringName resourceName);
 
+    // Sets how many bytes of unreferenced resources are kept, and evicts right away if there are too many.
+    // Zero frees every resource as soon as it is unloaded.
+    void setCacheBudget(u64 bytes);
+
+    ResourceCacheStats getCacheStats();
+
+    // Sets how much of each streamed package is kept in memory, as blocks small reads are served from.
+    void setBlockCacheBudget(u64 bytes);
+
+    // Summed over every mounted package. All zero unless packages are streamed.
+    BlockCacheStats getBlockCacheStats();
+
+    /**
+     * \brief Runs the callbacks of every asynchronous load that has finished. Call this once per frame, on the main thread.
+     * \details With PackageAccess::Streamed, this also starts the reads loadAsync() queued since the last update,
+     * all at once, and collects the ones that finished.
+     */
+    void update();
+
+    // How a mounted package is read. Without a package, the first one that is still mounted.
+    PackageAccess getAccess(PackageId package = INVALID_PACKAGE);
+
+    /**
+     * \brief Starts (or stops) recording every request into getTelemetry(): how much each load read, how long it
+     * spent reading, decompressing and decoding, whether it hit, and the frame it was requested in.
+     * \details Off by default, and costs nothing while it is off. While it is on, every request takes a lock.
+     */
+    void setTelemetryEnabled(bool enabled);
+
+    LoadTelemetry& getTelemetry();
+
+    // How many times update() has been called, which telemetry counts as the frame.
+    u64 getFrame() const;
+
+    /**
+     * \brief Starts recording which assets are asked for, in the order they are first asked for.
+     * \details Restarts the trace if one is being recorded. The ResourceCompiler builds a PrefetchManifest out of
+     * a trace written with writeAccessTrace(...). While it is on, every request takes a lock.
+     */
+    void startAccessTrace();
+
+    // Stops recording, and returns every asset asked for since startAccessTrace(), in order.
+    std::vector<StringName> stopAccessTrace();
+
+    /**
+     * \brief Reads ahead of the game along a prefetch manifest, until stopPrefetch().
+     * \details Every request for an asset in the manifest moves along it, and starts reading the next few assets
+     * in the background, so they are in memory by the time they are asked for. Only the reads are done ahead:
+     * the manifest doesn't know what type each asset is, so nothing is decoded or referenced, and a wrong guess
+     * only costs memory the OS (or the block cache) takes back. Mapped packages are paged in, and streamed ones
+     * read into the block cache, or the OS's file cache for assets too big for it. Requests for assets the
+     * manifest doesn't have are ignored, so it only has to roughly follow the session. While it is on, every
+     * request takes a lock.
+     * \param distance How many assets to keep reading ahead of the last one asked for.
+     * \return False if the manifest can't be loaded.
+     */
+    bool startPrefetch(StringName manifestName, u32 distance = DEFAULT_PREFETCH_DISTANCE);
+
+    // Stops reading ahead, and unloads the manifest. Reads that already started still finish.
+    void stopPrefetch();
+
+    // Since the last startPrefetch(...).
+    PrefetchStats getPrefetchStats();
+
 private:
-    // Some resource that is currently loaded at runtime.
+    template <typename T>
+    friend class AsyncResourceHandle;
+
+    // How many worker threads read and decode resources for loadAsync().
+    static constexpr u32 LOAD_THREAD_COUNT {2};
+
+    static constexpr u64 DEFAULT_CACHE_BUDGET {64 * 1024 * 1024};
+
+    // Batched reads this close together are merged, since reading the gap is cheaper than seeking over it.
+    static constexpr u64 BATCH_MAX_GAP {64 * 1024};
+    // Merged reads stop growing at this size, so a batch doesn't need one huge buffer.
+    static constexpr u64 BATCH_MAX_READ {16 * 1024 * 1024};
+
+    static constexpr u32 DEFAULT_PREFETCH_DISTANCE {8};
+
+    // Where an asset is, in the mounted package that wins for it. Keeps that package open while it is read.
+    struct AssetLocation
+    {
+        std::shared_ptr<PackageBank> bank {};
+        const PackageIndexEntry* entry {};
+    };
+
+    // The winning package for an asset, in the merged index. The slot is empty while the bank is null.
+    struct MergedIndexEntry
+    {
+        StringName::Hash hash {};
+        PackageBank* bank {};
+        const PackageIndexEntry* entry {};
+    };
+
+    // A resource that was just read out of a package.
+    struct ReadResource
+    {
+        const void* data {};
+        bool readInPlace {};
+        // The decompressed asset, when the resource was read in place from one.
+        std::unique_ptr<u8[]> buffer {};
+        u64 size {};
+        // Is the resource itself in the buffer (a patched relocatable image), so there is nothing to free?
+        bool inBuffer {};
+        // The package it was read from.
+        std::shared_ptr<PackageBank> bank {};
+        LoadTimings timings {};
+    };
+
+    // Set in LoadedResource::state while the resource is loaded. The rest of the state is its reference count.
+    static constexpr u32 LOADED {1u << 31};
+
+    /**
+     * \brief A resource that has been loaded at some point, and may be loaded right now.
+     * \details Never freed before the manager, only emptied, so it can be found and referenced without a lock.
+     * Everything but the state is written under its shard's mutex, before LOADED is set, and is left alone
+     * while anyone references it.
+     */
     struct LoadedResource
     {
+        const StringName name;
+        // LOADED, or'ed with how many references there are. Only cleared under the shard's mutex.
+        std::atomic<u32> state {};
+        // Set once another package wins for it, so it is freed instead of cached when nobody references it.
+        std::atomic<bool> overridden {};
+
+        const void* data {};
+        bool readInPlace {};
+        void (*free)(const void* data, bool readInPlace) {};
+        // Freed after the resource, which may point into it.
+        std::unique_ptr<u8[]> buffer {};
+        // What the resource costs in the cache, its size in the package once decompressed.
+        u64 size {};
+        // Kept open, since a resource read in place from a mapped package points into it.
+        std::shared_ptr<PackageBank> bank {};
+
+        // The load in flight, if there is one. Guarded by the shard's mutex.
+        std::shared_ptr<PendingResourceLoad> pending {};
+
+        // Where the resource is in m_cachedResources. Guarded by m_cacheMutex.
+        std::list<LoadedResource*>::iterator cacheEntry {};
+        bool isCached {};
+    };
+
+    static constexpr u32 SHARD_COUNT {16};
+
+    // Part of the table of loaded resources, picked by the low bits of their name.
+    struct ResourceShard
+    {
+        // An open addressed table, with a power of two slots. Replaced by one twice the size as it fills up.
+        struct Slots
+        {
+            u64 mask;
+            std::unique_ptr<std::atomic<LoadedResource*>[]> slots;
+        };
+
+        // Taken before a resource in this shard is inserted, starts loading, finishes loading or is freed.
+        std::mutex mutex {};
+        // Searched without the mutex. Slots are only ever filled in, never emptied.
+        std::atomic<Slots*> slots {};
+        u64 count {};
+        // Every table this shard has had, since a search may still be reading one that was replaced.
+        std::vector<std::unique_ptr<Slots>> tables {};
+        std::vector<std::unique_ptr<LoadedResource>> resources {};
+    };
+
+    // A read loadAsync() started, while it is in flight.
+    struct AsyncRead
+    {
+        std::shared_ptr<PackageBank> bank;
+        // The asset as it is stored in the package, which the read fills.
+        std::unique_ptr<u8[]> stored;
+        // Decodes the asset and finishes the load. Called on the load pool, with null if the read failed.
+        std::function<void(std::unique_ptr<u8[]> stored, u64 ioNanoseconds)> finish;
+        // When the read was queued. Its I/O time runs until it completes, so it includes waiting for update().
+        u64 queuedAt;
+    };
+
+    // Where a request for a resource stands, before anything is read.
+    struct LoadRequest
+    {
+        // Set when the resource was already loaded.
         const void* data;
-        u32 referenceCount;
+        // The load to wait on. Null when the resource was already loaded, unless an asynchronous handle needs one.
+        std::shared_ptr<PendingResourceLoad> load;
+        // Is this the first request for the resource? If so, it has to do the load.
+        bool isFirst;
     };
 
-    const char* m_packageFile {};
+    template <typename T>
+    static void freeLoadedResource(const void* data, bool readInPlace)
+    {
+        freeResource<T>(const_cast<T*>(static_cast<const T*>(data)), readInPlace);
+    }
+
+    // For resources that live in their buffer, which is freed after them.
+    static void freeNothing([[maybe_unused]] const void* data, [[maybe_unused]] bool readInPlace)
+    {
+    }
+
+    ResourceShard& shardOf(StringName resourceName);
+
+    // Finds a resource that has been loaded before, without a lock. Null if it never was.
+    LoadedResource* findResource(StringName resourceName);
+
+    // Finds a resource, or adds it to its shard if it was never loaded before. Needs the shard's mutex.
+    LoadedResource& findOrInsertResource(ResourceShard& shard, StringName resourceName);
+
+    // Adds a reference to a resource, without a lock. False if it isn't loaded.
+    bool acquire(LoadedResource& resource);
+
+    // Frees a resource if it is loaded, and nobody references it. Needs the shard's mutex.
+    bool freeUnreferenced(LoadedResource& resource);
+
+    // The time, to start timing a load phase with. Zero while telemetry is off, so nothing reads the clock.
+    u64 timestamp() const;
+    // The time since a timestamp(), or zero if it was taken while telemetry was off.
+    u64 elapsedSince(u64 start) const;
+
+    // Looks an asset up in the merged index. Empty if no mounted package has it. Safe to call from any thread.
+    AssetLocation findAsset(StringName resourceName);
+
+    // Where an asset's slot in the merged index is, or the empty slot it would go in. Needs m_bankMutex.
+    u64 findMergedSlot(StringName::Hash hash) const;
+
+    // Grows the merged index, if it needs to, so it can hold this many assets. Needs m_bankMutex, held exclusively.
+    void reserveMergedIndex(u64 count);
+
+    // Adds a package's assets to the merged index, collecting the ones it wins for from another package.
+    // Needs m_bankMutex, held exclusively.
+    void mergeBank(PackageBank& bank, std::vector<StringName::Hash>& overridden);
+
+    // Empties a slot, moving the entries after it back so searches still find them. Needs m_bankMutex, held exclusively.
+    void eraseMergedSlot(u64 slot);
+
+    // Reads a resource out of the package that wins for it, without touching any of the tables. Safe to call from any thread.
+    template <typename T>
+    ReadResource readResource(StringName resourceName);
+
+    template <typename T>
+    ReadResource readResource(StringName resourceName, const AssetLocation& location);
+
+    // Reads a resource in place from a buffer that holds its whole (decompressed) asset. The resource owns the buffer.
+    template <typename T>
+    ReadResource readResourceFromBuffer(StringName resourceName, std::unique_ptr<u8[]> buffer, u64 size);
+
+    // Reads a resource from its asset as it is stored in the package (compressed or not). Empty if stored is null.
+    template <typename T>
+    ReadResource decodeStoredAsset(StringName resourceName, const AssetLocation& location, std::unique_ptr<u8[]> stored,
+        LoadTimings timings);
+
+    /**
+     * \brief Starts the load loadAsync() has to do itself.
+     * \details From a streamed package, this queues an asynchronous read that pumpAsyncReads() starts and finishes.
+     * From a mapped one, the resource is read on the load pool.
+     */
+    template <typename T>
+    void startAsyncLoad(StringName resourceName, std::shared_ptr<PendingResourceLoad> load);
+
+    void queueAsyncRead(const AssetLocation& location, std::function<void(std::unique_ptr<u8[]> stored, u64 ioNanoseconds)> finish);
+
+    /**
+     * \brief Starts every queued asynchronous read, and hands the finished ones to the load pool to decode.
+     * \param wait Blocks until at least one read finishes, unless none are in flight.
+     * \return Whether reads are still in flight.
+     */
+    bool pumpAsyncReads(bool wait);
+
+    // Hands the reads of a package that finished to the load pool. Needs m_asyncReadMutex.
+    u32 completeAsyncReads(PackageBank& bank, bool wait);
+
+    // Reads an asset as it is stored from a streamed package. Small ones go through the block cache.
+    bool readStoredAsset(void* destination, const AssetLocation& location);
+
+    // Reads an asset out of a package into a buffer of its own, decompressing it if needed. Null if it is damaged.
+    std::unique_ptr<u8[]> readAsset(StringName resourceName, const AssetLocation& location, LoadTimings& timings);
+
+    // Turns an asset, as it is stored in the package, into a buffer of its own. Null if it is damaged.
+    std::unique_ptr<u8[]> unpackResource(StringName resourceName, const PackageIndexEntry& entry, std::span<const u8> stored,
+        LoadTimings& timings);
+
+    /**
+     * \brief Reads many assets out of a streamed package, merging reads that are close together.
+     * \details Each merged read is scattered straight into the assets' own buffers, so nothing is copied.
+     * \param entries Sorted by offset.
+     * \param onRead Called with each asset as it is stored (compressed or not), in order. Null if the read failed.
+     * Each asset is charged its share of the merged read's time, by size.
+     */
+    void readMerged(PackageBank& bank, std::span<const PackageIndexEntry* const> entries,
+        const std::function<void(size_t index, std::unique_ptr<u8[]> stored, u64 ioNanoseconds)>& onRead);
+
+    LoadRequest beginLoad(StringName resourceName, bool isAsync, std::function<void(const void* data)> onLoaded);
+    void finishLoad(StringName resourceName, PendingResourceLoad& load, ReadResource resource, void (*free)(const void*, bool));
+    void waitFor(const PendingResourceLoad& load);
+
+    // Frees the least recently used cached resources, until they fit in the budget. Needs m_cacheMutex.
+    void evictCachedResources();
 
-    // Every asset's GUID from the package file, associated with offsets in the package.
-    std::unordered_map<StringName::Hash, size_t> m_resourceOffsetLookup{};
+    // Frees a resource a package no longer wins for, if it is cached, or marks it overridden. Needs m_cacheMutex.
+    void dropOverriddenResource(StringName resourceName);
 
-    // Every resource that is currently being used at runtime.
-    std::unordered_map<StringName, LoadedResource> m_loadedResourceTable{};
+    // Adds a request to the access trace, unless the asset was asked for before.
+    void traceAccess(StringName resourceName);
+
+    // Moves along the prefetch manifest to a request, and reads ahead of it.
+    void advancePrefetch(StringName resourceName);
+
+    // Reads ahead every asset in the manifest before an index, that wasn't read ahead yet. Needs m_prefetchMutex.
+    void readAheadUntil(u32 end);
+
+    // Starts reading an asset into memory in the background, without loading it. Needs m_prefetchMutex.
+    void readAhead(StringName resourceName);
+
+    PackageAccess m_access;
+
+    // Taken before m_cacheMutex, when both are needed. Guards the packages and the merged index.
+    std::shared_mutex m_bankMutex {};
+    // Every mounted package, in the order they were mounted.
+    std::vector<std::shared_ptr<PackageBank>> m_banks {};
+    // Every asset in the mounted packages, and the package that wins for it, while more than one is mounted.
+    // Open addressed, with a power of two slots that are at most half full, so it grows at most once per mount.
+    // Updated asset by asset as packages are mounted and unmounted, so a lookup is a single hash, however many
+    // packages there are. A package mounted on its own is searched through its sorted index instead, so opening
+    // it allocates nothing per asset.
+    std::vector<MergedIndexEntry> m_mergedIndex {};
+    u64 m_mergedCount {};
+    PackageId m_nextPackage {INVALID_PACKAGE + 1};
+    u64 m_blockCacheBudget {BlockCache::DEFAULT_BUDGET};
+
+    // Every resource that has been loaded, split up so loads of different resources rarely share a lock.
+    // A PendingResourceLoad's request count and callbacks are guarded by its resource's shard.
+    ResourceShard m_shards[SHARD_COUNT] {};
+
+    // Taken before any shard's mutex, when both are needed. Guards the list of cached resources.
+    std::mutex m_cacheMutex {};
+    // Resources nobody referenced when they were added, the most recently used first. Resources that are
+    // referenced again stay in it until they reach the end, rather than taking the lock to leave.
+    std::list<LoadedResource*> m_cachedResources {};
+    std::atomic<u64> m_cacheBudget {DEFAULT_CACHE_BUDGET};
+    // The size of every loaded resource nobody references. May dip below zero for a moment, while a resource
+    // that was just let go of is referenced again.
+    std::atomic<s64> m_cachedBytes {};
+    std::atomic<u64> m_cacheHits {};
+    std::atomic<u64> m_cacheMisses {};
+    std::atomic<u64> m_cacheEvictions {};
+
+    // Lets waitFor() sleep until a load finishes.
+    std::mutex m_loadFinishedMutex {};
+    std::condition_variable m_loadFinished {};
+
+    // Guards the asynchronous reads in flight, by their user data.
+    // A package's asynchronous reads are only touched under it.
+    std::mutex m_asyncReadMutex {};
+    std::unordered_map<u64, AsyncRead> m_asyncReads {};
+    u64 m_nextAsyncRead {};
+    // Every package with asynchronous reads in flight, and how many.
+    std::vector<std::pair<std::shared_ptr<PackageBank>, u32>> m_asyncReadBanks {};
+
+    std::atomic<bool> m_telemetryEnabled {};
+    LoadTelemetry m_telemetry {};
+    std::atomic<u64> m_frame {};
+
+    // Guards the access trace, while it is being recorded.
+    std::atomic<bool> m_tracing {};
+    std::mutex m_traceMutex {};
+    std::vector<StringName> m_trace {};
+    std::unordered_set<StringName::Hash> m_tracedAssets {};
+
+    // Guards the prefetch manifest being followed, and how far along it is. Taken before m_bankMutex.
+    std::atomic<bool> m_prefetching {};
+    std::mutex m_prefetchMutex {};
+    // Loaded like any other resource, so it holds a reference until stopPrefetch().
+    const PrefetchManifest* m_prefetchManifest {};
+    StringName::Hash m_prefetchManifestName {};
+    // Where each asset is in the manifest.
+    std::unordered_map<StringName::Hash, u32> m_prefetchPositions {};
+    // The first asset that hasn't been read ahead. Assets before it were, or the session skipped them.
+    u32 m_prefetchNext {};
+    u32 m_prefetchDistance {};
+    PrefetchStats m_prefetchStats {};
+
+    // Callbacks of finished loads, waiting for update().
+    std::mutex m_callbackMutex {};
+    std::vector<std::function<void()>> m_finishedCallbacks {};
+
+    // Spreads the chunks of compressed assets over every core.
+    ThreadPool m_decompressPool {};
+    ThreadPool m_loadPool {LOAD_THREAD_COUNT};
 };
 
 template <typename T>
 ResourceHandle<T> ResourceManager::load(StringName resourceName)
 {
-    ResourceHandle<T> result{
-        .name = resourceName,
-    };
+    LoadRequest request {beginLoad(resourceName, false, {})};
 
-    if (m_loadedResourceTable.contains(resourceName))
+    if (request.load == nullptr)
     {
         // Someone else is already using this resource, so we can share it with them.
-        result.data = static_cast<const T*>(m_loadedResourceTable[resourceName].data);
-        m_loadedResourceTable[resourceName].referenceCount++;
+        return {.name = resourceName, .data = static_cast<const T*>(request.data)};
     }
-    else
+
+    if (request.isFirst)
     {
         // We are the first user of this resource, so construct it and cache it.
-        size_t offset = m_resourceOffsetLookup[resourceName.hash];
-        std::fstream packageFileStream {};
-        packageFileStream.open(m_packageFile, std::ios::binary | std::ios::in);
-        packageFileStream.seekg(offset);
-        BinaryStreamBuilder builder {&packageFileStream};
-        result.data = readResourceFrom<T>(builder);
-        packageFileStream.close();
+        finishLoad(resourceName, *request.load, readResource<T>(resourceName), &freeLoadedResource<T>);
+    }
+    else
+    {
+        // Someone else is already loading it, so wait for them instead of reading it twice.
+        waitFor(*request.load);
+    }
+
+    return {.name = resourceName, .data = static_cast<const T*>(request.load->data)};
+}
+
+template <typename T>
+AsyncResourceHandle<T> ResourceManager::loadAsync(StringName resourceName, std::function<void(ResourceHandle<T>)> onLoaded)
+{
+    std::function<void(const void*)> callback {};
+
+    if (onLoaded)
+    {
+        callback = [resourceName, onLoaded = std::move(onLoaded)](const void* data)
+        {
+            onLoaded({.name = resourceName, .data = static_cast<const T*>(data)});
+        };
+    }
+
+    LoadRequest request {beginLoad(resourceName, true, std::move(callback))};
+
+    if (request.isFirst)
+        startAsyncLoad<T>(resourceName, request.load);
+
+    return AsyncResourceHandle<T>{this, resourceName, request.load};
+}
 
-        LoadedResource resource;
-        resource.data = result.data;
-        resource.referenceCount = 1;
+template <typename T>
+std::vector<ResourceHandle<T>> ResourceManager::loadBatch(std::span<const StringName> resourceNames)
+{
+    // A load this batch has to do itself.
+    struct BatchLoad
+    {
+        size_t request;
+        AssetLocation location;
+    };
+
+    std::vector<LoadRequest> requests {};
+    std::vector<BatchLoad> loads {};
+    requests.reserve(resourceNames.size());
 
-        m_loadedResourceTable.emplace(resourceName, resource);
+    for (size_t i = 0; i < resourceNames.size(); i++)
+    {
+        requests.push_back(beginLoad(resourceNames[i], false, {}));
+
+        if (!requests.back().isFirst)
+            continue;
+
+        if (AssetLocation location {findAsset(resourceNames[i])}; location.entry != nullptr)
+        {
+            loads.push_back({i, std::move(location)});
+        }
+        else
+        {
+            LOG_ERROR(Logger::Channel::Resources, "Cannot load {}, it is not in any mounted package!", resourceNames[i]);
+            finishLoad(resourceNames[i], *requests.back().load, {}, &freeLoadedResource<T>);
+        }
+    }
+
+    // Package by package, in package order, so each package is read from front to back.
+    std::sort(loads.begin(), loads.end(), [](const BatchLoad& a, const BatchLoad& b)
+    {
+        if (a.location.bank != b.location.bank)
+            return a.location.bank->getId() < b.location.bank->getId();
+
+        return a.location.entry->offset < b.location.entry->offset;
+    });
+
+    for (size_t first = 0; first < loads.size();)
+    {
+        PackageBank& bank {*loads[first].location.bank};
+        size_t last {first};
+
+        while (last < loads.size() && loads[last].location.bank.get() == &bank)
+            last++;
+
+        if (bank.getAccess() == PackageAccess::Mapped)
+        {
+            for (size_t i = first; i < last; i++)
+            {
+                StringName resourceName {resourceNames[loads[i].request]};
+                finishLoad(resourceName, *requests[loads[i].request].load, readResource<T>(resourceName, loads[i].location),
+                    &freeLoadedResource<T>);
+            }
+        }
+        else
+        {
+            std::vector<const PackageIndexEntry*> entries {};
+
+            for (size_t i = first; i < last; i++)
+                entries.push_back(loads[i].location.entry);
+
+            readMerged(bank, entries, [&](size_t index, std::unique_ptr<u8[]> stored, u64 ioNanoseconds)
+            {
+                const BatchLoad& load {loads[first + index]};
+                StringName resourceName {resourceNames[load.request]};
+                LoadTimings timings {.readBytes = load.location.entry->compressedSize, .ioNanoseconds = ioNanoseconds};
+                ReadResource resource {decodeStoredAsset<T>(resourceName, load.location, std::move(stored), timings)};
+                finishLoad(resourceName, *requests[load.request].load, std::move(resource), &freeLoadedResource<T>);
+            });
+        }
+
+        first = last;
+    }
+
+    std::vector<ResourceHandle<T>> result {};
+    result.reserve(resourceNames.size());
+
+    for (size_t i = 0; i < resourceNames.size(); i++)
+    {
+        // Loads this batch joined (from elsewhere, or a name that is in it twice) are waited for last.
+        if (requests[i].load != nullptr)
+            waitFor(*requests[i].load);
+
+        const void* data {requests[i].load != nullptr ? requests[i].load->data : requests[i].data};
+        result.push_back({.name = resourceNames[i], .data = static_cast<const T*>(data)});
     }
 
     return result;
 }
 
+template <typename T>
+ResourceManager::ReadResource ResourceManager::readResource(StringName resourceName)
+{
+    AssetLocation location {findAsset(resourceName)};
+
+    if (location.entry == nullptr)
+    {
+        LOG_ERROR(Logger::Channel::Resources, "Cannot load {}, it is not in any mounted package!", resourceName);
+        return {};
+    }
+
+    return readResource<T>(resourceName, location);
+}
+
+template <typename T>
+ResourceManager::ReadResource ResourceManager::readResource(StringName resourceName, const AssetLocation& location)
+{
+    const PackageIndexEntry& entry {*location.entry};
+    const FileSystem::MappedFile* mappedPackage {location.bank->getMappedFile()};
+
+    LoadTimings timings {.readBytes = entry.compressedSize};
+
+    if (mappedPackage == nullptr || entry.compressedSize != entry.size)
+    {
+        std::unique_ptr<u8[]> buffer {readAsset(resourceName, location, timings)};
+        u64 decodeStart {timestamp()};
+        ReadResource result {readResourceFromBuffer<T>(resourceName, std::move(buffer), entry.size)};
+        timings.decodeNanoseconds = elapsedSince(decodeStart);
+        result.bank = location.bank;
+        result.timings = timings;
+        return result;
+    }
+
+    u64 decodeStart {timestamp()};
+    BinaryMemoryReader reader {mappedPackage->data(), mappedPackage->size()};
+    reader.seek(entry.offset);
+    T* result {readResourceInPlace<T>(reader)};
+    timings.decodeNanoseconds = elapsedSince(decodeStart);
+
+    if (reader.failed())
+    {
+        LOG_ERROR(Logger::Channel::Resources, "Cannot load {}, it runs past the end of the package!", resourceName);
+        freeResource<T>(result, true);
+        return {.timings = timings};
+    }
+
+    return {result, true, {}, entry.size, false, location.bank, timings};
+}
+
+template <typename T>
+ResourceManager::ReadResource ResourceManager::decodeStoredAsset(StringName resourceName, const AssetLocation& location, std::unique_ptr<u8[]> stored,
+    LoadTimings timings)
+{
+    const PackageIndexEntry& entry {*location.entry};
+
+    // Uncompressed assets were read straight into the buffer they keep.
+    if (stored != nullptr && entry.compressedSize != entry.size)
+        stored = unpackResource(resourceName, entry, {stored.get(), entry.compressedSize}, timings);
+
+    u64 decodeStart {timestamp()};
+    ReadResource result {readResourceFromBuffer<T>(resourceName, std::move(stored), entry.size)};
+    timings.decodeNanoseconds += elapsedSince(decodeStart);
+    result.bank = location.bank;
+    result.timings = timings;
+    return result;
+}
+
+template <typename T>
+void ResourceManager::startAsyncLoad(StringName resourceName, std::shared_ptr<PendingResourceLoad> load)
+{
+    AssetLocation location {findAsset(resourceName)};
+
+    if (location.entry == nullptr)
+    {
+        LOG_ERROR(Logger::Channel::Resources, "Cannot load {}, it is not in any mounted package!", resourceName);
+        finishLoad(resourceName, *load, {}, &freeLoadedResource<T>);
+        return;
+    }
+
+    if (location.bank->getAccess() == PackageAccess::Mapped)
+    {
+        m_loadPool.submit([this, resourceName, load = std::move(load), location = std::move(location)]
+        {
+            finishLoad(resourceName, *load, readResource<T>(resourceName, location), &freeLoadedResource<T>);
+        });
+
+        return;
+    }
+
+    queueAsyncRead(location, [this, resourceName, load = std::move(load), location](std::unique_ptr<u8[]> stored, u64 ioNanoseconds)
+    {
+        LoadTimings timings {.readBytes = location.entry->compressedSize, .ioNanoseconds = ioNanoseconds};
+        finishLoad(resourceName, *load, decodeStoredAsset<T>(resourceName, location, std::move(stored), timings), &freeLoadedResource<T>);
+    });
+}
+
+template <typename T>
+ResourceManager::ReadResource ResourceManager::readResourceFromBuffer(StringName resourceName, std::unique_ptr<u8[]> buffer, u64 size)
+{
+    if (buffer == nullptr)
+        return {};
+
+    BinaryMemoryReader reader {buffer.get(), size};
+
+    // The buffer is ours, so a relocatable resource is used right where it was read, once it is patched.
+    if constexpr (RelocatableResource<T>)
+    {
+        RelocatableImage image {};
+
+        if (!readRelocatableImage(reader, T::LAYOUT_VERSION, sizeof(T), image))
+        {
+            if (reader.failed())
+                LOG_ERROR(Logger::Channel::Resources, "Cannot load {}, it runs past the end of the asset!", resourceName);
+
+            return {};
+        }
+
+        u8* root {buffer.get() + (image.root - buffer.get())};
+        applyFixups(image, root);
+        return {root, true, std::move(buffer), size, true};
+    }
+
+    T* result {readResourceInPlace<T>(reader)};
+
+    if (reader.failed())
+    {
+        LOG_ERROR(Logger::Channel::Resources, "Cannot load {}, it runs past the end of the asset!", resourceName);
+        freeResource<T>(result, true);
+        return {};
+    }
+
+    return {result, true, std::move(buffer), size};
+}
+
+template <typename T>
+AsyncResourceHandle<T>::AsyncResourceHandle(ResourceManager* manager, StringName name, std::shared_ptr<PendingResourceLoad> load)
+    : m_manager{manager}, m_name{name}, m_load{std::move(load)}
+{
+}
+
+template <typename T>
+StringName AsyncResourceHandle<T>::getName() const
+{
+    return m_name;
+}
+
+template <typename T>
+bool AsyncResourceHandle<T>::isReady() const
+{
+    return m_load->state.load(std::memory_order_acquire) != LoadState::Loading;
+}
+
+template <typename T>
+ResourceHandle<T> AsyncResourceHandle<T>::wait() const
+{
+    if (!isReady())
+        m_manager->waitFor(*m_load);
+
+    return {.name = m_name, .data = static_cast<const T*>(m_load->data)};
+}
+
 #endif // RESOURCE_MANAGER_HPP
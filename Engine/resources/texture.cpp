@@ -14,38 +14,9 @@ s32 Texture::pixelDataLength() const
 }
 
 template <>
-void writeResourceTo<Texture>(Texture* resource, BinaryStreamBuilder& packageFile)
+void writeRelocatableBlobs<Texture>(const Texture& resource, RelocatableWriter& writer)
 {
-    packageFile.writeFixed(resource->wrappingX)
-               .writeFixed(resource->wrappingY)
-               .writeFixed(resource->textureFiltering)
-               .writeFixed(resource->mipmapFiltering)
-               .writeFixed(resource->format)
-               .writeFixed(resource->width)
-               .writeFixed(resource->height)
-               .writeFixed(resource->channels)
-               .write(resource->pixelData[0], resource->pixelDataLength());
-}
-
-template <>
-Texture* readResourceFrom<Texture>(BinaryStreamBuilder& packageFile)
-{
-    // todo: better allocation
-    Texture* resource = new Texture{};
-
-    packageFile.readFixed(&resource->wrappingX)
-               .readFixed(&resource->wrappingY)
-               .readFixed(&resource->textureFiltering)
-               .readFixed(&resource->mipmapFiltering)
-               .readFixed(&resource->format)
-               .readFixed(&resource->width)
-               .readFixed(&resource->height)
-               .readFixed(&resource->channels);
-
-    // todo: better allocation
-    resource->pixelData = new u8[resource->pixelDataLength()];
-    packageFile.read(resource->pixelData, resource->pixelDataLength());
-    return resource;
+    writer.writeBlob(resource.pixelData, resource.pixelData, resource.pixelDataLength());
 }
 
 // Texture Wrapping
@@ -64,7 +35,7 @@ const char* getDisplayName(TextureWrapping textureWrapping)
     if (textureWrapping == TextureWrapping::ClampBorder)
         return "ClampBorder";
 
-    Logger::log_error("Failed to parse display name for texture wrapping!");
+    LOG_ERROR(Logger::Channel::Resources, "Failed to parse display name for texture wrapping!");
     return nullptr;
 }
 
@@ -75,7 +46,7 @@ TextureWrapping parseTextureWrapping(std::string_view value)
     if (value == "ClampEdge") return TextureWrapping::ClampEdge;
     if (value == "ClampBorder") return TextureWrapping::ClampBorder;
 
-    Logger::log_error("Failed to parse texture wrapping from {}!", value);
+    LOG_ERROR(Logger::Channel::Resources, "Failed to parse texture wrapping from {}!", value);
     return TextureWrapping::Repeat;
 }
 
@@ -89,7 +60,7 @@ const char* getDisplayName(TextureFiltering textureFiltering)
     if (textureFiltering == TextureFiltering::Bilinear)
         return "Bilinear";
 
-    Logger::log_error("Failed to parse display name for texture filtering!");
+    LOG_ERROR(Logger::Channel::Resources, "Failed to parse display name for texture filtering!");
     return nullptr;
 }
 
@@ -98,7 +69,7 @@ TextureFiltering parseTextureFiltering(std::string_view value)
     if (value == "Point") return TextureFiltering::Point;
     if (value == "Bilinear") return TextureFiltering::Bilinear;
 
-    Logger::log_error("Failed to parse texture filtering from {}!", value);
+    LOG_ERROR(Logger::Channel::Resources, "Failed to parse texture filtering from {}!", value);
     return TextureFiltering::Bilinear;
 }
 
@@ -118,7 +89,7 @@ const char* getDisplayName(ColorFormat colorFormat)
     if (colorFormat == ColorFormat::Rgba)
         return "Rgba";
 
-    Logger::log_error("Failed to parse display name for color format!");
+    LOG_ERROR(Logger::Channel::Resources, "Failed to parse display name for color format!");
     return nullptr;
 }
 
@@ -129,6 +100,6 @@ ColorFormat parseColorFormat(std::string_view value)
     if (value == "Rgb") return ColorFormat::Rgb;
     if (value == "Rgba") return ColorFormat::Rgba;
 
-    Logger::log_error("Failed to parse color format from {}!", value);
+    LOG_ERROR(Logger::Channel::Resources, "Failed to parse color format from {}!", value);
     return ColorFormat::Rgba;
 }
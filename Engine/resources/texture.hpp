@@ -2,9 +2,8 @@
 #define TEXTURE_HPP
 
 #include <string_view>
-#include "resource.hpp"
 #include "types.hpp"
-#include "binary_stream_builder.hpp"
+#include "relocatable.hpp"
 #include "resource_manager.hpp"
 
 enum class ColorFormat { GrayScale, GrayScaleAlpha, Rgb, Rgba };
@@ -22,14 +21,11 @@ enum class TextureWrapping { Repeat, MirroredRepeat, ClampEdge, ClampBorder };
 const char* getDisplayName(TextureWrapping textureWrapping);
 TextureWrapping parseTextureWrapping(std::string_view value);
 
-struct Texture : Resource
+// Relocatable, so it is used straight from the package (see RelocatableResource).
+struct Texture
 {
     static const char* TYPE_NAME;
-
-    Texture()
-    {
-        type = TYPE_NAME;
-    }
+    static constexpr u16 LAYOUT_VERSION {1};
 
     TextureWrapping wrappingX{TextureWrapping::Repeat};
     TextureWrapping wrappingY{TextureWrapping::Repeat};
@@ -55,10 +51,8 @@ T* Texture::get(s32 x, s32 y) const
     return reinterpret_cast<T*>(&pixelData[index]);
 }
 
+// The pixels are written after the texture, and point straight into the package once it is loaded.
 template <>
-void writeResourceTo<Texture>(Texture* resource, BinaryStreamBuilder& packageFile);
-
-template <>
-Texture* readResourceFrom<Texture>(BinaryStreamBuilder& packageFile);
+void writeRelocatableBlobs<Texture>(const Texture& resource, RelocatableWriter& writer);
 
 #endif // TEXTURE_HPP
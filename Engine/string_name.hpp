@@ -2,8 +2,27 @@
 #define STRING_NAME_HPP
 
 #include "types.hpp"
+#include <cstddef>
+#include <format>
 #include <unordered_map>
 
+/**
+ * \brief A string literal stored by value, so that it can be passed as a template argument.
+ * \details Each distinct FixedString template argument is a single constant object for the
+ * whole program, which makes the set of them a compile-time registry of every name literal.
+ */
+template <size_t Size>
+struct FixedString
+{
+    char data[Size] {};
+
+    consteval FixedString(const char (&string)[Size])
+    {
+        for (size_t i = 0; i < Size; i++)
+            data[i] = string[i];
+    }
+};
+
 /**
  * \brief A hashed version of a string.
  * During debugging builds, you can still see the
@@ -17,7 +36,7 @@ struct StringName
      */
     typedef u64 Hash;
 
-    explicit StringName(Hash stringHash) : hash {stringHash}
+    constexpr explicit StringName(Hash stringHash) : hash {stringHash}
     {
     }
 
@@ -31,7 +50,7 @@ struct StringName
      * \param string The string that should be hashed.
      * \return A hashed identified for the string.
      */
-    static Hash createHash(const char* string)
+    static constexpr Hash createHash(const char* string)
     {
         // Perform the FNV-1a hash on the name, targeting 64 bits.
         Hash hash = 14695981039346656037u;
@@ -45,13 +64,42 @@ struct StringName
         return hash;
     }
 
-    bool operator ==(const StringName& other) const
+    /**
+     * \brief Creates a hashed version of a string that is not null-terminated.
+     * \param string The characters that should be hashed.
+     * \param length The number of characters in the string.
+     * \return The same hash createHash(const char*) gives for those characters.
+     */
+    static constexpr Hash createHash(const char* string, size_t length)
+    {
+        Hash hash = 14695981039346656037u;
+
+        for (size_t i = 0; i < length; i++)
+        {
+            hash ^= string[i];
+            hash *= 1099511628211u;
+        }
+
+        return hash;
+    }
+
+    /**
+     * \brief Finds the original string, from the debug name or the StringNameTable.
+     * \return The string, or nullptr if it is unknown.
+     */
+    const char* toString() const;
+
+    constexpr bool operator ==(const StringName& other) const
     {
         return hash == other.hash;
     }
 
 private:
 #if _DEBUG
+    constexpr StringName(Hash stringHash, const char* debugName) : hash {stringHash}, name {debugName}
+    {
+    }
+
     /**
      * \brief This parameter is only used for debugging purposes,
      * and is stripped out during release builds.
@@ -59,7 +107,8 @@ private:
     const char* name {};
 #endif // _DEBUG
 
-    friend StringName operator ""_sn(const char*, size_t);
+    template <FixedString Name>
+    friend consteval StringName operator ""_sn();
 };
 
 // Enable StringNames to be hashed and used in STL data structures.
@@ -72,11 +121,39 @@ struct std::hash<StringName>
     }
 };
 
+// Enable StringNames to be formatted (and logged), as their string when it is known.
+template<>
+struct std::formatter<StringName>
+{
+    constexpr auto parse(std::format_parse_context& context)
+    {
+        return context.begin();
+    }
+
+    auto format(const StringName& stringName, std::format_context& context) const
+    {
+        if (const char* string = stringName.toString())
+            return std::format_to(context.out(), "{}", string);
+
+        return std::format_to(context.out(), "#{:016x}", stringName.hash);
+    }
+};
+
 /**
  * \brief Creates a hashed version of a given C-string at compile time.
- * \param rawName The string that should be hashed.
+ * \details The result is always a constant, so using a literal costs nothing at runtime.
+ * During debugging builds, the name points at the registered copy of the literal.
+ * \tparam Name The string that should be hashed.
  * \return A hashed identifier for the string.
  */
-StringName operator ""_sn(const char* rawName, size_t);
+template <FixedString Name>
+consteval StringName operator ""_sn()
+{
+#if _DEBUG
+    return StringName {StringName::createHash(Name.data), Name.data};
+#else
+    return StringName {StringName::createHash(Name.data)};
+#endif // _DEBUG
+}
 
 #endif // STRING_NAME_HPP
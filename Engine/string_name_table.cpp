@@ -0,0 +1,325 @@
+﻿#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include "string_name_table.hpp"
+#include "logger.hpp"
+#include "resources/binary_memory_reader.hpp"
+#include "resources/binary_stream_builder.hpp"
+
+using namespace StringNameTable;
+
+namespace
+{
+    // Shards are picked by the top bits of a hash, and buckets by the bottom bits.
+    constexpr u32 SHARD_BITS {4};
+    constexpr u32 SHARD_COUNT {1 << SHARD_BITS};
+    constexpr u32 BUCKET_COUNT {1024};
+
+    constexpr size_t ARENA_BLOCK_SIZE {64 * 1024};
+
+    struct Entry
+    {
+        StringName::Hash hash;
+        const char* string;
+        // Older entries in the same bucket. Never changes once the entry is published.
+        Entry* next;
+    };
+
+    // Hands out memory from large blocks, which are kept until the program exits.
+    class Arena
+    {
+    public:
+        // Returns nullptr if a new block was needed and could not be allocated.
+        void* alloc(size_t sizeBytes, size_t align)
+        {
+            size_t padding {(align - reinterpret_cast<uintptr_t>(m_current) % align) % align};
+
+            if (m_current == nullptr || padding + sizeBytes > m_remainingBytes)
+            {
+                // Oversized requests get a block of their own.
+                size_t blockSize {std::max(sizeBytes + align, ARENA_BLOCK_SIZE)};
+                auto* block {static_cast<u8*>(malloc(blockSize))};
+
+                if (block == nullptr)
+                    return nullptr;
+
+                m_current = block;
+                m_remainingBytes = blockSize;
+                padding = (align - reinterpret_cast<uintptr_t>(m_current) % align) % align;
+            }
+
+            u8* result {m_current + padding};
+            m_current += padding + sizeBytes;
+            m_remainingBytes -= padding + sizeBytes;
+            return result;
+        }
+
+    private:
+        u8* m_current {};
+        size_t m_remainingBytes {};
+    };
+
+    struct Shard
+    {
+        // Only held while inserting, lookups go straight to the buckets.
+        std::mutex insertMutex;
+        Arena arena;
+        std::atomic<Entry*> buckets[BUCKET_COUNT] {};
+        std::atomic<u32> count {};
+    };
+
+    Shard s_shards[SHARD_COUNT] {};
+
+    Shard& getShard(StringName::Hash hash)
+    {
+        return s_shards[hash >> (64 - SHARD_BITS)];
+    }
+
+    std::atomic<Entry*>& getBucket(Shard& shard, StringName::Hash hash)
+    {
+        return shard.buckets[hash % BUCKET_COUNT];
+    }
+
+    Entry* findEntry(Shard& shard, StringName::Hash hash)
+    {
+        // Acquire pairs with the release in insert(), so the entry is fully written before we read it.
+        for (Entry* entry = getBucket(shard, hash).load(std::memory_order_acquire); entry != nullptr; entry = entry->next)
+        {
+            if (entry->hash == hash)
+                return entry;
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * Adds a string under the given hash.
+     * If copy is false, the string must already be null-terminated and live forever.
+     */
+    void insert(StringName::Hash hash, std::string_view string, bool copy)
+    {
+        Shard& shard {getShard(hash)};
+        std::scoped_lock lock {shard.insertMutex};
+
+        if (Entry* existing = findEntry(shard, hash))
+        {
+            if (string != existing->string)
+            {
+                LOG_ERROR(Logger::Channel::General, "StringName collision: \"{}\" and \"{}\" both hash to {:016x}!",
+                    existing->string, string, hash);
+            }
+
+            return;
+        }
+
+        const char* stored {string.data()};
+
+        if (copy)
+        {
+            char* buffer {static_cast<char*>(shard.arena.alloc(string.size() + 1, 1))};
+
+            if (buffer == nullptr)
+            {
+                LOG_ERROR(Logger::Channel::General, "Out of memory, \"{}\" was not added to the StringName table!", string);
+                return;
+            }
+
+            memcpy(buffer, string.data(), string.size());
+            buffer[string.size()] = '\0';
+            stored = buffer;
+        }
+
+        auto* entry {static_cast<Entry*>(shard.arena.alloc(sizeof(Entry), alignof(Entry)))};
+
+        if (entry == nullptr)
+        {
+            LOG_ERROR(Logger::Channel::General, "Out of memory, \"{}\" was not added to the StringName table!", string);
+            return;
+        }
+
+        std::atomic<Entry*>& bucket {getBucket(shard, hash)};
+        *entry = Entry{hash, stored, bucket.load(std::memory_order_relaxed)};
+        bucket.store(entry, std::memory_order_release);
+        shard.count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Holds the string blocks loaded by readFrom().
+    std::mutex s_loadedMutex {};
+    Arena s_loadedArena {};
+}
+
+StringName StringNameTable::intern(std::string_view string)
+{
+    StringName::Hash hash {StringName::createHash(string.data(), string.size())};
+    insert(hash, string, true);
+    return StringName{hash};
+}
+
+const char* StringNameTable::find(StringName::Hash hash)
+{
+    Entry* entry {findEntry(getShard(hash), hash)};
+    return entry != nullptr ? entry->string : nullptr;
+}
+
+u32 StringNameTable::getCount()
+{
+    u32 result {};
+
+    for (Shard& shard : s_shards)
+        result += shard.count.load(std::memory_order_relaxed);
+
+    return result;
+}
+
+namespace
+{
+    template <typename Reader>
+    void readTable(Reader& stream, size_t sizeBytes)
+    {
+        // The two sizes, the hash count and the total size of the strings, always take up this much.
+        constexpr size_t fixedBytes {2 * sizeof(size_t)};
+
+        size_t hashCount {};
+        stream.readFixed(&hashCount);
+
+        if (stream.failed() || sizeBytes < fixedBytes || hashCount > (sizeBytes - fixedBytes) / sizeof(StringName::Hash))
+        {
+            LOG_ERROR(Logger::Channel::General, "StringName table is damaged, no names were loaded.");
+            return;
+        }
+
+        std::vector<StringName::Hash> hashes(hashCount);
+        size_t stringBytes {};
+        stream.read(hashes.data(), hashCount * sizeof(StringName::Hash));
+        stream.readFixed(&stringBytes);
+
+        if (stream.failed() || stringBytes > sizeBytes - fixedBytes - hashCount * sizeof(StringName::Hash))
+        {
+            LOG_ERROR(Logger::Channel::General, "StringName table is damaged, no names were loaded.");
+            return;
+        }
+
+        std::vector<char> strings(stringBytes);
+        stream.read(strings.data(), stringBytes);
+
+        if (stream.failed())
+        {
+            LOG_ERROR(Logger::Channel::General, "StringName table is truncated, no names were loaded.");
+            return;
+        }
+
+        // Checks every string before interning any, and only makes room for the ones that are new.
+        size_t newBytes {};
+
+        for (size_t i {0}, offset {0}; i < hashCount; i++)
+        {
+            size_t length {strnlen(strings.data() + offset, stringBytes - offset)};
+
+            if (length == stringBytes - offset)
+            {
+                LOG_ERROR(Logger::Channel::General, "StringName table is truncated, no names were loaded.");
+                return;
+            }
+
+            if (find(hashes[i]) == nullptr)
+                newBytes += length + 1;
+
+            offset += length + 1;
+        }
+
+        if (newBytes == 0)
+            return;
+
+        char* block {};
+        {
+            std::scoped_lock lock {s_loadedMutex};
+            block = static_cast<char*>(s_loadedArena.alloc(newBytes, 1));
+        }
+
+        if (block == nullptr)
+        {
+            LOG_ERROR(Logger::Channel::General, "Out of memory, {} names were not loaded.", hashCount);
+            return;
+        }
+
+        for (size_t i {0}, offset {0}; i < hashCount; i++)
+        {
+            size_t length {strlen(strings.data() + offset)};
+
+            // Anything interned since the check above already has its string, so only the space is wasted.
+            if (find(hashes[i]) == nullptr)
+            {
+                memcpy(block, strings.data() + offset, length + 1);
+                insert(hashes[i], {block, length}, false);
+                block += length + 1;
+            }
+
+            offset += length + 1;
+        }
+    }
+}
+
+void StringNameTable::readFrom(BinaryStreamBuilder& stream, size_t sizeBytes)
+{
+    readTable(stream, sizeBytes);
+}
+
+void StringNameTable::readFrom(BinaryMemoryReader& stream, size_t sizeBytes)
+{
+    readTable(stream, sizeBytes);
+}
+
+void StringNameTable::writeTo(BinaryStreamBuilder& stream)
+{
+    std::vector<const Entry*> entries {};
+
+    for (Shard& shard : s_shards)
+    {
+        std::scoped_lock lock {shard.insertMutex};
+
+        for (std::atomic<Entry*>& bucket : shard.buckets)
+        {
+            for (const Entry* entry = bucket.load(std::memory_order_acquire); entry != nullptr; entry = entry->next)
+                entries.push_back(entry);
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry* a, const Entry* b) { return a->hash < b->hash; });
+
+    std::vector<StringName::Hash> hashes {};
+    std::vector<char> strings {};
+
+    for (const Entry* entry : entries)
+    {
+        hashes.push_back(entry->hash);
+        strings.insert(strings.end(), entry->string, entry->string + strlen(entry->string) + 1);
+    }
+
+    stream.writeFixed(hashes.size());
+
+    if (!hashes.empty())
+        stream.write(hashes[0], hashes.size() * sizeof(StringName::Hash));
+
+    stream.writeFixed(strings.size());
+
+    if (!strings.empty())
+        stream.write(strings[0], strings.size());
+}
+
+// Lives here rather than in string_name.hpp, so the header does not depend on the table.
+const char* StringName::toString() const
+{
+#if _DEBUG
+    if (name != nullptr)
+        return name;
+#endif // _DEBUG
+
+#ifdef STRING_NAME_TABLE_ENABLED
+    return StringNameTable::find(hash);
+#else
+    return nullptr;
+#endif // STRING_NAME_TABLE_ENABLED
+}
@@ -0,0 +1,63 @@
+﻿#ifndef STRING_NAME_TABLE_HPP
+#define STRING_NAME_TABLE_HPP
+
+#include <string_view>
+#include "config.hpp"
+#include "types.hpp"
+#include "string_name.hpp"
+
+class BinaryMemoryReader;
+class BinaryStreamBuilder;
+
+#if _DEBUG || defined(STRING_NAME_TABLE_IN_RELEASE)
+#define STRING_NAME_TABLE_ENABLED
+#endif
+
+/**
+ * \brief A global table of every interned string, so StringNames can be turned back into text.
+ * \details Strings are copied into arenas and never move or get freed, so the pointers handed
+ * out stay valid for the rest of the program. The table is split into shards by hash: inserts
+ * only lock their own shard, and lookups never lock at all.
+ *
+ * When STRING_NAME_TABLE_ENABLED is not defined (shipping builds), nothing fills the table
+ * automatically and StringName::toString() does not consult it.
+ */
+namespace StringNameTable
+{
+    /**
+     * \brief Adds a string to the table (if it is not there already).
+     * \param string The string to intern.
+     * \return The name of the string. On a hash collision, an error is logged and the
+     * previously interned string is kept.
+     */
+    StringName intern(std::string_view string);
+
+    /**
+     * \brief Finds the string that was interned with a given hash. Safe to call from any thread.
+     * \return The null-terminated string, or nullptr if nothing was interned with that hash.
+     */
+    const char* find(StringName::Hash hash);
+
+    // The total number of interned strings.
+    u32 getCount();
+
+    /**
+     * \brief Interns every name in a table written by writeTo(). The names that are not interned
+     * yet are copied into a single arena block, so reading the same table again allocates nothing.
+     * \param sizeBytes How many bytes the table may take up in the stream. The table comes from a
+     * file, so its counts are checked against this before anything is allocated, and a damaged
+     * table is logged and skipped.
+     */
+    void readFrom(BinaryStreamBuilder& stream, size_t sizeBytes);
+    void readFrom(BinaryMemoryReader& stream, size_t sizeBytes);
+
+    /**
+     * \brief Writes every interned string, sorted by hash so the output is deterministic.
+     * \details Layout: the name count, every hash, the total size of the strings, and then the
+     * null-terminated strings in the same order as the hashes.
+     */
+    void writeTo(BinaryStreamBuilder& stream);
+
+} // namespace StringNameTable
+
+#endif // STRING_NAME_TABLE_HPP
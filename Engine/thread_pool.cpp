@@ -0,0 +1,108 @@
+﻿#include <algorithm>
+#include <memory>
+#include "thread_pool.hpp"
+
+ThreadPool::ThreadPool(u32 threadCount)
+{
+    if (threadCount == 0)
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+    for (u32 i = 0; i < threadCount; i++)
+        m_threads.emplace_back([this] { run(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::scoped_lock lock {m_mutex};
+        m_stopping = true;
+    }
+
+    m_jobAdded.notify_all();
+
+    for (std::thread& thread : m_threads)
+        thread.join();
+}
+
+void ThreadPool::submit(std::function<void()> job)
+{
+    {
+        std::scoped_lock lock {m_mutex};
+        m_jobs.push_back(std::move(job));
+        m_unfinishedCount++;
+    }
+
+    m_jobAdded.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock lock {m_mutex};
+    m_jobFinished.wait(lock, [this] { return m_unfinishedCount == 0; });
+}
+
+void ThreadPool::parallelFor(u32 count, const std::function<void(u32 index)>& job)
+{
+    // Shared, since helpers that only start once everything is done still look at it.
+    struct Batch
+    {
+        std::function<void(u32 index)> job {};
+        u32 count {};
+        std::atomic<u32> next {};
+        std::atomic<u32> finished {};
+
+        void work()
+        {
+            for (u32 index = next++; index < count; index = next++)
+            {
+                job(index);
+
+                if (++finished == count)
+                    finished.notify_all();
+            }
+        }
+    };
+
+    if (count == 0)
+        return;
+
+    auto batch {std::make_shared<Batch>()};
+    batch->job = job;
+    batch->count = count;
+    u32 helperCount {std::min(count - 1, getThreadCount())};
+
+    for (u32 i = 0; i < helperCount; i++)
+        submit([batch] { batch->work(); });
+
+    batch->work();
+
+    for (u32 finished = batch->finished; finished != count; finished = batch->finished)
+        batch->finished.wait(finished);
+}
+
+u32 ThreadPool::getThreadCount() const
+{
+    return static_cast<u32>(m_threads.size());
+}
+
+void ThreadPool::run()
+{
+    std::unique_lock lock {m_mutex};
+
+    while (true)
+    {
+        m_jobAdded.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+
+        if (m_jobs.empty())
+            return;
+
+        std::function<void()> job {std::move(m_jobs.front())};
+        m_jobs.pop_front();
+        lock.unlock();
+        job();
+        lock.lock();
+
+        if (--m_unfinishedCount == 0)
+            m_jobFinished.notify_all();
+    }
+}
@@ -0,0 +1,54 @@
+﻿#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "types.hpp"
+
+/**
+ * \brief A fixed set of worker threads that run submitted jobs in the order they were submitted.
+ * \details Jobs still queued when the pool is destroyed are run before the workers exit.
+ */
+class ThreadPool
+{
+public:
+    // Zero picks one thread per hardware thread.
+    explicit ThreadPool(u32 threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> job);
+
+    // Blocks until every job submitted so far has finished.
+    void wait();
+
+    /**
+     * \brief Runs job(0) to job(count - 1) across the workers, and returns once all of them have finished.
+     * \details The calling thread works through the jobs too, so this also makes progress (and can't deadlock)
+     * when it is called from a job, or while the workers are busy with something else.
+     */
+    void parallelFor(u32 count, const std::function<void(u32 index)>& job);
+
+    u32 getThreadCount() const;
+
+private:
+    void run();
+
+    std::vector<std::thread> m_threads {};
+    std::deque<std::function<void()>> m_jobs {};
+    std::mutex m_mutex {};
+    std::condition_variable m_jobAdded {};
+    std::condition_variable m_jobFinished {};
+    // Jobs that are queued or running.
+    u32 m_unfinishedCount {};
+    bool m_stopping {};
+};
+
+#endif // THREAD_POOL_HPP
@@ -0,0 +1,109 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <bit>
+#include <cmath>
+#include <vector>
+#include "../Engine/math/fast_math.hpp"
+#include "../Engine/math/random.hpp"
+#include "../Engine/math/simd.hpp"
+
+/**
+ * \brief Shared setup for the math batch benchmarks.
+ * \details Each operation is measured three ways over the same inputs:
+ * - AoS: an array of engine types (Vec3, Mat4), using the engine's own functions.
+ * - SoA scalar: one array per component, one element per step.
+ * - SoA SIMD: one array per component, simd::WIDTH elements per step.
+ *
+ * The SoA kernels are written once as templates over a lane type, and instantiated with
+ * f32 and simd::f32x4, so both variants perform exactly the same arithmetic.
+ *
+ * Inputs come from a fixed seed and every benchmark reports the mean, median and deviation
+ * of several repetitions, so results can be compared across commits. For tracking, run with
+ * --benchmark_out=results.json --benchmark_out_format=json and compare the medians.
+ */
+namespace batch
+{
+    using namespace Math;
+
+    // Elements per batch, small enough to stay in cache so the arithmetic is what gets measured.
+    constexpr s32 COUNT {4096};
+
+    // Every batch is generated from this seed, so each run sees the same inputs.
+    constexpr u64 SEED {0x5EED};
+
+    // Fills an array with uniformly distributed values in [min, max).
+    inline std::vector<f32> randomFloats(s32 count, f32 min, f32 max, u64 stream)
+    {
+        Random random {SEED + stream};
+        std::vector<f32> result(count);
+
+        for (f32& value : result)
+            value = random.range(min, max);
+
+        return result;
+    }
+
+    // === Lanes ===
+
+    // How many elements one value of a lane type holds. Worked out from its size, since specializing
+    // on simd::f32x4 would drop the attributes of the __m128 behind it (see -Wignored-attributes).
+    template <typename Lane>
+    constexpr s32 WIDTH {static_cast<s32>(sizeof(Lane) / sizeof(f32))};
+
+    template <typename Lane>
+    Lane load(const f32* source);
+
+    template <>
+    inline f32 load<f32>(const f32* source) { return *source; }
+
+    template <>
+    inline simd::f32x4 load<simd::f32x4>(const f32* source) { return simd::load(source); }
+
+    template <typename Lane>
+    Lane splat(f32 value);
+
+    template <>
+    inline f32 splat<f32>(f32 value) { return value; }
+
+    template <>
+    inline simd::f32x4 splat<simd::f32x4>(f32 value) { return simd::set(value); }
+
+    inline void store(f32* destination, f32 value) { *destination = value; }
+    using simd::store;
+
+    // Scalar versions of the Math::simd operations, so kernels can call either unqualified.
+    inline f32 add(f32 a, f32 b) { return a + b; }
+    inline f32 sub(f32 a, f32 b) { return a - b; }
+    inline f32 mul(f32 a, f32 b) { return a * b; }
+    inline f32 div(f32 a, f32 b) { return a / b; }
+    inline f32 sqrt(f32 value) { return std::sqrt(value); }
+    inline f32 abs(f32 value) { return std::abs(value); }
+    inline bool lessEqual(f32 a, f32 b) { return a <= b; }
+    inline f32 select(bool mask, f32 whenTrue, f32 whenFalse) { return mask ? whenTrue : whenFalse; }
+    inline s32 countTrue(bool mask) { return mask ? 1 : 0; }
+    inline f32 tan(f32 value) { return std::tan(value); }
+
+    using simd::add;
+    using simd::sub;
+    using simd::mul;
+    using simd::div;
+    using simd::sqrt;
+    using simd::abs;
+    using simd::lessEqual;
+    using simd::select;
+
+    inline s32 countTrue(simd::f32x4 mask) { return std::popcount(static_cast<u32>(simd::moveMask(mask))); }
+
+    // There is no SIMD tan, so this goes through the fast sine and cosine instead.
+    inline simd::f32x4 tan(simd::f32x4 value) { return simd::div(fast::sin(value), fast::cos(value)); }
+
+    template <typename Lane>
+    Lane madd(Lane a, Lane b, Lane c) { return add(mul(a, b), c); }
+
+} // namespace batch
+
+// Repeats each benchmark and only reports the aggregates, which are far more stable between runs.
+#define BENCHMARK_BATCH(Function) BENCHMARK(Function)->Repetitions(5)->ReportAggregatesOnly(true)
+
+#endif // BATCH_H
@@ -0,0 +1,126 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+#include "../Engine/math/frustum.hpp"
+#include "../Engine/math/aabb.hpp"
+#include "../Engine/math/sphere.hpp"
+#include "../Engine/math/mat4.hpp"
+
+// Culls a scattered field of bounds against a typical camera, one at a time and in SIMD batches.
+// Roughly a tenth of the bounds end up visible.
+
+struct CullingScene
+{
+    Frustum frustum;
+    std::vector<f32> x, y, z, extentX, extentY, extentZ;
+
+    explicit CullingScene(s32 count) : x(count), y(count), z(count), extentX(count), extentY(count), extentZ(count)
+    {
+        Mat4 worldToView {Mat4::translate(0, -5, 0)};
+        Mat4 viewToClip {Mat4::perspective(0.1f, 500, 1920, 1080, 60)};
+        frustum = Frustum::fromMatrix(worldToView * viewToClip);
+
+        std::mt19937 random {42};
+        std::uniform_real_distribution<f32> position {-500, 500};
+        std::uniform_real_distribution<f32> size {0.5f, 4};
+
+        for (s32 i = 0; i < count; i++)
+        {
+            x[i] = position(random);
+            y[i] = position(random) * 0.1f;
+            z[i] = position(random);
+            extentX[i] = size(random);
+            extentY[i] = size(random);
+            extentZ[i] = size(random);
+        }
+    }
+
+    s32 count() const { return static_cast<s32>(x.size()); }
+};
+
+static void Culling_AabbSingle(benchmark::State& state)
+{
+    CullingScene scene {static_cast<s32>(state.range(0))};
+    std::vector<Aabb> boxes(scene.count());
+    std::vector<u32> visible(scene.count());
+
+    for (s32 i = 0; i < scene.count(); i++)
+        boxes[i] = Aabb::fromCenterExtents({scene.x[i], scene.y[i], scene.z[i]}, {scene.extentX[i], scene.extentY[i], scene.extentZ[i]});
+
+    for (auto _ : state)
+    {
+        s32 count {};
+
+        for (s32 i = 0; i < scene.count(); i++)
+        {
+            if (scene.frustum.intersects(boxes[i]))
+                visible[count++] = i;
+        }
+
+        benchmark::DoNotOptimize(count);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * scene.count());
+}
+
+static void Culling_AabbBatch(benchmark::State& state)
+{
+    CullingScene scene {static_cast<s32>(state.range(0))};
+    AabbBatch batch {scene.x.data(), scene.y.data(), scene.z.data(), scene.extentX.data(), scene.extentY.data(), scene.extentZ.data(), scene.count()};
+    std::vector<u32> visible(scene.count());
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(scene.frustum.cull(batch, visible.data()));
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * scene.count());
+}
+
+static void Culling_SphereSingle(benchmark::State& state)
+{
+    CullingScene scene {static_cast<s32>(state.range(0))};
+    std::vector<Sphere> spheres(scene.count());
+    std::vector<u32> visible(scene.count());
+
+    for (s32 i = 0; i < scene.count(); i++)
+        spheres[i] = Sphere{{scene.x[i], scene.y[i], scene.z[i]}, scene.extentX[i]};
+
+    for (auto _ : state)
+    {
+        s32 count {};
+
+        for (s32 i = 0; i < scene.count(); i++)
+        {
+            if (scene.frustum.intersects(spheres[i]))
+                visible[count++] = i;
+        }
+
+        benchmark::DoNotOptimize(count);
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * scene.count());
+}
+
+static void Culling_SphereBatch(benchmark::State& state)
+{
+    CullingScene scene {static_cast<s32>(state.range(0))};
+    SphereBatch batch {scene.x.data(), scene.y.data(), scene.z.data(), scene.extentX.data(), scene.count()};
+    std::vector<u32> visible(scene.count());
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(scene.frustum.cull(batch, visible.data()));
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * scene.count());
+}
+
+BENCHMARK(Culling_AabbSingle)->Arg(1024)->Arg(16384);
+BENCHMARK(Culling_AabbBatch)->Arg(1024)->Arg(16384);
+BENCHMARK(Culling_SphereSingle)->Arg(1024)->Arg(16384);
+BENCHMARK(Culling_SphereBatch)->Arg(1024)->Arg(16384);
@@ -0,0 +1,161 @@
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <vector>
+#include "../Engine/math/fast_math.hpp"
+
+using namespace Math;
+using namespace Math::fast;
+
+// Every benchmark runs its function over the same buffer of inputs, so libm, the scalar
+// approximations and the SIMD approximations are directly comparable per item.
+
+constexpr s32 INPUT_COUNT {4096};
+
+// Fills a buffer with evenly spaced values in [start, end).
+static std::vector<f32> makeInputs(f32 start, f32 end)
+{
+    std::vector<f32> result(INPUT_COUNT);
+
+    for (s32 i = 0; i < INPUT_COUNT; i++)
+        result[i] = start + (end - start) * static_cast<f32>(i) / INPUT_COUNT;
+
+    return result;
+}
+
+template <typename Function>
+void runScalar(benchmark::State& state, f32 start, f32 end, Function&& function)
+{
+    std::vector<f32> inputs {makeInputs(start, end)};
+    std::vector<f32> outputs(INPUT_COUNT);
+
+    for (auto _ : state)
+    {
+        for (s32 i = 0; i < INPUT_COUNT; i++)
+            outputs[i] = function(inputs[i]);
+
+        benchmark::DoNotOptimize(outputs.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * INPUT_COUNT);
+}
+
+template <typename Function>
+void runSimd(benchmark::State& state, f32 start, f32 end, Function&& function)
+{
+    std::vector<f32> inputs {makeInputs(start, end)};
+    std::vector<f32> outputs(INPUT_COUNT);
+
+    for (auto _ : state)
+    {
+        for (s32 i = 0; i < INPUT_COUNT; i += simd::WIDTH)
+            simd::store(&outputs[i], function(simd::load(&inputs[i])));
+
+        benchmark::DoNotOptimize(outputs.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * INPUT_COUNT);
+}
+
+// Registers the libm baseline, both scalar accuracies and both SIMD accuracies for one function.
+#define BENCHMARK_FAST_MATH(Name, Start, End, LibmExpression) \
+    static void Name##_Libm(benchmark::State& state) \
+    { runScalar(state, Start, End, [](f32 x) { return LibmExpression; }); } \
+    static void Name##_ScalarLow(benchmark::State& state) \
+    { runScalar(state, Start, End, [](f32 x) { return fast::Name<Accuracy::Low>(x); }); } \
+    static void Name##_ScalarHigh(benchmark::State& state) \
+    { runScalar(state, Start, End, [](f32 x) { return fast::Name<Accuracy::High>(x); }); } \
+    static void Name##_SimdLow(benchmark::State& state) \
+    { runSimd(state, Start, End, [](simd::f32x4 x) { return fast::Name<Accuracy::Low>(x); }); } \
+    static void Name##_SimdHigh(benchmark::State& state) \
+    { runSimd(state, Start, End, [](simd::f32x4 x) { return fast::Name<Accuracy::High>(x); }); } \
+    BENCHMARK(Name##_Libm); \
+    BENCHMARK(Name##_ScalarLow); \
+    BENCHMARK(Name##_ScalarHigh); \
+    BENCHMARK(Name##_SimdLow); \
+    BENCHMARK(Name##_SimdHigh);
+
+BENCHMARK_FAST_MATH(rsqrt, 0.001f, 1000.0f, 1.0f / std::sqrt(x))
+BENCHMARK_FAST_MATH(sin, -100.0f, 100.0f, std::sin(x))
+BENCHMARK_FAST_MATH(cos, -100.0f, 100.0f, std::cos(x))
+BENCHMARK_FAST_MATH(exp2, -100.0f, 100.0f, std::exp2(x))
+BENCHMARK_FAST_MATH(log2, 0.001f, 1000.0f, std::log2(x))
+
+// atan2 takes two inputs, so it gets points walking around the unit circle instead.
+template <typename Function>
+void runAtan2(benchmark::State& state, Function&& function)
+{
+    std::vector<f32> angles {makeInputs(-PI, PI)};
+    std::vector<f32> ys(INPUT_COUNT);
+    std::vector<f32> xs(INPUT_COUNT);
+    std::vector<f32> outputs(INPUT_COUNT);
+
+    for (s32 i = 0; i < INPUT_COUNT; i++)
+    {
+        ys[i] = std::sin(angles[i]);
+        xs[i] = std::cos(angles[i]);
+    }
+
+    for (auto _ : state)
+    {
+        function(ys.data(), xs.data(), outputs.data());
+        benchmark::DoNotOptimize(outputs.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * INPUT_COUNT);
+}
+
+template <typename Function>
+void runAtan2Scalar(benchmark::State& state, Function&& function)
+{
+    runAtan2(state, [&](const f32* ys, const f32* xs, f32* outputs)
+    {
+        for (s32 i = 0; i < INPUT_COUNT; i++)
+            outputs[i] = function(ys[i], xs[i]);
+    });
+}
+
+template <Accuracy A>
+void runAtan2Simd(benchmark::State& state)
+{
+    runAtan2(state, [](const f32* ys, const f32* xs, f32* outputs)
+    {
+        for (s32 i = 0; i < INPUT_COUNT; i += simd::WIDTH)
+            simd::store(&outputs[i], fast::atan2<A>(simd::load(&ys[i]), simd::load(&xs[i])));
+    });
+}
+
+static void atan2_Libm(benchmark::State& state)
+{
+    runAtan2Scalar(state, [](f32 y, f32 x) { return std::atan2(y, x); });
+}
+
+static void atan2_ScalarLow(benchmark::State& state)
+{
+    runAtan2Scalar(state, [](f32 y, f32 x) { return fast::atan2<Accuracy::Low>(y, x); });
+}
+
+static void atan2_ScalarHigh(benchmark::State& state)
+{
+    runAtan2Scalar(state, [](f32 y, f32 x) { return fast::atan2<Accuracy::High>(y, x); });
+}
+
+static void atan2_SimdLow(benchmark::State& state)
+{
+    runAtan2Simd<Accuracy::Low>(state);
+}
+
+static void atan2_SimdHigh(benchmark::State& state)
+{
+    runAtan2Simd<Accuracy::High>(state);
+}
+
+BENCHMARK(atan2_Libm);
+BENCHMARK(atan2_ScalarLow);
+BENCHMARK(atan2_ScalarHigh);
+BENCHMARK(atan2_SimdLow);
+BENCHMARK(atan2_SimdHigh);
+
+#undef BENCHMARK_FAST_MATH
@@ -0,0 +1,194 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include "../Engine/platform/file_system.hpp"
+#include "../Engine/platform/pooled_read_queue.hpp"
+#include "../Engine/resources/block_cache.hpp"
+
+using namespace FileSystem;
+
+// Random 4 KiB reads out of a 64 MiB file: blocking readAt() one after another, against the platform's
+// asynchronous reads (io_uring on Linux) and the thread pool they fall back to. The argument is how many
+// reads are submitted together. The file is in the page cache, so this shows what each read costs the CPU
+// rather than the disk; on a real disk, the asynchronous ones also keep it busy with many reads at once.
+// They run on real time, since the pool does its work on other threads.
+
+constexpr u64 FILE_SIZE {64 * 1024 * 1024};
+constexpr u64 READ_SIZE {4096};
+constexpr s32 READ_COUNT {1024};
+
+static const std::string& filePath()
+{
+    static const std::string path = []
+    {
+        std::string result {(std::filesystem::temp_directory_path() / "benchmarks_file_system.bin").string()};
+        std::ofstream file {result, std::ios::binary | std::ios::trunc};
+        std::vector<char> block(1024 * 1024);
+
+        for (u64 written = 0; written < FILE_SIZE; written += block.size())
+            file.write(block.data(), static_cast<std::streamsize>(block.size()));
+
+        return result;
+    }();
+
+    return path;
+}
+
+static std::vector<u64> readOffsets()
+{
+    std::mt19937_64 random {0x5EED};
+    std::vector<u64> offsets {};
+
+    for (s32 i = 0; i < READ_COUNT; i++)
+        offsets.push_back(random() % (FILE_SIZE / READ_SIZE) * READ_SIZE);
+
+    return offsets;
+}
+
+// Submits the reads a batch at a time, and waits for each batch to finish.
+template <typename Queue>
+static void readInBatches(Queue& queue, std::vector<u8>& buffer, const std::vector<u64>& offsets, size_t batchSize)
+{
+    ReadCompletion completions[64] {};
+
+    for (size_t first = 0; first < offsets.size(); first += batchSize)
+    {
+        size_t last {std::min(offsets.size(), first + batchSize)};
+
+        for (size_t i = first; i < last; i++)
+            queue.queue(buffer.data() + (i - first) * READ_SIZE, READ_SIZE, offsets[i], i);
+
+        queue.submit();
+
+        for (size_t completed = first; completed < last;)
+            completed += queue.complete(completions, true);
+    }
+}
+
+// Lets File and PooledReadQueue go through the same readInBatches().
+struct FileQueue
+{
+    File* file;
+
+    void queue(void* destination, size_t count, u64 offset, u64 userData)
+    {
+        file->queueRead(destination, count, offset, userData);
+    }
+
+    void submit()
+    {
+        file->submitReads();
+    }
+
+    u32 complete(std::span<ReadCompletion> completions, bool wait)
+    {
+        return file->completeReads(completions, wait);
+    }
+};
+
+static void FileSystem_BlockingRead(benchmark::State& state)
+{
+    File* file {openFile(filePath().c_str(), FileAccess::Read)};
+    std::vector<u64> offsets {readOffsets()};
+    std::vector<u8> buffer(READ_SIZE);
+
+    for (auto _ : state)
+    {
+        for (u64 offset : offsets)
+            benchmark::DoNotOptimize(file->readAt(buffer.data(), READ_SIZE, offset));
+    }
+
+    state.SetBytesProcessed(state.iterations() * READ_COUNT * static_cast<s64>(READ_SIZE));
+    file->close();
+    delete file;
+}
+
+static void FileSystem_AsyncRead(benchmark::State& state)
+{
+    File* file {openFile(filePath().c_str(), FileAccess::Read)};
+    std::vector<u64> offsets {readOffsets()};
+    std::vector<u8> buffer(state.range(0) * READ_SIZE);
+    FileQueue queue {file};
+
+    // Reads straight into registered memory, where the platform supports it.
+    std::span<u8> buffers[] {buffer};
+    file->registerBuffers(buffers);
+
+    for (auto _ : state)
+        readInBatches(queue, buffer, offsets, static_cast<size_t>(state.range(0)));
+
+    state.SetBytesProcessed(state.iterations() * READ_COUNT * static_cast<s64>(READ_SIZE));
+    file->registerBuffers({});
+    file->close();
+    delete file;
+}
+
+static void FileSystem_PooledAsyncRead(benchmark::State& state)
+{
+    File* file {openFile(filePath().c_str(), FileAccess::Read)};
+    std::vector<u64> offsets {readOffsets()};
+    std::vector<u8> buffer(state.range(0) * READ_SIZE);
+
+    {
+        PooledReadQueue queue {file};
+
+        for (auto _ : state)
+            readInBatches(queue, buffer, offsets, static_cast<size_t>(state.range(0)));
+    }
+
+    state.SetBytesProcessed(state.iterations() * READ_COUNT * static_cast<s64>(READ_SIZE));
+    file->close();
+    delete file;
+}
+
+// Small reads of neighbouring assets, as a package of small resources sees them: each one with a read of its own,
+// and through a BlockCache that is cleared every iteration, so it reads every block once.
+constexpr u64 SMALL_READ_SIZE {700};
+
+static void FileSystem_SmallReads(benchmark::State& state)
+{
+    File* file {openFile(filePath().c_str(), FileAccess::Read)};
+    std::vector<u8> buffer(SMALL_READ_SIZE);
+
+    for (auto _ : state)
+    {
+        for (u64 offset = 0; offset + SMALL_READ_SIZE <= 8 * 1024 * 1024; offset += SMALL_READ_SIZE)
+            benchmark::DoNotOptimize(file->readAt(buffer.data(), SMALL_READ_SIZE, offset));
+    }
+
+    state.SetBytesProcessed(state.iterations() * 8 * 1024 * 1024);
+    file->close();
+    delete file;
+}
+
+static void BlockCache_SmallReads(benchmark::State& state)
+{
+    File* file {openFile(filePath().c_str(), FileAccess::Read)};
+    std::vector<u8> buffer(SMALL_READ_SIZE);
+    BlockCacheStats stats {};
+
+    for (auto _ : state)
+    {
+        BlockCache cache {file};
+
+        for (u64 offset = 0; offset + SMALL_READ_SIZE <= 8 * 1024 * 1024; offset += SMALL_READ_SIZE)
+            benchmark::DoNotOptimize(cache.read(buffer.data(), SMALL_READ_SIZE, offset));
+
+        stats = cache.getStats();
+    }
+
+    state.SetBytesProcessed(state.iterations() * 8 * 1024 * 1024);
+    state.counters["hit_rate"] = static_cast<f64>(stats.hits) / static_cast<f64>(stats.hits + stats.misses);
+    file->close();
+    delete file;
+}
+
+BENCHMARK(FileSystem_BlockingRead)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(FileSystem_AsyncRead)->Arg(1)->Arg(32)->Arg(256)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(FileSystem_PooledAsyncRead)->Arg(1)->Arg(32)->Arg(256)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(FileSystem_SmallReads)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BlockCache_SmallReads)->UseRealTime()->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,81 @@
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include "../Engine/logger.hpp"
+
+using namespace Logger;
+
+// Measures the cost on the logging thread. Block is used so that a slow sink thread shows up as
+// back-pressure, instead of as (much cheaper) dropped messages.
+
+class NullSink final : public Sink
+{
+public:
+    void write(std::string_view) override
+    {
+    }
+
+    void flush() override
+    {
+    }
+};
+
+static void startLogging(const char* binaryLogPath)
+{
+    clearSinks();
+    addSink(std::make_unique<NullSink>());
+
+    AsyncSettings settings {};
+    settings.overflowPolicy = OverflowPolicy::Block;
+    settings.binaryLogPath = binaryLogPath;
+    startAsync(settings);
+}
+
+static void stopLogging()
+{
+    stopAsync();
+    clearSinks();
+}
+
+static void Logger_Synchronous(benchmark::State& state)
+{
+    clearSinks();
+    addSink(std::make_unique<NullSink>());
+    s32 frame {};
+
+    for (auto _ : state)
+        log_info(Channel::General, "Frame {} took {} ms on {}", frame++, 16.6f, "Rendering");
+
+    clearSinks();
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void Logger_AsyncText(benchmark::State& state)
+{
+    startLogging(nullptr);
+    s32 frame {};
+
+    for (auto _ : state)
+        log_info(Channel::General, "Frame {} took {} ms on {}", frame++, 16.6f, "Rendering");
+
+    stopLogging();
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void Logger_AsyncBinary(benchmark::State& state)
+{
+    std::string path {(std::filesystem::temp_directory_path() / "benchmarks_logger.blog").string()};
+    startLogging(path.c_str());
+    s32 frame {};
+
+    for (auto _ : state)
+        log_info<"Frame {} took {} ms on {}">(Channel::General, frame++, 16.6f, "Rendering");
+
+    stopLogging();
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(Logger_Synchronous);
+BENCHMARK(Logger_AsyncText);
+BENCHMARK(Logger_AsyncBinary);
@@ -0,0 +1,341 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "../Engine/math/mat4.hpp"
+#include "batch.hpp"
+
+using namespace batch;
+
+// === Batches ===
+
+// Well conditioned matrices (random transformations), so inverse() never divides by zero.
+static std::vector<Mat4> makeMatrices(u64 stream)
+{
+    std::vector<f32> values {randomFloats(COUNT * 9, -2, 2, stream)};
+    std::vector<Mat4> result(COUNT);
+
+    for (s32 i = 0; i < COUNT; i++)
+    {
+        const f32* v {&values[i * 9]};
+        result[i] = Mat4::trs({v[0], v[1], v[2]}, {v[3], v[4], v[5]}, {v[6] + 3, v[7] + 3, v[8] + 3});
+    }
+
+    return result;
+}
+
+// Sixteen arrays, one per element (row * 4 + column).
+struct Mat4Soa
+{
+    std::vector<f32> elements[16];
+
+    explicit Mat4Soa(const std::vector<Mat4>& matrices)
+    {
+        for (s32 element = 0; element < 16; element++)
+        {
+            elements[element].resize(matrices.size());
+
+            for (size_t i = 0; i < matrices.size(); i++)
+                elements[element][i] = matrices[i][element / 4][element % 4];
+        }
+    }
+};
+
+struct Vec3Soa
+{
+    std::vector<f32> x, y, z;
+
+    explicit Vec3Soa(s32 count) : x(count), y(count), z(count) {}
+};
+
+// Runs a kernel over the whole batch once per iteration.
+template <typename Function>
+void run(benchmark::State& state, Function&& function)
+{
+    for (auto _ : state)
+    {
+        function();
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * COUNT);
+}
+
+// === Multiply ===
+
+template <typename Lane>
+void multiplyKernel(const Mat4Soa& first, const Mat4Soa& second, Mat4Soa& result)
+{
+    for (s32 i = 0; i < COUNT; i += WIDTH<Lane>)
+    {
+        Lane a[16];
+        Lane b[16];
+
+        for (s32 element = 0; element < 16; element++)
+        {
+            a[element] = load<Lane>(&first.elements[element][i]);
+            b[element] = load<Lane>(&second.elements[element][i]);
+        }
+
+        for (s32 row = 0; row < 4; row++)
+        {
+            for (s32 column = 0; column < 4; column++)
+            {
+                Lane value {mul(a[row * 4], b[column])};
+                value = madd(a[row * 4 + 1], b[4 + column], value);
+                value = madd(a[row * 4 + 2], b[8 + column], value);
+                value = madd(a[row * 4 + 3], b[12 + column], value);
+                store(&result.elements[row * 4 + column][i], value);
+            }
+        }
+    }
+}
+
+static void Mat4Multiply_AoS(benchmark::State& state)
+{
+    std::vector<Mat4> first {makeMatrices(0)}, second {makeMatrices(1)}, result(COUNT);
+
+    run(state, [&]
+    {
+        for (s32 i = 0; i < COUNT; i++)
+            result[i] = first[i] * second[i];
+    });
+}
+
+// Each result row is a sum of the second matrix's rows, scaled by the first matrix's row elements.
+static void Mat4Multiply_AoS_Simd(benchmark::State& state)
+{
+    std::vector<Mat4> first {makeMatrices(0)}, second {makeMatrices(1)}, result(COUNT);
+
+    run(state, [&]
+    {
+        for (s32 i = 0; i < COUNT; i++)
+        {
+            simd::f32x4 rows[4];
+
+            for (s32 row = 0; row < 4; row++)
+                rows[row] = simd::load(second[i][row]);
+
+            for (s32 row = 0; row < 4; row++)
+            {
+                const f32* a {first[i][row]};
+                simd::f32x4 value {simd::mul(simd::set(a[0]), rows[0])};
+                value = simd::madd(simd::set(a[1]), rows[1], value);
+                value = simd::madd(simd::set(a[2]), rows[2], value);
+                value = simd::madd(simd::set(a[3]), rows[3], value);
+                simd::store(result[i][row], value);
+            }
+        }
+    });
+}
+
+template <typename Lane>
+void Mat4Multiply_SoA(benchmark::State& state)
+{
+    Mat4Soa first {makeMatrices(0)}, second {makeMatrices(1)}, result {std::vector<Mat4>(COUNT)};
+    run(state, [&] { multiplyKernel<Lane>(first, second, result); });
+}
+
+// === Inverse ===
+
+// The same cofactor expansion as Mat4::inverse().
+template <typename Lane>
+void inverseKernel(const Mat4Soa& source, Mat4Soa& result)
+{
+    auto difference = [](Lane a, Lane b, Lane c, Lane d) { return sub(mul(a, b), mul(c, d)); };
+    auto cofactor = [](Lane a, Lane b, Lane c, Lane d, Lane e, Lane f) { return madd(e, f, sub(mul(a, b), mul(c, d))); };
+
+    for (s32 i = 0; i < COUNT; i += WIDTH<Lane>)
+    {
+        Lane m[16];
+
+        for (s32 element = 0; element < 16; element++)
+            m[element] = load<Lane>(&source.elements[element][i]);
+
+        Lane s0 {difference(m[0], m[5], m[4], m[1])};
+        Lane s1 {difference(m[0], m[6], m[4], m[2])};
+        Lane s2 {difference(m[0], m[7], m[4], m[3])};
+        Lane s3 {difference(m[1], m[6], m[5], m[2])};
+        Lane s4 {difference(m[1], m[7], m[5], m[3])};
+        Lane s5 {difference(m[2], m[7], m[6], m[3])};
+
+        Lane c5 {difference(m[10], m[15], m[14], m[11])};
+        Lane c4 {difference(m[9], m[15], m[13], m[11])};
+        Lane c3 {difference(m[9], m[14], m[13], m[10])};
+        Lane c2 {difference(m[8], m[15], m[12], m[11])};
+        Lane c1 {difference(m[8], m[14], m[12], m[10])};
+        Lane c0 {difference(m[8], m[13], m[12], m[9])};
+
+        Lane determinant {add(cofactor(s0, c5, s1, c4, s2, c3), cofactor(s3, c2, s4, c1, s5, c0))};
+        Lane positive {div(splat<Lane>(1), determinant)};
+        Lane negative {sub(splat<Lane>(0), positive)};
+
+        auto write = [&](s32 element, Lane value, Lane scale) { store(&result.elements[element][i], mul(value, scale)); };
+
+        write(0, cofactor(m[5], c5, m[6], c4, m[7], c3), positive);
+        write(1, cofactor(m[1], c5, m[2], c4, m[3], c3), negative);
+        write(2, cofactor(m[13], s5, m[14], s4, m[15], s3), positive);
+        write(3, cofactor(m[9], s5, m[10], s4, m[11], s3), negative);
+
+        write(4, cofactor(m[4], c5, m[6], c2, m[7], c1), negative);
+        write(5, cofactor(m[0], c5, m[2], c2, m[3], c1), positive);
+        write(6, cofactor(m[12], s5, m[14], s2, m[15], s1), negative);
+        write(7, cofactor(m[8], s5, m[10], s2, m[11], s1), positive);
+
+        write(8, cofactor(m[4], c4, m[5], c2, m[7], c0), positive);
+        write(9, cofactor(m[0], c4, m[1], c2, m[3], c0), negative);
+        write(10, cofactor(m[12], s4, m[13], s2, m[15], s0), positive);
+        write(11, cofactor(m[8], s4, m[9], s2, m[11], s0), negative);
+
+        write(12, cofactor(m[4], c3, m[5], c1, m[6], c0), negative);
+        write(13, cofactor(m[0], c3, m[1], c1, m[2], c0), positive);
+        write(14, cofactor(m[12], s3, m[13], s1, m[14], s0), negative);
+        write(15, cofactor(m[8], s3, m[9], s1, m[10], s0), positive);
+    }
+}
+
+static void Mat4Inverse_AoS(benchmark::State& state)
+{
+    std::vector<Mat4> source {makeMatrices(2)}, result(COUNT);
+
+    run(state, [&]
+    {
+        for (s32 i = 0; i < COUNT; i++)
+            result[i] = source[i].inverse();
+    });
+}
+
+template <typename Lane>
+void Mat4Inverse_SoA(benchmark::State& state)
+{
+    Mat4Soa source {makeMatrices(2)}, result {std::vector<Mat4>(COUNT)};
+    run(state, [&] { inverseKernel<Lane>(source, result); });
+}
+
+// === Transform Point ===
+
+// One matrix applied to a whole batch of points, the common case when transforming a mesh.
+
+static Mat4 makeTransform()
+{
+    return Mat4::trs({1, 2, 3}, {0.3f, 0.2f, 0.1f}, {2, 2, 2});
+}
+
+template <typename Lane>
+void transformKernel(const Mat4& matrix, const Vec3Soa& points, Vec3Soa& result)
+{
+    Lane m[16];
+
+    for (s32 element = 0; element < 16; element++)
+        m[element] = splat<Lane>(matrix[element / 4][element % 4]);
+
+    for (s32 i = 0; i < COUNT; i += WIDTH<Lane>)
+    {
+        Lane x {load<Lane>(&points.x[i])};
+        Lane y {load<Lane>(&points.y[i])};
+        Lane z {load<Lane>(&points.z[i])};
+
+        store(&result.x[i], madd(x, m[0], madd(y, m[4], madd(z, m[8], m[12]))));
+        store(&result.y[i], madd(x, m[1], madd(y, m[5], madd(z, m[9], m[13]))));
+        store(&result.z[i], madd(x, m[2], madd(y, m[6], madd(z, m[10], m[14]))));
+    }
+}
+
+static Vec3Soa makePoints()
+{
+    Vec3Soa result {COUNT};
+    result.x = randomFloats(COUNT, -100, 100, 3);
+    result.y = randomFloats(COUNT, -100, 100, 4);
+    result.z = randomFloats(COUNT, -100, 100, 5);
+    return result;
+}
+
+static void Mat4TransformPoint_AoS(benchmark::State& state)
+{
+    Mat4 matrix {makeTransform()};
+    Vec3Soa soa {makePoints()};
+    std::vector<Vec3> points(COUNT), result(COUNT);
+
+    for (s32 i = 0; i < COUNT; i++)
+        points[i] = Vec3{soa.x[i], soa.y[i], soa.z[i]};
+
+    run(state, [&]
+    {
+        for (s32 i = 0; i < COUNT; i++)
+            result[i] = matrix.transformPoint(points[i]);
+    });
+}
+
+template <typename Lane>
+void Mat4TransformPoint_SoA(benchmark::State& state)
+{
+    Mat4 matrix {makeTransform()};
+    Vec3Soa points {makePoints()}, result {COUNT};
+    run(state, [&] { transformKernel<Lane>(matrix, points, result); });
+}
+
+// === Perspective ===
+
+// Builds a projection per field of view, like a camera zoom would.
+
+constexpr f32 NEAR_PLANE {0.1f};
+constexpr f32 FAR_PLANE {1000};
+constexpr s32 SCREEN_WIDTH {1920};
+constexpr s32 SCREEN_HEIGHT {1080};
+
+template <typename Lane>
+void perspectiveKernel(const std::vector<f32>& fovs, Mat4Soa& result)
+{
+    const f32 aspectRatio {static_cast<f32>(SCREEN_WIDTH) / SCREEN_HEIGHT};
+    const f32 depth {FAR_PLANE - NEAR_PLANE};
+
+    for (s32 i = 0; i < COUNT; i += WIDTH<Lane>)
+    {
+        // With a symmetric view, the general formula simplifies to only the diagonal and the depth terms.
+        Lane top {mul(batch::tan(mul(load<Lane>(&fovs[i]), splat<Lane>(DEG2RAD / 2))), splat<Lane>(NEAR_PLANE))};
+        Lane scaleY {div(splat<Lane>(NEAR_PLANE), top)};
+        Lane scaleX {div(scaleY, splat<Lane>(aspectRatio))};
+        Lane zero {splat<Lane>(0)};
+
+        for (s32 element = 0; element < 16; element++)
+            store(&result.elements[element][i], zero);
+
+        store(&result.elements[0][i], scaleX);
+        store(&result.elements[5][i], scaleY);
+        store(&result.elements[10][i], splat<Lane>(-(FAR_PLANE + NEAR_PLANE) / depth));
+        store(&result.elements[11][i], splat<Lane>(-1));
+        store(&result.elements[14][i], splat<Lane>(-(2 * NEAR_PLANE * FAR_PLANE) / depth));
+    }
+}
+
+static void Mat4Perspective_AoS(benchmark::State& state)
+{
+    std::vector<f32> fovs {randomFloats(COUNT, 30, 110, 6)};
+    std::vector<Mat4> result(COUNT);
+
+    run(state, [&]
+    {
+        for (s32 i = 0; i < COUNT; i++)
+            result[i] = Mat4::perspective(NEAR_PLANE, FAR_PLANE, SCREEN_WIDTH, SCREEN_HEIGHT, fovs[i]);
+    });
+}
+
+template <typename Lane>
+void Mat4Perspective_SoA(benchmark::State& state)
+{
+    std::vector<f32> fovs {randomFloats(COUNT, 30, 110, 6)};
+    Mat4Soa result {std::vector<Mat4>(COUNT)};
+    run(state, [&] { perspectiveKernel<Lane>(fovs, result); });
+}
+
+BENCHMARK_BATCH(Mat4Multiply_AoS);
+BENCHMARK_BATCH(Mat4Multiply_AoS_Simd);
+BENCHMARK_BATCH(Mat4Multiply_SoA<f32>);
+BENCHMARK_BATCH(Mat4Multiply_SoA<simd::f32x4>);
+BENCHMARK_BATCH(Mat4Inverse_AoS);
+BENCHMARK_BATCH(Mat4Inverse_SoA<f32>);
+BENCHMARK_BATCH(Mat4Inverse_SoA<simd::f32x4>);
+BENCHMARK_BATCH(Mat4TransformPoint_AoS);
+BENCHMARK_BATCH(Mat4TransformPoint_SoA<f32>);
+BENCHMARK_BATCH(Mat4TransformPoint_SoA<simd::f32x4>);
+BENCHMARK_BATCH(Mat4Perspective_AoS);
+BENCHMARK_BATCH(Mat4Perspective_SoA<f32>);
+BENCHMARK_BATCH(Mat4Perspective_SoA<simd::f32x4>);
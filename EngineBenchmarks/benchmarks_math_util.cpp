@@ -0,0 +1,72 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "../Engine/math/math_util.hpp"
+#include "batch.hpp"
+
+using namespace batch;
+
+// Half of the pairs are within the tolerance, so neither outcome is always predicted.
+static void makePairs(std::vector<f32>& a, std::vector<f32>& b)
+{
+    a = randomFloats(COUNT, -1, 1, 0);
+    std::vector<f32> offsets {randomFloats(COUNT, -0.00002f, 0.00002f, 1)};
+    b.resize(COUNT);
+
+    for (s32 i = 0; i < COUNT; i++)
+        b[i] = a[i] + offsets[i];
+}
+
+struct Pair
+{
+    f32 a;
+    f32 b;
+};
+
+static void NearlyEqual_AoS(benchmark::State& state)
+{
+    std::vector<f32> a, b;
+    makePairs(a, b);
+    std::vector<Pair> pairs(COUNT);
+
+    for (s32 i = 0; i < COUNT; i++)
+        pairs[i] = Pair{a[i], b[i]};
+
+    for (auto _ : state)
+    {
+        s32 count {};
+
+        for (const Pair& pair : pairs)
+            count += Math::nearlyEqual(pair.a, pair.b) ? 1 : 0;
+
+        benchmark::DoNotOptimize(count);
+    }
+
+    state.SetItemsProcessed(state.iterations() * COUNT);
+}
+
+// The same comparison as Math::nearlyEqual().
+template <typename Lane>
+void NearlyEqual_SoA(benchmark::State& state)
+{
+    std::vector<f32> a, b;
+    makePairs(a, b);
+
+    for (auto _ : state)
+    {
+        s32 count {};
+
+        for (s32 i = 0; i < COUNT; i += WIDTH<Lane>)
+        {
+            Lane difference {batch::abs(sub(load<Lane>(&a[i]), load<Lane>(&b[i])))};
+            count += countTrue(lessEqual(difference, splat<Lane>(0.00001f)));
+        }
+
+        benchmark::DoNotOptimize(count);
+    }
+
+    state.SetItemsProcessed(state.iterations() * COUNT);
+}
+
+BENCHMARK_BATCH(NearlyEqual_AoS);
+BENCHMARK_BATCH(NearlyEqual_SoA<f32>);
+BENCHMARK_BATCH(NearlyEqual_SoA<simd::f32x4>);
@@ -0,0 +1,104 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "../Engine/math/noise.hpp"
+#include "../Engine/math/random.hpp"
+
+using namespace Math;
+
+constexpr s32 SAMPLE_COUNT {4096};
+
+static void Noise_SimplexScalar(benchmark::State& state)
+{
+    std::vector<f32> outputs(SAMPLE_COUNT);
+
+    for (auto _ : state)
+    {
+        for (s32 i = 0; i < SAMPLE_COUNT; i++)
+            outputs[i] = noise::simplex(static_cast<f32>(i) * 0.1f, 3.7f, 1);
+
+        benchmark::DoNotOptimize(outputs.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * SAMPLE_COUNT);
+}
+
+static void Noise_SimplexSimd(benchmark::State& state)
+{
+    std::vector<f32> outputs(SAMPLE_COUNT);
+    simd::f32x4 laneOffsets {simd::set(0.0f, 1.0f, 2.0f, 3.0f)};
+
+    for (auto _ : state)
+    {
+        for (s32 i = 0; i < SAMPLE_COUNT; i += simd::WIDTH)
+        {
+            simd::f32x4 x {simd::mul(simd::add(simd::set(static_cast<f32>(i)), laneOffsets), simd::set(0.1f))};
+            simd::store(&outputs[i], noise::simplex(x, simd::set(3.7f), 1));
+        }
+
+        benchmark::DoNotOptimize(outputs.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * SAMPLE_COUNT);
+}
+
+// Generates a square heightfield with six octaves and domain warping, using range(1) threads (0 = all).
+static void Noise_Heightfield(benchmark::State& state)
+{
+    s32 size {static_cast<s32>(state.range(0))};
+    std::vector<f32> heights(size * size);
+
+    noise::HeightfieldSettings settings {};
+    settings.fractal.frequency = 0.01f;
+    settings.warpStrength = 20;
+
+    for (auto _ : state)
+    {
+        noise::generateHeightfield(heights.data(), size, size, settings, static_cast<s32>(state.range(1)));
+        benchmark::DoNotOptimize(heights.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * size * size);
+}
+
+static void Random_Scalar(benchmark::State& state)
+{
+    Random random {1};
+    std::vector<u32> outputs(SAMPLE_COUNT);
+
+    for (auto _ : state)
+    {
+        for (s32 i = 0; i < SAMPLE_COUNT; i++)
+            outputs[i] = random.next();
+
+        benchmark::DoNotOptimize(outputs.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * SAMPLE_COUNT);
+}
+
+static void Random_Simd(benchmark::State& state)
+{
+    RandomX4 random {Random{1}};
+    std::vector<u32> outputs(SAMPLE_COUNT);
+
+    for (auto _ : state)
+    {
+        for (s32 i = 0; i < SAMPLE_COUNT; i += simd::WIDTH)
+            simd::storeInt(&outputs[i], random.next());
+
+        benchmark::DoNotOptimize(outputs.data());
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * SAMPLE_COUNT);
+}
+
+BENCHMARK(Noise_SimplexScalar);
+BENCHMARK(Noise_SimplexSimd);
+BENCHMARK(Noise_Heightfield)->Args({512, 1})->Args({512, 0})->Args({2048, 0})->Unit(benchmark::kMillisecond);
+BENCHMARK(Random_Scalar);
+BENCHMARK(Random_Simd);
@@ -0,0 +1,179 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include "../Engine/resources/resource_manager.hpp"
+#include "../Engine/resources/texture.hpp"
+#include "../Engine/string_name_table.hpp"
+
+// Loads a level's worth of textures out of a synthetic package, one load() at a time in a random order,
+// and with one loadBatch(). The package is streamed and nothing is cached, so every iteration reads it again.
+// The argument is the stride between the textures, so 2 leaves a gap after each one that a batch reads over.
+// These run with the package in the page cache, where seeks are free, so they show the CPU side of the
+// cost. On a cold disk, the gaps are much cheaper to read than to seek over.
+
+constexpr s32 ASSET_COUNT {4096};
+
+static const std::string& packagePath()
+{
+    static const std::string path = []
+    {
+        std::string result {(std::filesystem::temp_directory_path() / "benchmarks_resource_manager.pak").string()};
+        std::fstream file {result, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc};
+        PackageWriter writer {&file, false};
+        std::mt19937 random {0x5EED};
+        std::vector<u8> pixels(32 * 32 * 4);
+
+        for (s32 i = 0; i < ASSET_COUNT; i++)
+        {
+            for (u8& pixel : pixels)
+                pixel = static_cast<u8>(random());
+
+            Texture texture {};
+            texture.width = 32;
+            texture.height = 32;
+            texture.channels = 4;
+            texture.pixelData = pixels.data();
+            writeResourceTo(&texture, writer.beginAsset(StringNameTable::intern(std::format("Texture{}", i))));
+        }
+
+        writer.finish();
+        return result;
+    }();
+
+    return path;
+}
+
+// Half of the assets, spread out by a stride.
+static std::vector<StringName> levelNames(s32 stride)
+{
+    std::vector<s32> assets {};
+
+    for (s32 i = 0; i < ASSET_COUNT / 2; i++)
+        assets.push_back(i * stride);
+
+    std::shuffle(assets.begin(), assets.end(), std::mt19937{42});
+    std::vector<StringName> names {};
+
+    for (s32 asset : assets)
+        names.push_back(StringNameTable::intern(std::format("Texture{}", asset)));
+
+    return names;
+}
+
+static void ResourceManager_LoadEach(benchmark::State& state)
+{
+    ResourceManager resourceManager {packagePath().c_str(), PackageAccess::Streamed};
+    resourceManager.setCacheBudget(0);
+    std::vector<StringName> names {levelNames(static_cast<s32>(state.range(0)))};
+    Logger::g_severityMask = Logger::Severity::Error;
+
+    for (auto _ : state)
+    {
+        for (StringName name : names)
+            benchmark::DoNotOptimize(resourceManager.load<Texture>(name).data);
+
+        for (StringName name : names)
+            resourceManager.unload(name);
+    }
+
+    BlockCacheStats stats {resourceManager.getBlockCacheStats()};
+    state.counters["block_hit_rate"] = static_cast<f64>(stats.hits) / static_cast<f64>(stats.hits + stats.misses);
+    state.SetItemsProcessed(state.iterations() * static_cast<s64>(names.size()));
+}
+
+static void ResourceManager_LoadBatch(benchmark::State& state)
+{
+    ResourceManager resourceManager {packagePath().c_str(), PackageAccess::Streamed};
+    resourceManager.setCacheBudget(0);
+    std::vector<StringName> names {levelNames(static_cast<s32>(state.range(0)))};
+    Logger::g_severityMask = Logger::Severity::Error;
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(resourceManager.loadBatch<Texture>(names).data());
+
+        for (StringName name : names)
+            resourceManager.unload(name);
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<s64>(names.size()));
+}
+
+// Loads from a mapped package, with the same package mounted again and again over it. Every mount overrides
+// the last, so this shows what a lookup costs as packages are added. It should stay flat.
+static void ResourceManager_LoadMounted(benchmark::State& state)
+{
+    Logger::g_severityMask = Logger::Severity::Error;
+    ResourceManager resourceManager {PackageAccess::Mapped};
+    resourceManager.setCacheBudget(0);
+    std::vector<StringName> names {levelNames(1)};
+
+    for (s64 i = 0; i < state.range(0); i++)
+        resourceManager.mount(packagePath().c_str());
+
+    for (auto _ : state)
+    {
+        for (StringName name : names)
+            benchmark::DoNotOptimize(resourceManager.load<Texture>(name).data);
+
+        for (StringName name : names)
+            resourceManager.unload(name);
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<s64>(names.size()));
+}
+
+// Loads and unloads from many threads at once, out of one shared manager. The first half of every thread's
+// loads hit resources that stay referenced the whole time, the rest hit the cache or go back to the package.
+static ResourceManager* s_sharedManager {};
+
+static void ResourceManager_ConcurrentLoadUnload(benchmark::State& state)
+{
+    constexpr s32 HELD_COUNT {256};
+    constexpr s32 LOADED_COUNT {1024};
+
+    if (state.thread_index() == 0)
+    {
+        Logger::g_severityMask = Logger::Severity::Error;
+        s_sharedManager = new ResourceManager {packagePath().c_str(), PackageAccess::Mapped};
+
+        for (s32 i = 0; i < HELD_COUNT; i++)
+            s_sharedManager->load<Texture>(StringNameTable::intern(std::format("Texture{}", i)));
+    }
+
+    std::vector<StringName> names {};
+    std::mt19937 random {static_cast<u32>(state.thread_index())};
+
+    for (s32 i = 0; i < 4096; i++)
+    {
+        s32 texture {i % 2 == 0 ? static_cast<s32>(random() % HELD_COUNT) : static_cast<s32>(random() % LOADED_COUNT)};
+        names.push_back(StringNameTable::intern(std::format("Texture{}", texture)));
+    }
+
+    for (auto _ : state)
+    {
+        for (StringName name : names)
+        {
+            benchmark::DoNotOptimize(s_sharedManager->load<Texture>(name).data);
+            s_sharedManager->unload(name);
+        }
+    }
+
+    if (state.thread_index() == 0)
+    {
+        delete s_sharedManager;
+        s_sharedManager = nullptr;
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<s64>(names.size()));
+}
+
+BENCHMARK(ResourceManager_LoadEach)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+BENCHMARK(ResourceManager_LoadBatch)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+BENCHMARK(ResourceManager_LoadMounted)->Arg(1)->Arg(8)->Arg(64)->Unit(benchmark::kMillisecond);
+BENCHMARK(ResourceManager_ConcurrentLoadUnload)->ThreadRange(1, 8)->UseRealTime()->Unit(benchmark::kMillisecond);
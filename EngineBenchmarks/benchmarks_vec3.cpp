@@ -0,0 +1,125 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "../Engine/math/vec3.hpp"
+#include "batch.hpp"
+
+using namespace batch;
+
+// Covers the VectorBase operations (through Vec3), plus Vec3::cross.
+
+struct Vec3Soa
+{
+    std::vector<f32> x, y, z;
+};
+
+static Vec3Soa makeSoa(u64 stream)
+{
+    return Vec3Soa{randomFloats(COUNT, -10, 10, stream * 3), randomFloats(COUNT, -10, 10, stream * 3 + 1), randomFloats(COUNT, -10, 10, stream * 3 + 2)};
+}
+
+static std::vector<Vec3> makeAos(u64 stream)
+{
+    Vec3Soa soa {makeSoa(stream)};
+    std::vector<Vec3> result(COUNT);
+
+    for (s32 i = 0; i < COUNT; i++)
+        result[i] = Vec3{soa.x[i], soa.y[i], soa.z[i]};
+
+    return result;
+}
+
+// Runs a per-element operation over an AoS batch once per iteration.
+template <typename Function>
+void runAos(benchmark::State& state, Function&& function)
+{
+    for (auto _ : state)
+    {
+        for (s32 i = 0; i < COUNT; i++)
+            function(i);
+
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * COUNT);
+}
+
+// Runs a per-lane operation over an SoA batch once per iteration, with the inputs already loaded.
+template <typename Lane, typename Function>
+void runSoa(benchmark::State& state, Function&& function)
+{
+    Vec3Soa a {makeSoa(0)}, b {makeSoa(1)}, result {makeSoa(2)};
+    std::vector<f32> scalars(COUNT);
+
+    for (auto _ : state)
+    {
+        for (s32 i = 0; i < COUNT; i += WIDTH<Lane>)
+        {
+            Lane ax {load<Lane>(&a.x[i])}, ay {load<Lane>(&a.y[i])}, az {load<Lane>(&a.z[i])};
+            Lane bx {load<Lane>(&b.x[i])}, by {load<Lane>(&b.y[i])}, bz {load<Lane>(&b.z[i])};
+            function(ax, ay, az, bx, by, bz, &result.x[i], &result.y[i], &result.z[i], &scalars[i]);
+        }
+
+        benchmark::ClobberMemory();
+    }
+
+    state.SetItemsProcessed(state.iterations() * COUNT);
+}
+
+// Registers the AoS benchmark, and both SoA instantiations of a kernel.
+#define BENCHMARK_VEC3(Name, AosBody, SoaBody) \
+    static void Vec3##Name##_AoS(benchmark::State& state) \
+    { \
+        std::vector<Vec3> a {makeAos(0)}, b {makeAos(1)}, result(COUNT); \
+        std::vector<f32> scalars(COUNT); \
+        runAos(state, [&](s32 i) { AosBody; }); \
+    } \
+    template <typename Lane> \
+    void Vec3##Name##_SoA(benchmark::State& state) \
+    { \
+        runSoa<Lane>(state, [](Lane ax, Lane ay, Lane az, Lane bx, Lane by, Lane bz, f32* rx, f32* ry, f32* rz, f32* scalar) \
+        { \
+            (void)ax; (void)ay; (void)az; (void)bx; (void)by; (void)bz; \
+            (void)rx; (void)ry; (void)rz; (void)scalar; \
+            SoaBody; \
+        }); \
+    } \
+    BENCHMARK_BATCH(Vec3##Name##_AoS); \
+    BENCHMARK_BATCH(Vec3##Name##_SoA<f32>); \
+    BENCHMARK_BATCH(Vec3##Name##_SoA<simd::f32x4>);
+
+BENCHMARK_VEC3(Add,
+    result[i] = a[i] + b[i],
+    store(rx, add(ax, bx)); store(ry, add(ay, by)); store(rz, add(az, bz)))
+
+BENCHMARK_VEC3(Scale,
+    result[i] = a[i] * 1.5f,
+    Lane s {splat<Lane>(1.5f)}; store(rx, mul(ax, s)); store(ry, mul(ay, s)); store(rz, mul(az, s)))
+
+BENCHMARK_VEC3(Dot,
+    scalars[i] = Vec3::dot(a[i], b[i]),
+    store(scalar, madd(az, bz, madd(ay, by, mul(ax, bx)))))
+
+BENCHMARK_VEC3(Cross,
+    result[i] = Vec3::cross(a[i], b[i]),
+    store(rx, sub(mul(ay, bz), mul(az, by)));
+    store(ry, sub(mul(az, bx), mul(ax, bz)));
+    store(rz, sub(mul(ax, by), mul(ay, bx))))
+
+BENCHMARK_VEC3(Magnitude,
+    scalars[i] = a[i].magnitude(),
+    store(scalar, batch::sqrt(madd(az, az, madd(ay, ay, mul(ax, ax))))))
+
+// Matches VectorBase::normalize(), which leaves (nearly) zero vectors unchanged.
+BENCHMARK_VEC3(Normalize,
+    result[i] = a[i].normalized(),
+    Lane m {batch::sqrt(madd(az, az, madd(ay, ay, mul(ax, ax))))};
+    auto isZero = lessEqual(batch::abs(m), splat<Lane>(0.00001f));
+    Lane inverse {select(isZero, splat<Lane>(1), div(splat<Lane>(1), m))};
+    store(rx, mul(ax, inverse)); store(ry, mul(ay, inverse)); store(rz, mul(az, inverse)))
+
+BENCHMARK_VEC3(Lerp,
+    result[i] = Vec3::lerp(a[i], b[i], 0.25f),
+    Lane t {splat<Lane>(0.25f)}; Lane u {splat<Lane>(0.75f)};
+    store(rx, madd(u, ax, mul(t, bx))); store(ry, madd(u, ay, mul(t, by))); store(rz, madd(u, az, mul(t, bz))))
+
+#undef BENCHMARK_VEC3
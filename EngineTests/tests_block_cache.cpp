@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../Engine/resources/block_cache.hpp"
+
+using namespace FileSystem;
+
+constexpr u64 FILE_SIZE {BlockCache::BLOCK_SIZE * 8 + 1000};
+
+class BlockCacheTests : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        std::string path {testing::TempDir() + "block_cache_tests.bin"};
+
+        {
+            std::ofstream output {path, std::ios::binary | std::ios::trunc};
+
+            for (u64 i = 0; i < FILE_SIZE; i++)
+                output.put(static_cast<char>(i * 13));
+        }
+
+        m_file = openFile(path.c_str(), FileAccess::Read);
+        ASSERT_NE(m_file, nullptr);
+    }
+
+    void TearDown() override
+    {
+        if (m_file == nullptr)
+            return;
+
+        m_file->close();
+        delete m_file;
+    }
+
+    static bool matches(const std::vector<u8>& data, u64 offset)
+    {
+        for (u64 i = 0; i < data.size(); i++)
+        {
+            if (data[i] != static_cast<u8>((offset + i) * 13))
+                return false;
+        }
+
+        return true;
+    }
+
+    File* m_file {};
+};
+
+TEST_F(BlockCacheTests, ReadsAcrossBlocks)
+{
+    BlockCache cache {m_file};
+
+    // Starting in one block, running through the next, and ending in the one after.
+    std::vector<u8> data(BlockCache::BLOCK_SIZE + 200);
+    ASSERT_TRUE(cache.read(data.data(), data.size(), BlockCache::BLOCK_SIZE - 100));
+    EXPECT_TRUE(matches(data, BlockCache::BLOCK_SIZE - 100));
+
+    // The short block at the end of the file.
+    data.resize(1000);
+    ASSERT_TRUE(cache.read(data.data(), data.size(), FILE_SIZE - 1000));
+    EXPECT_TRUE(matches(data, FILE_SIZE - 1000));
+
+    EXPECT_FALSE(cache.read(data.data(), data.size(), FILE_SIZE - 10));
+}
+
+TEST_F(BlockCacheTests, SmallReadsHitTheCache)
+{
+    BlockCache cache {m_file};
+    std::vector<u8> data(100);
+
+    // Far apart, so nothing is read ahead.
+    ASSERT_TRUE(cache.read(data.data(), data.size(), BlockCache::BLOCK_SIZE * 4));
+    ASSERT_TRUE(cache.read(data.data(), data.size(), BlockCache::BLOCK_SIZE * 4 + 500));
+    EXPECT_TRUE(matches(data, BlockCache::BLOCK_SIZE * 4 + 500));
+
+    BlockCacheStats stats {cache.getStats()};
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.cachedBytes, BlockCache::BLOCK_SIZE);
+
+    EXPECT_TRUE(cache.readCached(data.data(), data.size(), BlockCache::BLOCK_SIZE * 4 + 1000));
+    EXPECT_TRUE(matches(data, BlockCache::BLOCK_SIZE * 4 + 1000));
+    EXPECT_FALSE(cache.readCached(data.data(), data.size(), 0));
+    EXPECT_EQ(cache.getStats().misses, 1u);
+}
+
+TEST_F(BlockCacheTests, PrefetchesSequentialReads)
+{
+    BlockCache cache {m_file};
+    std::vector<u8> data(BlockCache::BLOCK_SIZE / 2);
+
+    for (u64 offset = 0; offset + data.size() <= FILE_SIZE; offset += data.size())
+    {
+        ASSERT_TRUE(cache.read(data.data(), data.size(), offset));
+        EXPECT_TRUE(matches(data, offset));
+    }
+
+    // Only the first block had to be waited for, the rest were read ahead.
+    BlockCacheStats stats {cache.getStats()};
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_GE(stats.prefetches, 7u);
+}
+
+TEST_F(BlockCacheTests, ReadsAheadWhenAsked)
+{
+    BlockCache cache {m_file};
+    std::vector<u8> data(200);
+
+    // Straddles blocks 2 and 3, neither of which is cached yet.
+    cache.readAhead(BlockCache::BLOCK_SIZE * 3 - 100, data.size());
+    cache.readAhead(BlockCache::BLOCK_SIZE * 3 - 100, data.size());
+    EXPECT_EQ(cache.getStats().prefetches, 2u);
+
+    ASSERT_TRUE(cache.read(data.data(), data.size(), BlockCache::BLOCK_SIZE * 3 - 100));
+    EXPECT_TRUE(matches(data, BlockCache::BLOCK_SIZE * 3 - 100));
+    EXPECT_EQ(cache.getStats().misses, 0u);
+}
+
+TEST_F(BlockCacheTests, EvictsLeastRecentlyUsed)
+{
+    BlockCache cache {m_file, BlockCache::BLOCK_SIZE * 2};
+    u8 data {};
+
+    // Every other block, so nothing is read ahead.
+    ASSERT_TRUE(cache.read(&data, 1, BlockCache::BLOCK_SIZE));
+    ASSERT_TRUE(cache.read(&data, 1, BlockCache::BLOCK_SIZE * 3));
+    ASSERT_TRUE(cache.read(&data, 1, BlockCache::BLOCK_SIZE));
+    ASSERT_TRUE(cache.read(&data, 1, BlockCache::BLOCK_SIZE * 5));
+
+    EXPECT_TRUE(cache.readCached(&data, 1, BlockCache::BLOCK_SIZE));
+    EXPECT_FALSE(cache.readCached(&data, 1, BlockCache::BLOCK_SIZE * 3));
+
+    BlockCacheStats stats {cache.getStats()};
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_EQ(stats.cachedBytes, BlockCache::BLOCK_SIZE * 2);
+
+    cache.setBudget(0);
+    EXPECT_EQ(cache.getStats().cachedBytes, 0u);
+
+    // Still reads, just without keeping anything.
+    ASSERT_TRUE(cache.read(&data, 1, 1));
+    EXPECT_EQ(data, 13);
+}
+
+TEST_F(BlockCacheTests, ConcurrentReadersShareAFill)
+{
+    BlockCache cache {m_file};
+    std::vector<std::thread> threads {};
+    // Not vector<bool>, which packs every thread's flag into the same word.
+    std::vector<u8> matched(8);
+
+    for (s32 thread = 0; thread < 8; thread++)
+    {
+        threads.emplace_back([&, thread]
+        {
+            std::vector<u8> data(1000);
+            u64 offset {BlockCache::BLOCK_SIZE * 6 + thread * 1000};
+            matched[thread] = cache.read(data.data(), data.size(), offset) && matches(data, offset);
+        });
+    }
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    for (bool threadMatched : matched)
+        EXPECT_TRUE(threadMatched);
+
+    EXPECT_EQ(cache.getStats().misses, 1u);
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include "../Engine/math/aabb.hpp"
+#include "../Engine/math/sphere.hpp"
+#include "../Engine/math/mat4.hpp"
+#include "../Engine/math/math_util.hpp"
+
+using namespace Math;
+
+TEST(AabbTests, CenterExtents)
+{
+    Aabb box {Aabb::fromCenterExtents({1, 2, 3}, {4, 5, 6})};
+    EXPECT_EQ(box.min, Vec3(-3, -3, -3));
+    EXPECT_EQ(box.max, Vec3(5, 7, 9));
+    EXPECT_EQ(box.center(), Vec3(1, 2, 3));
+    EXPECT_EQ(box.extents(), Vec3(4, 5, 6));
+}
+
+TEST(AabbTests, Contains)
+{
+    Aabb box {{-1, -1, -1}, {1, 1, 1}};
+    EXPECT_TRUE(box.contains(Vec3::ZERO));
+    EXPECT_TRUE(box.contains(Vec3::ONE));
+    EXPECT_FALSE(box.contains({0, 1.5f, 0}));
+}
+
+TEST(AabbTests, Intersects)
+{
+    Aabb box {{0, 0, 0}, {1, 1, 1}};
+    EXPECT_TRUE(box.intersects({{0.5f, 0.5f, 0.5f}, {2, 2, 2}}));
+    EXPECT_TRUE(box.intersects({{1, 1, 1}, {2, 2, 2}}));
+    EXPECT_FALSE(box.intersects({{1.5f, 0, 0}, {2, 1, 1}}));
+}
+
+TEST(AabbTests, Encapsulate)
+{
+    Aabb box {Vec3::ZERO, Vec3::ZERO};
+    box.encapsulate({-1, 2, 0});
+    box.encapsulate({3, -4, 5});
+    EXPECT_EQ(box.min, Vec3(-1, -4, 0));
+    EXPECT_EQ(box.max, Vec3(3, 2, 5));
+}
+
+TEST(AabbTests, Transformed)
+{
+    Aabb box {{-1, -1, -1}, {1, 1, 1}};
+
+    Aabb moved {box.transformed(Mat4::translate(10, 0, 0))};
+    EXPECT_EQ(moved.min, Vec3(9, -1, -1));
+    EXPECT_EQ(moved.max, Vec3(11, 1, 1));
+
+    // A 45 degree turn makes the box wider, by a factor of sqrt(2).
+    Aabb turned {box.transformed(Mat4::rotateY(PI / 4))};
+    EXPECT_NEAR(turned.max.x, std::sqrt(2.0f), 0.0001f);
+    EXPECT_NEAR(turned.max.z, std::sqrt(2.0f), 0.0001f);
+    EXPECT_NEAR(turned.max.y, 1, 0.0001f);
+}
+
+TEST(SphereTests, FromAabb)
+{
+    Sphere sphere {Sphere::fromAabb({{0, 0, 0}, {2, 2, 2}})};
+    EXPECT_EQ(sphere.center, Vec3::ONE);
+    EXPECT_FLOAT_EQ(sphere.radius, std::sqrt(3.0f));
+}
+
+TEST(SphereTests, ContainsAndIntersects)
+{
+    Sphere sphere {Vec3::ZERO, 2};
+    EXPECT_TRUE(sphere.contains({0, 2, 0}));
+    EXPECT_FALSE(sphere.contains({2, 2, 0}));
+    EXPECT_TRUE(sphere.intersects({{3, 0, 0}, 1}));
+    EXPECT_FALSE(sphere.intersects({{3.5f, 0, 0}, 1}));
+}
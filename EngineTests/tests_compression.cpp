@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "../Engine/resources/compression.hpp"
+#include "../Engine/thread_pool.hpp"
+
+static std::vector<u8> roundTrip(const std::vector<u8>& data)
+{
+    std::vector<u8> compressed(Compression::maxCompressedSize(data.size()));
+    size_t size {Compression::compress(data, compressed)};
+    EXPECT_NE(size, 0u);
+    compressed.resize(size);
+
+    std::vector<u8> result(data.size());
+    EXPECT_TRUE(Compression::decompress(compressed, result));
+    return result;
+}
+
+static std::vector<u8> randomBytes(size_t size)
+{
+    std::mt19937 random {1234};
+    std::vector<u8> result(size);
+
+    for (u8& byte : result)
+        byte = static_cast<u8>(random());
+
+    return result;
+}
+
+TEST(CompressionTests, RoundTrips)
+{
+    std::vector<std::vector<u8>> inputs {{}, {7}, {1, 2, 3}, std::vector<u8>(100000, 42), randomBytes(70000)};
+
+    // Matches of every length and distance, including ones that overlap their own output.
+    std::vector<u8> repeats {};
+
+    for (s32 i = 0; i < 5000; i++)
+        repeats.push_back(static_cast<u8>(i % (1 + i / 500)));
+
+    inputs.push_back(repeats);
+
+    for (const std::vector<u8>& input : inputs)
+        EXPECT_EQ(roundTrip(input), input);
+}
+
+TEST(CompressionTests, ShrinksRepetitiveData)
+{
+    std::vector<u8> data(64 * 1024);
+
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = static_cast<u8>(i % 24);
+
+    std::vector<u8> compressed(Compression::maxCompressedSize(data.size()));
+    EXPECT_LT(Compression::compress(data, compressed), data.size() / 50);
+}
+
+TEST(CompressionTests, StaysWithinBound)
+{
+    std::vector<u8> data {randomBytes(100000)};
+    std::vector<u8> compressed(Compression::maxCompressedSize(data.size()));
+    EXPECT_NE(Compression::compress(data, compressed), 0u);
+
+    // Too small a destination is reported, not overrun.
+    std::vector<u8> tooSmall(data.size() / 2);
+    EXPECT_EQ(Compression::compress(data, tooSmall), 0u);
+}
+
+TEST(CompressionTests, RejectsDamagedData)
+{
+    std::vector<u8> data {randomBytes(1000)};
+    data.resize(10000, 5);
+    std::vector<u8> compressed(Compression::maxCompressedSize(data.size()));
+    compressed.resize(Compression::compress(data, compressed));
+    std::vector<u8> result(data.size());
+    ASSERT_TRUE(Compression::decompress(compressed, result));
+
+    // Cut short.
+    EXPECT_FALSE(Compression::decompress(std::span{compressed}.first(compressed.size() / 2), result));
+
+    // The wrong size.
+    std::vector<u8> tooLarge(data.size() + 1);
+    EXPECT_FALSE(Compression::decompress(compressed, tooLarge));
+
+    // A match from before the start of the output.
+    std::vector<u8> badOffset {0x00, 0x05, 0x00};
+    EXPECT_FALSE(Compression::decompress(badOffset, result));
+}
+
+TEST(ThreadPoolTests, ParallelForRunsEveryIndexOnce)
+{
+    ThreadPool pool {4};
+    std::vector<std::atomic<s32>> counts(1000);
+
+    pool.parallelFor(static_cast<u32>(counts.size()), [&](u32 index) { counts[index]++; });
+
+    for (std::atomic<s32>& count : counts)
+        EXPECT_EQ(count, 1);
+
+    // Nested inside a job, even with every worker busy.
+    std::atomic<s32> total {};
+
+    pool.parallelFor(4, [&](u32)
+    {
+        pool.parallelFor(100, [&](u32) { total++; });
+    });
+
+    EXPECT_EQ(total, 400);
+}
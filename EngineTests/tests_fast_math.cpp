@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include "../Engine/math/fast_math.hpp"
+
+using namespace Math;
+using namespace Math::fast;
+
+// These sweep each function densely over its documented range, and check that the
+// worst error (against double precision libm) stays within the bound in fast_math.hpp.
+
+constexpr s32 SAMPLES {200000};
+
+template <typename Function>
+f64 maxError(f32 start, f32 end, Function&& error)
+{
+    f64 result {};
+
+    for (s32 i = 0; i <= SAMPLES; i++)
+    {
+        f32 x {start + (end - start) * static_cast<f32>(i) / SAMPLES};
+        result = std::max(result, error(x));
+    }
+
+    return result;
+}
+
+// Runs a SIMD function on a single value, and reads back its first lane.
+template <typename Function>
+f32 firstLane(Function&& function, f32 x)
+{
+    return simd::lane(function(simd::set(x)), 0);
+}
+
+TEST(FastMathTests, ReciprocalSquareRoot)
+{
+    auto relativeError = [](f32 value, f32 x) { return std::abs(value * std::sqrt(static_cast<f64>(x)) - 1); };
+
+    EXPECT_LE(maxError(-40, 40, [&](f32 e) { f32 x = std::exp2(e); return relativeError(rsqrt<Accuracy::Low>(x), x); }), 1.8e-3);
+    EXPECT_LE(maxError(-40, 40, [&](f32 e) { f32 x = std::exp2(e); return relativeError(rsqrt<Accuracy::High>(x), x); }), 4.8e-6);
+    EXPECT_LE(maxError(-40, 40, [&](f32 e)
+    {
+        f32 x = std::exp2(e);
+        return relativeError(firstLane([](simd::f32x4 v) { return rsqrt(v); }, x), x);
+    }), 4.8e-6);
+}
+
+TEST(FastMathTests, SquareRoot)
+{
+    EXPECT_EQ(fast::sqrt(0.0f), 0);
+    EXPECT_EQ(simd::lane(fast::sqrt(simd::set(0.0f)), 0), 0);
+    EXPECT_NEAR(fast::sqrt(25.0f), 5, 5 * 4.8e-6);
+    EXPECT_NEAR(simd::lane(fast::sqrt(simd::set(25.0f)), 0), 5, 5 * 4.8e-6);
+}
+
+TEST(FastMathTests, Sine)
+{
+    auto error = [](f32 value, f32 x) { return std::abs(value - std::sin(static_cast<f64>(x))); };
+
+    EXPECT_LE(maxError(-8192, 8192, [&](f32 x) { return error(fast::sin<Accuracy::Low>(x), x); }), 1.5e-4);
+    EXPECT_LE(maxError(-8192, 8192, [&](f32 x) { return error(fast::sin<Accuracy::High>(x), x); }), 2.5e-7);
+    EXPECT_LE(maxError(-8192, 8192, [&](f32 x)
+    {
+        return error(firstLane([](simd::f32x4 v) { return fast::sin<Accuracy::Low>(v); }, x), x);
+    }), 1.5e-4);
+    EXPECT_LE(maxError(-8192, 8192, [&](f32 x)
+    {
+        return error(firstLane([](simd::f32x4 v) { return fast::sin(v); }, x), x);
+    }), 2.5e-7);
+}
+
+TEST(FastMathTests, Cosine)
+{
+    auto error = [](f32 value, f32 x) { return std::abs(value - std::cos(static_cast<f64>(x))); };
+
+    EXPECT_LE(maxError(-8192, 8192, [&](f32 x) { return error(fast::cos<Accuracy::Low>(x), x); }), 1.5e-4);
+    EXPECT_LE(maxError(-8192, 8192, [&](f32 x) { return error(fast::cos<Accuracy::High>(x), x); }), 2.5e-7);
+    EXPECT_LE(maxError(-8192, 8192, [&](f32 x)
+    {
+        return error(firstLane([](simd::f32x4 v) { return fast::cos(v); }, x), x);
+    }), 2.5e-7);
+}
+
+TEST(FastMathTests, ArcTangent)
+{
+    // Walk around circles of a few different sizes, so every octant is covered.
+    for (f32 radius : {0.001f, 1.0f, 1000.0f})
+    {
+        auto error = [radius](auto function)
+        {
+            return maxError(-PI, PI, [&](f32 angle)
+            {
+                f32 y {std::sin(angle) * radius};
+                f32 x {std::cos(angle) * radius};
+                return std::abs(function(y, x) - std::atan2(static_cast<f64>(y), static_cast<f64>(x)));
+            });
+        };
+
+        EXPECT_LE(error([](f32 y, f32 x) { return fast::atan2<Accuracy::Low>(y, x); }), 8.5e-5);
+        EXPECT_LE(error([](f32 y, f32 x) { return fast::atan2<Accuracy::High>(y, x); }), 6.0e-7);
+        EXPECT_LE(error([](f32 y, f32 x) { return simd::lane(fast::atan2(simd::set(y), simd::set(x)), 0); }), 6.0e-7);
+    }
+
+    EXPECT_EQ(fast::atan2(0.0f, 0.0f), 0);
+    EXPECT_EQ(simd::lane(fast::atan2(simd::set(0.0f), simd::set(0.0f)), 0), 0);
+}
+
+TEST(FastMathTests, Exponent)
+{
+    auto relativeError = [](f32 value, f32 x)
+    {
+        f64 expected {std::exp2(static_cast<f64>(x))};
+        return std::abs(value - expected) / expected;
+    };
+
+    EXPECT_LE(maxError(-126, 127, [&](f32 x) { return relativeError(fast::exp2<Accuracy::Low>(x), x); }), 7.5e-5);
+    EXPECT_LE(maxError(-126, 127, [&](f32 x) { return relativeError(fast::exp2<Accuracy::High>(x), x); }), 3.0e-7);
+    EXPECT_LE(maxError(-126, 127, [&](f32 x)
+    {
+        return relativeError(firstLane([](simd::f32x4 v) { return fast::exp2(v); }, x), x);
+    }), 3.0e-7);
+
+    EXPECT_NEAR(fast::exp2(3.0f), 8, 8 * 3.0e-7);
+    EXPECT_NEAR(fast::exp2(-1.0f), 0.5f, 0.5f * 3.0e-7);
+}
+
+TEST(FastMathTests, Logarithm)
+{
+    auto error = [](f32 value, f32 x) { return std::abs(value - std::log2(static_cast<f64>(x))); };
+
+    EXPECT_LE(maxError(-60, 60, [&](f32 e) { f32 x = std::exp2(e); return error(fast::log2<Accuracy::Low>(x), x); }), 1.1e-4);
+    EXPECT_LE(maxError(-60, 60, [&](f32 e) { f32 x = std::exp2(e); return error(fast::log2<Accuracy::High>(x), x); }), 6.0e-7);
+    EXPECT_LE(maxError(-60, 60, [&](f32 e)
+    {
+        f32 x = std::exp2(e);
+        return error(firstLane([](simd::f32x4 v) { return fast::log2(v); }, x), x);
+    }), 6.0e-7);
+
+    EXPECT_EQ(fast::log2(1.0f), 0);
+    EXPECT_EQ(fast::log2(1024.0f), 10);
+}
+
+TEST(FastMathTests, LanesAreIndependent)
+{
+    simd::f32x4 x {simd::set(0.5f, -2.0f, 100.0f, 3.0f)};
+    simd::f32x4 result {fast::sin(x)};
+
+    for (s32 i = 0; i < simd::WIDTH; i++)
+        EXPECT_NEAR(simd::lane(result, i), std::sin(simd::lane(x, i)), 2.5e-7);
+}
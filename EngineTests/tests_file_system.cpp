@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../Engine/platform/file_system.hpp"
+#include "../Engine/platform/pooled_read_queue.hpp"
+
+using namespace FileSystem;
+
+static std::string writeTestFile(size_t size)
+{
+    std::string path {testing::TempDir() + "file_system_tests.bin"};
+    std::ofstream file {path, std::ios::binary | std::ios::trunc};
+
+    for (size_t i = 0; i < size; i++)
+        file.put(static_cast<char>(i * 7));
+
+    return path;
+}
+
+TEST(FileSystemTests, ReadsAtOffsets)
+{
+    std::string path {writeTestFile(100000)};
+    File* file {openFile(path.c_str(), FileAccess::Read)};
+    ASSERT_NE(file, nullptr);
+    EXPECT_EQ(file->size(), 100000u);
+
+    file->adviseAccess(AccessHint::Random);
+    file->adviseAccess(AccessHint::WillNeed, 50000, 1000);
+
+    // Positional reads from several threads at once, which a shared cursor couldn't do.
+    std::vector<std::thread> threads {};
+    // Not vector<bool>, which packs every thread's flag into the same word.
+    std::vector<u8> matched(8);
+
+    for (s32 thread = 0; thread < 8; thread++)
+    {
+        threads.emplace_back([&, thread]
+        {
+            bool allMatched {true};
+
+            for (u64 offset = thread * 997; offset + 64 <= 100000; offset += 8 * 997)
+            {
+                u8 data[64] {};
+                allMatched &= file->readAt(data, sizeof(data), offset);
+
+                for (u64 i = 0; i < sizeof(data); i++)
+                    allMatched &= data[i] == static_cast<u8>((offset + i) * 7);
+            }
+
+            matched[thread] = allMatched;
+        });
+    }
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    for (bool threadMatched : matched)
+        EXPECT_TRUE(threadMatched);
+
+    // The cursor is left alone.
+    u8 first {};
+    file->read(&first, 1);
+    EXPECT_EQ(first, 0);
+
+    file->seek(10);
+    file->read(&first, 1);
+    EXPECT_EQ(first, 70);
+
+    file->close();
+    delete file;
+}
+
+TEST(FileSystemTests, ReadsPastTheEndFail)
+{
+    std::string path {writeTestFile(10)};
+    File* file {openFile(path.c_str(), FileAccess::Read)};
+    ASSERT_NE(file, nullptr);
+
+    u8 data[16] {};
+    EXPECT_FALSE(file->readAt(data, sizeof(data), 0));
+    EXPECT_TRUE(file->readAt(data, 10, 0));
+
+    file->close();
+    delete file;
+}
+
+// Queues a read of 64 bytes at every offset, and checks each one as it completes.
+static void expectAsyncReads(ReadQueue& queue, const std::vector<u64>& offsets)
+{
+    std::vector<std::array<u8, 64>> data(offsets.size());
+
+    for (size_t i = 0; i < offsets.size(); i++)
+        queue.queue(data[i].data(), data[i].size(), offsets[i], i);
+
+    queue.submit();
+
+    std::vector<bool> completed(offsets.size());
+    size_t completedCount {};
+    ReadCompletion completions[16] {};
+
+    while (u32 count = queue.complete(completions, true))
+    {
+        for (u32 i = 0; i < count; i++)
+        {
+            u64 read {completions[i].userData};
+            ASSERT_LT(read, offsets.size());
+            EXPECT_TRUE(completions[i].succeeded);
+            EXPECT_FALSE(completed[read]);
+            completed[read] = true;
+            completedCount++;
+
+            for (u64 j = 0; j < data[read].size(); j++)
+                EXPECT_EQ(data[read][j], static_cast<u8>((offsets[read] + j) * 7));
+        }
+    }
+
+    EXPECT_EQ(completedCount, offsets.size());
+}
+
+TEST(FileSystemTests, ReadsAsynchronously)
+{
+    std::string path {writeTestFile(1000000)};
+    File* file {openFile(path.c_str(), FileAccess::Read)};
+    ASSERT_NE(file, nullptr);
+
+    // Through whatever the platform has, and through the fallback every platform has.
+    struct FileReadQueue final : ReadQueue
+    {
+        File* file;
+
+        explicit FileReadQueue(File* file) : file{file}
+        {
+        }
+
+        void queue(void* destination, size_t count, u64 offset, u64 userData) override
+        {
+            file->queueRead(destination, count, offset, userData);
+        }
+
+        void submit() override
+        {
+            file->submitReads();
+        }
+
+        u32 complete(std::span<ReadCompletion> completions, bool wait) override
+        {
+            return file->completeReads(completions, wait);
+        }
+    };
+
+    FileReadQueue fileQueue {file};
+    PooledReadQueue pooledQueue {file};
+
+    // More reads than any queue keeps in flight at once.
+    std::vector<u64> offsets {};
+
+    for (u64 i = 0; i < 1000; i++)
+        offsets.push_back((i * 7919) % (1000000 - 64));
+
+    expectAsyncReads(fileQueue, offsets);
+    expectAsyncReads(pooledQueue, offsets);
+
+    // Nothing in flight, so nothing to wait for.
+    ReadCompletion completion {};
+    EXPECT_EQ(file->completeReads({&completion, 1}, true), 0u);
+
+    file->close();
+    delete file;
+}
+
+TEST(FileSystemTests, ReadsAsynchronouslyIntoRegisteredBuffers)
+{
+    std::string path {writeTestFile(100000)};
+    File* file {openFile(path.c_str(), FileAccess::Read)};
+    ASSERT_NE(file, nullptr);
+
+    std::vector<u8> buffer(64 * 1024);
+    std::span<u8> buffers[] {buffer};
+    // Optional, so only the reads themselves are checked.
+    file->registerBuffers(buffers);
+
+    for (u64 i = 0; i < 16; i++)
+        file->queueRead(buffer.data() + i * 4096, 4096, i * 5000, i);
+
+    // Outside every registered buffer, which works too.
+    u8 unregistered[100] {};
+    file->queueRead(unregistered, sizeof(unregistered), 1234, 16);
+    file->submitReads();
+
+    u32 completed {};
+    ReadCompletion completions[8] {};
+
+    while (u32 count = file->completeReads(completions, true))
+    {
+        for (u32 i = 0; i < count; i++)
+            EXPECT_TRUE(completions[i].succeeded);
+
+        completed += count;
+    }
+
+    EXPECT_EQ(completed, 17u);
+
+    for (u64 i = 0; i < 16; i++)
+        EXPECT_EQ(buffer[i * 4096 + 100], static_cast<u8>((i * 5000 + 100) * 7));
+
+    EXPECT_EQ(unregistered[0], static_cast<u8>(1234 * 7));
+
+    file->registerBuffers({});
+    file->close();
+    delete file;
+}
+
+TEST(FileSystemTests, AsynchronousReadsPastTheEndFail)
+{
+    std::string path {writeTestFile(10)};
+    File* file {openFile(path.c_str(), FileAccess::Read)};
+    ASSERT_NE(file, nullptr);
+
+    u8 data[16] {};
+    file->queueRead(data, sizeof(data), 0, 1);
+    file->submitReads();
+
+    ReadCompletion completion {};
+    ASSERT_EQ(file->completeReads({&completion, 1}, true), 1u);
+    EXPECT_EQ(completion.userData, 1u);
+    EXPECT_FALSE(completion.succeeded);
+
+    file->close();
+    delete file;
+}
+
+TEST(FileSystemTests, MissingFile)
+{
+    EXPECT_EQ(openFile((testing::TempDir() + "does_not_exist.bin").c_str(), FileAccess::Read), nullptr);
+}
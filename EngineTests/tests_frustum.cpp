@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "../Engine/math/frustum.hpp"
+#include "../Engine/math/aabb.hpp"
+#include "../Engine/math/sphere.hpp"
+#include "../Engine/math/mat4.hpp"
+
+// A camera at (0, 0, 10) looking down -z, with a 90 degree square view from 1 to 100 units away.
+static Frustum makeFrustum()
+{
+    Mat4 worldToView {Mat4::translate(0, 0, -10)};
+    Mat4 viewToClip {Mat4::perspective(1, 100, 1, 1, 90)};
+    return Frustum::fromMatrix(worldToView * viewToClip);
+}
+
+TEST(FrustumTests, PlanesAreNormalized)
+{
+    Frustum frustum {makeFrustum()};
+
+    for (const Plane& plane : frustum.planes)
+        EXPECT_NEAR(plane.normal.magnitude(), 1, 0.0001f);
+
+    EXPECT_NEAR(frustum.planes[Frustum::Near].distanceTo({0, 0, 9}), 0, 0.0001f);
+    EXPECT_NEAR(frustum.planes[Frustum::Far].distanceTo({0, 0, -90}), 0, 0.001f);
+}
+
+TEST(FrustumTests, ContainsPoint)
+{
+    Frustum frustum {makeFrustum()};
+    EXPECT_TRUE(frustum.contains({0, 0, 0}));
+    EXPECT_TRUE(frustum.contains({9, -9, 0}));
+    EXPECT_FALSE(frustum.contains({11, 0, 0}));
+    EXPECT_FALSE(frustum.contains({0, 0, 9.5f}));
+    EXPECT_FALSE(frustum.contains({0, 0, -91}));
+    EXPECT_FALSE(frustum.contains({0, 0, 20}));
+}
+
+TEST(FrustumTests, IntersectsBounds)
+{
+    Frustum frustum {makeFrustum()};
+    EXPECT_TRUE(frustum.intersects(Aabb{{-1, -1, -1}, {1, 1, 1}}));
+    EXPECT_TRUE(frustum.intersects(Aabb{{9, -1, -1}, {12, 1, 1}}));
+    EXPECT_FALSE(frustum.intersects(Aabb{{11, -1, -1}, {12, 1, 1}}));
+    EXPECT_FALSE(frustum.intersects(Aabb{{-1, -1, 11}, {1, 1, 12}}));
+
+    EXPECT_TRUE(frustum.intersects(Sphere{{12, 0, 0}, 2}));
+    EXPECT_FALSE(frustum.intersects(Sphere{{12, 0, 0}, 1}));
+    EXPECT_FALSE(frustum.intersects(Sphere{{0, 0, -95}, 4}));
+}
+
+// The batch functions must agree exactly with the single tests, including for the leftover
+// bounds that do not fill a whole SIMD register.
+TEST(FrustumTests, BatchMatchesSingle)
+{
+    constexpr s32 COUNT {1003};
+    Frustum frustum {makeFrustum()};
+
+    std::mt19937 random {1234};
+    std::uniform_real_distribution<f32> position {-120, 120};
+    std::uniform_real_distribution<f32> size {0.1f, 8};
+
+    std::vector<f32> x(COUNT), y(COUNT), z(COUNT), extentX(COUNT), extentY(COUNT), extentZ(COUNT);
+
+    for (s32 i = 0; i < COUNT; i++)
+    {
+        x[i] = position(random);
+        y[i] = position(random);
+        z[i] = position(random);
+        extentX[i] = size(random);
+        extentY[i] = size(random);
+        extentZ[i] = size(random);
+    }
+
+    std::vector<u32> expectedBoxes {};
+    std::vector<u32> expectedSpheres {};
+
+    for (s32 i = 0; i < COUNT; i++)
+    {
+        Vec3 center {x[i], y[i], z[i]};
+
+        if (frustum.intersects(Aabb::fromCenterExtents(center, {extentX[i], extentY[i], extentZ[i]})))
+            expectedBoxes.push_back(i);
+
+        if (frustum.intersects(Sphere{center, extentX[i]}))
+            expectedSpheres.push_back(i);
+    }
+
+    std::vector<u32> visible(COUNT);
+
+    s32 boxCount {frustum.cull(AabbBatch{x.data(), y.data(), z.data(), extentX.data(), extentY.data(), extentZ.data(), COUNT}, visible.data())};
+    EXPECT_EQ(std::vector<u32>(visible.begin(), visible.begin() + boxCount), expectedBoxes);
+
+    s32 sphereCount {frustum.cull(SphereBatch{x.data(), y.data(), z.data(), extentX.data(), COUNT}, visible.data())};
+    EXPECT_EQ(std::vector<u32>(visible.begin(), visible.begin() + sphereCount), expectedSpheres);
+
+    // Make sure the test is not trivially passing.
+    EXPECT_GT(boxCount, 0);
+    EXPECT_LT(boxCount, COUNT);
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include <format>
+#include <fstream>
+#include <string>
+#include "../Engine/resources/load_telemetry.hpp"
+#include "../Engine/string_name_table.hpp"
+
+TEST(LoadTelemetryTests, SumsRequestsPerAsset)
+{
+    LoadTelemetry telemetry {};
+    telemetry.recordMiss("Light"_sn, 3, {.readBytes = 100, .ioNanoseconds = 10, .decodeNanoseconds = 5}, 200, true);
+    telemetry.recordHit("Light"_sn, 4);
+    telemetry.recordHit("Light"_sn, 9);
+    telemetry.recordMiss("Heavy"_sn, 5, {.readBytes = 1000, .ioNanoseconds = 300, .decompressNanoseconds = 200}, 4000, true);
+    telemetry.recordMiss("Heavy"_sn, 6, {.readBytes = 1000, .ioNanoseconds = 100}, 0, false);
+
+    std::vector<AssetLoadStats> stats {telemetry.getStats()};
+    ASSERT_EQ(stats.size(), 2u);
+
+    // The heaviest asset comes first.
+    EXPECT_EQ(stats[0].name, "Heavy"_sn.hash);
+    EXPECT_EQ(stats[0].misses, 2u);
+    EXPECT_EQ(stats[0].failures, 1u);
+    EXPECT_EQ(stats[0].size, 4000u);
+    EXPECT_EQ(stats[0].total.readBytes, 2000u);
+    EXPECT_EQ(stats[0].total.ioNanoseconds, 400u);
+    EXPECT_EQ(stats[0].slowestNanoseconds, 500u);
+
+    EXPECT_EQ(stats[1].name, "Light"_sn.hash);
+    EXPECT_EQ(stats[1].hits, 2u);
+    EXPECT_EQ(stats[1].misses, 1u);
+    EXPECT_EQ(stats[1].firstFrame, 3u);
+    EXPECT_EQ(stats[1].lastFrame, 9u);
+
+    telemetry.clear();
+    EXPECT_TRUE(telemetry.getStats().empty());
+}
+
+TEST(LoadTelemetryTests, WritesCsv)
+{
+    LoadTelemetry telemetry {};
+    StringName name {StringNameTable::intern("textures/a,b.png")};
+    telemetry.recordMiss(name, 1, {.readBytes = 10, .decodeNanoseconds = 2500000}, 20, true);
+    telemetry.recordHit(name, 2);
+
+    std::string path {testing::TempDir() + "load_telemetry_tests.csv"};
+    ASSERT_TRUE(telemetry.writeCsv(path.c_str()));
+
+    std::ifstream file {path};
+    std::string header {};
+    std::string row {};
+    std::getline(file, header);
+    std::getline(file, row);
+
+    EXPECT_EQ(header, "name,hits,misses,failures,size,read_bytes,io_ms,decompress_ms,decode_ms,slowest_ms,first_frame,last_frame");
+    // Names are only text while the StringNameTable is compiled in, and hashes otherwise.
+    EXPECT_EQ(row, std::format("\"{}\",1,1,0,20,10,0.000,0.000,2.500,2.500,1,2", name));
+    EXPECT_FALSE(telemetry.writeCsv((testing::TempDir() + "missing/load_telemetry_tests.csv").c_str()));
+}
@@ -0,0 +1,279 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../Engine/logger.hpp"
+#include "../Engine/string_name_table.hpp"
+
+using namespace Logger;
+
+// Collects everything written to it, so the tests can check the output.
+class MemorySink final : public Sink
+{
+public:
+    void write(std::string_view lines) override
+    {
+        std::scoped_lock lock {mutex};
+        text.append(lines);
+    }
+
+    void flush() override
+    {
+    }
+
+    std::string read()
+    {
+        std::scoped_lock lock {mutex};
+        return text;
+    }
+
+    std::mutex mutex;
+    std::string text;
+};
+
+// Routes logs into a fresh MemorySink for the duration of a test.
+class LoggerTests : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        auto memorySink {std::make_unique<MemorySink>()};
+        sink = memorySink.get();
+        addSink(std::move(memorySink));
+    }
+
+    void TearDown() override
+    {
+        stopAsync();
+        clearSinks();
+    }
+
+    MemorySink* sink {};
+};
+
+TEST_F(LoggerTests, Synchronous)
+{
+    log_info(Channel::Rendering, "Drew {} triangles", 42);
+    EXPECT_EQ(sink->read(), "[Info:Rendering] Drew 42 triangles\n");
+}
+
+TEST_F(LoggerTests, AsynchronousKeepsOrder)
+{
+    startAsync();
+    EXPECT_TRUE(isAsync());
+
+    for (s32 i = 0; i < 100; i++)
+        log_info(Channel::General, "Message {}", i);
+
+    flush();
+    std::string expected {};
+
+    for (s32 i = 0; i < 100; i++)
+        expected += std::format("[Info:General] Message {}\n", i);
+
+    EXPECT_EQ(sink->read(), expected);
+}
+
+TEST_F(LoggerTests, AsynchronousCopiesStrings)
+{
+    startAsync();
+    {
+        std::string temporary {"temporary"};
+        log_warning(Channel::Resources, "{} {}", temporary.c_str(), std::string_view{temporary});
+    }
+
+    stopAsync();
+    EXPECT_EQ(sink->read(), "[Warning:Resources] temporary temporary\n");
+}
+
+TEST_F(LoggerTests, DropPolicy)
+{
+    AsyncSettings settings {};
+    settings.queueCapacity = 4;
+    settings.overflowPolicy = OverflowPolicy::Drop;
+    settings.flushInterval = std::chrono::milliseconds{1000};
+    startAsync(settings);
+
+    u64 dropped {getDroppedCount()};
+
+    for (s32 i = 0; i < 20; i++)
+        log_info(Channel::General, "Message {}", i);
+
+    // The queue may be drained while logging, so at most 16 of the 20 are dropped.
+    EXPECT_GT(getDroppedCount(), dropped);
+    EXPECT_LE(getDroppedCount() - dropped, 16u);
+
+    flush();
+    EXPECT_NE(sink->read().find("log messages were dropped"), std::string::npos);
+}
+
+TEST_F(LoggerTests, BlockPolicyLosesNothing)
+{
+    constexpr s32 THREAD_COUNT {4};
+    constexpr s32 MESSAGES_PER_THREAD {500};
+
+    AsyncSettings settings {};
+    settings.queueCapacity = 8;
+    settings.overflowPolicy = OverflowPolicy::Block;
+    startAsync(settings);
+
+    std::vector<std::thread> threads {};
+
+    for (s32 thread = 0; thread < THREAD_COUNT; thread++)
+    {
+        threads.emplace_back([]
+        {
+            for (s32 i = 0; i < MESSAGES_PER_THREAD; i++)
+                log_info(Channel::General, "Message {}", i);
+        });
+    }
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    stopAsync();
+    std::string text {sink->read()};
+    EXPECT_EQ(std::count(text.begin(), text.end(), '\n'), THREAD_COUNT * MESSAGES_PER_THREAD);
+}
+
+TEST_F(LoggerTests, StopWhileLoggingLosesNothing)
+{
+    constexpr s32 THREAD_COUNT {4};
+    constexpr s32 MESSAGES_PER_THREAD {2000};
+
+    AsyncSettings settings {};
+    settings.queueCapacity = 8;
+    settings.overflowPolicy = OverflowPolicy::Block;
+    startAsync(settings);
+
+    std::atomic<s32> started {};
+    std::vector<std::thread> threads {};
+
+    for (s32 thread = 0; thread < THREAD_COUNT; thread++)
+    {
+        threads.emplace_back([&]
+        {
+            started++;
+
+            for (s32 i = 0; i < MESSAGES_PER_THREAD; i++)
+                log_info(Channel::General, "Message {}", i);
+        });
+    }
+
+    while (started < THREAD_COUNT)
+        std::this_thread::yield();
+
+    // Whatever is logged after this is written by the logging threads themselves.
+    stopAsync();
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    std::string text {sink->read()};
+    EXPECT_EQ(std::count(text.begin(), text.end(), '\n'), THREAD_COUNT * MESSAGES_PER_THREAD);
+}
+
+TEST_F(LoggerTests, CrashWritesQueuedFormats)
+{
+    EXPECT_DEATH(
+    {
+        AsyncSettings settings {};
+        settings.flushInterval = std::chrono::hours{1};
+        startAsync(settings);
+        log_warning(Channel::Resources, "Still queued {}", 1);
+        std::raise(SIGSEGV);
+    }, "Crashed with signal [0-9]+, 1 queued log messages follow.*\n\\[Warning:Resources\\] Still queued \\{\\}");
+}
+
+TEST_F(LoggerTests, CompileTimeFormatWithoutBinaryLog)
+{
+    log_info<"Drew {} triangles">(Channel::Rendering, 42);
+    EXPECT_EQ(sink->read(), "[Info:Rendering] Drew 42 triangles\n");
+}
+
+TEST_F(LoggerTests, BinaryLogRoundTrip)
+{
+    std::string path {testing::TempDir() + "logger_tests.blog"};
+    StringName name {StringNameTable::intern("BinaryLogTest")};
+
+    AsyncSettings settings {};
+    settings.binaryLogPath = path.c_str();
+    startAsync(settings);
+
+    {
+        std::string temporary {"temporary"};
+        log_info<"{} {} {} {}">(Channel::Resources, true, 'x', -12, 7u);
+        log_warning<"{:.2f} {} [{:>6}]">(Channel::Rendering, 1.5f, 2.25, temporary);
+        log_error<"{1}{0}{1} {{escaped}}">(Channel::General, "a", "b");
+        log_info<"Loaded {}">(Channel::Resources, name);
+    }
+
+    // Runtime formats still go to the text sinks.
+    log_info(Channel::General, "Text {}", 1);
+    stopAsync();
+
+    std::ifstream file {path, std::ios::binary};
+    std::vector<u8> data {std::istreambuf_iterator<char>{file}, {}};
+    std::string text {};
+
+    EXPECT_TRUE(decodeBinaryLog(data, text));
+    EXPECT_EQ(text, "[Info:Resources] true x -12 7\n"
+                    "[Warning:Rendering] 1.50 2.25 [temporary]\n"
+                    "[Error:General] bab {escaped}\n"
+                    "[Info:Resources] Loaded BinaryLogTest\n");
+    EXPECT_EQ(sink->read(), "[Info:General] Text 1\n");
+
+    // A log cut short still decodes up to the damage.
+    text.clear();
+    EXPECT_FALSE(decodeBinaryLog(std::span{data}.first(data.size() - 1), text));
+    EXPECT_EQ(text, "[Info:Resources] true x -12 7\n"
+                    "[Warning:Rendering] 1.50 2.25 [temporary]\n"
+                    "[Error:General] bab {escaped}\n");
+
+    EXPECT_FALSE(decodeBinaryLog(std::span<const u8>{}, text));
+}
+
+TEST_F(LoggerTests, DefaultChannelIsPerThread)
+{
+    DefaultLogChannelJanitor janitor {Channel::Rendering};
+    EXPECT_EQ(getDefaultChannel(), Channel::Rendering);
+
+    std::thread {[]
+    {
+        EXPECT_EQ(getDefaultChannel(), Channel::General);
+        DefaultLogChannelJanitor innerJanitor {Channel::Resources};
+        EXPECT_EQ(getDefaultChannel(), Channel::Resources);
+    }}.join();
+
+    EXPECT_EQ(getDefaultChannel(), Channel::Rendering);
+    {
+        DefaultLogChannelJanitor innerJanitor {Channel::General};
+        EXPECT_EQ(getDefaultChannel(), Channel::General);
+    }
+
+    EXPECT_EQ(getDefaultChannel(), Channel::Rendering);
+}
+
+TEST_F(LoggerTests, MacrosSkipArgumentsWhenHidden)
+{
+    // Everything is compiled in by default.
+    static_assert(isCompiledIn(Severity::Info) && isCompiledIn(Channel::Resources));
+
+    s32 evaluations {};
+    auto count = [&] { return ++evaluations; };
+
+    Severity previousMask {g_severityMask};
+    g_severityMask = Severity::Error;
+    LOG_INFO(Channel::General, "Evaluated {}", count());
+    LOG_ERROR(Channel::General, "Evaluated {}", count());
+    g_severityMask = previousMask;
+
+    EXPECT_EQ(evaluations, 1);
+    EXPECT_EQ(sink->read(), "[Error:General] Evaluated 1\n");
+}
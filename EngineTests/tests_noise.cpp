@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "../Engine/math/noise.hpp"
+
+using namespace Math;
+
+TEST(NoiseTests, SimplexRange)
+{
+    f32 largest {};
+    bool anyNonZero {false};
+
+    for (s32 i = 0; i < 200000; i++)
+    {
+        f32 value {noise::simplex(static_cast<f32>(i) * 0.0137f - 1000, static_cast<f32>(i) * 0.0291f + 500, 7)};
+        largest = std::max(largest, std::abs(value));
+        anyNonZero |= value != 0;
+    }
+
+    EXPECT_LE(largest, 1);
+    EXPECT_GT(largest, 0.5f);
+    EXPECT_TRUE(anyNonZero);
+}
+
+TEST(NoiseTests, SimplexIsContinuous)
+{
+    for (s32 i = 0; i < 10000; i++)
+    {
+        f32 x {static_cast<f32>(i) * 0.013f};
+        EXPECT_NEAR(noise::simplex(x, 3, 0), noise::simplex(x + 0.0001f, 3, 0), 0.005f);
+    }
+}
+
+TEST(NoiseTests, SeedsDiffer)
+{
+    EXPECT_NE(noise::simplex(0.3f, 0.7f, 1), noise::simplex(0.3f, 0.7f, 2));
+}
+
+TEST(NoiseTests, SimdMatchesScalar)
+{
+    noise::FractalSettings settings {};
+    settings.frequency = 0.05f;
+
+    for (s32 i = 0; i < 1000; i++)
+    {
+        f32 x[simd::WIDTH] {i * 0.37f, -i * 1.1f, i * 7.3f, 0.5f};
+        f32 y[simd::WIDTH] {i * 0.11f, i * 0.9f, -3.0f, -i * 2.7f};
+        f32 simplexLanes[simd::WIDTH];
+        f32 fbmLanes[simd::WIDTH];
+        simd::store(simplexLanes, noise::simplex(simd::load(x), simd::load(y), 5));
+        simd::store(fbmLanes, noise::fbm(simd::load(x), simd::load(y), 5, settings));
+
+        for (s32 lane = 0; lane < simd::WIDTH; lane++)
+        {
+            EXPECT_NEAR(simplexLanes[lane], noise::simplex(x[lane], y[lane], 5), 1e-5f);
+            EXPECT_NEAR(fbmLanes[lane], noise::fbm(x[lane], y[lane], 5, settings), 1e-5f);
+        }
+    }
+}
+
+TEST(NoiseTests, HeightfieldIsIndependentOfThreads)
+{
+    constexpr s32 WIDTH {37};
+    constexpr s32 HEIGHT {45};
+
+    noise::HeightfieldSettings settings {};
+    settings.seed = 12;
+    settings.fractal.frequency = 0.02f;
+    settings.warpStrength = 4;
+
+    std::vector<f32> single(WIDTH * HEIGHT);
+    std::vector<f32> parallel(WIDTH * HEIGHT);
+    noise::generateHeightfield(single.data(), WIDTH, HEIGHT, settings, 1);
+    noise::generateHeightfield(parallel.data(), WIDTH, HEIGHT, settings, 4);
+
+    EXPECT_EQ(single, parallel);
+
+    for (s32 y = 0; y < HEIGHT; y++)
+    {
+        for (s32 x = 0; x < WIDTH; x++)
+        {
+            f32 sampleX {static_cast<f32>(x)};
+            f32 sampleY {static_cast<f32>(y)};
+            noise::warp(sampleX, sampleY, settings.seed, settings.fractal, settings.warpStrength);
+            f32 expected {std::clamp(noise::fbm(sampleX, sampleY, settings.seed, settings.fractal) * 0.5f + 0.5f, 0.0f, 1.0f)};
+
+            EXPECT_GE(single[y * WIDTH + x], 0);
+            EXPECT_LE(single[y * WIDTH + x], 1);
+            EXPECT_NEAR(single[y * WIDTH + x], expected, 1e-5f);
+        }
+    }
+}
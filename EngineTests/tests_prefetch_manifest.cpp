@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../Engine/resources/prefetch_manifest.hpp"
+#include "../Engine/string_name_table.hpp"
+
+TEST(PrefetchManifestTests, WritesAndReadsAccessTraces)
+{
+    std::string path {testing::TempDir() + "prefetch_manifest_tests.trace"};
+    // Not in the string table, so it is written as its hash.
+    StringName unknown {0x0123456789abcdefull};
+    std::vector<StringName> trace {StringNameTable::intern("textures/grass.png"), unknown, StringNameTable::intern("Level1")};
+    ASSERT_TRUE(writeAccessTrace(path.c_str(), trace));
+
+    std::vector<StringName::Hash> assets {};
+    ASSERT_TRUE(readAccessTrace(path.c_str(), assets));
+    ASSERT_EQ(assets.size(), 3u);
+    EXPECT_EQ(assets[0], StringName::createHash("textures/grass.png"));
+    EXPECT_EQ(assets[1], unknown.hash);
+    EXPECT_EQ(assets[2], StringName::createHash("Level1"));
+}
+
+TEST(PrefetchManifestTests, ReadsHandWrittenTraces)
+{
+    std::string path {testing::TempDir() + "prefetch_manifest_tests_edited.trace"};
+
+    {
+        std::ofstream file {path, std::ios::binary};
+        file << "Level1\r\n\r\n#notahash\n#00000000000000ff\n";
+    }
+
+    std::vector<StringName::Hash> assets {};
+    ASSERT_TRUE(readAccessTrace(path.c_str(), assets));
+    ASSERT_EQ(assets.size(), 3u);
+    EXPECT_EQ(assets[0], StringName::createHash("Level1"));
+    // Names may start with #, as long as they aren't a hash.
+    EXPECT_EQ(assets[1], StringName::createHash("#notahash"));
+    EXPECT_EQ(assets[2], 0xffu);
+
+    EXPECT_FALSE(readAccessTrace((testing::TempDir() + "missing.trace").c_str(), assets));
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include "../Engine/math/random.hpp"
+
+using namespace Math;
+
+TEST(RandomTests, MatchesReference)
+{
+    // Outputs of the reference xoshiro128** implementation, seeded with splitmix64(0).
+    Random random {};
+    EXPECT_EQ(random.next(), 0xDEC9045Du);
+    EXPECT_EQ(random.next(), 0x9A089D75u);
+    EXPECT_EQ(random.next(), 0xAB77D362u);
+}
+
+TEST(RandomTests, SameSeedSameSequence)
+{
+    Random first {1234};
+    Random second {1234};
+    Random other {1235};
+    bool anyDifferent {false};
+
+    for (s32 i = 0; i < 100; i++)
+    {
+        u32 value = first.next();
+        EXPECT_EQ(value, second.next());
+        anyDifferent |= value != other.next();
+    }
+
+    EXPECT_TRUE(anyDifferent);
+}
+
+TEST(RandomTests, Ranges)
+{
+    Random random {42};
+    f64 sum {};
+
+    for (s32 i = 0; i < 10000; i++)
+    {
+        f32 unit = random.nextFloat();
+        EXPECT_GE(unit, 0);
+        EXPECT_LT(unit, 1);
+        sum += unit;
+
+        f32 value = random.range(-5.0f, 5.0f);
+        EXPECT_GE(value, -5);
+        EXPECT_LT(value, 5);
+
+        s32 integer = random.range(-3, 3);
+        EXPECT_GE(integer, -3);
+        EXPECT_LE(integer, 3);
+    }
+
+    EXPECT_NEAR(sum / 10000, 0.5, 0.02);
+}
+
+TEST(RandomTests, LanesFollowJumps)
+{
+    Random source {99};
+    RandomX4 lanes {source};
+    u32 values[simd::WIDTH];
+    simd::storeInt(values, lanes.next());
+
+    for (s32 lane = 0; lane < simd::WIDTH; lane++)
+    {
+        source.jump();
+        Random copy {source};
+        EXPECT_EQ(values[lane], copy.next());
+    }
+}
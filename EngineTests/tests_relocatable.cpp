@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../Engine/resources/resource_manager.hpp"
+#include "../Engine/resources/texture.hpp"
+
+// A resource with several pointers, two of them into the same blob.
+struct Mesh
+{
+    static constexpr u16 LAYOUT_VERSION {3};
+
+    u32 vertexCount;
+    const f32* positions;
+    u32 indexCount;
+    const u16* indices;
+    // The second vertex.
+    const f32* second;
+};
+
+template <>
+void writeRelocatableBlobs<Mesh>(const Mesh& resource, RelocatableWriter& writer)
+{
+    u64 positions {writer.writeBlob(resource.positions, resource.positions, resource.vertexCount * 3 * sizeof(f32))};
+    writer.writeBlob(resource.indices, resource.indices, resource.indexCount * sizeof(u16));
+    writer.addFixup(writer.locationOf(resource.second), positions + 3 * sizeof(f32));
+}
+
+static std::vector<u8> writeImage(Mesh& mesh)
+{
+    std::stringstream stream {std::ios::binary | std::ios::in | std::ios::out};
+    BinaryStreamBuilder builder {&stream};
+    writeResourceTo(&mesh, builder);
+
+    std::string data {stream.str()};
+    return {data.begin(), data.end()};
+}
+
+static Mesh testMesh()
+{
+    static const f32 positions[] {0, 1, 2, 3, 4, 5};
+    static const u16 indices[] {1, 0, 1};
+    return {2, positions, 3, indices, nullptr};
+}
+
+TEST(RelocatableTests, RoundTrips)
+{
+    static_assert(RelocatableResource<Mesh>);
+    static_assert(RelocatableResource<Texture>);
+
+    Mesh mesh {testMesh()};
+    std::vector<u8> image {writeImage(mesh)};
+
+    // Copied somewhere else entirely, which the pointers have to follow.
+    std::vector<u8> moved {image};
+    BinaryMemoryReader reader {moved.data(), moved.size()};
+    Mesh* loaded {readResourceInPlace<Mesh>(reader)};
+    ASSERT_NE(loaded, nullptr);
+    EXPECT_FALSE(reader.failed());
+    EXPECT_EQ(reader.tell(), moved.size());
+
+    EXPECT_EQ(loaded->vertexCount, 2u);
+    EXPECT_EQ(loaded->indexCount, 3u);
+    EXPECT_GE(reinterpret_cast<const u8*>(loaded->positions), moved.data());
+    EXPECT_LT(reinterpret_cast<const u8*>(loaded->positions), moved.data() + moved.size());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(loaded->positions) % RELOCATABLE_ALIGNMENT, reinterpret_cast<uintptr_t>(moved.data()) % RELOCATABLE_ALIGNMENT);
+
+    for (u32 i = 0; i < 6; i++)
+        EXPECT_EQ(loaded->positions[i], static_cast<f32>(i));
+
+    EXPECT_EQ(loaded->indices[0], 1);
+    EXPECT_EQ(loaded->indices[2], 1);
+    EXPECT_EQ(loaded->second, loaded->positions + 3);
+
+    freeResource(loaded, true);
+}
+
+TEST(RelocatableTests, RejectsOtherLayouts)
+{
+    Mesh mesh {testMesh()};
+    std::vector<u8> image {writeImage(mesh)};
+
+    RelocatableHeader header {};
+    std::memcpy(&header, image.data(), sizeof(header));
+    header.layoutVersion++;
+    std::memcpy(image.data(), &header, sizeof(header));
+
+    BinaryMemoryReader reader {image.data(), image.size()};
+    EXPECT_EQ(readResourceInPlace<Mesh>(reader), nullptr);
+
+    // Not an image at all.
+    std::vector<u8> garbage(256, 7);
+    BinaryMemoryReader garbageReader {garbage.data(), garbage.size()};
+    EXPECT_EQ(readResourceInPlace<Mesh>(garbageReader), nullptr);
+}
+
+TEST(RelocatableTests, RejectsDamagedImages)
+{
+    Mesh mesh {testMesh()};
+    std::vector<u8> image {writeImage(mesh)};
+
+    // Cut short, before the fixup table.
+    BinaryMemoryReader shortReader {image.data(), image.size() - 1};
+    EXPECT_EQ(readResourceInPlace<Mesh>(shortReader), nullptr);
+    EXPECT_TRUE(shortReader.failed());
+
+    // A pointer that would be written outside the resource.
+    RelocatableHeader header {};
+    std::memcpy(&header, image.data(), sizeof(header));
+    RelocatableFixup fixup {};
+    std::memcpy(&fixup, image.data() + header.fixupOffset, sizeof(fixup));
+    fixup.location = header.fixupOffset;
+    std::memcpy(image.data() + header.fixupOffset, &fixup, sizeof(fixup));
+
+    BinaryMemoryReader reader {image.data(), image.size()};
+    EXPECT_EQ(readResourceInPlace<Mesh>(reader), nullptr);
+    EXPECT_FALSE(reader.failed());
+}
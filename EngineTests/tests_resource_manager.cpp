@@ -0,0 +1,760 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../Engine/resources/prefetch_manifest.hpp"
+#include "../Engine/resources/resource_manager.hpp"
+#include "../Engine/resources/texture.hpp"
+#include "../Engine/string_name_table.hpp"
+
+// Writes a package of small gradient textures, the same way ResourceCompiler's package() does.
+// Texture i is (width + i) pixels wide, so tests can tell packages apart.
+static std::string writeTestPackage(s32 textureCount, bool compress = true, const char* fileName = "resource_manager_tests.pak", s32 width = 4)
+{
+    std::string path {testing::TempDir() + fileName};
+    std::fstream file {path, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc};
+    PackageWriter writer {&file, compress};
+
+    for (s32 i = 0; i < textureCount; i++)
+    {
+        Texture texture {};
+        texture.width = width + i;
+        texture.height = 3;
+        texture.channels = 1;
+        std::vector<u8> pixels(texture.pixelDataLength());
+
+        for (size_t pixel = 0; pixel < pixels.size(); pixel++)
+            pixels[pixel] = static_cast<u8>(pixel + i);
+
+        texture.pixelData = pixels.data();
+        writeResourceTo(&texture, writer.beginAsset(StringNameTable::intern(std::format("Texture{}", i))));
+    }
+
+    EXPECT_TRUE(writer.finish());
+    return path;
+}
+
+// Writes a package with just a prefetch manifest in it, the same way ResourceCompiler's package() does.
+static std::string writeManifestPackage(StringName manifestName, const std::vector<StringName::Hash>& assets)
+{
+    std::string path {testing::TempDir() + "resource_manager_tests_manifest.pak"};
+    std::fstream file {path, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc};
+    PackageWriter writer {&file};
+
+    PrefetchManifest manifest {.assetCount = static_cast<u32>(assets.size()), .assets = assets.data()};
+    writeResourceTo(&manifest, writer.beginAsset(manifestName));
+
+    EXPECT_TRUE(writer.finish());
+    return path;
+}
+
+// A resource that counts how many times it is read, and reads slowly enough for requests to overlap.
+struct CountedResource
+{
+    u32 firstBytes;
+};
+
+static std::atomic<s32> s_countedReads {};
+
+template <>
+CountedResource* readResourceInPlace<CountedResource>(BinaryMemoryReader& package)
+{
+    s_countedReads++;
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    CountedResource* resource {new CountedResource{}};
+    package.readFixed(&resource->firstBytes);
+    return resource;
+}
+
+class ResourceManagerTests : public testing::TestWithParam<PackageAccess>
+{
+};
+
+TEST_P(ResourceManagerTests, LoadsTextures)
+{
+    std::string path {writeTestPackage(3)};
+    ResourceManager resourceManager {path.c_str(), GetParam()};
+    EXPECT_EQ(resourceManager.getAccess(), GetParam());
+
+    for (s32 i = 0; i < 3; i++)
+    {
+        ResourceHandle<Texture> texture {resourceManager.load<Texture>(StringNameTable::intern(std::format("Texture{}", i)))};
+        ASSERT_NE(texture.data, nullptr);
+        EXPECT_EQ(texture.data->width, 4 + i);
+        EXPECT_EQ(texture.data->height, 3);
+
+        for (s32 pixel = 0; pixel < texture.data->pixelDataLength(); pixel++)
+            EXPECT_EQ(texture.data->pixelData[pixel], static_cast<u8>(pixel + i));
+    }
+}
+
+TEST_P(ResourceManagerTests, SharesLoadedResources)
+{
+    std::string path {writeTestPackage(1)};
+    ResourceManager resourceManager {path.c_str(), GetParam()};
+
+    const Texture* first {resourceManager.load<Texture>("Texture0"_sn).data};
+    const Texture* second {resourceManager.load<Texture>("Texture0"_sn).data};
+    EXPECT_EQ(first, second);
+
+    resourceManager.unload("Texture0"_sn);
+    resourceManager.unload("Texture0"_sn);
+    EXPECT_NE(resourceManager.load<Texture>("Texture0"_sn).data, nullptr);
+}
+
+TEST_P(ResourceManagerTests, MissingResource)
+{
+    std::string path {writeTestPackage(1)};
+    ResourceManager resourceManager {path.c_str(), GetParam()};
+    EXPECT_EQ(resourceManager.load<Texture>("Missing"_sn).data, nullptr);
+}
+
+TEST_P(ResourceManagerTests, LoadsAsynchronously)
+{
+    std::string path {writeTestPackage(2)};
+    ResourceManager resourceManager {path.c_str(), GetParam()};
+    const Texture* calledBack {};
+
+    AsyncResourceHandle<Texture> handle {resourceManager.loadAsync<Texture>("Texture1"_sn, [&](ResourceHandle<Texture> texture)
+    {
+        calledBack = texture.data;
+    })};
+
+    ResourceHandle<Texture> texture {handle.wait()};
+    EXPECT_TRUE(handle.isReady());
+    ASSERT_NE(texture.data, nullptr);
+    EXPECT_EQ(texture.data->width, 5);
+
+    // Callbacks only run on the thread that calls update().
+    EXPECT_EQ(calledBack, nullptr);
+    resourceManager.update();
+    EXPECT_EQ(calledBack, texture.data);
+
+    // Already loaded, but the callback still waits for update().
+    calledBack = nullptr;
+    AsyncResourceHandle<Texture> loadedHandle {resourceManager.loadAsync<Texture>("Texture1"_sn, [&](ResourceHandle<Texture> loaded)
+    {
+        calledBack = loaded.data;
+    })};
+
+    EXPECT_TRUE(loadedHandle.isReady());
+    resourceManager.update();
+    EXPECT_EQ(calledBack, texture.data);
+}
+
+TEST_P(ResourceManagerTests, FinishesAsynchronousLoadsInUpdate)
+{
+    // More than fit in flight at once.
+    std::string path {writeTestPackage(300)};
+    ResourceManager resourceManager {path.c_str(), GetParam()};
+    std::vector<StringName> names {};
+    s32 calledBack {};
+
+    for (s32 i = 0; i < 300; i++)
+    {
+        names.push_back(StringNameTable::intern(std::format("Texture{}", i)));
+        resourceManager.loadAsync<Texture>(names.back(), [&](ResourceHandle<Texture> texture)
+        {
+            calledBack += texture.data != nullptr;
+        });
+    }
+
+    // Nobody waits, so only update() moves the loads along.
+    for (s32 frame = 0; frame < 100000 && calledBack < 300; frame++)
+    {
+        resourceManager.update();
+        std::this_thread::yield();
+    }
+
+    EXPECT_EQ(calledBack, 300);
+
+    for (StringName name : names)
+        resourceManager.unload(name);
+}
+
+TEST_P(ResourceManagerTests, CoalescesRequests)
+{
+    std::string path {writeTestPackage(1)};
+    ResourceManager resourceManager {path.c_str(), GetParam()};
+    s_countedReads = 0;
+
+    std::vector<AsyncResourceHandle<CountedResource>> handles {};
+
+    for (s32 i = 0; i < 8; i++)
+        handles.push_back(resourceManager.loadAsync<CountedResource>("Texture0"_sn));
+
+    // Joins the load that is already in flight, rather than reading it again.
+    const CountedResource* resource {resourceManager.load<CountedResource>("Texture0"_sn).data};
+    ASSERT_NE(resource, nullptr);
+
+    for (AsyncResourceHandle<CountedResource>& handle : handles)
+        EXPECT_EQ(handle.wait().data, resource);
+
+    EXPECT_EQ(s_countedReads, 1);
+}
+
+TEST_P(ResourceManagerTests, FailedAsynchronousLoad)
+{
+    std::string path {writeTestPackage(1)};
+    ResourceManager resourceManager {path.c_str(), GetParam()};
+    bool calledBack {};
+
+    AsyncResourceHandle<Texture> handle {resourceManager.loadAsync<Texture>("Missing"_sn, [&](ResourceHandle<Texture> texture)
+    {
+        calledBack = texture.data == nullptr;
+    })};
+
+    EXPECT_EQ(handle.wait().data, nullptr);
+    resourceManager.update();
+    EXPECT_TRUE(calledBack);
+}
+
+TEST_P(ResourceManagerTests, LoadsFromLargePackages)
+{
+    std::string path {writeTestPackage(200)};
+    ResourceManager resourceManager {path.c_str(), GetParam()};
+
+    // Spread over the whole index, so both ends of the binary search are covered.
+    for (s32 i : {0, 1, 77, 198, 199})
+    {
+        ResourceHandle<Texture> texture {resourceManager.load<Texture>(StringNameTable::intern(std::format("Texture{}", i)))};
+        ASSERT_NE(texture.data, nullptr);
+        EXPECT_EQ(texture.data->width, 4 + i);
+    }
+}
+
+TEST_P(ResourceManagerTests, RejectsOtherFiles)
+{
+    std::string path {testing::TempDir() + "resource_manager_tests.pak"};
+    std::ofstream {path, std::ios::binary | std::ios::trunc} << "certainly not a package, but long enough for a header";
+
+    ResourceManager resourceManager {path.c_str(), GetParam()};
+    EXPECT_EQ(resourceManager.load<Texture>("Texture0"_sn).data, nullptr);
+}
+
+TEST_P(ResourceManagerTests, LoadsCompressedTextures)
+{
+    std::string path {testing::TempDir() + "resource_manager_tests.pak"};
+    std::fstream file {path, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc};
+    PackageWriter writer {&file};
+
+    // Spans several chunks. The noisy one doesn't compress, so it is stored as is.
+    std::mt19937 random {99};
+    std::vector<u8> tiles(300 * 300 * 3);
+    std::vector<u8> noise(300 * 300 * 3);
+
+    for (size_t i = 0; i < tiles.size(); i++)
+    {
+        tiles[i] = static_cast<u8>(i % 300 / 16 * 13);
+        noise[i] = static_cast<u8>(random());
+    }
+
+    for (auto [name, pixels] : {std::pair{"Tiles", &tiles}, std::pair{"Noise", &noise}})
+    {
+        Texture texture {};
+        texture.width = 300;
+        texture.height = 300;
+        texture.channels = 3;
+        texture.pixelData = pixels->data();
+        writeResourceTo(&texture, writer.beginAsset(StringNameTable::intern(name)));
+    }
+
+    ASSERT_TRUE(writer.finish());
+    EXPECT_LT(file.tellp(), static_cast<std::streamoff>(tiles.size() + noise.size()));
+    file.close();
+
+    ResourceManager resourceManager {path.c_str(), GetParam()};
+    ResourceHandle<Texture> loadedTiles {resourceManager.load<Texture>("Tiles"_sn)};
+    ResourceHandle<Texture> loadedNoise {resourceManager.load<Texture>("Noise"_sn)};
+    ASSERT_NE(loadedTiles.data, nullptr);
+    ASSERT_NE(loadedNoise.data, nullptr);
+    EXPECT_TRUE(std::equal(tiles.begin(), tiles.end(), loadedTiles.data->pixelData));
+    EXPECT_TRUE(std::equal(noise.begin(), noise.end(), loadedNoise.data->pixelData));
+}
+
+TEST_P(ResourceManagerTests, LoadsUncompressedPackages)
+{
+    std::string path {writeTestPackage(2, false)};
+    ResourceManager resourceManager {path.c_str(), GetParam()};
+
+    ResourceHandle<Texture> texture {resourceManager.load<Texture>("Texture1"_sn)};
+    ASSERT_NE(texture.data, nullptr);
+    EXPECT_EQ(texture.data->width, 5);
+}
+
+TEST_P(ResourceManagerTests, LoadsBatches)
+{
+    std::string path {writeTestPackage(50)};
+    ResourceManager resourceManager {path.c_str(), GetParam()};
+    const Texture* alreadyLoaded {resourceManager.load<Texture>("Texture7"_sn).data};
+
+    // Out of package order, with a name that is missing, one that is already loaded, and one that is there twice.
+    std::vector<StringName> names {};
+
+    for (s32 i = 49; i >= 0; i -= 3)
+        names.push_back(StringNameTable::intern(std::format("Texture{}", i)));
+
+    names.push_back("Missing"_sn);
+    names.push_back("Texture7"_sn);
+    names.push_back("Texture1"_sn);
+
+    std::vector<ResourceHandle<Texture>> textures {resourceManager.loadBatch<Texture>(names)};
+    ASSERT_EQ(textures.size(), names.size());
+
+    for (size_t i = 0; i < names.size(); i++)
+    {
+        EXPECT_EQ(textures[i].name, names[i]);
+
+        if (names[i] == "Missing"_sn)
+        {
+            EXPECT_EQ(textures[i].data, nullptr);
+            continue;
+        }
+
+        ASSERT_NE(textures[i].data, nullptr);
+        EXPECT_EQ(textures[i].data, resourceManager.load<Texture>(names[i]).data);
+        EXPECT_EQ(textures[i].data->height, 3);
+
+        for (s32 pixel = 0; pixel < textures[i].data->pixelDataLength(); pixel++)
+            EXPECT_EQ(textures[i].data->pixelData[pixel], static_cast<u8>(pixel + textures[i].data->width - 4));
+    }
+
+    EXPECT_EQ(textures[names.size() - 2].data, alreadyLoaded);
+}
+
+TEST_P(ResourceManagerTests, SharesBlockReads)
+{
+    std::string path {writeTestPackage(16)};
+    ResourceManager resourceManager {path.c_str(), GetParam()};
+
+    // Small textures, back to back, so they share blocks.
+    for (s32 i = 0; i < 16; i++)
+        EXPECT_NE(resourceManager.load<Texture>(StringNameTable::intern(std::format("Texture{}", i))).data, nullptr);
+
+    BlockCacheStats stats {resourceManager.getBlockCacheStats()};
+
+    if (GetParam() == PackageAccess::Mapped)
+    {
+        EXPECT_EQ(stats.hits + stats.misses, 0u);
+    }
+    else
+    {
+        EXPECT_EQ(stats.misses, 1u);
+        EXPECT_EQ(stats.hits, 15u);
+    }
+}
+
+TEST_P(ResourceManagerTests, CachesUnreferencedResources)
+{
+    std::string path {writeTestPackage(1)};
+    ResourceManager resourceManager {path.c_str(), GetParam()};
+
+    const Texture* first {resourceManager.load<Texture>("Texture0"_sn).data};
+    resourceManager.unload("Texture0"_sn);
+    EXPECT_GT(resourceManager.getCacheStats().cachedBytes, 0u);
+
+    // Still cached, so nothing is read again.
+    EXPECT_EQ(resourceManager.load<Texture>("Texture0"_sn).data, first);
+
+    ResourceCacheStats stats {resourceManager.getCacheStats()};
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.evictions, 0u);
+    EXPECT_EQ(stats.cachedBytes, 0u);
+}
+
+TEST_P(ResourceManagerTests, EvictsLeastRecentlyUsed)
+{
+    std::string path {writeTestPackage(3)};
+    ResourceManager resourceManager {path.c_str(), GetParam()};
+    u64 sizes[3] {};
+
+    for (s32 i = 0; i < 3; i++)
+        resourceManager.load<Texture>(StringNameTable::intern(std::format("Texture{}", i)));
+
+    for (s32 i = 0; i < 3; i++)
+    {
+        u64 cachedBefore {resourceManager.getCacheStats().cachedBytes};
+        resourceManager.unload(StringNameTable::intern(std::format("Texture{}", i)));
+        sizes[i] = resourceManager.getCacheStats().cachedBytes - cachedBefore;
+    }
+
+    // Only room for the two that were unloaded last.
+    resourceManager.setCacheBudget(sizes[1] + sizes[2]);
+    ResourceCacheStats stats {resourceManager.getCacheStats()};
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_EQ(stats.cachedBytes, sizes[1] + sizes[2]);
+
+    resourceManager.load<Texture>("Texture1"_sn);
+    resourceManager.load<Texture>("Texture0"_sn);
+    stats = resourceManager.getCacheStats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 4u);
+
+    // Without a budget, nothing is kept.
+    resourceManager.setCacheBudget(0);
+    resourceManager.unload("Texture0"_sn);
+    EXPECT_EQ(resourceManager.getCacheStats().cachedBytes, 0u);
+    EXPECT_EQ(resourceManager.getCacheStats().evictions, 3u);
+}
+
+TEST_P(ResourceManagerTests, LoadsAndUnloadsFromManyThreads)
+{
+    std::string path {writeTestPackage(16)};
+    ResourceManager resourceManager {path.c_str(), GetParam()};
+    // Small enough that resources are evicted (and read again) while other threads are loading them.
+    resourceManager.setCacheBudget(256);
+    std::atomic<s32> mismatches {};
+    std::vector<std::thread> threads {};
+
+    for (s32 thread = 0; thread < 8; thread++)
+    {
+        threads.emplace_back([&, thread]
+        {
+            std::mt19937 random {static_cast<u32>(thread)};
+
+            for (s32 i = 0; i < 2000; i++)
+            {
+                s32 texture {static_cast<s32>(random() % 16)};
+                StringName name {StringNameTable::intern(std::format("Texture{}", texture))};
+                ResourceHandle<Texture> handle {i % 2 == 0 ? resourceManager.load<Texture>(name)
+                    : resourceManager.loadAsync<Texture>(name).wait()};
+
+                if (handle.data == nullptr || handle.data->width != 4 + texture || handle.data->pixelData[0] != static_cast<u8>(texture))
+                    mismatches++;
+
+                resourceManager.unload(name);
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(mismatches, 0);
+
+    // Every reference was dropped, so everything left fits in the budget.
+    ResourceCacheStats stats {resourceManager.getCacheStats()};
+    EXPECT_LE(stats.cachedBytes, 256u);
+    EXPECT_GT(stats.evictions, 0u);
+}
+
+TEST_P(ResourceManagerTests, RecordsTelemetry)
+{
+    std::string path {writeTestPackage(2)};
+    ResourceManager resourceManager {path.c_str(), GetParam()};
+
+    // Not recorded, since telemetry is off.
+    resourceManager.load<Texture>("Texture1"_sn);
+    resourceManager.setTelemetryEnabled(true);
+    resourceManager.update();
+
+    resourceManager.load<Texture>("Texture0"_sn);
+    resourceManager.unload("Texture0"_sn);
+    resourceManager.update();
+    resourceManager.load<Texture>("Texture0"_sn);
+    resourceManager.loadAsync<Texture>("Missing"_sn).wait();
+
+    std::vector<AssetLoadStats> stats {resourceManager.getTelemetry().getStats()};
+    ASSERT_EQ(stats.size(), 2u);
+    const AssetLoadStats& texture {stats[0].name == "Texture0"_sn.hash ? stats[0] : stats[1]};
+    const AssetLoadStats& missing {stats[0].name == "Texture0"_sn.hash ? stats[1] : stats[0]};
+
+    EXPECT_EQ(texture.misses, 1u);
+    EXPECT_EQ(texture.hits, 1u);
+    EXPECT_EQ(texture.failures, 0u);
+    EXPECT_GT(texture.size, 0u);
+    EXPECT_GT(texture.total.readBytes, 0u);
+    EXPECT_GT(texture.total.decodeNanoseconds, 0u);
+    EXPECT_EQ(texture.firstFrame, 1u);
+    EXPECT_EQ(texture.lastFrame, 2u);
+    EXPECT_EQ(missing.failures, 1u);
+}
+
+TEST_P(ResourceManagerTests, RecordsAccessTraces)
+{
+    std::string path {writeTestPackage(2)};
+    ResourceManager resourceManager {path.c_str(), GetParam()};
+
+    // Not recorded, since nothing is being traced yet.
+    resourceManager.load<Texture>("Texture0"_sn);
+    resourceManager.startAccessTrace();
+
+    resourceManager.load<Texture>("Texture1"_sn);
+    resourceManager.load<Texture>("Texture0"_sn);
+    resourceManager.loadAsync<Texture>("Texture1"_sn).wait();
+    resourceManager.load<Texture>("Missing"_sn);
+
+    std::vector<StringName> trace {resourceManager.stopAccessTrace()};
+    ASSERT_EQ(trace.size(), 3u);
+    EXPECT_EQ(trace[0], "Texture1"_sn);
+    EXPECT_EQ(trace[1], "Texture0"_sn);
+    EXPECT_EQ(trace[2], "Missing"_sn);
+
+    resourceManager.load<Texture>("Texture0"_sn);
+    EXPECT_TRUE(resourceManager.stopAccessTrace().empty());
+}
+
+TEST_P(ResourceManagerTests, PrefetchesAlongManifests)
+{
+    std::string path {writeTestPackage(6)};
+    std::vector<StringName::Hash> assets {};
+
+    for (s32 i = 0; i < 6; i++)
+        assets.push_back(StringName::createHash(std::format("Texture{}", i).c_str()));
+
+    std::string manifestPath {writeManifestPackage("Session"_sn, assets)};
+    ResourceManager resourceManager {path.c_str(), GetParam()};
+    resourceManager.mount(manifestPath.c_str());
+    EXPECT_FALSE(resourceManager.startPrefetch("Missing"_sn));
+
+    // Already loaded, so it isn't read ahead.
+    resourceManager.load<Texture>("Texture1"_sn);
+
+    // The start of the manifest is read ahead right away: Texture0, but not Texture1.
+    ASSERT_TRUE(resourceManager.startPrefetch("Session"_sn, 2));
+    EXPECT_EQ(resourceManager.getPrefetchStats().readAhead, 1u);
+
+    // Moves along to Texture2.
+    EXPECT_EQ(resourceManager.load<Texture>("Texture0"_sn).data->width, 4);
+    EXPECT_EQ(resourceManager.getPrefetchStats().readAhead, 2u);
+
+    // Jumps ahead, past Texture3, and reads the rest of the manifest.
+    resourceManager.load<Texture>("Unknown"_sn);
+    ResourceHandle<Texture> texture {resourceManager.load<Texture>("Texture4"_sn)};
+    ASSERT_NE(texture.data, nullptr);
+    EXPECT_EQ(texture.data->width, 8);
+    EXPECT_EQ(texture.data->pixelData[2], 6);
+    EXPECT_EQ(resourceManager.loadAsync<Texture>("Texture5"_sn).wait().data->width, 9);
+
+    PrefetchStats stats {resourceManager.getPrefetchStats()};
+    EXPECT_EQ(stats.followed, 3u);
+    EXPECT_EQ(stats.strayed, 1u);
+    EXPECT_EQ(stats.readAhead, 3u);
+
+    // The manifest is unloaded, and nothing moves anymore.
+    resourceManager.stopPrefetch();
+    resourceManager.load<Texture>("Texture3"_sn);
+    EXPECT_EQ(resourceManager.getPrefetchStats().followed, 3u);
+}
+
+TEST_P(ResourceManagerTests, MountsPackagesWithPriority)
+{
+    std::string base {writeTestPackage(3)};
+    std::string patch {writeTestPackage(2, true, "resource_manager_tests_patch.pak", 100)};
+    std::string mod {writeTestPackage(1, true, "resource_manager_tests_mod.pak", 200)};
+    ResourceManager resourceManager {GetParam()};
+    EXPECT_EQ(resourceManager.load<Texture>("Texture0"_sn).data, nullptr);
+
+    PackageId baseId {resourceManager.mount(base.c_str())};
+    PackageId patchId {resourceManager.mount(patch.c_str(), 1)};
+    // Mounted last, but with a lower priority than the patch.
+    PackageId modId {resourceManager.mount(mod.c_str())};
+    EXPECT_NE(baseId, INVALID_PACKAGE);
+    EXPECT_NE(patchId, INVALID_PACKAGE);
+    EXPECT_NE(modId, INVALID_PACKAGE);
+    EXPECT_EQ(resourceManager.getAccess(patchId), GetParam());
+    EXPECT_EQ(resourceManager.mount("missing.pak"), INVALID_PACKAGE);
+
+    EXPECT_EQ(resourceManager.load<Texture>("Texture0"_sn).data->width, 100);
+    EXPECT_EQ(resourceManager.load<Texture>("Texture1"_sn).data->width, 101);
+    EXPECT_EQ(resourceManager.load<Texture>("Texture2"_sn).data->width, 6);
+
+    ResourceHandle<Texture> texture {resourceManager.load<Texture>("Texture2"_sn)};
+    EXPECT_EQ(texture.data->pixelData[1], 3);
+}
+
+TEST_P(ResourceManagerTests, UnmountsPackages)
+{
+    std::string base {writeTestPackage(2)};
+    std::string patch {writeTestPackage(2, true, "resource_manager_tests_patch.pak", 100)};
+    ResourceManager resourceManager {base.c_str(), GetParam()};
+
+    // Held while the patch is mounted, so it keeps what it was loaded from.
+    ResourceHandle<Texture> held {resourceManager.load<Texture>("Texture1"_sn)};
+    resourceManager.load<Texture>("Texture0"_sn);
+    resourceManager.unload("Texture0"_sn);
+
+    PackageId patchId {resourceManager.mount(patch.c_str(), 1)};
+    EXPECT_EQ(resourceManager.getCacheStats().cachedBytes, 0u);
+    EXPECT_EQ(held.data->width, 5);
+    EXPECT_EQ(resourceManager.load<Texture>("Texture0"_sn).data->width, 100);
+    resourceManager.unload("Texture0"_sn);
+
+    // Once it is let go of, it is read again from the patch instead of being cached.
+    resourceManager.unload("Texture1"_sn);
+    EXPECT_EQ(resourceManager.load<Texture>("Texture1"_sn).data->width, 101);
+    resourceManager.unload("Texture1"_sn);
+
+    EXPECT_TRUE(resourceManager.unmount(patchId));
+    EXPECT_FALSE(resourceManager.unmount(patchId));
+    EXPECT_EQ(resourceManager.getCacheStats().cachedBytes, 0u);
+    EXPECT_EQ(resourceManager.load<Texture>("Texture0"_sn).data->width, 4);
+    EXPECT_EQ(resourceManager.loadAsync<Texture>("Texture1"_sn).wait().data->width, 5);
+}
+
+TEST_P(ResourceManagerTests, MergesManyAssets)
+{
+    std::string base {writeTestPackage(96)};
+    std::string patch {writeTestPackage(64, true, "resource_manager_tests_patch.pak", 100)};
+    std::string mod {writeTestPackage(32, true, "resource_manager_tests_mod.pak", 200)};
+    ResourceManager resourceManager {base.c_str(), GetParam()};
+    PackageId patchId {resourceManager.mount(patch.c_str(), 1)};
+    PackageId modId {resourceManager.mount(mod.c_str(), 2)};
+
+    // Unmounting empties slots in the middle of the merged index, which must not hide the entries after them.
+    EXPECT_TRUE(resourceManager.unmount(patchId));
+
+    for (s32 i = 0; i < 96; i++)
+    {
+        StringName name {StringNameTable::intern(std::format("Texture{}", i))};
+        EXPECT_EQ(resourceManager.load<Texture>(name).data->width, (i < 32 ? 200 : 4) + i);
+        resourceManager.unload(name);
+    }
+
+    // Back to one package, which is searched on its own.
+    EXPECT_TRUE(resourceManager.unmount(modId));
+    EXPECT_EQ(resourceManager.load<Texture>("Texture1"_sn).data->width, 5);
+}
+
+TEST_P(ResourceManagerTests, OverridesLoadsInFlight)
+{
+    std::string base {writeTestPackage(2)};
+    std::string patch {writeTestPackage(2, true, "resource_manager_tests_patch.pak", 100)};
+    ResourceManager resourceManager {base.c_str(), GetParam()};
+
+    // Streamed reads only start in update() or wait(), so this is still reading from the base when the patch wins.
+    AsyncResourceHandle<Texture> handle {resourceManager.loadAsync<Texture>("Texture0"_sn)};
+    PackageId patchId {resourceManager.mount(patch.c_str(), 1)};
+    EXPECT_EQ(handle.wait().data->width, 4);
+
+    // Once it is let go of, it is read again from the patch instead of being cached.
+    resourceManager.unload("Texture0"_sn);
+    EXPECT_EQ(resourceManager.getCacheStats().cachedBytes, 0u);
+    EXPECT_EQ(resourceManager.load<Texture>("Texture0"_sn).data->width, 100);
+    resourceManager.unload("Texture0"_sn);
+
+    // The same goes for a load from a package that is unmounted while it is read.
+    AsyncResourceHandle<Texture> patchHandle {resourceManager.loadAsync<Texture>("Texture1"_sn)};
+    EXPECT_TRUE(resourceManager.unmount(patchId));
+    EXPECT_EQ(patchHandle.wait().data->width, 101);
+    resourceManager.unload("Texture1"_sn);
+    EXPECT_EQ(resourceManager.load<Texture>("Texture1"_sn).data->width, 5);
+}
+
+INSTANTIATE_TEST_SUITE_P(Access, ResourceManagerTests, testing::Values(PackageAccess::Streamed, PackageAccess::Mapped),
+    [](const testing::TestParamInfo<PackageAccess>& info)
+    {
+        return info.param == PackageAccess::Mapped ? "Mapped" : "Streamed";
+    });
+
+TEST(ResourceManagerLogTests, LogsInBinary)
+{
+    std::string path {writeTestPackage(1)};
+    std::string logPath {testing::TempDir() + "resource_manager_tests.blog"};
+    Logger::startAsync({.binaryLogPath = logPath.c_str()});
+
+    {
+        ResourceManager resourceManager {path.c_str()};
+        EXPECT_NE(resourceManager.load<Texture>("Texture0"_sn).data, nullptr);
+        resourceManager.unload("Texture0"_sn);
+    }
+
+    Logger::stopAsync();
+    std::ifstream file {logPath, std::ios::binary};
+    std::vector<u8> data {std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    std::string text {};
+    EXPECT_TRUE(Logger::decodeBinaryLog(data, text));
+    EXPECT_NE(text.find("[Info:Resources] Ref count for Texture0 reached 0, so it was cached\n"), std::string::npos);
+}
+
+TEST(BinaryMemoryReaderTests, FlagsReadsPastTheEnd)
+{
+    u8 data[] {1, 2, 3, 4, 5, 6};
+    BinaryMemoryReader reader {data, sizeof(data)};
+
+    u32 value {};
+    reader.readFixed(&value);
+    EXPECT_EQ(value, 0x04030201u);
+    EXPECT_EQ(reader.view(2), data + 4);
+    EXPECT_FALSE(reader.failed());
+
+    reader.readFixed(&value);
+    EXPECT_EQ(value, 0u);
+    EXPECT_TRUE(reader.failed());
+}
+
+TEST(PackageTests, FindsEntries)
+{
+    PackageIndexEntry index[] {{2, 20, 0, 0}, {5, 50, 0, 0}, {9, 90, 0, 0}};
+
+    for (const PackageIndexEntry& entry : index)
+    {
+        const PackageIndexEntry* found {findPackageEntry(index, entry.hash)};
+        ASSERT_NE(found, nullptr);
+        EXPECT_EQ(found->offset, entry.offset);
+    }
+
+    EXPECT_EQ(findPackageEntry(index, 1), nullptr);
+    EXPECT_EQ(findPackageEntry(index, 6), nullptr);
+    EXPECT_EQ(findPackageEntry(index, 10), nullptr);
+    EXPECT_EQ(findPackageEntry({}, 2), nullptr);
+}
+
+TEST(PackageTests, RejectsDuplicateNames)
+{
+    std::string path {testing::TempDir() + "package_tests.pak"};
+    std::fstream file {path, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc};
+    PackageWriter writer {&file};
+
+    writer.beginAsset("Twice"_sn).writeFixed(1);
+    writer.beginAsset("Twice"_sn).writeFixed(2);
+    EXPECT_FALSE(writer.finish());
+}
+
+TEST(PackageTests, AlignsAssetsToBlocks)
+{
+    constexpr u64 BLOCK_SIZE {4096};
+    std::string path {testing::TempDir() + "package_tests_blocks.pak"};
+
+    {
+        std::fstream file {path, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc};
+        PackageWriter writer {&file, false, BLOCK_SIZE};
+
+        // Sizes, and whether each asset starts a block of its own.
+        std::pair<u64, bool> assets[] {{100, false}, {3000, false}, {2000, false}, {10000, false}, {10, true}};
+
+        for (size_t i = 0; i < std::size(assets); i++)
+        {
+            std::vector<u8> data(assets[i].first, static_cast<u8>(i + 1));
+            writer.beginAsset(StringName{i + 1}, assets[i].second).write(data[0], data.size());
+        }
+
+        ASSERT_TRUE(writer.finish());
+        EXPECT_GT(writer.getPaddingBytes(), 0u);
+    }
+
+    std::shared_ptr<PackageBank> bank {PackageBank::open(path.c_str(), PackageAccess::Mapped, 1, 0)};
+    ASSERT_NE(bank, nullptr);
+    const u8* data {bank->getMappedFile()->data()};
+
+    auto offsetOf = [&](StringName::Hash hash) { return findPackageEntry(bank->getIndex(), hash)->offset; };
+
+    // The first two share a block, the third would straddle into the next one, and the fourth is bigger than a block.
+    EXPECT_EQ(offsetOf(2) / BLOCK_SIZE, 0u);
+    EXPECT_EQ(offsetOf(3), BLOCK_SIZE);
+    EXPECT_EQ(offsetOf(4), BLOCK_SIZE * 2);
+    EXPECT_EQ(offsetOf(5), BLOCK_SIZE * 5);
+
+    for (const PackageIndexEntry& entry : bank->getIndex())
+    {
+        EXPECT_EQ(entry.offset % PACKAGE_ASSET_ALIGNMENT, 0u);
+        EXPECT_EQ(data[entry.offset], entry.hash);
+        EXPECT_EQ(data[entry.offset + entry.size - 1], entry.hash);
+    }
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <format>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../Engine/string_name.hpp"
+#include "../Engine/string_name_table.hpp"
+#include "../Engine/resources/binary_stream_builder.hpp"
+
+// Both of these only compile if the literal is a constant expression.
+static_assert(""_sn.hash == 0xCBF29CE484222325);
+static_assert("TerrainTest"_sn.hash == 0xC6BECA2B826A6D56);
+
+TEST(StringNameTests, LiteralMatchesRuntimeHash)
+{
+    std::string name {"TerrainTest"};
+    EXPECT_EQ("TerrainTest"_sn.hash, StringName::createHash(name.c_str()));
+}
+
+TEST(StringNameTests, Equality)
+{
+    constexpr StringName name {"Player"_sn};
+    EXPECT_TRUE(name == "Player"_sn);
+    EXPECT_FALSE(name == "player"_sn);
+    EXPECT_TRUE(name == StringName{StringName::createHash("Player")});
+}
+
+TEST(StringNameTests, Formatting)
+{
+    // Unknown names fall back to their hash.
+    EXPECT_EQ(std::format("{}", StringName{0x1234}), "#0000000000001234");
+
+#ifdef STRING_NAME_TABLE_ENABLED
+    StringNameTable::intern("TerrainTest");
+    EXPECT_EQ(std::format("{}", "TerrainTest"_sn), "TerrainTest");
+    EXPECT_EQ(std::format("{}", StringName{"TerrainTest"_sn.hash}), "TerrainTest");
+#endif // STRING_NAME_TABLE_ENABLED
+}
+
+TEST(StringNameTableTests, InternAndFind)
+{
+    StringName name {StringNameTable::intern(std::string{"Interned/Name"})};
+    EXPECT_EQ(name, "Interned/Name"_sn);
+    EXPECT_STREQ(StringNameTable::find(name.hash), "Interned/Name");
+    EXPECT_EQ(StringNameTable::find(StringName::createHash("Never/Interned")), nullptr);
+
+    // Interning the same string again does not add anything.
+    u32 count {StringNameTable::getCount()};
+    StringNameTable::intern("Interned/Name");
+    EXPECT_EQ(StringNameTable::getCount(), count);
+}
+
+TEST(StringNameTableTests, ConcurrentInterning)
+{
+    constexpr s32 THREAD_COUNT {4};
+    constexpr s32 NAMES_PER_THREAD {2000};
+    u32 count {StringNameTable::getCount()};
+    std::vector<std::thread> threads {};
+
+    // Every thread interns the same names, so they race on every insert.
+    for (s32 thread = 0; thread < THREAD_COUNT; thread++)
+    {
+        threads.emplace_back([]
+        {
+            for (s32 i = 0; i < NAMES_PER_THREAD; i++)
+                StringNameTable::intern(std::format("Concurrent/{}", i));
+        });
+    }
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(StringNameTable::getCount(), count + NAMES_PER_THREAD);
+
+    for (s32 i = 0; i < NAMES_PER_THREAD; i++)
+    {
+        std::string name {std::format("Concurrent/{}", i)};
+        EXPECT_EQ(StringNameTable::find(StringName::createHash(name.c_str())), name);
+    }
+}
+
+TEST(StringNameTableTests, WriteAndRead)
+{
+    StringNameTable::intern("Saved/First");
+    StringNameTable::intern("Saved/Second");
+    std::filesystem::path path {std::filesystem::temp_directory_path() / "string_name_table_test.bin"};
+
+    std::fstream file {path, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc};
+    BinaryStreamBuilder builder {&file};
+    StringNameTable::writeTo(builder);
+    u32 count {StringNameTable::getCount()};
+
+    // Reading the table back into itself must not duplicate or change anything.
+    size_t size {builder.tell()};
+    builder.seek(0);
+    StringNameTable::readFrom(builder, size);
+    file.close();
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(StringNameTable::getCount(), count);
+    EXPECT_STREQ(StringNameTable::find("Saved/Second"_sn.hash), "Saved/Second");
+}
+
+TEST(StringNameTableTests, SkipsDamagedTables)
+{
+    std::filesystem::path path {std::filesystem::temp_directory_path() / "string_name_table_damaged_test.bin"};
+    std::fstream file {path, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc};
+    BinaryStreamBuilder builder {&file};
+    StringName::Hash hash {"Damaged/Name"_sn.hash};
+    u32 count {StringNameTable::getCount()};
+
+    // A hash count far larger than the table.
+    builder.writeFixed(size_t {1} << 60).writeFixed(hash);
+    builder.seek(0);
+    StringNameTable::readFrom(builder, 2 * sizeof(size_t) + sizeof(hash));
+
+    // A string without its null terminator.
+    builder.seek(0);
+    builder.writeFixed(size_t {1}).writeFixed(hash).writeFixed(size_t {7}).write("Damaged"[0], 7);
+    size_t size {builder.tell()};
+    builder.seek(0);
+    StringNameTable::readFrom(builder, size);
+
+    // A bound that cuts the strings off.
+    builder.seek(0);
+    builder.writeFixed(size_t {1}).writeFixed(hash).writeFixed(size_t {13}).write("Damaged/Name"[0], 13);
+    size = builder.tell();
+    builder.seek(0);
+    StringNameTable::readFrom(builder, size - 1);
+
+    // More strings than the file holds.
+    builder.seek(0);
+    builder.writeFixed(size_t {1}).writeFixed(hash).writeFixed(size_t {40}).write("Damaged/Name"[0], 13);
+    builder.seek(0);
+    StringNameTable::readFrom(builder, size + 64);
+    file.close();
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(StringNameTable::getCount(), count);
+    EXPECT_EQ(StringNameTable::find(hash), nullptr);
+}
@@ -1,10 +1,18 @@
 #include <GL/glew.h>
 #include <imgui.h>
 #include <SDL2/SDL.h>
+#include <algorithm>
+#include <format>
+#include <string>
 #include <unordered_map>
 
+#include "logger.hpp"
 #include "resource_manager.hpp"
+#include "resources/prefetch_manifest.hpp"
 #include "math/mat4.hpp"
+#include "math/aabb.hpp"
+#include "math/frustum.hpp"
+#include "math/noise.hpp"
 #include "math/vec2.hpp"
 #include "math/vec4.hpp"
 #include "rendering/mesh.hpp"
@@ -21,22 +29,26 @@ class Terrain
 {
 public:
     explicit Terrain(GameTexture* heightmap, f32 heightScale)
+        : Terrain{readHeights(heightmap), heightmap->texture->width, heightmap->texture->height, heightScale}
     {
-        s32 width = heightmap->texture->width;
-        s32 height = heightmap->texture->height;
+    }
 
+    // Builds the terrain from width * height samples in [0, 1], stored row by row.
+    Terrain(const std::vector<f32>& heights, s32 width, s32 height, f32 heightScale)
+    {
         std::vector<f32> vertices;
+        m_bounds = Aabb{Vec3::ZERO, Vec3::ZERO};
 
         // Generate all the vertices based on the heightmap image.
         for (s32 x = 0; x < width; x++)
         {
             for (s32 y = 0; y < height; y++)
             {
-                u8* pixel = heightmap->texture->get<u8>(x, y);
                 // Points
                 vertices.push_back(static_cast<f32>(x));
-                vertices.push_back(static_cast<f32>(*pixel) / 255.0f * heightScale);
+                vertices.push_back(heights[y * width + x] * heightScale);
                 vertices.push_back(static_cast<f32>(y));
+                m_bounds.encapsulate({vertices[vertices.size() - 3], vertices[vertices.size() - 2], vertices[vertices.size() - 1]});
                 // UVs
                 vertices.push_back(static_cast<f32>(x));
                 vertices.push_back(static_cast<f32>(y));
@@ -76,13 +88,173 @@ public:
         m_mesh->draw(Renderer::TriangleStrips);
     }
 
+    const Aabb& getBounds() const
+    {
+        return m_bounds;
+    }
+
 private:
+    static std::vector<f32> readHeights(GameTexture* heightmap)
+    {
+        s32 width = heightmap->texture->width;
+        s32 height = heightmap->texture->height;
+        std::vector<f32> heights(width * height);
+
+        for (s32 x = 0; x < width; x++)
+        {
+            for (s32 y = 0; y < height; y++)
+                heights[y * width + x] = static_cast<f32>(*heightmap->texture->get<u8>(x, y)) / 255.0f;
+        }
+
+        return heights;
+    }
+
     Mesh* m_mesh;
+    Aabb m_bounds;
 };
 
+// Lists every asset the resource manager has served since recording started, so the heaviest assets
+// and the slowest load phases stand out. Every column sorts.
+// Also records access traces: session.trace, put in the ResourceCompiler's source directory, is packaged
+// as the "session" prefetch manifest, which Prefetch then follows.
+static void drawLoadTelemetry(ResourceManager& resourceManager)
+{
+    static bool recording{false};
+    static bool tracing{false};
+    static bool prefetching{false};
+
+    ImGui::Begin("Resource Loading");
+
+    if (ImGui::Checkbox("Record", &recording))
+        resourceManager.setTelemetryEnabled(recording);
+
+    ImGui::SameLine();
+
+    if (ImGui::Button("Clear"))
+        resourceManager.getTelemetry().clear();
+
+    ImGui::SameLine();
+
+    if (ImGui::Button("Export CSV"))
+        resourceManager.getTelemetry().writeCsv("load_telemetry.csv");
+
+    if (ImGui::Checkbox("Trace", &tracing))
+    {
+        if (tracing)
+            resourceManager.startAccessTrace();
+        else
+            writeAccessTrace("session.trace", resourceManager.stopAccessTrace());
+    }
+
+    ImGui::SameLine();
+
+    if (ImGui::Checkbox("Prefetch", &prefetching))
+    {
+        if (!prefetching)
+            resourceManager.stopPrefetch();
+        else if (!resourceManager.startPrefetch("session"_sn))
+            prefetching = false;
+    }
+
+    if (prefetching)
+    {
+        PrefetchStats prefetch = resourceManager.getPrefetchStats();
+        ImGui::SameLine();
+        ImGui::Text("%llu followed, %llu strayed, %llu read ahead", static_cast<unsigned long long>(prefetch.followed),
+            static_cast<unsigned long long>(prefetch.strayed), static_cast<unsigned long long>(prefetch.readAhead));
+    }
+
+    ResourceCacheStats cache = resourceManager.getCacheStats();
+    ImGui::Text("Frame %llu, cache: %llu hits, %llu misses, %.1f / %.1f MiB", static_cast<unsigned long long>(resourceManager.getFrame()),
+        static_cast<unsigned long long>(cache.hits), static_cast<unsigned long long>(cache.misses), static_cast<f64>(cache.cachedBytes) / (1024 * 1024), static_cast<f64>(cache.budget) / (1024 * 1024));
+
+    constexpr s32 columnCount = 9;
+    constexpr ImGuiTableFlags flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg
+        | ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY;
+
+    if (ImGui::BeginTable("##loads", columnCount, flags))
+    {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("Asset");
+        ImGui::TableSetupColumn("Hits");
+        ImGui::TableSetupColumn("Misses");
+        ImGui::TableSetupColumn("Read KiB");
+        ImGui::TableSetupColumn("I/O ms");
+        ImGui::TableSetupColumn("Decompress ms");
+        ImGui::TableSetupColumn("Decode ms", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_PreferSortDescending);
+        ImGui::TableSetupColumn("Slowest ms");
+        ImGui::TableSetupColumn("Last Frame");
+        ImGui::TableHeadersRow();
+
+        auto milliseconds = [](u64 nanoseconds) { return static_cast<f64>(nanoseconds) / 1e6; };
+        auto value = [&](const AssetLoadStats& stats, s32 column) -> f64
+        {
+            switch (column)
+            {
+            case 1: return stats.hits;
+            case 2: return stats.misses;
+            case 3: return static_cast<f64>(stats.total.readBytes) / 1024;
+            case 4: return milliseconds(stats.total.ioNanoseconds);
+            case 5: return milliseconds(stats.total.decompressNanoseconds);
+            case 6: return milliseconds(stats.total.decodeNanoseconds);
+            case 7: return milliseconds(stats.slowestNanoseconds);
+            default: return static_cast<f64>(stats.lastFrame);
+            }
+        };
+
+        // Names are resolved once per row, so the asset column sorts by them rather than by their hashes.
+        struct Row
+        {
+            AssetLoadStats stats;
+            std::string name;
+        };
+
+        std::vector<Row> rows{};
+
+        for (const AssetLoadStats& stats : resourceManager.getTelemetry().getStats())
+            rows.push_back({stats, std::format("{}", StringName{stats.name})});
+
+        if (const ImGuiTableSortSpecs* sortSpecs = ImGui::TableGetSortSpecs(); sortSpecs != nullptr && sortSpecs->SpecsCount > 0)
+        {
+            s32 column = sortSpecs->Specs[0].ColumnIndex;
+            bool ascending = sortSpecs->Specs[0].SortDirection == ImGuiSortDirection_Ascending;
+
+            std::stable_sort(rows.begin(), rows.end(), [&](const Row& a, const Row& b)
+            {
+                if (column == 0)
+                    return ascending ? a.name < b.name : a.name > b.name;
+
+                return ascending ? value(a.stats, column) < value(b.stats, column) : value(a.stats, column) > value(b.stats, column);
+            });
+        }
+
+        for (const Row& row : rows)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(row.name.c_str());
+
+            for (s32 column = 1; column < columnCount; column++)
+            {
+                ImGui::TableNextColumn();
+
+                if (column <= 2 || column == columnCount - 1)
+                    ImGui::Text("%.0f", value(row.stats, column));
+                else
+                    ImGui::Text("%.3f", value(row.stats, column));
+            }
+        }
+
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
+
 int main()
 {
     // === Initialization ===
+    Logger::startAsync();
     Application::init();
     Renderer::init();
     CustomImGui::init();
@@ -94,10 +266,30 @@ int main()
     ResourceManager resourceManager {"resources.pak"};
     Mesh mesh = Mesh::quad();
     Shader terrainShader = Shader::fromFiles("terrain.vert", "terrain.frag");
-    GameTexture heightmap {resourceManager.load<Texture>(R"(source\heightmap.ppm)"_sn).data};
     f32 terrain_height = 25;
-    GameTexture terrain_texture {resourceManager.load<Texture>("TerrainTest"_sn).data};
-    Terrain terrain{&heightmap, terrain_height};
+    const Texture* terrain_data {resourceManager.load<Texture>("TerrainTest"_sn).data};
+
+    // A package from an older ResourceCompiler won't mount at all, so this is where a stale one shows up.
+    if (terrain_data == nullptr)
+    {
+        Logger::log_error("Can't start without the TerrainTest texture. Rebuild resources.pak with the ResourceCompiler!");
+        CustomImGui::free();
+        mesh.free();
+        Application::free();
+        return 1;
+    }
+
+    GameTexture terrain_texture {terrain_data};
+
+    // Generated at load time, instead of shipping a heightmap in the package.
+    constexpr s32 terrain_size {512};
+    Math::noise::HeightfieldSettings terrain_noise {};
+    terrain_noise.seed = 1;
+    terrain_noise.fractal.frequency = 0.01f;
+    terrain_noise.warpStrength = 20;
+    std::vector<f32> terrain_heights(terrain_size * terrain_size);
+    Math::noise::generateHeightfield(terrain_heights.data(), terrain_size, terrain_size, terrain_noise);
+    Terrain terrain{terrain_heights, terrain_size, terrain_size, terrain_height};
 
     bool wantsToQuit{false};
     f32 elapsedTime{};
@@ -113,6 +305,7 @@ int main()
         // gather input
         Input::pollInput();
         wantsToQuit = Input::wantsToQuit();
+        resourceManager.update();
 
         static bool mouseShown{true};
 
@@ -253,6 +446,8 @@ int main()
             ImGui::End();
         }
 
+        drawLoadTelemetry(resourceManager);
+
         // Probably submit this to a rendering queue so it can be batched?
         // shader.use();
         // todo: these should be a uniform block because this stuff is pretty common?
@@ -269,7 +464,9 @@ int main()
         terrainShader.setVec3("bottomColor", terrain_bottomColor);
         terrainShader.setMat4("world_to_view", world_to_view);
         terrainShader.setMat4("view_to_clip", view_to_clip);
-        terrain.draw();
+
+        if (Frustum::fromMatrix(world_to_view * view_to_clip).intersects(terrain.getBounds()))
+            terrain.draw();
 
         // This should always happen after scene is rendered.
         CustomImGui::renderEnd();
@@ -0,0 +1,54 @@
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "logger.hpp"
+
+using namespace std;
+
+// Turns a binary log (see Logger::AsyncSettings::binaryLogPath) back into text.
+int main(int argc, char* argv[])
+{
+    if (argc != 2 && argc != 3)
+    {
+        cerr << "usage: \n[binaryLog] [outputFile]\nwrites to the console if no output file is given\n";
+        return 1;
+    }
+
+    ifstream input {argv[1], ios::binary};
+
+    if (!input.is_open())
+    {
+        cerr << "Failed to open file " << argv[1] << "!" << endl;
+        return 1;
+    }
+
+    vector<u8> data {istreambuf_iterator<char>{input}, {}};
+    string text {};
+    bool complete {Logger::decodeBinaryLog(data, text)};
+
+    if (argc == 3)
+    {
+        ofstream output {argv[2], ios::out | ios::trunc};
+
+        if (!output.is_open())
+        {
+            cerr << "Failed to open file " << argv[2] << "!" << endl;
+            return 1;
+        }
+
+        output << text;
+    }
+    else
+        cout << text;
+
+    if (!complete)
+    {
+        cerr << argv[1] << " is not a binary log, or is damaged. Decoded everything up to the damage." << endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,6 +1,10 @@
 ﻿#include "factory_util.hpp"
+#include <format>
 #include <fstream>
 #include <iostream>
+#include <system_error>
+#include <thread>
+#include "logger.hpp"
 
 std::filesystem::path SETTINGS_FILE_DIR = "resources/settings";
 std::filesystem::path BINARY_FILE_DIR = "resources/data";
@@ -8,7 +12,7 @@ std::filesystem::path BINARY_FILE_DIR = "resources/data";
 std::fstream openFile(std::string_view fileName, std::ios::openmode openMode)
 {
     std::fstream fileStream{};
-    fileStream.open(fileName, openMode | std::ios::in | std::ios::out);
+    fileStream.open(std::filesystem::path{fileName}, openMode | std::ios::in | std::ios::out);
 
     if (!fileStream.is_open())
         std::cerr << "Failed to open file " << fileName << std::endl;
@@ -24,7 +28,7 @@ std::filesystem::path getSettingsFilePath(std::string_view fileName)
 
 std::fstream openSettingsFile(std::string_view fileName, bool isWriting)
 {
-    std::ios::openmode openMode {0};
+    std::ios::openmode openMode {};
 
     if (isWriting)
         openMode |= std::ios::trunc;
@@ -48,6 +52,45 @@ std::fstream openBinaryFile(std::string_view fileName, bool isWriting)
     return openFile(getBinaryFilePath(fileName).string(), openMode);
 }
 
+bool writeFileAtomically(const std::filesystem::path& path, std::ios::openmode openMode, const std::function<void(std::fstream&)>& write)
+{
+    std::filesystem::path temporaryPath{path};
+    temporaryPath += std::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+    {
+        std::fstream file{temporaryPath, openMode | std::ios::out | std::ios::trunc};
+
+        if (!file.is_open())
+        {
+            Logger::log_error("Failed to open {} to write!", temporaryPath.string());
+            return false;
+        }
+
+        write(file);
+        file.flush();
+
+        if (!file)
+        {
+            Logger::log_error("Failed to write {}!", temporaryPath.string());
+            file.close();
+            std::filesystem::remove(temporaryPath);
+            return false;
+        }
+    }
+
+    std::error_code error{};
+    std::filesystem::rename(temporaryPath, path, error);
+
+    if (error)
+    {
+        Logger::log_error("Failed to move {} into place. Reason: {}", path.string(), error.message());
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+
+    return true;
+}
+
 void applyResourceSettings(Resource* resource, const nlohmann::json& settings)
 {
     resource->name = settings["ResourceName"];
@@ -2,6 +2,7 @@
 
 #include <fstream>
 #include <filesystem>
+#include <functional>
 #include <nlohmann/json.hpp>
 #include "resources/resource.hpp"
 
@@ -16,5 +17,9 @@ std::fstream openSettingsFile(std::string_view fileName, bool isWriting);
 std::filesystem::path getBinaryFilePath(std::string_view fileName);
 std::fstream openBinaryFile(std::string_view fileName, bool isWriting);
 
+// Writes a whole file under a name of this thread's own, and then renames it into place, so workers building at
+// once (or a package step reading it) never see half of one. Returns false (and logs why) if it can't be written.
+bool writeFileAtomically(const std::filesystem::path& path, std::ios::openmode openMode, const std::function<void(std::fstream&)>& write);
+
 void applyResourceSettings(Resource* resource, const nlohmann::json& settings);
 void writeResourceSettings(const Resource& resource, nlohmann::json& settings);
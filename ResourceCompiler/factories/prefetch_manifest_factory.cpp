@@ -0,0 +1,43 @@
+﻿#include "prefetch_manifest_factory.hpp"
+#include "factory_util.hpp"
+#include "../../Engine/resources/binary_stream_builder.hpp"
+#include "../../Engine/resources/resource_manager.hpp"
+#include <nlohmann/json.hpp>
+
+void PrefetchManifestFactory::serialize(std::string_view fileName, BinaryStreamBuilder& packageFile)
+{
+    std::vector<StringName::Hash> assets = readManifest(fileName);
+    PrefetchManifest manifest{.assetCount = static_cast<u32>(assets.size()), .assets = assets.data()};
+    writeResourceTo(&manifest, packageFile);
+}
+
+bool PrefetchManifestFactory::writeManifest(const std::vector<StringName::Hash>& assets, const Resource& resource, const char* fileName)
+{
+    nlohmann::json settings{};
+    writeResourceSettings(resource, settings);
+
+    // Like TextureFactory::writeTexture(...), the binary file goes first.
+    bool binaryWritten = writeFileAtomically(getBinaryFilePath(fileName), std::ios::binary, [&](std::fstream& binaryFile)
+    {
+        BinaryStreamBuilder{&binaryFile}.writeVector(assets);
+    });
+
+    return binaryWritten && writeFileAtomically(getSettingsFilePath(fileName), {}, [&](std::fstream& settingsFile)
+    {
+        settingsFile << std::setw(4) << settings;
+    });
+}
+
+std::vector<StringName::Hash> PrefetchManifestFactory::readManifest(std::string_view fileName)
+{
+    std::fstream binaryFile = openBinaryFile(fileName, false);
+    std::vector<StringName::Hash> assets{};
+    BinaryStreamBuilder{&binaryFile}.readVector(&assets);
+    binaryFile.close();
+    return assets;
+}
+
+bool PrefetchManifestFactory::canSerialize(std::string_view type)
+{
+    return type == PrefetchManifest::TYPE_NAME;
+}
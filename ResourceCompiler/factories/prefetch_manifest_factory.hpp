@@ -0,0 +1,18 @@
+﻿#pragma once
+
+#include <vector>
+#include "resource_factory.hpp"
+#include "resources/resource.hpp"
+#include "resources/prefetch_manifest.hpp"
+
+class PrefetchManifestFactory final : public ResourceFactory
+{
+public:
+    void serialize(std::string_view fileName, BinaryStreamBuilder& packageFile) override;
+    bool canSerialize(std::string_view type) override;
+
+    static bool writeManifest(const std::vector<StringName::Hash>& assets, const Resource& resource, const char* fileName);
+
+    // The assets of a manifest written by writeManifest(...), in order.
+    static std::vector<StringName::Hash> readManifest(std::string_view fileName);
+};
@@ -11,11 +11,10 @@ void TextureFactory::serialize(std::string_view fileName, BinaryStreamBuilder& p
     nlohmann::json settings = nlohmann::json::parse(settingsFile);
     settingsFile.close();
 
-    applyResourceSettings(texture, settings);
-    texture->mipmapFiltering = parseTextureFiltering(settings["TextureMipmapFiltering"]);
-    texture->textureFiltering = parseTextureFiltering(settings["TextureFiltering"]);
-    texture->wrappingX = parseTextureWrapping(settings["TextureWrappingX"]);
-    texture->wrappingY = parseTextureWrapping(settings["TextureWrappingY"]);
+    texture->mipmapFiltering = parseTextureFiltering(settings["TextureMipmapFiltering"].get<std::string>());
+    texture->textureFiltering = parseTextureFiltering(settings["TextureFiltering"].get<std::string>());
+    texture->wrappingX = parseTextureWrapping(settings["TextureWrappingX"].get<std::string>());
+    texture->wrappingY = parseTextureWrapping(settings["TextureWrappingY"].get<std::string>());
 
     std::fstream binaryFile = openBinaryFile(fileName, false);
     BinaryStreamBuilder builder{&binaryFile};
@@ -32,29 +31,30 @@ void TextureFactory::serialize(std::string_view fileName, BinaryStreamBuilder& p
     writeResourceTo(texture, packageFile);
 }
 
-void TextureFactory::writeTexture(const Texture& texture, const char* fileName)
+bool TextureFactory::writeTexture(const Texture& texture, const Resource& resource, const char* fileName)
 {
     nlohmann::json settings{};
-    writeResourceSettings(texture, settings);
+    writeResourceSettings(resource, settings);
     settings["TextureMipmapFiltering"] = getDisplayName(texture.mipmapFiltering);
     settings["TextureFiltering"] = getDisplayName(texture.textureFiltering);
     settings["TextureWrappingX"] = getDisplayName(texture.wrappingX);
     settings["TextureWrappingY"] = getDisplayName(texture.wrappingY);
 
-    std::fstream settingsFile = openSettingsFile(fileName, true);
-    settingsFile << std::setw(4) << settings;
-    settingsFile.close();
-
-    std::fstream binaryFile = openBinaryFile(fileName, true);
-
-    BinaryStreamBuilder{&binaryFile}
-        .writeFixed(texture.width)
-        .writeFixed(texture.height)
-        .writeFixed(texture.format)
-        .writeFixed(texture.channels)
-        .write(texture.pixelData[0], texture.pixelDataLength());
-
-    binaryFile.close();
+    // The binary file goes first, so a settings file is never found without the data it describes.
+    bool binaryWritten = writeFileAtomically(getBinaryFilePath(fileName), std::ios::binary, [&](std::fstream& binaryFile)
+    {
+        BinaryStreamBuilder{&binaryFile}
+            .writeFixed(texture.width)
+            .writeFixed(texture.height)
+            .writeFixed(texture.format)
+            .writeFixed(texture.channels)
+            .write(texture.pixelData[0], texture.pixelDataLength());
+    });
+
+    return binaryWritten && writeFileAtomically(getSettingsFilePath(fileName), {}, [&](std::fstream& settingsFile)
+    {
+        settingsFile << std::setw(4) << settings;
+    });
 }
 
 bool TextureFactory::canSerialize(std::string_view type)
@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include "resource_factory.hpp"
+#include "resources/resource.hpp"
 #include "resources/texture.hpp"
 
 class TextureFactory final : public ResourceFactory
@@ -9,5 +10,6 @@ public:
     void serialize(std::string_view fileName, BinaryStreamBuilder& packageFile) override;
     bool canSerialize(std::string_view type) override;
 
-    static void writeTexture(const Texture& texture, const char* fileName);
+    // Safe to call from several threads at once, for different files.
+    static bool writeTexture(const Texture& texture, const Resource& resource, const char* fileName);
 };
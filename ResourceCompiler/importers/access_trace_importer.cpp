@@ -0,0 +1,41 @@
+﻿#include "access_trace_importer.hpp"
+#include <filesystem>
+#include <unordered_set>
+#include <vector>
+#include "logger.hpp"
+#include "resources/prefetch_manifest.hpp"
+#include "../factories/prefetch_manifest_factory.hpp"
+
+std::unordered_set<std::string_view> AccessTraceImporter::supportedExtensions()
+{
+    return {".trace"};
+}
+
+bool AccessTraceImporter::process(const char* fileName)
+{
+    std::vector<StringName::Hash> trace{};
+
+    if (!readAccessTrace(fileName, trace))
+        return false;
+
+    // Traces may be put together by hand, so only the first request for each asset is kept.
+    std::vector<StringName::Hash> assets{};
+    std::unordered_set<StringName::Hash> seen{};
+
+    for (StringName::Hash asset : trace)
+    {
+        if (seen.insert(asset).second)
+            assets.push_back(asset);
+    }
+
+    if (assets.empty())
+    {
+        Logger::log_error("Access trace {} is empty!", fileName);
+        return false;
+    }
+
+    std::string name{std::filesystem::path{fileName}.stem().string()};
+    Resource resource{.name = name, .type = PrefetchManifest::TYPE_NAME, .version = 1};
+
+    return PrefetchManifestFactory::writeManifest(assets, resource, fileName);
+}
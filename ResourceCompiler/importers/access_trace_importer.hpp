@@ -0,0 +1,11 @@
+﻿#pragma once
+
+#include "../resource_importer.hpp"
+
+// Turns an access trace (see ResourceManager::startAccessTrace()) into a prefetch manifest, named after the trace's file.
+class AccessTraceImporter final : public ResourceImporter
+{
+public:
+    std::unordered_set<std::string_view> supportedExtensions() override;
+    bool process(const char* fileName) override;
+};
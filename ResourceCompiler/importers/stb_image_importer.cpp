@@ -13,9 +13,8 @@ std::unordered_set<std::string_view> StbImageImporter::supportedExtensions()
 bool StbImageImporter::process(const char* fileName)
 {
     Texture texture{};
+    Resource resource{.name = fileName, .type = Texture::TYPE_NAME, .version = 1};
 
-    texture.name = fileName;
-    texture.version = 1;
     texture.pixelData = stbi_load(fileName, &texture.width, &texture.height, &texture.channels, 0);
 
     if (texture.pixelData == nullptr)
@@ -36,6 +35,7 @@ bool StbImageImporter::process(const char* fileName)
             texture.format = ColorFormat::Rgba;
     }
 
-    TextureFactory::writeTexture(texture, fileName);
-    return true;
+    bool written = TextureFactory::writeTexture(texture, resource, fileName);
+    stbi_image_free(texture.pixelData);
+    return written;
 }
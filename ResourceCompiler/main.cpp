@@ -1,139 +1,283 @@
+#include <algorithm>
+#include <bit>
+#include <charconv>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
-#include <unordered_map>
+#include <map>
+#include <mutex>
 #include <nlohmann/json.hpp>
 
 #include "logger.hpp"
+#include "resources/package.hpp"
 #include "resource_factory.hpp"
 #include "resource_importer.hpp"
+#include "package_layout.hpp"
 #include "string_name.hpp"
+#include "string_name_table.hpp"
+#include "thread_pool.hpp"
 #include "factories/factory_util.hpp"
+#include "factories/prefetch_manifest_factory.hpp"
 #include "factories/texture_factory.hpp"
+#include "importers/access_trace_importer.hpp"
 #include "importers/stb_image_importer.hpp"
 #include "math/vec3.hpp"
 
 using namespace std;
 using namespace std::filesystem;
 
-int build(const path& sourceDir, const path& buildDir);
-int package(const path& buildDir, const path& packageDir);
+int build(const path& sourceDir, const path& buildDir, u32 jobCount);
+bool parseJobCount(const char* text, u32* jobCount);
+bool parseBlockSize(const char* text, u64* blockSize);
+int package(const path& buildDir, const path& packageDir, u64 blockSize);
+
+// Assets are laid out so the ones used together touch as few pages (and disk sectors) as they can.
+constexpr u64 DEFAULT_BLOCK_SIZE{4096};
 
 int main(int argc, char* argv[])
 {
     if (argc >= 4)
     {
-        if (strcmp(argv[1], "build") == 0)
+        if (strcmp(argv[1], "build") == 0 && (argc == 4 || (argc == 6 && strcmp(argv[4], "-j") == 0)))
         {
-            return build(argv[2], argv[3]);
+            u32 jobCount {0};
+
+            if (argc == 6 && !parseJobCount(argv[5], &jobCount))
+            {
+                cerr << "-j needs a whole number of jobs above 0, not \"" << argv[5] << "\"\n";
+                return 1;
+            }
+
+            return build(argv[2], argv[3], jobCount);
         }
 
         if (strcmp(argv[1], "package") == 0)
         {
-            return package(argv[2], argv[3]);
+            u64 blockSize{DEFAULT_BLOCK_SIZE};
+
+            if (argc >= 5 && !parseBlockSize(argv[4], &blockSize))
+            {
+                Logger::log_error("The block size must be 0 or a power of two, not \"{}\"!", argv[4]);
+                return 1;
+            }
+
+            return package(argv[2], argv[3], blockSize);
         }
     }
 
-    cerr << "usage: \nbuild [sourceDir] [buildDir]\npackage [buildDir] [packageDir]\n";
+    cerr << "usage: \nbuild [sourceDir] [buildDir] [-j jobs]\npackage [buildDir] [packageDir] [blockSize]\n"
+            "build imports files on as many threads as there are jobs (one per hardware thread by default)\n"
+            "access traces (.trace) in the source directory are built into prefetch manifests, named after the file\n"
+            "packages lay assets out in the order the traces asked for them, then by their PackageGroup setting\n"
+            "blockSize (a power of two, 4096 by default, or 0 to pack tightly) is the page or sector size assets are aligned to\n";
     return 1;
 }
 
-int build(const path& sourceDir, const path& buildDir)
+// 0 would ask the thread pool for one job per hardware thread, so it is only ever the default, never typed.
+bool parseJobCount(const char* text, u32* jobCount)
+{
+    const char* end = text + strlen(text);
+    auto [last, error] = from_chars(text, end, *jobCount);
+    return error == errc{} && last == end && *jobCount > 0;
+}
+
+// 0 packs tightly, anything else is a page or sector size.
+bool parseBlockSize(const char* text, u64* blockSize)
+{
+    const char* end = text + strlen(text);
+    auto [last, error] = from_chars(text, end, *blockSize);
+    return error == errc{} && last == end && (*blockSize == 0 || has_single_bit(*blockSize));
+}
+
+int build(const path& sourceDir, const path& buildDir, u32 jobCount)
 {
     SETTINGS_FILE_DIR = buildDir / "settings";
     BINARY_FILE_DIR = buildDir / "data";
 
     cout << "source: " << sourceDir << ", build: " << buildDir << endl;
 
+    // Made up front, since every worker writes into them.
+    error_code error{};
+    create_directories(SETTINGS_FILE_DIR, error);
+    create_directories(BINARY_FILE_DIR, error);
+
+    if (error)
+    {
+        Logger::log_error("Failed to make the build directories in {}. Reason: {}", buildDir.string(), error.message());
+        return 1;
+    }
+
+    // Importers keep no state, so each one is shared by every worker.
     vector<ResourceImporter*> importers{
         new StbImageImporter{},
+        new AccessTraceImporter{},
     };
 
+    struct Import
+    {
+        path file;
+        ResourceImporter* importer;
+    };
+
+    vector<Import> imports{};
+
     for (path file : recursive_directory_iterator{sourceDir})
     {
         for (ResourceImporter* importer : importers)
         {
             if (importer->supportedExtensions().contains(file.extension().string()))
+                imports.push_back({file, importer});
+        }
+    }
+
+    // Sorted, so which file wins below doesn't depend on directory order.
+    sort(imports.begin(), imports.end(), [](const Import& a, const Import& b) { return a.file < b.file; });
+
+    // Built files are named after the source file alone, so two sources with the same name would write the
+    // same files. Sequential builds let the last one win, so parallel ones do too, instead of racing.
+    map<path, size_t> outputs{};
+
+    for (size_t i = 0; i < imports.size(); i++)
+    {
+        auto [output, inserted] = outputs.try_emplace(imports[i].file.filename(), i);
+
+        if (!inserted)
+        {
+            Logger::log_warning("{} and {} are both built into {}, so only the second is kept", imports[output->second].file.string(),
+                imports[i].file.string(), imports[i].file.filename().string());
+            output->second = i;
+        }
+    }
+
+    // Decoding images is most of the work, and every file is independent of the others.
+    ThreadPool workers{jobCount};
+    std::mutex consoleMutex{};
+    std::atomic<u32> failures{};
+
+    for (const auto& [output, i] : outputs)
+    {
+        workers.submit([&, i]
+        {
             {
-                cout << "converting " << file << std::endl;
-                importer->process(file.string().c_str());
+                std::scoped_lock lock{consoleMutex};
+                cout << "converting " << imports[i].file << endl;
             }
-        }
+
+            if (!imports[i].importer->process(imports[i].file.string().c_str()))
+            {
+                std::scoped_lock lock{consoleMutex};
+                cerr << "failed to convert " << imports[i].file << endl;
+                failures++;
+            }
+        });
     }
 
-    return 0;
+    workers.wait();
+    return failures == 0 ? 0 : 1;
 }
 
-int package(const path& buildDir, const path& packageDir)
+int package(const path& buildDir, const path& packageDir, u64 blockSize)
 {
     SETTINGS_FILE_DIR = buildDir / "settings";
     BINARY_FILE_DIR = buildDir / "data";
 
     std::vector<ResourceFactory*> factories{
         new TextureFactory{},
+        new PrefetchManifestFactory{},
     };
 
-    // desired output: one big package file. header = resource name hashes -> resource offset
-    // step 1: calculate header size (key-values for each resource)
-    //   - stringHash size (u64)
-    //   - resource offset (size_t)
-    //   - total header size = sizeof(stringHash + size_t struct) * resource files
-
-    std::unordered_map<StringName::Hash, size_t> hashToOffset;
-    size_t assetCount{};
-
-    for (directory_entry entry : recursive_directory_iterator{SETTINGS_FILE_DIR})
-        assetCount++;
-
-    size_t headerSize{(sizeof(StringName::Hash) + sizeof(size_t)) * assetCount + sizeof(size_t)};
-    Logger::log("{} bytes reserved for header.", headerSize);
+    if (blockSize % PACKAGE_ASSET_ALIGNMENT != 0)
+    {
+        Logger::log_error("The block size must be a multiple of {}!", PACKAGE_ASSET_ALIGNMENT);
+        return 1;
+    }
 
-    // step 2: loop through all settings + data files and create memory reps, and append to file (storing name hash -> pos in dict)
-    //   - factories[RESOURCE_TYPE]->serialize(const char* fileName)
+    // desired output: one big package file, laid out as described in package.hpp.
+    // step 1: find every asset, and the factory that writes it
+    std::vector<path> settingsFiles{};
 
-    std::fstream packageFile{};
-    packageFile.open(packageDir / "resources.pak", std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
-    BinaryStreamBuilder packageBuilder{&packageFile};
-    packageFile.seekg(static_cast<std::streamoff>(headerSize));
+    for (const directory_entry& entry : recursive_directory_iterator{SETTINGS_FILE_DIR})
+    {
+        // Skips files a build left half written, see writeFileAtomically(...).
+        if (entry.is_regular_file() && entry.path().extension() == ".json")
+            settingsFiles.push_back(entry.path());
+    }
 
-    if (!packageFile.is_open())
-        Logger::log_error("Failed to open package file!");
+    // Directory order differs between file systems, so packages would too.
+    std::sort(settingsFiles.begin(), settingsFiles.end());
+    std::vector<PackageAsset> assets{};
 
-    for (const directory_entry& entry : recursive_directory_iterator{SETTINGS_FILE_DIR})
+    for (const path& file : settingsFiles)
     {
         nlohmann::json settings{};
         std::fstream settingsFile{};
-        settingsFile.open(entry.path());
+        settingsFile.open(file);
         settingsFile >> settings;
         settingsFile.close();
 
-        for (ResourceFactory* factory : factories)
+        std::string type = settings["ResourceType"];
+        std::string name = settings["ResourceName"];
+        auto factory = std::find_if(factories.begin(), factories.end(), [&](ResourceFactory* factory)
         {
-            std::string type = settings["ResourceType"];
-            std::string name = settings["ResourceName"];
+            return factory->canSerialize(type);
+        });
 
-            if (factory->canSerialize(type))
-            {
-                Logger::log("{} is being serialized", entry.path().string());
-                StringName::Hash hash{StringName::createHash(name.c_str())};
-                hashToOffset.emplace(hash, packageFile.tellg());
-                factory->serialize(entry.path().stem().string(), packageBuilder);
-            }
+        if (factory == factories.end())
+        {
+            Logger::log_warning("Nothing can package {}, which is a {}", file.string(), type);
+            continue;
         }
+
+        assets.push_back({
+            .fileName = file.stem().string(),
+            .name = name,
+            .type = type,
+            .group = settings.value("PackageGroup", std::string{}),
+            .factory = *factory,
+        });
     }
 
-    // step 3: insert the generated dict into the reserved header
-    packageFile.seekg(0);
-    packageBuilder.writeFixed(assetCount);
+    // step 2: put the assets that are used together next to each other
+    std::vector<std::vector<StringName::Hash>> traces{};
 
-    for (auto [hash, offset] : hashToOffset)
+    for (const PackageAsset& asset : assets)
     {
-        Logger::log("Hash: {}, Offset: {}", hash, offset);
+        if (asset.type == PrefetchManifest::TYPE_NAME)
+            traces.push_back(PrefetchManifestFactory::readManifest(asset.fileName));
+    }
+
+    std::vector<std::vector<const PackageAsset*>> layout = layoutPackage(assets, traces);
+
+    std::fstream packageFile{};
+    packageFile.open(packageDir / "resources.pak", std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
 
-        packageBuilder.writeFixed(hash)
-                      .writeFixed(offset);
+    if (!packageFile.is_open())
+    {
+        Logger::log_error("Failed to open package file!");
+        return 1;
+    }
+
+    PackageWriter packageWriter{&packageFile, true, blockSize};
+
+    // step 3: append each asset to the file, in that order
+    for (const std::vector<const PackageAsset*>& group : layout)
+    {
+        for (size_t i = 0; i < group.size(); i++)
+        {
+            Logger::log("{} is being serialized", group[i]->fileName);
+            // Interning catches hash collisions between asset names here, instead of at runtime.
+            group[i]->factory->serialize(group[i]->fileName, packageWriter.beginAsset(StringNameTable::intern(group[i]->name), i == 0));
+        }
+    }
+
+    // step 4: append the name table and the sorted index, then fill in the header
+    if (!packageWriter.finish())
+    {
+        Logger::log_error("Failed to write package file!");
+        return 1;
     }
 
     packageFile.close();
+    Logger::log("Packaged {} assets in {} groups, with {} bytes of padding", assets.size(), layout.size(), packageWriter.getPaddingBytes());
     return 0;
 }
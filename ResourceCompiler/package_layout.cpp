@@ -0,0 +1,83 @@
+﻿#include "package_layout.hpp"
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include "resources/prefetch_manifest.hpp"
+
+std::vector<std::vector<const PackageAsset*>> layoutPackage(std::span<const PackageAsset> assets,
+    std::span<const std::vector<StringName::Hash>> traces)
+{
+    std::vector<const PackageAsset*> sorted{};
+
+    for (const PackageAsset& asset : assets)
+        sorted.push_back(&asset);
+
+    std::sort(sorted.begin(), sorted.end(), [](const PackageAsset* a, const PackageAsset* b)
+    {
+        return a->name < b->name;
+    });
+
+    std::unordered_map<StringName::Hash, const PackageAsset*> byName{};
+
+    for (const PackageAsset* asset : sorted)
+        byName.emplace(StringName::createHash(asset->name.data(), asset->name.size()), asset);
+
+    std::vector<std::vector<const PackageAsset*>> layout{};
+    std::unordered_set<const PackageAsset*> placed{};
+
+    auto addGroup = [&](const std::vector<const PackageAsset*>& assetsInOrder)
+    {
+        std::vector<const PackageAsset*> group{};
+
+        for (const PackageAsset* asset : assetsInOrder)
+        {
+            if (placed.insert(asset).second)
+                group.push_back(asset);
+        }
+
+        if (!group.empty())
+            layout.push_back(std::move(group));
+    };
+
+    std::vector<const PackageAsset*> manifests{};
+
+    for (const PackageAsset* asset : sorted)
+    {
+        if (asset->type == PrefetchManifest::TYPE_NAME)
+            manifests.push_back(asset);
+    }
+
+    addGroup(manifests);
+
+    for (const std::vector<StringName::Hash>& trace : traces)
+    {
+        std::vector<const PackageAsset*> traced{};
+
+        // Traces may list assets that were removed since, or that some other package has.
+        for (StringName::Hash name : trace)
+        {
+            if (auto asset = byName.find(name); asset != byName.end())
+                traced.push_back(asset->second);
+        }
+
+        addGroup(traced);
+    }
+
+    std::map<std::string, std::vector<const PackageAsset*>> groups{};
+    std::vector<const PackageAsset*> rest{};
+
+    for (const PackageAsset* asset : sorted)
+    {
+        if (asset->group.empty())
+            rest.push_back(asset);
+        else
+            groups[asset->group].push_back(asset);
+    }
+
+    for (const auto& [name, group] : groups)
+        addGroup(group);
+
+    addGroup(rest);
+    return layout;
+}
@@ -0,0 +1,32 @@
+﻿#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+#include "string_name.hpp"
+
+class ResourceFactory;
+
+// An asset to package, as its settings file describes it.
+struct PackageAsset
+{
+    // The settings file's name, which the factory reads the asset by.
+    std::string fileName;
+    std::string name;
+    std::string type;
+    // The optional PackageGroup setting, for assets that are used together but aren't in any trace.
+    std::string group;
+    ResourceFactory* factory;
+};
+
+/**
+ * \brief Orders assets so the ones used together sit together in the package.
+ * \details Prefetch manifests come first, since they are loaded before anything they list. Then each access trace
+ * claims the assets it lists that nothing claimed yet, in the order they were asked for. Then each group (by the
+ * PackageGroup setting), and then everything left. Groups are sorted by their name, and assets within them by
+ * theirs, so the layout doesn't depend on the order the settings files were found in.
+ * \param traces The assets of each access trace, in the order they were asked for.
+ * \return The groups, in the order to write them. Each one should start on a new block (see PackageWriter).
+ */
+std::vector<std::vector<const PackageAsset*>> layoutPackage(std::span<const PackageAsset> assets,
+    std::span<const std::vector<StringName::Hash>> traces);